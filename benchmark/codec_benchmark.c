@@ -0,0 +1,246 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "codec_benchmark.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "memory_manager.h"
+
+// A case runs at least this many operations...
+#define CODEC_BENCHMARK_OPS_MIN (16)
+// ...and at least this long [ns]...
+#define CODEC_BENCHMARK_TIME_MIN_NS (200000000LL)
+// ...but stops after this many operations.
+#define CODEC_BENCHMARK_OPS_MAX (100000)
+
+// Heap allocations made by the process. The executable is linked with
+// --wrap=malloc/calloc/realloc, so these count every allocation of code that
+// is linked statically, the codecs and parson included.
+static uint64_t s_alloc_count = 0;
+
+// Substring a case name must contain to run, NULL runs every case.
+static const char* s_filter = NULL;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  __atomic_fetch_add(&s_alloc_count, 1, __ATOMIC_RELAXED);
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size) {
+  __atomic_fetch_add(&s_alloc_count, 1, __ATOMIC_RELAXED);
+  return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  __atomic_fetch_add(&s_alloc_count, 1, __ATOMIC_RELAXED);
+  return __real_realloc(ptr, size);
+}
+
+// """Gets the monotonic clock.
+
+// Returns:
+//    Current time [ns].
+static int64_t CodecBenchmarkNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// qsort comparator of latency samples.
+static int CodecBenchmarkCompare(const void* a, const void* b) {
+  int64_t lhs = *(const int64_t*)a;
+  int64_t rhs = *(const int64_t*)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+// """Gets the printable name of an access mode.
+
+// Args:
+//    mode (CodecBenchmarkMode): Access mode.
+
+// Returns:
+//    Name of the mode.
+static const char* CodecBenchmarkModeName(CodecBenchmarkMode mode) {
+  switch (mode) {
+    case kCodecBenchmarkModeBuffer:
+      return "buffer";
+    case kCodecBenchmarkModeMapped:
+      return "mapped";
+    case kCodecBenchmarkModeFileIo:
+      return "fileio";
+    default:
+      return "?";
+  }
+}
+
+bool CodecBenchmarkRun(const char* name, CodecBenchmarkMode mode, size_t bytes,
+                       CodecBenchmarkFunc func, void* ctx) {
+  if (s_filter != NULL && strstr(name, s_filter) == NULL) {
+    return true;
+  }
+
+  int64_t* samples =
+      (int64_t*)malloc(sizeof(*samples) * CODEC_BENCHMARK_OPS_MAX);
+  if (samples == NULL) {
+    printf("%-40s %-6s FAILED (no memory for samples)\n", name,
+           CodecBenchmarkModeName(mode));
+    return false;
+  }
+
+  // One warm-up operation keeps one-time setup out of the numbers.
+  if (!func(ctx)) {
+    printf("%-40s %-6s FAILED\n", name, CodecBenchmarkModeName(mode));
+    free(samples);
+    return false;
+  }
+
+  uint64_t allocs_start = __atomic_load_n(&s_alloc_count, __ATOMIC_RELAXED);
+  int64_t start = CodecBenchmarkNow();
+  int64_t now = start;
+  size_t ops = 0;
+  while (ops < CODEC_BENCHMARK_OPS_MAX &&
+         (ops < CODEC_BENCHMARK_OPS_MIN ||
+          now - start < CODEC_BENCHMARK_TIME_MIN_NS)) {
+    int64_t op_start = now;
+    if (!func(ctx)) {
+      printf("%-40s %-6s FAILED\n", name, CodecBenchmarkModeName(mode));
+      free(samples);
+      return false;
+    }
+    now = CodecBenchmarkNow();
+    samples[ops++] = now - op_start;
+  }
+  uint64_t allocs =
+      __atomic_load_n(&s_alloc_count, __ATOMIC_RELAXED) - allocs_start;
+
+  qsort(samples, ops, sizeof(*samples), CodecBenchmarkCompare);
+  double seconds = (double)(now - start) / 1e9;
+  double mb_per_s = (double)bytes * (double)ops / seconds / 1e6;
+  double p50_us = (double)samples[(ops - 1) * 50 / 100] / 1e3;
+  double p99_us = (double)samples[(ops - 1) * 99 / 100] / 1e3;
+  printf("%-40s %-6s %10zu %10.1f %10.1f %12.1f %12.1f\n", name,
+         CodecBenchmarkModeName(mode), bytes, mb_per_s,
+         (double)allocs / (double)ops, p50_us, p99_us);
+  free(samples);
+  return true;
+}
+
+void CodecBenchmarkSkip(const char* name, CodecBenchmarkMode mode,
+                        const char* reason) {
+  if (s_filter != NULL && strstr(name, s_filter) == NULL) {
+    return;
+  }
+  printf("%-40s %-6s skipped (%s)\n", name, CodecBenchmarkModeName(mode),
+         reason);
+}
+
+void CodecBenchmarkRandomFill(uint8_t* buf, size_t size, uint32_t seed) {
+  // xorshift32, the same bytes on every run and device.
+  uint32_t x = (seed != 0) ? seed : 0x12345678u;
+  for (size_t i = 0; i < size; ++i) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    buf[i] = (uint8_t)x;
+  }
+}
+
+bool CodecBenchmarkHandleCreate(const void* data, size_t size,
+                                size_t capacity,
+                                EsfMemoryManagerHandle* handle) {
+  if (capacity < size || capacity > (size_t)INT32_MAX) {
+    return false;
+  }
+  EsfMemoryManagerResult ret = EsfMemoryManagerAllocate(
+      kEsfMemoryManagerTargetLargeHeap, NULL, (int32_t)capacity, handle);
+  if (ret != kEsfMemoryManagerResultSuccess) {
+    printf("EsfMemoryManagerAllocate failed. ret=%d size=%zu\n", ret,
+           capacity);
+    return false;
+  }
+  if (data == NULL || size == 0) {
+    return true;
+  }
+
+  if (CodecBenchmarkHandleMode(*handle) == kCodecBenchmarkModeMapped) {
+    void* address = NULL;
+    ret = EsfMemoryManagerMap(*handle, NULL, (int32_t)capacity, &address);
+    if (ret == kEsfMemoryManagerResultSuccess) {
+      memcpy(address, data, size);
+      ret = EsfMemoryManagerUnmap(*handle, &address);
+    }
+  } else {
+    ret = EsfMemoryManagerFopen(*handle);
+    if (ret == kEsfMemoryManagerResultSuccess) {
+      size_t written = 0;
+      ret = EsfMemoryManagerFwrite(*handle, data, size, &written);
+      if (ret == kEsfMemoryManagerResultSuccess && written != size) {
+        ret = kEsfMemoryManagerResultFileIoError;
+      }
+      EsfMemoryManagerResult close_ret = EsfMemoryManagerFclose(*handle);
+      if (ret == kEsfMemoryManagerResultSuccess) {
+        ret = close_ret;
+      }
+    }
+  }
+  if (ret != kEsfMemoryManagerResultSuccess) {
+    printf("Failed to store data in handle. ret=%d\n", ret);
+    (void)EsfMemoryManagerFree(*handle, NULL);
+    return false;
+  }
+  return true;
+}
+
+CodecBenchmarkMode CodecBenchmarkHandleMode(EsfMemoryManagerHandle handle) {
+  EsfMemoryManagerMapSupport support = kEsfMemoryManagerMapIsNotSupport;
+  if (EsfMemoryManagerIsMapSupport(handle, &support) ==
+          kEsfMemoryManagerResultSuccess &&
+      support == kEsfMemoryManagerMapIsSupport) {
+    return kCodecBenchmarkModeMapped;
+  }
+  return kCodecBenchmarkModeFileIo;
+}
+
+bool CodecBenchmarkHandleRewind(EsfMemoryManagerHandle handle) {
+  off_t offset = 0;
+  return EsfMemoryManagerFseek(handle, 0, SEEK_SET, &offset) ==
+         kEsfMemoryManagerResultSuccess;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc > 2) {
+    printf("Usage: %s [filter]\n", argv[0]);
+    return 2;
+  }
+  if (argc == 2) {
+    s_filter = argv[1];
+  }
+
+  EsfMemoryManagerResult mm_ret = EsfMemoryManagerInitialize(1);
+  if (mm_ret != kEsfMemoryManagerResultSuccess) {
+    printf("EsfMemoryManagerInitialize failed. ret=%d\n", mm_ret);
+    return 1;
+  }
+
+  printf("%-40s %-6s %10s %10s %10s %12s %12s\n", "case", "mode", "bytes",
+         "MB/s", "allocs/op", "p50[us]", "p99[us]");
+  bool ok = true;
+  ok = CodecBenchmarkJson() && ok;
+  ok = CodecBenchmarkBase64() && ok;
+  ok = CodecBenchmarkJpeg() && ok;
+
+  (void)EsfMemoryManagerFinalize();
+  return ok ? 0 : 1;
+}
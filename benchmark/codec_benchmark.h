@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef BENCHMARK_CODEC_BENCHMARK_H_
+#define BENCHMARK_CODEC_BENCHMARK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "memory_manager.h"
+
+// Access modes of the data under test.
+typedef enum CodecBenchmarkMode {
+  kCodecBenchmarkModeBuffer,  // Plain memory, pointer based API.
+  kCodecBenchmarkModeMapped,  // Memory Manager handle that supports Map.
+  kCodecBenchmarkModeFileIo,  // Memory Manager handle accessed with FileIO.
+} CodecBenchmarkMode;
+
+// One operation of a benchmark case. Returns false on failure.
+typedef bool (*CodecBenchmarkFunc)(void* ctx);
+
+// """Runs a benchmark case and prints its result.
+
+// func is called repeatedly until both a minimum number of operations and a
+// minimum duration are reached. The result line holds the throughput in MB/s
+// computed from bytes, the number of heap allocations per operation and the
+// p50/p99 latency of one operation.
+
+// Args:
+//    name (const char*): Case name, "<codec>/<operation>/<corpus>".
+//    mode (CodecBenchmarkMode): Access mode, printed with the result.
+//    bytes (size_t): Bytes processed by one operation.
+//    func (CodecBenchmarkFunc): Operation to measure.
+//    ctx (void*): Argument of func.
+
+// Returns:
+//    false if func failed, true otherwise. A case filtered out by the command
+//    line counts as success.
+bool CodecBenchmarkRun(const char* name, CodecBenchmarkMode mode, size_t bytes,
+                       CodecBenchmarkFunc func, void* ctx);
+
+// """Prints that a benchmark case could not run on this device.
+
+// Args:
+//    name (const char*): Case name.
+//    mode (CodecBenchmarkMode): Access mode.
+//    reason (const char*): Why the case was skipped.
+void CodecBenchmarkSkip(const char* name, CodecBenchmarkMode mode,
+                        const char* reason);
+
+// """Fills a buffer with reproducible pseudo random bytes.
+
+// Args:
+//    buf (uint8_t*): Buffer to fill.
+//    size (size_t): Size of buf.
+//    seed (uint32_t): Seed of the sequence.
+void CodecBenchmarkRandomFill(uint8_t* buf, size_t size, uint32_t seed);
+
+// """Allocates a LargeHeap Memory Manager handle and stores data in it.
+
+// Args:
+//    data (const void*): Initial contents. NULL leaves the area unwritten.
+//    size (size_t): Size of data.
+//    capacity (size_t): Size of the area. Must be size or more.
+//    handle (EsfMemoryManagerHandle*): Allocated handle.
+
+// Returns:
+//    true on success.
+bool CodecBenchmarkHandleCreate(const void* data, size_t size,
+                                size_t capacity,
+                                EsfMemoryManagerHandle* handle);
+
+// """Gets the access mode a handle is used with by the *Handle APIs.
+
+// Args:
+//    handle (EsfMemoryManagerHandle): Memory Manager handle.
+
+// Returns:
+//    kCodecBenchmarkModeMapped if the handle supports Map, otherwise
+//    kCodecBenchmarkModeFileIo.
+CodecBenchmarkMode CodecBenchmarkHandleMode(EsfMemoryManagerHandle handle);
+
+// """Rewinds a handle opened with EsfMemoryManagerFopen.
+
+// Args:
+//    handle (EsfMemoryManagerHandle): Memory Manager handle.
+
+// Returns:
+//    true on success.
+bool CodecBenchmarkHandleRewind(EsfMemoryManagerHandle handle);
+
+// Benchmark suites of each codec. Each returns false if a case failed.
+bool CodecBenchmarkJson(void);
+bool CodecBenchmarkBase64(void);
+bool CodecBenchmarkJpeg(void);
+
+#endif  // BENCHMARK_CODEC_BENCHMARK_H_
@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "base64/include/base64.h"
+#include "base64/include/base64_fileio.h"
+#include "codec_benchmark.h"
+
+// Sizes of the random binaries [Byte].
+static const size_t kCodecBenchmarkBase64Sizes[] = {
+    1024,
+    64 * 1024,
+    1024 * 1024,
+};
+
+// State shared by the operations of one binary.
+typedef struct CodecBenchmarkBase64Context {
+  const uint8_t* binary;
+  size_t binary_size;
+  char* text;
+  size_t text_size;
+  uint8_t* decoded;
+  size_t decoded_size;
+  EsfMemoryManagerHandle in_handle;
+  EsfMemoryManagerHandle out_handle;
+} CodecBenchmarkBase64Context;
+
+// Binary to base64 text.
+static bool CodecBenchmarkBase64Encode(void* ctx) {
+  CodecBenchmarkBase64Context* context = (CodecBenchmarkBase64Context*)ctx;
+  size_t size = context->text_size;
+  return EsfCodecBase64Encode(context->binary, context->binary_size,
+                              context->text,
+                              &size) == kEsfCodecBase64ResultSuccess;
+}
+
+// Base64 text to binary.
+static bool CodecBenchmarkBase64Decode(void* ctx) {
+  CodecBenchmarkBase64Context* context = (CodecBenchmarkBase64Context*)ctx;
+  size_t size = context->decoded_size;
+  // text_size counts the NULL terminator.
+  return EsfCodecBase64Decode(context->text, context->text_size - 1,
+                              context->decoded,
+                              &size) == kEsfCodecBase64ResultSuccess;
+}
+
+// Memory Manager handle to handle, mapped or FileIO as the handles support.
+static bool CodecBenchmarkBase64EncodeHandle(void* ctx) {
+  CodecBenchmarkBase64Context* context = (CodecBenchmarkBase64Context*)ctx;
+  size_t size = context->text_size;
+  return EsfCodecBase64EncodeHandle(context->in_handle, context->binary_size,
+                                    context->out_handle,
+                                    &size) == kEsfCodecBase64ResultSuccess;
+}
+
+// Memory Manager handle to handle, both opened for FileIO.
+static bool CodecBenchmarkBase64EncodeFileIo(void* ctx) {
+  CodecBenchmarkBase64Context* context = (CodecBenchmarkBase64Context*)ctx;
+  size_t size = context->text_size;
+  return CodecBenchmarkHandleRewind(context->in_handle) &&
+         CodecBenchmarkHandleRewind(context->out_handle) &&
+         EsfCodecBase64EncodeFileIO(context->in_handle, context->binary_size,
+                                    context->out_handle,
+                                    &size) == kEsfCodecBase64ResultSuccess;
+}
+
+// """Runs the cases of one binary.
+
+// Args:
+//    context (CodecBenchmarkBase64Context*): Prepared context.
+
+// Returns:
+//    false if a case failed.
+static bool CodecBenchmarkBase64Cases(CodecBenchmarkBase64Context* context) {
+  char name[64];
+  bool ok = true;
+
+  snprintf(name, sizeof(name), "base64/encode/%zu", context->binary_size);
+  ok = CodecBenchmarkRun(name, kCodecBenchmarkModeBuffer, context->binary_size,
+                         CodecBenchmarkBase64Encode, context) &&
+       ok;
+  ok = CodecBenchmarkRun(name, CodecBenchmarkHandleMode(context->in_handle),
+                         context->binary_size,
+                         CodecBenchmarkBase64EncodeHandle, context) &&
+       ok;
+  if (EsfMemoryManagerFopen(context->in_handle) ==
+      kEsfMemoryManagerResultSuccess) {
+    if (EsfMemoryManagerFopen(context->out_handle) ==
+        kEsfMemoryManagerResultSuccess) {
+      ok = CodecBenchmarkRun(name, kCodecBenchmarkModeFileIo,
+                             context->binary_size,
+                             CodecBenchmarkBase64EncodeFileIo, context) &&
+           ok;
+      (void)EsfMemoryManagerFclose(context->out_handle);
+    } else {
+      CodecBenchmarkSkip(name, kCodecBenchmarkModeFileIo, "Fopen failed");
+    }
+    (void)EsfMemoryManagerFclose(context->in_handle);
+  } else {
+    CodecBenchmarkSkip(name, kCodecBenchmarkModeFileIo, "Fopen failed");
+  }
+
+  // The decode case needs the text of the encode case.
+  snprintf(name, sizeof(name), "base64/decode/%zu", context->binary_size);
+  if (CodecBenchmarkBase64Encode(context)) {
+    ok = CodecBenchmarkRun(name, kCodecBenchmarkModeBuffer,
+                           context->text_size - 1, CodecBenchmarkBase64Decode,
+                           context) &&
+         ok;
+  } else {
+    printf("%s: failed to prepare the text\n", name);
+    ok = false;
+  }
+  return ok;
+}
+
+bool CodecBenchmarkBase64(void) {
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(kCodecBenchmarkBase64Sizes) /
+                             sizeof(kCodecBenchmarkBase64Sizes[0]);
+       ++i) {
+    CodecBenchmarkBase64Context context = {0};
+    context.binary_size = kCodecBenchmarkBase64Sizes[i];
+    context.text_size = EsfCodecBase64GetEncodeSize(context.binary_size);
+    // The decoder asks for room for the padding as well.
+    context.decoded_size = EsfCodecBase64GetDecodeSize(context.text_size - 1);
+    uint8_t* binary = (uint8_t*)malloc(context.binary_size);
+    context.text = (char*)malloc(context.text_size);
+    context.decoded = (uint8_t*)malloc(context.decoded_size);
+    bool in_allocated = false;
+    bool out_allocated = false;
+    if (binary != NULL && context.text != NULL && context.decoded != NULL) {
+      CodecBenchmarkRandomFill(binary, context.binary_size, (uint32_t)i + 1);
+      context.binary = binary;
+      in_allocated = CodecBenchmarkHandleCreate(
+          binary, context.binary_size, context.binary_size,
+          &context.in_handle);
+      out_allocated = in_allocated &&
+                      CodecBenchmarkHandleCreate(NULL, 0, context.text_size,
+                                                 &context.out_handle);
+    }
+
+    if (out_allocated) {
+      ok = CodecBenchmarkBase64Cases(&context) && ok;
+    } else {
+      printf("base64/%zu: failed to prepare the binary\n",
+             context.binary_size);
+      ok = false;
+    }
+
+    if (out_allocated) {
+      (void)EsfMemoryManagerFree(context.out_handle, NULL);
+    }
+    if (in_allocated) {
+      (void)EsfMemoryManagerFree(context.in_handle, NULL);
+    }
+    free(context.decoded);
+    free(context.text);
+    free(binary);
+  }
+  return ok;
+}
@@ -0,0 +1,470 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "codec_benchmark.h"
+#include "jpeg.h"
+
+// Image quality of every case.
+#define CODEC_BENCHMARK_JPEG_QUALITY (80)
+
+// Threads of the parallel encode, one per core of the Raspberry Pi.
+#define CODEC_BENCHMARK_JPEG_THREAD_NUM (4)
+
+// Thumbnail of the thumbnail case: a quarter of the size, lower quality.
+#define CODEC_BENCHMARK_JPEG_THUMBNAIL_SCALE (4)
+#define CODEC_BENCHMARK_JPEG_THUMBNAIL_QUALITY (60)
+
+// Target of the target size case, in percent of the size at
+// CODEC_BENCHMARK_JPEG_QUALITY.
+#define CODEC_BENCHMARK_JPEG_TARGET_SIZE_PERCENT (50)
+
+// Resolution of a test image.
+typedef struct CodecBenchmarkJpegSize {
+  const char* name;
+  int32_t width;
+  int32_t height;
+} CodecBenchmarkJpegSize;
+
+static const CodecBenchmarkJpegSize kCodecBenchmarkJpegSizes[] = {
+    {"qvga", 320, 240},
+    {"vga", 640, 480},
+    {"fhd", 1920, 1080},
+};
+
+// Input formats, with the name used in the case names.
+typedef struct CodecBenchmarkJpegFormat {
+  const char* name;
+  EsfCodecJpegInputFormat format;
+} CodecBenchmarkJpegFormat;
+
+static const CodecBenchmarkJpegFormat kCodecBenchmarkJpegFormats[] = {
+    {"rgb_planar", kJpegInputRgbPlanar_8},
+    {"rgb_packed", kJpegInputRgbPacked_8},
+    {"bgr_packed", kJpegInputBgrPacked_8},
+    {"gray", kJpegInputGray_8},
+    {"nv12", kJpegInputYuv_8},
+};
+
+// State shared by the operations of one image.
+typedef struct CodecBenchmarkJpegContext {
+  EsfCodecJpegInfo info;
+  uint8_t* image;
+  size_t image_size;
+  uint8_t* jpeg;
+  EsfMemoryManagerHandle in_handle;
+  EsfMemoryManagerHandle out_handle;
+  EsfMemoryManagerHandle base64_handle;
+  EsfMemoryManagerHandle thumbnail_handle;
+  EsfCodecJpegEncoderHandle encoder;
+  int32_t target_size;
+  // Whether a quality gives a size within the tolerance of target_size.
+  bool target_reachable;
+} CodecBenchmarkJpegContext;
+
+// """Gets the stride and size of an image.
+
+// Args:
+//    format (EsfCodecJpegInputFormat): Input format.
+//    width (int32_t): Width [pixel].
+//    height (int32_t): Height [pixel].
+//    stride (int32_t*): Bytes per row.
+
+// Returns:
+//    Size of the image [Byte].
+static size_t CodecBenchmarkJpegLayout(EsfCodecJpegInputFormat format,
+                                       int32_t width, int32_t height,
+                                       int32_t* stride) {
+  switch (format) {
+    case kJpegInputRgbPacked_8:
+    case kJpegInputBgrPacked_8:
+      *stride = width * 3;
+      return (size_t)*stride * (size_t)height;
+    case kJpegInputRgbPlanar_8:
+      // Three planes of one byte per pixel.
+      *stride = width;
+      return (size_t)*stride * (size_t)height * 3;
+    case kJpegInputYuv_8:
+      // Y plane followed by the interleaved half height UV plane.
+      *stride = width;
+      return (size_t)*stride * (size_t)height * 3 / 2;
+    case kJpegInputGray_8:
+    default:
+      *stride = width;
+      return (size_t)*stride * (size_t)height;
+  }
+}
+
+// """Draws a test image: smooth gradients with a little noise, so that the
+// encoder sees both flat areas and detail.
+
+// Args:
+//    image (uint8_t*): Image buffer.
+//    size (size_t): Size of image.
+//    stride (int32_t): Bytes per row.
+//    seed (uint32_t): Seed of the noise.
+static void CodecBenchmarkJpegDraw(uint8_t* image, size_t size, int32_t stride,
+                                   uint32_t seed) {
+  CodecBenchmarkRandomFill(image, size, seed);
+  for (size_t i = 0; i < size; ++i) {
+    size_t x = i % (size_t)stride;
+    size_t y = i / (size_t)stride;
+    image[i] = (uint8_t)(((x + y) & 0xFF) ^ (image[i] & 0x0F));
+  }
+}
+
+// Pointer based encode.
+static bool CodecBenchmarkJpegEncode(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  EsfCodecJpegEncParam param = {
+      .input_adr_handle = (uint64_t)(uintptr_t)context->image,
+      .out_buf =
+          {
+              .output_adr_handle = (uint64_t)(uintptr_t)context->jpeg,
+              .output_buf_size = (int32_t)context->image_size,
+          },
+      .input_fmt = context->info.input_fmt,
+      .width = context->info.width,
+      .height = context->info.height,
+      .stride = context->info.stride,
+      .quality = context->info.quality,
+  };
+  int32_t jpeg_size = 0;
+  return EsfCodecJpegEncode(&param, &jpeg_size) == kJpegSuccess;
+}
+
+// Pointer based encode in slices on several threads.
+static bool CodecBenchmarkJpegEncodeParallel(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  EsfCodecJpegEncParam param = {
+      .input_adr_handle = (uint64_t)(uintptr_t)context->image,
+      .out_buf =
+          {
+              .output_adr_handle = (uint64_t)(uintptr_t)context->jpeg,
+              .output_buf_size = (int32_t)context->image_size,
+          },
+      .input_fmt = context->info.input_fmt,
+      .width = context->info.width,
+      .height = context->info.height,
+      .stride = context->info.stride,
+      .quality = context->info.quality,
+  };
+  int32_t jpeg_size = 0;
+  return EsfCodecJpegEncodeParallel(&param, CODEC_BENCHMARK_JPEG_THREAD_NUM,
+                                    &jpeg_size) == kJpegSuccess;
+}
+
+// Pointer based encode with an encoder context made once for the image.
+static bool CodecBenchmarkJpegEncoderEncode(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  EsfCodecJpegOutputBuf out_buf = {
+      .output_adr_handle = (uint64_t)(uintptr_t)context->jpeg,
+      .output_buf_size = (int32_t)context->image_size,
+  };
+  int32_t jpeg_size = 0;
+  return EsfCodecJpegEncoderEncode(context->encoder,
+                                   (uint64_t)(uintptr_t)context->image,
+                                   &out_buf, &jpeg_size) == kJpegSuccess;
+}
+
+// Pointer based encode to a target size, which fails when the size is not
+// within the tolerance of the target although a quality gives such a size.
+static bool CodecBenchmarkJpegEncodeTargetSize(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  EsfCodecJpegEncParam param = {
+      .input_adr_handle = (uint64_t)(uintptr_t)context->image,
+      .out_buf =
+          {
+              .output_adr_handle = (uint64_t)(uintptr_t)context->jpeg,
+              .output_buf_size = (int32_t)context->image_size,
+          },
+      .input_fmt = context->info.input_fmt,
+      .width = context->info.width,
+      .height = context->info.height,
+      .stride = context->info.stride,
+      .quality = context->info.quality,
+  };
+  int32_t jpeg_size = 0;
+  int32_t quality = 0;
+  if (EsfCodecJpegEncodeTargetSize(&param, context->target_size, &jpeg_size,
+                                   &quality) != kJpegSuccess) {
+    return false;
+  }
+  int32_t size_min =
+      context->target_size -
+      context->target_size * ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE / 100;
+  return jpeg_size <= context->target_size &&
+         (jpeg_size >= size_min || !context->target_reachable);
+}
+
+// """Sets the target of the target size case from the size at the quality of
+// the image, and finds whether a quality lands within its tolerance by
+// encoding the image at every lower quality.
+
+// Args:
+//    context (CodecBenchmarkJpegContext*): Prepared context.
+
+// Returns:
+//    false if an encode failed.
+static bool CodecBenchmarkJpegPrepareTargetSize(
+    CodecBenchmarkJpegContext* context) {
+  EsfCodecJpegEncParam param = {
+      .input_adr_handle = (uint64_t)(uintptr_t)context->image,
+      .out_buf =
+          {
+              .output_adr_handle = (uint64_t)(uintptr_t)context->jpeg,
+              .output_buf_size = (int32_t)context->image_size,
+          },
+      .input_fmt = context->info.input_fmt,
+      .width = context->info.width,
+      .height = context->info.height,
+      .stride = context->info.stride,
+      .quality = context->info.quality,
+  };
+  int32_t jpeg_size = 0;
+  if (EsfCodecJpegEncode(&param, &jpeg_size) != kJpegSuccess) {
+    return false;
+  }
+  context->target_size =
+      jpeg_size * CODEC_BENCHMARK_JPEG_TARGET_SIZE_PERCENT / 100;
+  int32_t size_min =
+      context->target_size -
+      context->target_size * ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE / 100;
+  context->target_reachable = false;
+  for (int32_t quality = 1; quality < context->info.quality; ++quality) {
+    param.quality = quality;
+    if (EsfCodecJpegEncode(&param, &jpeg_size) != kJpegSuccess) {
+      return false;
+    }
+    if (jpeg_size >= size_min && jpeg_size <= context->target_size) {
+      context->target_reachable = true;
+    }
+  }
+  return true;
+}
+
+// Memory Manager handle to handle, mapped or FileIO as the handles support.
+static bool CodecBenchmarkJpegEncodeHandle(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  int32_t jpeg_size = 0;
+  return EsfCodecJpegEncodeHandle(context->in_handle, context->out_handle,
+                                  &context->info, &jpeg_size) == kJpegSuccess;
+}
+
+// Memory Manager handle to a full size image and a thumbnail, reading the
+// input once.
+static bool CodecBenchmarkJpegEncodeThumbnail(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  EsfCodecJpegThumbnailInfo thumbnail_info = {
+      .scale_numerator = 1,
+      .scale_denominator = CODEC_BENCHMARK_JPEG_THUMBNAIL_SCALE,
+      .quality = CODEC_BENCHMARK_JPEG_THUMBNAIL_QUALITY,
+  };
+  int32_t jpeg_size = 0;
+  int32_t thumbnail_size = 0;
+  return EsfCodecJpegEncodeHandleWithThumbnail(
+             context->in_handle, context->out_handle,
+             context->thumbnail_handle, &context->info, &thumbnail_info,
+             &jpeg_size, &thumbnail_size) == kJpegSuccess;
+}
+
+// Memory Manager handle to handle, both opened for FileIO.
+static bool CodecBenchmarkJpegEncodeFileIo(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  int32_t jpeg_size = 0;
+  return CodecBenchmarkHandleRewind(context->in_handle) &&
+         CodecBenchmarkHandleRewind(context->out_handle) &&
+         EsfCodecJpegEncodeFileIo(context->in_handle, context->out_handle,
+                                  &context->info, &jpeg_size) == kJpegSuccess;
+}
+
+// Memory Manager handle to a Base64 string in one pass.
+static bool CodecBenchmarkJpegEncodeBase64Handle(void* ctx) {
+  CodecBenchmarkJpegContext* context = (CodecBenchmarkJpegContext*)ctx;
+  int32_t base64_size = 0;
+  return EsfCodecJpegEncodeBase64Handle(context->in_handle,
+                                        context->base64_handle, &context->info,
+                                        &base64_size) == kJpegSuccess;
+}
+
+// """Runs the cases of one image.
+
+// Args:
+//    name (const char*): Case name.
+//    base64_name (const char*): Case name of the Base64 output.
+//    parallel_name (const char*): Case name of the parallel encode.
+//    encoder_name (const char*): Case name of the encoder context.
+//    thumbnail_name (const char*): Case name of the thumbnail output.
+//    target_size_name (const char*): Case name of the target size encode.
+//    context (CodecBenchmarkJpegContext*): Prepared context.
+
+// Returns:
+//    false if a case failed.
+static bool CodecBenchmarkJpegCases(const char* name, const char* base64_name,
+                                    const char* parallel_name,
+                                    const char* encoder_name,
+                                    const char* thumbnail_name,
+                                    const char* target_size_name,
+                                    CodecBenchmarkJpegContext* context) {
+  bool ok = true;
+  ok = CodecBenchmarkRun(name, kCodecBenchmarkModeBuffer, context->image_size,
+                         CodecBenchmarkJpegEncode, context) &&
+       ok;
+  ok = CodecBenchmarkRun(parallel_name, kCodecBenchmarkModeBuffer,
+                         context->image_size, CodecBenchmarkJpegEncodeParallel,
+                         context) &&
+       ok;
+  if (EsfCodecJpegEncoderCreate(&context->info, &context->encoder) ==
+      kJpegSuccess) {
+    ok = CodecBenchmarkRun(encoder_name, kCodecBenchmarkModeBuffer,
+                           context->image_size,
+                           CodecBenchmarkJpegEncoderEncode, context) &&
+         ok;
+    (void)EsfCodecJpegEncoderDestroy(context->encoder);
+  } else {
+    CodecBenchmarkSkip(encoder_name, kCodecBenchmarkModeBuffer,
+                       "EsfCodecJpegEncoderCreate failed");
+  }
+  if (CodecBenchmarkJpegPrepareTargetSize(context)) {
+    ok = CodecBenchmarkRun(target_size_name, kCodecBenchmarkModeBuffer,
+                           context->image_size,
+                           CodecBenchmarkJpegEncodeTargetSize, context) &&
+         ok;
+  } else {
+    printf("%s: failed to prepare the target size\n", target_size_name);
+    ok = false;
+  }
+  ok = CodecBenchmarkRun(name, CodecBenchmarkHandleMode(context->in_handle),
+                         context->image_size, CodecBenchmarkJpegEncodeHandle,
+                         context) &&
+       ok;
+  ok = CodecBenchmarkRun(base64_name,
+                         CodecBenchmarkHandleMode(context->base64_handle),
+                         context->image_size,
+                         CodecBenchmarkJpegEncodeBase64Handle, context) &&
+       ok;
+  ok = CodecBenchmarkRun(thumbnail_name,
+                         CodecBenchmarkHandleMode(context->in_handle),
+                         context->image_size,
+                         CodecBenchmarkJpegEncodeThumbnail, context) &&
+       ok;
+  if (EsfMemoryManagerFopen(context->in_handle) ==
+      kEsfMemoryManagerResultSuccess) {
+    if (EsfMemoryManagerFopen(context->out_handle) ==
+        kEsfMemoryManagerResultSuccess) {
+      ok = CodecBenchmarkRun(name, kCodecBenchmarkModeFileIo,
+                             context->image_size,
+                             CodecBenchmarkJpegEncodeFileIo, context) &&
+           ok;
+      (void)EsfMemoryManagerFclose(context->out_handle);
+    } else {
+      CodecBenchmarkSkip(name, kCodecBenchmarkModeFileIo, "Fopen failed");
+    }
+    (void)EsfMemoryManagerFclose(context->in_handle);
+  } else {
+    CodecBenchmarkSkip(name, kCodecBenchmarkModeFileIo, "Fopen failed");
+  }
+  return ok;
+}
+
+bool CodecBenchmarkJpeg(void) {
+  bool ok = true;
+  for (size_t s = 0; s < sizeof(kCodecBenchmarkJpegSizes) /
+                             sizeof(kCodecBenchmarkJpegSizes[0]);
+       ++s) {
+    const CodecBenchmarkJpegSize* size = &kCodecBenchmarkJpegSizes[s];
+    for (size_t f = 0; f < sizeof(kCodecBenchmarkJpegFormats) /
+                               sizeof(kCodecBenchmarkJpegFormats[0]);
+         ++f) {
+      const CodecBenchmarkJpegFormat* format = &kCodecBenchmarkJpegFormats[f];
+      char name[64];
+      snprintf(name, sizeof(name), "jpeg/encode/%s/%s", format->name,
+               size->name);
+      char base64_name[64];
+      snprintf(base64_name, sizeof(base64_name), "jpeg/encode_base64/%s/%s",
+               format->name, size->name);
+      char parallel_name[64];
+      snprintf(parallel_name, sizeof(parallel_name),
+               "jpeg/encode_parallel/%s/%s", format->name, size->name);
+      char encoder_name[64];
+      snprintf(encoder_name, sizeof(encoder_name), "jpeg/encoder/%s/%s",
+               format->name, size->name);
+      char thumbnail_name[64];
+      snprintf(thumbnail_name, sizeof(thumbnail_name),
+               "jpeg/encode_thumbnail/%s/%s", format->name, size->name);
+      char target_size_name[64];
+      snprintf(target_size_name, sizeof(target_size_name),
+               "jpeg/encode_target_size/%s/%s", format->name, size->name);
+
+      CodecBenchmarkJpegContext context = {
+          .info =
+              {
+                  .input_fmt = format->format,
+                  .width = size->width,
+                  .height = size->height,
+                  .quality = CODEC_BENCHMARK_JPEG_QUALITY,
+              },
+      };
+      context.image_size = CodecBenchmarkJpegLayout(
+          format->format, size->width, size->height, &context.info.stride);
+      // The encoder expects an output area as large as the input.
+      context.image = (uint8_t*)malloc(context.image_size);
+      context.jpeg = (uint8_t*)malloc(context.image_size);
+      bool in_allocated = false;
+      bool out_allocated = false;
+      bool base64_allocated = false;
+      bool thumbnail_allocated = false;
+      if (context.image != NULL && context.jpeg != NULL) {
+        CodecBenchmarkJpegDraw(context.image, context.image_size,
+                               context.info.stride, (uint32_t)(s * 8 + f + 1));
+        in_allocated = CodecBenchmarkHandleCreate(
+            context.image, context.image_size, context.image_size,
+            &context.in_handle);
+        out_allocated = in_allocated &&
+                        CodecBenchmarkHandleCreate(NULL, 0, context.image_size,
+                                                   &context.out_handle);
+        // Room for the Base64 string of a JPEG image as large as the input.
+        base64_allocated =
+            out_allocated &&
+            CodecBenchmarkHandleCreate(NULL, 0,
+                                       (context.image_size + 2) / 3 * 4 + 1,
+                                       &context.base64_handle);
+        thumbnail_allocated =
+            base64_allocated &&
+            CodecBenchmarkHandleCreate(NULL, 0, context.image_size,
+                                       &context.thumbnail_handle);
+      }
+
+      if (thumbnail_allocated) {
+        ok = CodecBenchmarkJpegCases(name, base64_name, parallel_name,
+                                     encoder_name, thumbnail_name,
+                                     target_size_name, &context) &&
+             ok;
+      } else {
+        printf("%s: failed to prepare the image\n", name);
+        ok = false;
+      }
+
+      if (thumbnail_allocated) {
+        (void)EsfMemoryManagerFree(context.thumbnail_handle, NULL);
+      }
+      if (base64_allocated) {
+        (void)EsfMemoryManagerFree(context.base64_handle, NULL);
+      }
+      if (out_allocated) {
+        (void)EsfMemoryManagerFree(context.out_handle, NULL);
+      }
+      if (in_allocated) {
+        (void)EsfMemoryManagerFree(context.in_handle, NULL);
+      }
+      free(context.jpeg);
+      free(context.image);
+    }
+  }
+  return ok;
+}
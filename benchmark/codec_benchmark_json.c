@@ -0,0 +1,302 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "codec_benchmark.h"
+#include "json.h"
+#include "json_fileio.h"
+#include "json_handle.h"
+#include "json_pull.h"
+
+// Shape of a synthetic JSON document.
+typedef struct CodecBenchmarkJsonCorpus {
+  const char* name;
+  // Number of records in the top level object.
+  int members;
+  // Number of objects each record is nested in.
+  int depth;
+} CodecBenchmarkJsonCorpus;
+
+// Documents of increasing size and depth.
+static const CodecBenchmarkJsonCorpus kCodecBenchmarkJsonCorpora[] = {
+    {"small", 8, 1},
+    {"medium", 256, 2},
+    {"large", 4096, 2},
+    {"deep", 64, 32},
+};
+
+// Growable text buffer.
+typedef struct CodecBenchmarkJsonText {
+  char* buf;
+  size_t len;
+  size_t capacity;
+} CodecBenchmarkJsonText;
+
+// State shared by the operations of one corpus.
+typedef struct CodecBenchmarkJsonContext {
+  // The document as text.
+  const char* text;
+  size_t text_len;
+  // Handle holding the document as JSON Values, and its root.
+  EsfJsonHandle handle;
+  EsfJsonValue root;
+  // Handle the deserialize case parses into.
+  EsfJsonHandle scratch;
+  // Memory Manager handles holding the text and receiving serialized text.
+  EsfMemoryManagerHandle in_handle;
+  EsfMemoryManagerHandle out_handle;
+  size_t out_capacity;
+} CodecBenchmarkJsonContext;
+
+// """Appends formatted text.
+
+// Args:
+//    text (CodecBenchmarkJsonText*): Buffer.
+//    fmt (const char*): printf format.
+
+// Returns:
+//    true on success.
+static bool CodecBenchmarkJsonAppend(CodecBenchmarkJsonText* text,
+                                     const char* fmt, ...) {
+  for (;;) {
+    va_list args;
+    va_start(args, fmt);
+    size_t room = text->capacity - text->len;
+    int len = vsnprintf(text->buf + text->len, room, fmt, args);
+    va_end(args);
+    if (len < 0) {
+      return false;
+    }
+    if ((size_t)len < room) {
+      text->len += (size_t)len;
+      return true;
+    }
+    size_t capacity = (text->capacity + (size_t)len) * 2;
+    char* buf = (char*)realloc(text->buf, capacity);
+    if (buf == NULL) {
+      return false;
+    }
+    text->buf = buf;
+    text->capacity = capacity;
+  }
+}
+
+// """Generates the text of a corpus.
+
+// Each record mixes the value types and the string contents telemetry
+// usually carries: identifiers, URLs with '/' to escape and base64 blobs.
+
+// Args:
+//    corpus (const CodecBenchmarkJsonCorpus*): Shape of the document.
+//    text (CodecBenchmarkJsonText*): Buffer to write to. Must be empty.
+
+// Returns:
+//    true on success.
+static bool CodecBenchmarkJsonGenerate(const CodecBenchmarkJsonCorpus* corpus,
+                                       CodecBenchmarkJsonText* text) {
+  static const char kBase64[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char blob[129];
+  bool ok = CodecBenchmarkJsonAppend(text, "{");
+  for (int i = 0; ok && i < corpus->members; ++i) {
+    for (size_t j = 0; j < sizeof(blob) - 1; ++j) {
+      blob[j] = kBase64[(size_t)(i * 7 + (int)j * 13) % (sizeof(kBase64) - 1)];
+    }
+    blob[sizeof(blob) - 1] = '\0';
+    ok = CodecBenchmarkJsonAppend(text, "%s\"record%d\":", (i == 0) ? "" : ",",
+                                  i);
+    for (int d = 1; ok && d < corpus->depth; ++d) {
+      ok = CodecBenchmarkJsonAppend(text, "{\"level%d\":", d);
+    }
+    ok = ok && CodecBenchmarkJsonAppend(
+                   text,
+                   "{\"id\":%d,\"name\":\"sensor \\\"%d\\\"\",\"url\":"
+                   "\"https://example.com/devices/%d/state?v=1\",\"enabled\":"
+                   "%s,\"ratio\":%d.25,\"values\":[%d,%d,%d,null],\"blob\":"
+                   "\"%s\"}",
+                   i, i, i, (i % 2 == 0) ? "true" : "false", i, i, i + 1,
+                   i + 2, blob);
+    for (int d = 1; ok && d < corpus->depth; ++d) {
+      ok = CodecBenchmarkJsonAppend(text, "}");
+    }
+  }
+  return ok && CodecBenchmarkJsonAppend(text, "}");
+}
+
+// JSON Values to string.
+static bool CodecBenchmarkJsonSerialize(void* ctx) {
+  CodecBenchmarkJsonContext* context = (CodecBenchmarkJsonContext*)ctx;
+  const char* str = NULL;
+  return EsfJsonSerialize(context->handle, context->root, &str) ==
+         kEsfJsonSuccess;
+}
+
+// String to JSON Values.
+static bool CodecBenchmarkJsonDeserialize(void* ctx) {
+  CodecBenchmarkJsonContext* context = (CodecBenchmarkJsonContext*)ctx;
+  EsfJsonValue value = ESF_JSON_VALUE_INVALID;
+  return EsfJsonReset(context->scratch) == kEsfJsonSuccess &&
+         EsfJsonDeserialize(context->scratch, context->text, &value) ==
+             kEsfJsonSuccess;
+}
+
+// JSON Values to a Memory Manager handle, mapped or FileIO as the handle
+// supports.
+static bool CodecBenchmarkJsonSerializeHandle(void* ctx) {
+  CodecBenchmarkJsonContext* context = (CodecBenchmarkJsonContext*)ctx;
+  size_t size = 0;
+  return EsfJsonSerializeHandle(context->handle, context->root,
+                                context->out_handle,
+                                &size) == kEsfJsonSuccess;
+}
+
+// JSON Values to a Memory Manager handle opened for FileIO.
+static bool CodecBenchmarkJsonSerializeFileIo(void* ctx) {
+  CodecBenchmarkJsonContext* context = (CodecBenchmarkJsonContext*)ctx;
+  size_t size = 0;
+  return CodecBenchmarkHandleRewind(context->out_handle) &&
+         EsfJsonSerializeFileIO(context->handle, context->root,
+                                context->out_handle,
+                                &size) == kEsfJsonSuccess;
+}
+
+// Pull parsing of the whole document held in a Memory Manager handle.
+static bool CodecBenchmarkJsonPull(void* ctx) {
+  CodecBenchmarkJsonContext* context = (CodecBenchmarkJsonContext*)ctx;
+  if (CodecBenchmarkHandleMode(context->in_handle) ==
+          kCodecBenchmarkModeFileIo &&
+      !CodecBenchmarkHandleRewind(context->in_handle)) {
+    return false;
+  }
+  EsfJsonPullParser parser = NULL;
+  if (EsfJsonPullOpen(context->in_handle, context->text_len, &parser) !=
+      kEsfJsonSuccess) {
+    return false;
+  }
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  EsfJsonPullEvent event = kEsfJsonPullEventNull;
+  do {
+    ret = EsfJsonPullNext(parser, &event);
+  } while (ret == kEsfJsonSuccess && event != kEsfJsonPullEventEndOfDocument);
+  (void)EsfJsonPullClose(parser);
+  return ret == kEsfJsonSuccess;
+}
+
+// """Runs the cases of one corpus.
+
+// Args:
+//    corpus (const CodecBenchmarkJsonCorpus*): Corpus.
+//    context (CodecBenchmarkJsonContext*): Prepared context.
+
+// Returns:
+//    false if a case failed.
+static bool CodecBenchmarkJsonCases(const CodecBenchmarkJsonCorpus* corpus,
+                                    CodecBenchmarkJsonContext* context) {
+  char name[64];
+  bool ok = true;
+
+  snprintf(name, sizeof(name), "json/serialize/%s", corpus->name);
+  ok = CodecBenchmarkRun(name, kCodecBenchmarkModeBuffer, context->text_len,
+                         CodecBenchmarkJsonSerialize, context) &&
+       ok;
+  ok = CodecBenchmarkRun(name, CodecBenchmarkHandleMode(context->out_handle),
+                         context->text_len, CodecBenchmarkJsonSerializeHandle,
+                         context) &&
+       ok;
+  if (EsfMemoryManagerFopen(context->out_handle) ==
+      kEsfMemoryManagerResultSuccess) {
+    ok = CodecBenchmarkRun(name, kCodecBenchmarkModeFileIo, context->text_len,
+                           CodecBenchmarkJsonSerializeFileIo, context) &&
+         ok;
+    (void)EsfMemoryManagerFclose(context->out_handle);
+  } else {
+    CodecBenchmarkSkip(name, kCodecBenchmarkModeFileIo, "Fopen failed");
+  }
+
+  snprintf(name, sizeof(name), "json/deserialize/%s", corpus->name);
+  ok = CodecBenchmarkRun(name, kCodecBenchmarkModeBuffer, context->text_len,
+                         CodecBenchmarkJsonDeserialize, context) &&
+       ok;
+
+  snprintf(name, sizeof(name), "json/pull/%s", corpus->name);
+  CodecBenchmarkMode mode = CodecBenchmarkHandleMode(context->in_handle);
+  if (mode == kCodecBenchmarkModeFileIo &&
+      EsfMemoryManagerFopen(context->in_handle) !=
+          kEsfMemoryManagerResultSuccess) {
+    CodecBenchmarkSkip(name, mode, "Fopen failed");
+    return ok;
+  }
+  ok = CodecBenchmarkRun(name, mode, context->text_len, CodecBenchmarkJsonPull,
+                         context) &&
+       ok;
+  if (mode == kCodecBenchmarkModeFileIo) {
+    (void)EsfMemoryManagerFclose(context->in_handle);
+  }
+  return ok;
+}
+
+bool CodecBenchmarkJson(void) {
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(kCodecBenchmarkJsonCorpora) /
+                             sizeof(kCodecBenchmarkJsonCorpora[0]);
+       ++i) {
+    const CodecBenchmarkJsonCorpus* corpus = &kCodecBenchmarkJsonCorpora[i];
+    CodecBenchmarkJsonText text = {NULL, 0, 0};
+    CodecBenchmarkJsonContext context = {
+        .handle = ESF_JSON_HANDLE_INITIALIZER,
+        .root = ESF_JSON_VALUE_INVALID,
+        .scratch = ESF_JSON_HANDLE_INITIALIZER,
+    };
+    bool in_allocated = false;
+    bool out_allocated = false;
+    bool ready = CodecBenchmarkJsonGenerate(corpus, &text);
+    if (ready) {
+      context.text = text.buf;
+      context.text_len = text.len;
+      // Serialized text can be longer than the input since parson escapes
+      // '/'; leave room for it.
+      context.out_capacity = text.len * 2 + 1;
+      ready = EsfJsonOpen(&context.handle) == kEsfJsonSuccess &&
+              EsfJsonDeserialize(context.handle, context.text,
+                                 &context.root) == kEsfJsonSuccess &&
+              EsfJsonOpen(&context.scratch) == kEsfJsonSuccess;
+    }
+    if (ready) {
+      in_allocated = CodecBenchmarkHandleCreate(
+          context.text, context.text_len, context.text_len, &context.in_handle);
+      out_allocated = in_allocated &&
+                      CodecBenchmarkHandleCreate(NULL, 0, context.out_capacity,
+                                                 &context.out_handle);
+      ready = out_allocated;
+    }
+
+    if (ready) {
+      ok = CodecBenchmarkJsonCases(corpus, &context) && ok;
+    } else {
+      printf("json/%s: failed to prepare the corpus\n", corpus->name);
+      ok = false;
+    }
+
+    if (out_allocated) {
+      (void)EsfMemoryManagerFree(context.out_handle, NULL);
+    }
+    if (in_allocated) {
+      (void)EsfMemoryManagerFree(context.in_handle, NULL);
+    }
+    if (context.scratch != ESF_JSON_HANDLE_INITIALIZER) {
+      (void)EsfJsonClose(context.scratch);
+    }
+    if (context.handle != ESF_JSON_HANDLE_INITIALIZER) {
+      (void)EsfJsonClose(context.handle);
+    }
+    free(text.buf);
+  }
+  return ok;
+}
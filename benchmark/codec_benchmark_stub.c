@@ -0,0 +1,53 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// The utility log forwards to the Log Manager, which pulls in most of ESF.
+// The benchmark drops the log instead, so that only the codecs, the Memory
+// Manager and the porting layer are linked and measured.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log_manager.h"
+
+EsfLogManagerStatus EsfLogManagerStoreDlog(uint8_t *str, uint32_t size,
+                                           bool is_critical) {
+  (void)str;
+  (void)size;
+  (void)is_critical;
+  return kEsfLogManagerStatusOk;
+}
+
+EsfLogManagerStatus EsfLogManagerSendElog(
+    const EsfLogManagerElogMessage *message) {
+  (void)message;
+  return kEsfLogManagerStatusOk;
+}
+
+EsfLogManagerStatus EsfLogManagerRegisterChangeDlogCallback(
+    uint32_t module_id, EsfLogManagerChangeDlogCallback callback) {
+  (void)module_id;
+  (void)callback;
+  return kEsfLogManagerStatusOk;
+}
+
+EsfLogManagerStatus EsfLogManagerUnregisterChangeDlogCallback(
+    uint32_t module_id) {
+  (void)module_id;
+  return kEsfLogManagerStatusOk;
+}
+
+EsfLogManagerStatus EsfLogManagerSendBulkDlog(
+    uint32_t module_id, size_t size, uint8_t *bulk_log,
+    EsfLogManagerBulkDlogCallback callback, void *user_data) {
+  (void)module_id;
+  (void)size;
+  (void)bulk_log;
+  (void)callback;
+  (void)user_data;
+  return kEsfLogManagerStatusOk;
+}
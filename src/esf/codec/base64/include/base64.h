@@ -107,6 +107,8 @@ EsfCodecBase64ResultEnum EsfCodecBase64Encode(const uint8_t* in, size_t in_size,
 //     kEsfCodecBase64ResultIllegalInSize: Arg in_size is illegal.
 //     kEsfCodecBase64ResultIllegalInData: Arg in is illegal because Arg in
 //                        contains characters that do not correspond to Base64.
+//                        The characters are checked while decoding, so out
+//                        may hold partly decoded data.
 //
 EsfCodecBase64ResultEnum EsfCodecBase64Decode(const char* in, size_t in_size,
                                               uint8_t* out, size_t* out_size);
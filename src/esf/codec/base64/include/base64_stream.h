@@ -0,0 +1,178 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ESF_CODEC_BASE64_BASE64_STREAM_H_
+#define ESF_CODEC_BASE64_BASE64_STREAM_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "base64.h"
+
+// struct
+// State of an incremental Base64 encode. The members are internal; use the
+// EsfCodecBase64Encode{Init,Update,Final} functions.
+typedef struct EsfCodecBase64EncodeContext {
+  // Bytes waiting for the rest of their 3 byte group.
+  uint8_t pending[2];
+  size_t pending_size;
+} EsfCodecBase64EncodeContext;
+
+// State of an incremental Base64 decode. The members are internal; use the
+// EsfCodecBase64Decode{Init,Update,Final} functions.
+typedef struct EsfCodecBase64DecodeContext {
+  // Characters waiting for the rest of their 4 character group.
+  char pending[3];
+  size_t pending_size;
+  // A group with padding was decoded; it must be the last one.
+  bool padded;
+} EsfCodecBase64DecodeContext;
+
+// function
+// """Base64 Encoding Start (Stream)
+
+// Description: Prepares a context for encoding data given in pieces.
+
+// Args:
+//     [OUT] context (EsfCodecBase64EncodeContext*): Encoding context.
+//                   NULL assignment not allowed.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context is a NULL.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeInit(
+    EsfCodecBase64EncodeContext* context);
+
+// """Base64 Encoding Update (Stream)
+
+// Description: Encodes the next piece of the original data. Bytes that do not
+//              fill a 3 byte group are kept in the context until the next
+//              call.
+
+// Args:
+//     [IN/OUT] context (EsfCodecBase64EncodeContext*): Encoding context.
+//                      NULL assignment not allowed.
+//     [IN] in (const uint8_t*): Original data. NULL is allowed when in_size
+//                               is 0.
+//     [IN] in_size (size_t): Size of in (in bytes).
+//     [OUT] out (char*): Base64 string buffer. No null terminator is written.
+//                        NULL assignment not allowed.
+//     [IN/OUT] out_size (size_t*): [IN] Size of out. (in_size + 2) / 3 * 4
+//                                       is always enough.
+//                                  [OUT] Number of characters written.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context, in, out or out_size is a
+//                                     NULL.
+//     kEsfCodecBase64ResultOutOfRange: Arg in_size is out of range.
+//     kEsfCodecBase64ResultExceedsOutBuffer: Base64 string exceeds out buffer.
+//                                            The context is unchanged.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeUpdate(
+    EsfCodecBase64EncodeContext* context, const uint8_t* in, size_t in_size,
+    char* out, size_t* out_size);
+
+// """Base64 Encoding End (Stream)
+
+// Description: Encodes the bytes kept in the context with padding and
+//              terminates the string. The strings of all Update calls and of
+//              this call make the same string as EsfCodecBase64Encode. The
+//              context is ready for a new encode afterwards.
+
+// Args:
+//     [IN/OUT] context (EsfCodecBase64EncodeContext*): Encoding context.
+//                      NULL assignment not allowed.
+//     [OUT] out (char*): Base64 string buffer. NULL assignment not allowed.
+//     [IN/OUT] out_size (size_t*): [IN] Size of out. 5 is always enough.
+//                                  [OUT] Number of characters written
+//                                        including the null terminator.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context, out or out_size is a NULL.
+//     kEsfCodecBase64ResultExceedsOutBuffer: Base64 string exceeds out buffer.
+//                                            The context is unchanged.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeFinal(
+    EsfCodecBase64EncodeContext* context, char* out, size_t* out_size);
+
+// """Base64 Decoding Start (Stream)
+
+// Description: Prepares a context for decoding a string given in pieces.
+
+// Args:
+//     [OUT] context (EsfCodecBase64DecodeContext*): Decoding context.
+//                   NULL assignment not allowed.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context is a NULL.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeInit(
+    EsfCodecBase64DecodeContext* context);
+
+// """Base64 Decoding Update (Stream)
+
+// Description: Decodes the next piece of the Base64 string. Characters that
+//              do not fill a 4 character group are kept in the context until
+//              the next call. Padding is only allowed in the last group.
+
+// Args:
+//     [IN/OUT] context (EsfCodecBase64DecodeContext*): Decoding context.
+//                      NULL assignment not allowed.
+//     [IN] in (const char*): Base64 string. NULL is allowed when in_size is
+//                            0.
+//     [IN] in_size (size_t): Size of in (in bytes), without a null
+//                            terminator.
+//     [OUT] out (uint8_t*): Original data buffer. NULL assignment not allowed.
+//     [IN/OUT] out_size (size_t*): [IN] Size of out. (in_size + 3) / 4 * 3
+//                                       is always enough.
+//                                  [OUT] Number of bytes written.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context, in, out or out_size is a
+//                                     NULL.
+//     kEsfCodecBase64ResultOutOfRange: Arg in_size is out of range.
+//     kEsfCodecBase64ResultExceedsOutBuffer: Original data exceeds out buffer.
+//                                            The context is unchanged.
+//     kEsfCodecBase64ResultIllegalInData: Arg in contains characters that do
+//                        not correspond to Base64, or data after padding. out
+//                        may hold partly decoded data and the context must be
+//                        initialized again.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeUpdate(
+    EsfCodecBase64DecodeContext* context, const char* in, size_t in_size,
+    uint8_t* out, size_t* out_size);
+
+// """Base64 Decoding End (Stream)
+
+// Description: Checks that the string ended on a group boundary. The context
+//              is ready for a new decode afterwards.
+
+// Args:
+//     [IN/OUT] context (EsfCodecBase64DecodeContext*): Decoding context.
+//                      NULL assignment not allowed.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultNullParam: Arg context is a NULL.
+//     kEsfCodecBase64ResultIllegalInSize: The string is not in 4-character
+//                                         units.
+//
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeFinal(
+    EsfCodecBase64DecodeContext* context);
+
+#ifdef __cplusplus
+}
+#endif
+#endif  // ESF_CODEC_BASE64_BASE64_STREAM_H_
@@ -8,7 +8,6 @@
 
 #include <errno.h>
 #include <limits.h>
-#include <pthread.h>
 #include <stdio.h>
 #include <time.h>
 
@@ -16,10 +15,28 @@
 #include "include/base64_fileio.h"
 #include "memory_manager.h"
 #include "src/base64_log.h"
+#include "src/base64_simd.h"
+#include "utility_counter.h"
 #include "utility_log.h"
 
-// Mutex object for FileIO access state.
-static pthread_mutex_t file_io_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Work area of FileIO encodes.
+typedef struct EsfCodecBase64WorkArea {
+  // true while an encode uses buf.
+  bool in_use;
+  // Allocated on first use and kept for the next encode.
+  void* buf;
+} EsfCodecBase64WorkArea;
+
+// Work areas shared by FileIO encodes. Each encode claims its own entry, so
+// independent conversions run in parallel.
+static EsfCodecBase64WorkArea
+    s_work_pool[CONFIG_EXTERNAL_CODEC_BASE64_FILEIO_WORK_POOL_NUM];
+
+// Number of input bytes processed by successful encodes and decodes.
+static UTILITY_COUNTER_DEFINE(s_encode_bytes_counter,
+                              "codec.base64.encode_bytes");
+static UTILITY_COUNTER_DEFINE(s_decode_bytes_counter,
+                              "codec.base64.decode_bytes");
 
 // """EsfCodecBase64CheckMaxSizeForEncode
 
@@ -216,6 +233,33 @@ static EsfCodecBase64ResultEnum EsfCodecBase64ValidateCharacter(
   return kEsfCodecBase64ResultSuccess;
 }
 
+// """EsfCodecBase64EncodeBuffer
+
+// Encodes data using Base64. The vector kernel encodes the leading blocks and
+// b64_encode the rest.
+
+// Args:
+//     [IN] in (const uint8_t*): Data to be encoded.
+//     [IN] in_size (size_t): Size of in [Byte].
+//     [OUT] out (char*): Buffer for the Base64 string. Must have room for the
+//                        encoded string and its terminator.
+
+// Returns:
+//     Size of the Base64 string, not counting the terminator.
+
+// Note:
+
+// """
+static size_t EsfCodecBase64EncodeBuffer(const uint8_t* in, size_t in_size,
+                                         char* out) {
+  size_t done = EsfCodecBase64EncodeBlocks(in, in_size, out);
+  size_t encoded = done / kBase64EncodeConvertDataUnit * kBase64EncodeUnit;
+  // b64_encode also writes the terminator, so it runs even with nothing left.
+  encoded += (size_t)b64_encode(in + done, (unsigned int)(in_size - done),
+                                (unsigned char*)out + encoded);
+  return encoded;
+}
+
 // """EsfCodecBase64CheckParamForEncode
 
 // Performs input parameter checks for Base64 encoding process.
@@ -307,9 +351,9 @@ static EsfCodecBase64ResultEnum EsfCodecBase64CheckParamForEncode(
 //     kEsfCodecBase64ResultExceedsOutBuffer: Decode result size exceeds
 //                                            out_size buffer.
 //     kEsfCodecBase64ResultIllegalInSize: "in" is not in 4-character units.
-//     kEsfCodecBase64ResultIllegalInData: "in" contains non-base64 characters.
 
 // Note:
+//     The characters of "in" are checked while decoding.
 
 // """
 static EsfCodecBase64ResultEnum EsfCodecBase64CheckParamForDecode(
@@ -351,12 +395,6 @@ static EsfCodecBase64ResultEnum EsfCodecBase64CheckParamForDecode(
     ESF_CODEC_BASE64_TRACE("func end");
     return ret;
   }
-  ret = EsfCodecBase64ValidateCharacter(in, in_size);
-  if (ret != kEsfCodecBase64ResultSuccess) {
-    ESF_CODEC_BASE64_ERR("EsfCodecBase64ValidateCharacter=%d", ret);
-    ESF_CODEC_BASE64_TRACE("func end");
-    return ret;
-  }
   ESF_CODEC_BASE64_TRACE("func end");
   return kEsfCodecBase64ResultSuccess;
 }
@@ -486,86 +524,78 @@ static bool EsfCodecBase64IsFileIoAccess(EsfMemoryManagerHandle file_handle) {
   return true;
 }
 
-// """EsfCodecBase64MutexLock
+// """EsfCodecBase64WorkAcquire
 
-// Starting exclusive control of the Base64 function using a mutex.
+// Gets a work area for a FileIO encode. A free area of the pool is reused, or
+// allocated on its first use; when every area of the pool is in use, a work
+// area is allocated for this call only.
 
 // Args:
-//     [IN] mutex (pthread_mutex_t*): It is a mutex structure.
+//     [IN] size (size_t): Size of the work area [Byte].
+//     [OUT] slot (int32_t*): Index of the pool entry, -1 when the work area
+//                            is not from the pool.
 
 // Returns:
-//     One of the values of EsfCodecBase64ResultEnum is returned
-//     depending on the execution result.
-
-// Yields:
-//     kEsfCodecBase64ResultSuccess: Success.
-//     kEsfCodecBase64ResultExternalError: External processing error.
+//     Work area. NULL if allocation failed.
 
 // Note:
+//     Every FileIO encode asks for the same size.
 
 // """
-static EsfCodecBase64ResultEnum EsfCodecBase64MutexLock(
-    pthread_mutex_t* mutex) {
+static void* EsfCodecBase64WorkAcquire(size_t size, int32_t* slot) {
   ESF_CODEC_BASE64_TRACE("func start");
-
-  if (mutex == NULL) {
-    ESF_CODEC_BASE64_ERR("mutex is NULL.");
+  for (int32_t i = 0; i < CONFIG_EXTERNAL_CODEC_BASE64_FILEIO_WORK_POOL_NUM;
+       ++i) {
+    EsfCodecBase64WorkArea* work = &s_work_pool[i];
+    if (__atomic_exchange_n(&work->in_use, true, __ATOMIC_ACQUIRE)) {
+      continue;
+    }
+    // The entry is owned by this call until it is released.
+    if (work->buf == NULL) {
+      work->buf = malloc(size);
+      if (work->buf == NULL) {
+        ESF_CODEC_BASE64_ERR("malloc error. errno=%d", errno);
+        __atomic_store_n(&work->in_use, false, __ATOMIC_RELEASE);
+        ESF_CODEC_BASE64_TRACE("func end");
+        return NULL;
+      }
+    }
+    *slot = i;
+    ESF_CODEC_BASE64_DBG("work area slot=%d", i);
     ESF_CODEC_BASE64_TRACE("func end");
-    return kEsfCodecBase64ResultInternalError;
+    return work->buf;
   }
 
-  // Try to acquire the mutex
-  int ret = pthread_mutex_lock(mutex);
-  if (ret != 0) {
-    ESF_CODEC_BASE64_ERR("pthread_mutex_lock ret=%d", ret);
-    ESF_CODEC_BASE64_TRACE("func end");
-    return kEsfCodecBase64ResultExternalError;
+  *slot = -1;
+  void* buf = malloc(size);
+  if (buf == NULL) {
+    ESF_CODEC_BASE64_ERR("malloc error. errno=%d", errno);
   }
-  ESF_CODEC_BASE64_DBG("mutex lock.");
-
   ESF_CODEC_BASE64_TRACE("func end");
-  return kEsfCodecBase64ResultSuccess;
+  return buf;
 }
 
-// """EsfCodecBase64MutexUnlock
+// """EsfCodecBase64WorkRelease
 
-// Releasing exclusive control of the Base64 using a mutex.
+// Returns a work area got by EsfCodecBase64WorkAcquire.
 
 // Args:
-//     [IN] mutex (pthread_mutex_t*): It is a mutex structure.
-
-// Returns:
-//     One of the values of EsfCodecBase64ResultEnum is returned
-//     depending on the execution result.
-
-// Yields:
-//     kEsfCodecBase64ResultSuccess: Success.
-//     kEsfCodecBase64ResultInternalError: Internal processing error.
-//     kEsfCodecBase64ResultExternalError: External processing error.
+//     [IN] buf (void*): Work area.
+//     [IN] slot (int32_t): Index of the pool entry given by
+//                          EsfCodecBase64WorkAcquire.
 
 // Note:
+//     Work areas of the pool stay allocated for the next encode.
 
 // """
-static EsfCodecBase64ResultEnum EsfCodecBase64MutexUnlock(
-    pthread_mutex_t* mutex) {
+static void EsfCodecBase64WorkRelease(void* buf, int32_t slot) {
   ESF_CODEC_BASE64_TRACE("func start");
-
-  if (mutex == NULL) {
-    ESF_CODEC_BASE64_ERR("mutex is NULL.");
-    ESF_CODEC_BASE64_TRACE("func end");
-    return kEsfCodecBase64ResultInternalError;
-  }
-
-  int ret = pthread_mutex_unlock(mutex);
-  if (ret != 0) {
-    ESF_CODEC_BASE64_ERR("pthread_mutex_unlock ret=%d", ret);
-    ESF_CODEC_BASE64_TRACE("func end");
-    return kEsfCodecBase64ResultExternalError;
+  if (slot < 0) {
+    free(buf);
+  } else {
+    __atomic_store_n(&s_work_pool[slot].in_use, false, __ATOMIC_RELEASE);
   }
-  ESF_CODEC_BASE64_DBG("mutex unlock.");
-
   ESF_CODEC_BASE64_TRACE("func end");
-  return kEsfCodecBase64ResultSuccess;
 }
 
 // """EsfCodecBase64SplitWorkArea
@@ -837,10 +867,10 @@ EsfCodecBase64ResultEnum EsfCodecBase64Encode(const uint8_t* in, size_t in_size,
     ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
     return ret;
   }
-  // For b64_encode, "out" sets the string including the terminating character.
-  // The return value sets the size without the terminating character, so add 1
-  // to out_size.
-  *out_size = (size_t)(b64_encode(in, in_size, (unsigned char*)out) + 1U);
+  // "out" gets the string including the terminating character. The encoded
+  // size does not count it, so add 1 to out_size.
+  *out_size = EsfCodecBase64EncodeBuffer(in, in_size, out) + 1U;
+  UTILITY_COUNTER_ADD(s_encode_bytes_counter, in_size);
   ESF_CODEC_BASE64_TRACE("func end");
   return kEsfCodecBase64ResultSuccess;
 }
@@ -855,7 +885,25 @@ EsfCodecBase64ResultEnum EsfCodecBase64Decode(const char* in, size_t in_size,
     ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
     return ret;
   }
-  *out_size = (size_t)b64_decode((const unsigned char*)in, in_size, out);
+  // The vector kernel decodes and checks the characters in one pass. It stops
+  // at the first block holding padding or an illegal character, and only the
+  // rest goes through the character check and the scalar decoder.
+  size_t done = EsfCodecBase64DecodeBlocks(in, in_size, out);
+  size_t decoded = done / kBase64EncodeUnit * kBase64EncodeConvertDataUnit;
+  if (done < in_size) {
+    ret = EsfCodecBase64ValidateCharacter(in + done, in_size - done);
+    if (ret != kEsfCodecBase64ResultSuccess) {
+      ESF_CODEC_BASE64_ERR("EsfCodecBase64ValidateCharacter=%d offset=%zu",
+                           ret, done);
+      ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+      return ret;
+    }
+    decoded += (size_t)b64_decode((const unsigned char*)in + done,
+                                  (unsigned int)(in_size - done),
+                                  out + decoded);
+  }
+  *out_size = decoded;
+  UTILITY_COUNTER_ADD(s_decode_bytes_counter, in_size);
   ESF_CODEC_BASE64_TRACE("func end");
   return kEsfCodecBase64ResultSuccess;
 }
@@ -926,22 +974,11 @@ EsfCodecBase64ResultEnum EsfCodecBase64EncodeFileIO(
     return result;
   }
 
-  result = EsfCodecBase64MutexLock(&file_io_mutex);
-  if (result != kEsfCodecBase64ResultSuccess) {
-    ESF_CODEC_BASE64_ERR("EsfCodecBase64MutexLock error. ret=%d", result);
-    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_ENCODE_FAILURE);
-    ESF_CODEC_BASE64_TRACE("func end");
-    return result;
-  }
-
   // Allocate and offset in batches to prevent memory fragmentation
-  void* buf = malloc(in_buf_size + enc_buf_size);
+  int32_t slot = -1;
+  void* buf = EsfCodecBase64WorkAcquire(in_buf_size + enc_buf_size, &slot);
   if (buf == NULL) {
-    ESF_CODEC_BASE64_ERR("malloc error. errno=%d", errno);
-    result = EsfCodecBase64MutexUnlock(&file_io_mutex);
-    if (result != kEsfCodecBase64ResultSuccess) {
-      ESF_CODEC_BASE64_ERR("EsfCodecBase64MutexUnlock error. ret=%d", result);
-    }
+    ESF_CODEC_BASE64_ERR("EsfCodecBase64WorkAcquire error.");
     ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_ENCODE_FAILURE);
     ESF_CODEC_BASE64_TRACE("func end");
     return kEsfCodecBase64ResultExternalError;
@@ -981,10 +1018,11 @@ EsfCodecBase64ResultEnum EsfCodecBase64EncodeFileIO(
       break;
     }
 
-    size_t enc_size = (size_t)(b64_encode(
-        (unsigned char*)buf, (unsigned int)rsize, (unsigned char*)enc_buf));
+    size_t enc_size =
+        EsfCodecBase64EncodeBuffer((const uint8_t*)buf, rsize, enc_buf);
     if (enc_size == 0) {
-      ESF_CODEC_BASE64_ERR("b64_encode error. ret=%zu", enc_size);
+      ESF_CODEC_BASE64_ERR("EsfCodecBase64EncodeBuffer error. ret=%zu",
+                           enc_size);
       ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_ENCODE_FAILURE);
       ret_result = kEsfCodecBase64ResultExceedsOutBuffer;
       break;
@@ -1030,19 +1068,11 @@ EsfCodecBase64ResultEnum EsfCodecBase64EncodeFileIO(
   // If encoding process is successful, set out_size
   if (ret_result == kEsfCodecBase64ResultSuccess) {
     *out_size = encoded_size;
+    UTILITY_COUNTER_ADD(s_encode_bytes_counter, in_size);
     ESF_CODEC_BASE64_DBG("out_size=%zu", *out_size);
   }
 
-  free(buf);
-
-  result = EsfCodecBase64MutexUnlock(&file_io_mutex);
-  if (result != kEsfCodecBase64ResultSuccess) {
-    ESF_CODEC_BASE64_ERR("EsfCodecBase64MutexUnlock error. ret=%d", result);
-    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_ENCODE_FAILURE);
-    ESF_CODEC_BASE64_TRACE("func end");
-    ret_result = result;
-    return ret_result;
-  }
+  EsfCodecBase64WorkRelease(buf, slot);
 
   ESF_CODEC_BASE64_TRACE("func end");
   return ret_result;
@@ -0,0 +1,370 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/base64_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ESF_CODEC_BASE64_SIMD_X86
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ESF_CODEC_BASE64_SIMD_NEON
+#endif
+
+// The kernels follow the pshufb based scheme of W. Mula and D. Lemire,
+// "Faster Base64 Encoding and Decoding using AVX2 Instructions". Encoding
+// spreads every 3 bytes over 4 lanes, cuts out the 6 bit indices with
+// multiplies and maps them to characters with a small table of offsets.
+// Decoding maps the characters back with a table indexed by the high nibble
+// and checks them against a bit mask indexed by the low nibble, so that
+// validation costs no separate pass over the input.
+
+#if defined(ESF_CODEC_BASE64_SIMD_X86)
+
+// Vector kernels of the CPU, in order of preference.
+typedef enum EsfCodecBase64SimdLevel {
+  kEsfCodecBase64SimdLevelUnknown = -1,
+  kEsfCodecBase64SimdLevelNone = 0,
+  kEsfCodecBase64SimdLevelSsse3,
+  kEsfCodecBase64SimdLevelAvx2,
+} EsfCodecBase64SimdLevel;
+
+// Kernel selected on first use. Every thread computes the same value, so a
+// race only repeats the detection.
+static int s_simd_level = kEsfCodecBase64SimdLevelUnknown;
+
+// """EsfCodecBase64SimdGetLevel
+
+// Gets the best vector kernel the CPU supports.
+
+// Returns:
+//     Kernel level.
+
+// Note:
+
+// """
+static EsfCodecBase64SimdLevel EsfCodecBase64SimdGetLevel(void) {
+  int level = __atomic_load_n(&s_simd_level, __ATOMIC_RELAXED);
+  if (level == kEsfCodecBase64SimdLevelUnknown) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      level = kEsfCodecBase64SimdLevelAvx2;
+    } else if (__builtin_cpu_supports("ssse3")) {
+      level = kEsfCodecBase64SimdLevelSsse3;
+    } else {
+      level = kEsfCodecBase64SimdLevelNone;
+    }
+    __atomic_store_n(&s_simd_level, level, __ATOMIC_RELAXED);
+  }
+  return (EsfCodecBase64SimdLevel)level;
+}
+
+// Converts the bytes 0..11 of src to 16 characters.
+__attribute__((target("ssse3"))) static inline __m128i
+EsfCodecBase64EncodeSsse3Step(__m128i src) {
+  // Each 32 bit lane gets the bytes [1, 0, 2, 1] of its 3 byte group.
+  src = _mm_shuffle_epi8(
+      src, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i t0 = _mm_and_si128(src, _mm_set1_epi32(0x0FC0FC00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(src, _mm_set1_epi32(0x003F03F0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  const __m128i indices = _mm_or_si128(t1, t3);
+
+  // 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12.
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i offset = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offset, range), indices);
+}
+
+// Converts 16 characters to their 6 bit values. *error gets a non zero lane
+// for every character outside the alphabet, padding included.
+__attribute__((target("ssse3"))) static inline __m128i
+EsfCodecBase64DecodeSsse3Step(__m128i src, __m128i* error) {
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i high = _mm_and_si128(_mm_srli_epi32(src, 4), nibble);
+  const __m128i low = _mm_and_si128(src, nibble);
+
+  // Bit n of mask[low] is set when (n << 4 | low) is in the alphabet.
+  const __m128i mask = _mm_setr_epi8(
+      (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+      (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF0, (char)0x54,
+      (char)0x50, (char)0x50, (char)0x50, (char)0x54);
+  const __m128i bit = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40,
+                                    (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i hit = _mm_and_si128(_mm_shuffle_epi8(mask, low),
+                                    _mm_shuffle_epi8(bit, high));
+  *error = _mm_or_si128(*error,
+                        _mm_cmpeq_epi8(hit, _mm_setzero_si128()));
+
+  // '+' and '/' share the high nibble; '/' needs 3 less than '+'.
+  const __m128i shift_table =
+      _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  __m128i shift = _mm_shuffle_epi8(shift_table, high);
+  shift = _mm_add_epi8(shift,
+                       _mm_and_si128(_mm_cmpeq_epi8(src, _mm_set1_epi8('/')),
+                                     _mm_set1_epi8(-3)));
+  return _mm_add_epi8(src, shift);
+}
+
+// Packs 16 values of 6 bits into the bytes 0..11.
+__attribute__((target("ssse3"))) static inline __m128i
+EsfCodecBase64PackSsse3Step(__m128i values) {
+  const __m128i pairs =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(quads, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                               13, 12, -1, -1, -1, -1));
+}
+
+__attribute__((target("ssse3"))) static size_t EsfCodecBase64EncodeSsse3(
+    const uint8_t* in, size_t in_size, char* out) {
+  size_t done = 0;
+  // A step loads 16 bytes and encodes 12 of them.
+  for (; in_size - done >= 16; done += 12, out += 16) {
+    __m128i src = _mm_loadu_si128((const __m128i*)(in + done));
+    _mm_storeu_si128((__m128i*)out, EsfCodecBase64EncodeSsse3Step(src));
+  }
+  return done;
+}
+
+__attribute__((target("ssse3"))) static size_t EsfCodecBase64DecodeSsse3(
+    const char* in, size_t in_size, uint8_t* out) {
+  size_t done = 0;
+  // A step stores 16 bytes for 12 decoded ones; the 8 characters kept back
+  // guarantee the room for the other 4.
+  for (; in_size - done >= 24; done += 16, out += 12) {
+    __m128i error = _mm_setzero_si128();
+    __m128i values = EsfCodecBase64DecodeSsse3Step(
+        _mm_loadu_si128((const __m128i*)(in + done)), &error);
+    if (_mm_movemask_epi8(error) != 0) {
+      break;
+    }
+    _mm_storeu_si128((__m128i*)out, EsfCodecBase64PackSsse3Step(values));
+  }
+  return done;
+}
+
+__attribute__((target("avx2"))) static size_t EsfCodecBase64EncodeAvx2(
+    const uint8_t* in, size_t in_size, char* out) {
+  size_t done = 0;
+  // Each 128 bit lane encodes 12 bytes as the SSSE3 step does, the upper one
+  // loaded 12 bytes after the lower one.
+  const __m256i spread = _mm256_broadcastsi128_si256(
+      _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m256i offset = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+  for (; in_size - done >= 28; done += 24, out += 32) {
+    __m256i src = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(in + done))),
+        _mm_loadu_si128((const __m128i*)(in + done + 12)), 1);
+    src = _mm256_shuffle_epi8(src, spread);
+    const __m256i t0 = _mm256_and_si256(src, _mm256_set1_epi32(0x0FC0FC00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(src, _mm256_set1_epi32(0x003F03F0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(t1, t3);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range =
+        _mm256_or_si256(range, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    _mm256_storeu_si256(
+        (__m256i*)out,
+        _mm256_add_epi8(_mm256_shuffle_epi8(offset, range), indices));
+  }
+  return done;
+}
+
+__attribute__((target("avx2"))) static size_t EsfCodecBase64DecodeAvx2(
+    const char* in, size_t in_size, uint8_t* out) {
+  size_t done = 0;
+  const __m256i nibble = _mm256_set1_epi8(0x0F);
+  const __m256i mask = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      (char)0xA8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8,
+      (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF8, (char)0xF0, (char)0x54,
+      (char)0x50, (char)0x50, (char)0x50, (char)0x54));
+  const __m256i bit = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0,
+                    0, 0, 0, 0, 0, 0, 0));
+  const __m256i shift_table = _mm256_broadcastsi128_si256(
+      _mm_setr_epi8(0, 0, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+  const __m256i pack = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+  // A step stores the 12 bytes of each lane with two 16 byte stores; the 8
+  // characters kept back guarantee the room for the last 4.
+  for (; in_size - done >= 40; done += 32, out += 24) {
+    const __m256i src = _mm256_loadu_si256((const __m256i*)(in + done));
+    const __m256i high = _mm256_and_si256(_mm256_srli_epi32(src, 4), nibble);
+    const __m256i low = _mm256_and_si256(src, nibble);
+    const __m256i hit = _mm256_and_si256(_mm256_shuffle_epi8(mask, low),
+                                         _mm256_shuffle_epi8(bit, high));
+    if (_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(hit, _mm256_setzero_si256())) != 0) {
+      break;
+    }
+
+    __m256i shift = _mm256_shuffle_epi8(shift_table, high);
+    shift = _mm256_add_epi8(
+        shift, _mm256_and_si256(_mm256_cmpeq_epi8(src, _mm256_set1_epi8('/')),
+                                _mm256_set1_epi8(-3)));
+    const __m256i values = _mm256_add_epi8(src, shift);
+    const __m256i pairs =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    const __m256i quads =
+        _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    const __m256i bytes = _mm256_shuffle_epi8(quads, pack);
+    _mm_storeu_si128((__m128i*)out, _mm256_castsi256_si128(bytes));
+    _mm_storeu_si128((__m128i*)(out + 12), _mm256_extracti128_si256(bytes, 1));
+  }
+  return done;
+}
+
+size_t EsfCodecBase64EncodeBlocks(const uint8_t* in, size_t in_size,
+                                  char* out) {
+  switch (EsfCodecBase64SimdGetLevel()) {
+    case kEsfCodecBase64SimdLevelAvx2: {
+      size_t done = EsfCodecBase64EncodeAvx2(in, in_size, out);
+      return done + EsfCodecBase64EncodeSsse3(in + done, in_size - done,
+                                              out + done / 3 * 4);
+    }
+    case kEsfCodecBase64SimdLevelSsse3:
+      return EsfCodecBase64EncodeSsse3(in, in_size, out);
+    default:
+      return 0;
+  }
+}
+
+size_t EsfCodecBase64DecodeBlocks(const char* in, size_t in_size,
+                                  uint8_t* out) {
+  switch (EsfCodecBase64SimdGetLevel()) {
+    case kEsfCodecBase64SimdLevelAvx2: {
+      size_t done = EsfCodecBase64DecodeAvx2(in, in_size, out);
+      return done + EsfCodecBase64DecodeSsse3(in + done, in_size - done,
+                                              out + done / 4 * 3);
+    }
+    case kEsfCodecBase64SimdLevelSsse3:
+      return EsfCodecBase64DecodeSsse3(in, in_size, out);
+    default:
+      return 0;
+  }
+}
+
+#elif defined(ESF_CODEC_BASE64_SIMD_NEON)
+
+// Base64 alphabet, the table of the encoder.
+static const uint8_t kEsfCodecBase64EncodeTable[64] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+    'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+    'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
+
+// Value of every ASCII character, 0xFF outside the alphabet.
+static const uint8_t kEsfCodecBase64DecodeTable[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30,
+    0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Loads 64 bytes of a table.
+static inline uint8x16x4_t EsfCodecBase64LoadTable(const uint8_t* table) {
+  uint8x16x4_t ret;
+  ret.val[0] = vld1q_u8(table);
+  ret.val[1] = vld1q_u8(table + 16);
+  ret.val[2] = vld1q_u8(table + 32);
+  ret.val[3] = vld1q_u8(table + 48);
+  return ret;
+}
+
+size_t EsfCodecBase64EncodeBlocks(const uint8_t* in, size_t in_size,
+                                  char* out) {
+  const uint8x16x4_t table =
+      EsfCodecBase64LoadTable(kEsfCodecBase64EncodeTable);
+  const uint8x16_t low6 = vdupq_n_u8(0x3F);
+  size_t done = 0;
+  // vld3q/vst4q split 48 bytes into the three bytes of 16 groups and
+  // interleave the 64 characters back.
+  for (; in_size - done >= 48; done += 48, out += 64) {
+    const uint8x16x3_t src = vld3q_u8(in + done);
+    uint8x16x4_t dst;
+    dst.val[0] = vshrq_n_u8(src.val[0], 2);
+    dst.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[0], 4), vshrq_n_u8(src.val[1], 4)), low6);
+    dst.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(src.val[1], 2), vshrq_n_u8(src.val[2], 6)), low6);
+    dst.val[3] = vandq_u8(src.val[2], low6);
+    for (int i = 0; i < 4; ++i) {
+      dst.val[i] = vqtbl4q_u8(table, dst.val[i]);
+    }
+    vst4q_u8((uint8_t*)out, dst);
+  }
+  return done;
+}
+
+size_t EsfCodecBase64DecodeBlocks(const char* in, size_t in_size,
+                                  uint8_t* out) {
+  const uint8x16x4_t table_low =
+      EsfCodecBase64LoadTable(kEsfCodecBase64DecodeTable);
+  const uint8x16x4_t table_high =
+      EsfCodecBase64LoadTable(kEsfCodecBase64DecodeTable + 64);
+  const uint8x16_t half = vdupq_n_u8(64);
+  size_t done = 0;
+  for (; in_size - done >= 64; done += 64, out += 48) {
+    uint8x16x4_t src = vld4q_u8((const uint8_t*)in + done);
+    // Characters from 0x80 and those outside the alphabet set the top bit.
+    uint8x16_t error = vdupq_n_u8(0);
+    for (int i = 0; i < 4; ++i) {
+      uint8x16_t value = vqtbl4q_u8(table_low, src.val[i]);
+      value = vqtbx4q_u8(value, table_high, vsubq_u8(src.val[i], half));
+      error = vorrq_u8(error, vorrq_u8(value, src.val[i]));
+      src.val[i] = value;
+    }
+    if ((vmaxvq_u8(error) & 0x80) != 0) {
+      break;
+    }
+    uint8x16x3_t dst;
+    dst.val[0] =
+        vorrq_u8(vshlq_n_u8(src.val[0], 2), vshrq_n_u8(src.val[1], 4));
+    dst.val[1] =
+        vorrq_u8(vshlq_n_u8(src.val[1], 4), vshrq_n_u8(src.val[2], 2));
+    dst.val[2] = vorrq_u8(vshlq_n_u8(src.val[2], 6), src.val[3]);
+    vst3q_u8(out, dst);
+  }
+  return done;
+}
+
+#else
+
+size_t EsfCodecBase64EncodeBlocks(const uint8_t* in, size_t in_size,
+                                  char* out) {
+  (void)in;
+  (void)in_size;
+  (void)out;
+  return 0;
+}
+
+size_t EsfCodecBase64DecodeBlocks(const char* in, size_t in_size,
+                                  uint8_t* out) {
+  (void)in;
+  (void)in_size;
+  (void)out;
+  return 0;
+}
+
+#endif
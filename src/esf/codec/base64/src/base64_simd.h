@@ -0,0 +1,57 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ESF_CODEC_BASE64_BASE64_SIMD_H_
+#define ESF_CODEC_BASE64_BASE64_SIMD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// """EsfCodecBase64EncodeBlocks
+
+// Encodes the leading part of the input with the vector unit of the CPU.
+// The kernel is chosen at run time on x86 (AVX2, SSSE3) and at build time on
+// AArch64 (NEON). The caller encodes the rest with the scalar encoder.
+
+// Args:
+//     [IN] in (const uint8_t*): Data to be encoded.
+//     [IN] in_size (size_t): Size of in [Byte].
+//     [OUT] out (char*): Buffer for the Base64 characters. Must have room for
+//                        the encoded in_size bytes. No terminator is written.
+
+// Returns:
+//     Number of bytes of in that were encoded, a multiple of 3. out holds
+//     4 characters for every 3 of them. 0 if no vector kernel is available.
+
+// Note:
+
+// """
+size_t EsfCodecBase64EncodeBlocks(const uint8_t* in, size_t in_size, char* out);
+
+// """EsfCodecBase64DecodeBlocks
+
+// Decodes the leading part of the input with the vector unit of the CPU,
+// checking the characters in the same pass. Decoding stops before the first
+// block that holds padding or a character outside the Base64 alphabet, so
+// the caller validates and decodes only the rest with the scalar decoder.
+
+// Args:
+//     [IN] in (const char*): Base64 characters.
+//     [IN] in_size (size_t): Size of in [Byte]. A multiple of 4.
+//     [OUT] out (uint8_t*): Buffer for the decoded data. Must have room for
+//                           in_size * 3 / 4 bytes.
+
+// Returns:
+//     Number of characters of in that were decoded, a multiple of 4. out
+//     holds 3 bytes for every 4 of them. 0 if no vector kernel is available.
+
+// Note:
+
+// """
+size_t EsfCodecBase64DecodeBlocks(const char* in, size_t in_size,
+                                  uint8_t* out);
+
+#endif  // ESF_CODEC_BASE64_BASE64_SIMD_H_
@@ -0,0 +1,352 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "include/base64_stream.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "src/base64_log.h"
+#include "src/base64_simd.h"
+#include "utility_log.h"
+
+// Base64 alphabet.
+static const char kEsfCodecBase64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Padding character.
+#define ESF_CODEC_BASE64_PAD ('=')
+
+// """EsfCodecBase64StreamEncodeGroup
+
+// Encodes one group of 3 bytes.
+
+// Args:
+//     [IN] in (const uint8_t*): 3 bytes of original data.
+//     [OUT] out (char*): 4 characters.
+
+// Note:
+
+// """
+static void EsfCodecBase64StreamEncodeGroup(const uint8_t* in, char* out) {
+  uint32_t group =
+      ((uint32_t)in[0] << 16) | ((uint32_t)in[1] << 8) | (uint32_t)in[2];
+  out[0] = kEsfCodecBase64Alphabet[(group >> 18) & 0x3F];
+  out[1] = kEsfCodecBase64Alphabet[(group >> 12) & 0x3F];
+  out[2] = kEsfCodecBase64Alphabet[(group >> 6) & 0x3F];
+  out[3] = kEsfCodecBase64Alphabet[group & 0x3F];
+}
+
+// """EsfCodecBase64StreamValue
+
+// Gets the value of a Base64 character.
+
+// Args:
+//     [IN] c (char): Character.
+
+// Returns:
+//     0..63, or -1 if c is not in the Base64 alphabet.
+
+// Note:
+
+// """
+static int32_t EsfCodecBase64StreamValue(char c) {
+  if (c >= 'A' && c <= 'Z') {
+    return c - 'A';
+  }
+  if (c >= 'a' && c <= 'z') {
+    return c - 'a' + 26;
+  }
+  if (c >= '0' && c <= '9') {
+    return c - '0' + 52;
+  }
+  if (c == '+') {
+    return 62;
+  }
+  if (c == '/') {
+    return 63;
+  }
+  return -1;
+}
+
+// """EsfCodecBase64StreamDecodeGroup
+
+// Decodes one group of 4 characters. The last two may be padding.
+
+// Args:
+//     [IN] in (const char*): 4 Base64 characters.
+//     [OUT] out (uint8_t*): Room for 3 bytes of original data.
+//     [OUT] out_size (size_t*): Number of bytes written.
+//     [OUT] padded (bool*): true if the group had padding.
+
+// Returns:
+//     kEsfCodecBase64ResultSuccess: Success.
+//     kEsfCodecBase64ResultIllegalInData: The group is not valid Base64.
+
+// Note:
+
+// """
+static EsfCodecBase64ResultEnum EsfCodecBase64StreamDecodeGroup(
+    const char* in, uint8_t* out, size_t* out_size, bool* padded) {
+  int32_t v0 = EsfCodecBase64StreamValue(in[0]);
+  int32_t v1 = EsfCodecBase64StreamValue(in[1]);
+  int32_t v2 = EsfCodecBase64StreamValue(in[2]);
+  int32_t v3 = EsfCodecBase64StreamValue(in[3]);
+  *padded = false;
+  if (v0 < 0 || v1 < 0) {
+    return kEsfCodecBase64ResultIllegalInData;
+  }
+  out[0] = (uint8_t)((v0 << 2) | (v1 >> 4));
+  if (in[2] == ESF_CODEC_BASE64_PAD && in[3] == ESF_CODEC_BASE64_PAD) {
+    *out_size = 1;
+    *padded = true;
+    return kEsfCodecBase64ResultSuccess;
+  }
+  if (v2 < 0) {
+    return kEsfCodecBase64ResultIllegalInData;
+  }
+  out[1] = (uint8_t)(((v1 & 0x0F) << 4) | (v2 >> 2));
+  if (in[3] == ESF_CODEC_BASE64_PAD) {
+    *out_size = 2;
+    *padded = true;
+    return kEsfCodecBase64ResultSuccess;
+  }
+  if (v3 < 0) {
+    return kEsfCodecBase64ResultIllegalInData;
+  }
+  out[2] = (uint8_t)(((v2 & 0x03) << 6) | v3);
+  *out_size = 3;
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeInit(
+    EsfCodecBase64EncodeContext* context) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  memset(context, 0, sizeof(*context));
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeUpdate(
+    EsfCodecBase64EncodeContext* context, const uint8_t* in, size_t in_size,
+    char* out, size_t* out_size) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL || (in == NULL && in_size != 0) || out == NULL ||
+      out_size == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  if (ESF_BASE64_MAX_SIZE < in_size) {
+    ESF_CODEC_BASE64_ERR("in_size is out of range. in_size=%zu", in_size);
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultOutOfRange;
+  }
+  size_t total = context->pending_size + in_size;
+  size_t need = total / kBase64EncodeConvertDataUnit * kBase64EncodeUnit;
+  if (*out_size < need) {
+    ESF_CODEC_BASE64_ERR("out_size is too small. out_size=%zu, need=%zu",
+                         *out_size, need);
+    return kEsfCodecBase64ResultExceedsOutBuffer;
+  }
+
+  size_t written = 0;
+  if (context->pending_size > 0) {
+    if (total < kBase64EncodeConvertDataUnit) {
+      memcpy(&context->pending[context->pending_size], in, in_size);
+      context->pending_size = total;
+      *out_size = 0;
+      ESF_CODEC_BASE64_TRACE("func end");
+      return kEsfCodecBase64ResultSuccess;
+    }
+    uint8_t group[kBase64EncodeConvertDataUnit];
+    size_t fill = kBase64EncodeConvertDataUnit - context->pending_size;
+    memcpy(group, context->pending, context->pending_size);
+    memcpy(&group[context->pending_size], in, fill);
+    EsfCodecBase64StreamEncodeGroup(group, out);
+    written = kBase64EncodeUnit;
+    in += fill;
+    in_size -= fill;
+    context->pending_size = 0;
+  }
+
+  size_t done = EsfCodecBase64EncodeBlocks(in, in_size, out + written);
+  written += done / kBase64EncodeConvertDataUnit * kBase64EncodeUnit;
+  for (; in_size - done >= kBase64EncodeConvertDataUnit;
+       done += kBase64EncodeConvertDataUnit) {
+    EsfCodecBase64StreamEncodeGroup(in + done, out + written);
+    written += kBase64EncodeUnit;
+  }
+  context->pending_size = in_size - done;
+  if (context->pending_size > 0) {
+    memcpy(context->pending, in + done, context->pending_size);
+  }
+  *out_size = written;
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64EncodeFinal(
+    EsfCodecBase64EncodeContext* context, char* out, size_t* out_size) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL || out == NULL || out_size == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  size_t need = ((context->pending_size > 0) ? kBase64EncodeUnit : 0) + 1U;
+  if (*out_size < need) {
+    ESF_CODEC_BASE64_ERR("out_size is too small. out_size=%zu, need=%zu",
+                         *out_size, need);
+    return kEsfCodecBase64ResultExceedsOutBuffer;
+  }
+
+  if (context->pending_size > 0) {
+    uint8_t group[kBase64EncodeConvertDataUnit] = {0};
+    memcpy(group, context->pending, context->pending_size);
+    EsfCodecBase64StreamEncodeGroup(group, out);
+    // 1 byte leaves 2 characters, 2 bytes leave 3.
+    for (size_t i = context->pending_size + 1U; i < kBase64EncodeUnit; ++i) {
+      out[i] = ESF_CODEC_BASE64_PAD;
+    }
+  }
+  out[need - 1U] = '\0';
+  *out_size = need;
+  context->pending_size = 0;
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeInit(
+    EsfCodecBase64DecodeContext* context) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  memset(context, 0, sizeof(*context));
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeUpdate(
+    EsfCodecBase64DecodeContext* context, const char* in, size_t in_size,
+    uint8_t* out, size_t* out_size) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL || (in == NULL && in_size != 0) || out == NULL ||
+      out_size == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  if (ESF_BASE64_MAX_SIZE < in_size) {
+    ESF_CODEC_BASE64_ERR("in_size is out of range. in_size=%zu", in_size);
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultOutOfRange;
+  }
+  if (context->padded && in_size > 0) {
+    ESF_CODEC_BASE64_ERR("Data after padding.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+    return kEsfCodecBase64ResultIllegalInData;
+  }
+  size_t total = context->pending_size + in_size;
+  size_t need = total / kBase64EncodeUnit * kBase64EncodeConvertDataUnit;
+  if (*out_size < need) {
+    ESF_CODEC_BASE64_ERR("out_size is too small. out_size=%zu, need=%zu",
+                         *out_size, need);
+    return kEsfCodecBase64ResultExceedsOutBuffer;
+  }
+
+  EsfCodecBase64ResultEnum ret = kEsfCodecBase64ResultSuccess;
+  size_t written = 0;
+  size_t size = 0;
+  bool padded = false;
+  if (context->pending_size > 0) {
+    if (total < kBase64EncodeUnit) {
+      memcpy(&context->pending[context->pending_size], in, in_size);
+      context->pending_size = total;
+      *out_size = 0;
+      ESF_CODEC_BASE64_TRACE("func end");
+      return kEsfCodecBase64ResultSuccess;
+    }
+    char group[kBase64EncodeUnit];
+    size_t fill = kBase64EncodeUnit - context->pending_size;
+    memcpy(group, context->pending, context->pending_size);
+    memcpy(&group[context->pending_size], in, fill);
+    ret = EsfCodecBase64StreamDecodeGroup(group, out, &size, &padded);
+    if (ret != kEsfCodecBase64ResultSuccess) {
+      ESF_CODEC_BASE64_ERR("Illegal Base64 group. [%.4s]", group);
+      ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+      return ret;
+    }
+    written = size;
+    in += fill;
+    in_size -= fill;
+    context->pending_size = 0;
+  }
+
+  size_t whole = in_size - in_size % kBase64EncodeUnit;
+  size_t done = 0;
+  if (!padded) {
+    done = EsfCodecBase64DecodeBlocks(in, whole, out + written);
+    written += done / kBase64EncodeUnit * kBase64EncodeConvertDataUnit;
+  }
+  for (; done < whole; done += kBase64EncodeUnit) {
+    if (padded) {
+      ESF_CODEC_BASE64_ERR("Data after padding.");
+      ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+      return kEsfCodecBase64ResultIllegalInData;
+    }
+    ret = EsfCodecBase64StreamDecodeGroup(in + done, out + written, &size,
+                                          &padded);
+    if (ret != kEsfCodecBase64ResultSuccess) {
+      ESF_CODEC_BASE64_ERR("Illegal Base64 group. [%.4s]", in + done);
+      ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+      return ret;
+    }
+    written += size;
+  }
+  if (padded && whole < in_size) {
+    ESF_CODEC_BASE64_ERR("Data after padding.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+    return kEsfCodecBase64ResultIllegalInData;
+  }
+  context->padded = padded;
+  context->pending_size = in_size - whole;
+  if (context->pending_size > 0) {
+    memcpy(context->pending, in + whole, context->pending_size);
+  }
+  *out_size = written;
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
+
+EsfCodecBase64ResultEnum EsfCodecBase64DecodeFinal(
+    EsfCodecBase64DecodeContext* context) {
+  ESF_CODEC_BASE64_TRACE("func start");
+  if (context == NULL) {
+    ESF_CODEC_BASE64_ERR("Input parameter is NULL.");
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_INVALID_PARAM);
+    return kEsfCodecBase64ResultNullParam;
+  }
+  size_t pending_size = context->pending_size;
+  memset(context, 0, sizeof(*context));
+  if (pending_size > 0) {
+    ESF_CODEC_BASE64_ERR("String is not in 4-character units. left=%zu",
+                         pending_size);
+    ESF_CODEC_BASE64_ELOG_WARN(ESF_CODEC_BASE64_ELOG_DECODE_FAILURE);
+    return kEsfCodecBase64ResultIllegalInSize;
+  }
+  ESF_CODEC_BASE64_TRACE("func end");
+  return kEsfCodecBase64ResultSuccess;
+}
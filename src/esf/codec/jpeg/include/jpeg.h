@@ -17,6 +17,13 @@ extern "C" {
 
 #include "memory_manager.h"
 
+// Maximum number of threads of EsfCodecJpegEncodeParallel().
+#define ESF_CODEC_JPEG_THREAD_NUM_MAX (8)
+
+// Tolerance of the size of EsfCodecJpegEncodeTargetSize() below the target
+// (in percent of the target size).
+#define ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE (10)
+
 // This code defines an enumeration type for the result of executing an API.
 typedef enum {
   kJpegSuccess,               // No errors.
@@ -47,6 +54,14 @@ typedef struct {
   int32_t output_buf_size;
 } EsfCodecJpegOutputBuf;
 
+// The struct defines a rectangle of the input image (in pixels).
+typedef struct {
+  int32_t x;       // Left edge.
+  int32_t y;       // Top edge.
+  int32_t width;   // Horizontal size.
+  int32_t height;  // Vertical size.
+} EsfCodecJpegRegion;
+
 // The struct defines the parameters for JPEG encoding.
 typedef struct {
   // The starting address of the input data. Setting zero is not allowed.
@@ -73,6 +88,19 @@ typedef struct {
 
   // Image quality (0: low quality ~ 100: high quality).
   int32_t quality;
+
+  // Region of the input image to encode. All zero encodes the whole image.
+  // Otherwise it must lie inside the image, and x and y must be even for
+  // kJpegInputYuv_8. Only the lines and columns of the region are read.
+  EsfCodecJpegRegion roi;
+
+  // Scale factor scale_numerator / scale_denominator of the region, applied
+  // while the lines are converted; each JPEG pixel is the average of the
+  // input pixels it covers. Only downscaling (numerator <= denominator) is
+  // supported, and the JPEG image is the scaled region size rounded up. Both
+  // zero keeps the size.
+  int32_t scale_numerator;
+  int32_t scale_denominator;
 } EsfCodecJpegEncParam;
 
 // The struct defines the parameters for JPEG encoding.
@@ -88,6 +116,21 @@ typedef struct {
   int32_t quality;  // Image quality (0: low quality ~ 100: high quality).
 } EsfCodecJpegInfo;
 
+// The struct defines the thumbnail of EsfCodecJpegEncodeHandleWithThumbnail().
+typedef struct {
+  // Scale factor scale_numerator / scale_denominator of the thumbnail. It
+  // must be smaller than 1; the size is rounded up, as for
+  // EsfCodecJpegEncParam.
+  int32_t scale_numerator;
+  int32_t scale_denominator;
+
+  // Image quality of the thumbnail (0: low quality ~ 100: high quality).
+  int32_t quality;
+} EsfCodecJpegThumbnailInfo;
+
+// Handle of a JPEG encoder context. See EsfCodecJpegEncoderCreate().
+typedef struct EsfCodecJpegEncoder *EsfCodecJpegEncoderHandle;
+
 // """Input data is encoded in JPEG format, and a JPEG image is output.
 
 // Translate the input data to JPEG encoding and output a JPEG image. Carry out
@@ -192,6 +235,294 @@ EsfCodecJpegError EsfCodecJpegEncodeHandle(EsfMemoryManagerHandle input_handle,
                                            const EsfCodecJpegInfo *info,
                                            int32_t *jpeg_size);
 
+// """Processes input data of a memory handle through a JPEG encoder and
+//   outputs a JPEG image to memory.
+// The input handle is mapped when the MemoryManager supports it and read with
+// FileIO otherwise. The JPEG image is written to the output buffer as it is
+// compressed, so no output handle or intermediate copy is needed.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     info (const struct EsfCodecJpegInfo *):
+//       JPEG encoding parameters. NULL assignment not allowed.
+//     out_buf (const EsfCodecJpegOutputBuf *):
+//       Output buffer. NULL assignment not allowed.
+//     jpeg_size (int32_t *):
+//       The size of the JPEG image after outputting the encoded. NULL
+//       assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When info, out_buf or jpeg_size is NULL.
+//                      When the value of info or out_buf is invalid.
+//                      When input_handle is not a LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleToMemory(
+    EsfMemoryManagerHandle input_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegOutputBuf *out_buf, int32_t *jpeg_size);
+
+// """Encodes an image to JPEG and outputs it as a Base64 string.
+// Each block of JPEG data is Base64 encoded into the output as soon as the
+// encoder produces it, so neither the JPEG image nor a second pass over it is
+// needed. The string is the same as EsfCodecBase64EncodeHandle() makes from
+// the JPEG image, including the null terminator. Each handle is mapped when
+// the MemoryManager supports it and is opened for FileIO otherwise; FileIO
+// handles must be closed when passed. Ensure the output area can hold
+// (jpeg size + 2) / 3 * 4 + 1 bytes. If it is not sufficient,
+// kJpegOutputBufferFullError will be returned.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     output_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle.
+//     info (const struct EsfCodecJpegInfo *):
+//       JPEG encoding parameters. NULL assignment not allowed.
+//     base64_size (int32_t *):
+//       The size of the Base64 string including the null terminator. NULL
+//       assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When info is NULL.
+//                      When the value of info is invalid.
+//                      When base64_size is NULL.
+//                      When input_handle or output_handle is not a
+//                      LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient for
+//       the Base64 string, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeBase64Handle(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    const EsfCodecJpegInfo *info, int32_t *base64_size);
+
+// """Input data is encoded in JPEG format on several threads.
+
+// Same as EsfCodecJpegEncode(), but the image is cut into horizontal slices
+// that are encoded on up to thread_num threads, the calling thread included.
+// The slices are joined with restart markers, so the JPEG image is a valid
+// baseline JPEG with a restart interval of one slice; it is slightly larger
+// than the one of EsfCodecJpegEncode(). A slice is at most 65535 MCUs, so a
+// large image may have more slices than threads. The JPEG data of the slices
+// is held until all are done, so about the size of the JPEG image is
+// allocated on top of the output area.
+
+// Args:
+//     enc_param (const struct EsfCodecJpegEncParam *): JPEG encoding
+//       parameters. NULL assignment not allowed.
+//     thread_num (int32_t): Number of threads, 1 to
+//       ESF_CODEC_JPEG_THREAD_NUM_MAX.
+//     jpeg_size (int32_t *): The size of the JPEG image after outputting the
+//       encoded. NULL assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When enc_param is NULL.
+//                      When the value of enc_param is invalid.
+//                      When thread_num is out of range.
+//                      When jpeg_size is NULL.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+
+// """
+EsfCodecJpegError EsfCodecJpegEncodeParallel(
+    const EsfCodecJpegEncParam *enc_param, int32_t thread_num,
+    int32_t *jpeg_size);
+
+// """Creates a JPEG encoder context for images of one size, format and
+//   quality.
+// The context keeps the JPEG compression object with its parameters and
+// tables, the scratch area for the input lines and the FileIO write buffer
+// between images, so that encoding a stream of images with
+// EsfCodecJpegEncoderEncode() or EsfCodecJpegEncoderEncodeHandle() does not
+// set them up for each image. A context is used by one thread at a time.
+// Release it with EsfCodecJpegEncoderDestroy().
+
+// Args:
+//     info (const struct EsfCodecJpegInfo *): JPEG encoding parameters of
+//       every image. NULL assignment not allowed.
+//     encoder (EsfCodecJpegEncoderHandle *): The created context. NULL
+//       assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When info is NULL.
+//                      When the value of info is invalid.
+//                      When encoder is NULL.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+// """
+EsfCodecJpegError EsfCodecJpegEncoderCreate(const EsfCodecJpegInfo *info,
+                                            EsfCodecJpegEncoderHandle *encoder);
+
+// """Encodes an image with a JPEG encoder context.
+// Same as EsfCodecJpegEncode() with the parameters of the context. The
+// context stays usable after an error.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment not allowed.
+//     input_adr_handle (uint64_t): The starting address of the input data.
+//       Setting zero is not allowed.
+//     out_buf (const EsfCodecJpegOutputBuf *): Output buffer information.
+//       NULL assignment not allowed.
+//     jpeg_size (int32_t *): The size of the JPEG image after outputting the
+//       encoded. NULL assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When encoder, out_buf or jpeg_size is NULL.
+//                      When input_adr_handle or the output address is zero.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncoderEncode(
+    EsfCodecJpegEncoderHandle encoder, uint64_t input_adr_handle,
+    const EsfCodecJpegOutputBuf *out_buf, int32_t *jpeg_size);
+
+// """Encodes an image of a MemoryManager handle with a JPEG encoder context.
+// Each handle is mapped when the MemoryManager supports it and is opened for
+// FileIO otherwise; FileIO handles must be closed when passed. The context
+// stays usable after an error.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment not allowed.
+//     input_handle (EsfMemoryManagerHandle): Input side MemoryManager's
+//       handle.
+//     output_handle (EsfMemoryManagerHandle): Output side MemoryManager's
+//       handle.
+//     jpeg_size (int32_t *): The size of the JPEG image after outputting the
+//       encoded. NULL assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When encoder or jpeg_size is NULL.
+//                      When input_handle or output_handle is not a
+//                      LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncoderEncodeHandle(
+    EsfCodecJpegEncoderHandle encoder, EsfMemoryManagerHandle input_handle,
+    EsfMemoryManagerHandle output_handle, int32_t *jpeg_size);
+
+// """Destroys a JPEG encoder context and releases its resources.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When encoder is NULL.
+// """
+EsfCodecJpegError EsfCodecJpegEncoderDestroy(
+    EsfCodecJpegEncoderHandle encoder);
+
+// """Processes input data through two JPEG encoders at once, and outputs a
+//   JPEG image and a scaled down thumbnail of it.
+// Each input line is read once and passed to both encoders, so the two images
+// cost about one read of the input. The thumbnail is made while the lines
+// are read: each of its pixels is the average of the input pixels it covers.
+// Each handle is mapped when the MemoryManager supports it and is opened for
+// FileIO otherwise; FileIO handles must be closed when passed.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     output_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle of the full size image.
+//     thumbnail_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle of the thumbnail.
+//     info (const struct EsfCodecJpegInfo *):
+//       JPEG encoding parameters. NULL assignment not allowed.
+//     thumbnail_info (const struct EsfCodecJpegThumbnailInfo *):
+//       Scale factor and quality of the thumbnail. NULL assignment not
+//       allowed.
+//     jpeg_size (int32_t *):
+//       The size of the full size JPEG image. NULL assignment not allowed.
+//     thumbnail_size (int32_t *):
+//       The size of the thumbnail. NULL assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When info or thumbnail_info is NULL.
+//                      When the value of info or thumbnail_info is invalid.
+//                      When jpeg_size or thumbnail_size is NULL.
+//                      When a handle is not a LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If an output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleWithThumbnail(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    EsfMemoryManagerHandle thumbnail_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegThumbnailInfo *thumbnail_info, int32_t *jpeg_size,
+    int32_t *thumbnail_size);
+
+// """Input data is encoded in JPEG format at the quality that makes a JPEG
+//   image of about a target size.
+// The quality is estimated from trial encodes, which only count bytes, of
+// tiles sampled from the image (of the whole image when it is small), and the
+// image is encoded at that quality. Only when the size does not land between
+// (100 - ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE)% of target_size and
+// target_size is the image encoded a second time, with the estimate
+// corrected by the first encode; there is no third encode.
+// On kJpegSuccess the image always fits in target_size, but it may be smaller
+// than the tolerance: when enc_param's quality is too low to reach it, when
+// the second encode misses it too, or when a second encode to a higher
+// quality does not fit in the output area behind the first image, which is
+// kept then (the output area should be about twice target_size).
+
+// Args:
+//     enc_param (const struct EsfCodecJpegEncParam *): JPEG encoding
+//       parameters. quality is the highest quality that is used. NULL
+//       assignment not allowed.
+//     target_size (int32_t): The largest size of the JPEG image. A setting
+//       of 0 or less is not allowed. Limited to the size of the output
+//       buffer.
+//     jpeg_size (int32_t *): The size of the JPEG image after outputting the
+//       encoded. NULL assignment not allowed.
+//     quality (int32_t *): The quality the JPEG image was encoded at. NULL
+//       assignment not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When enc_param is NULL.
+//                      When the value of enc_param is invalid.
+//                      When target_size is 0 or less.
+//                      When jpeg_size or quality is NULL.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the JPEG image is still larger than
+//       target_size after the second encode.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeTargetSize(
+    const EsfCodecJpegEncParam *enc_param, int32_t target_size,
+    int32_t *jpeg_size, int32_t *quality);
+
 #ifdef __cplusplus
 }
 #endif
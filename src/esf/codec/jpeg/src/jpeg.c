@@ -362,3 +362,147 @@ EsfCodecJpegError EsfCodecJpegEncodeHandle(EsfMemoryManagerHandle input_handle,
 
   return jpeg_error_result;
 }
+
+EsfCodecJpegError EsfCodecJpegEncodeHandleToMemory(
+    EsfMemoryManagerHandle input_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegOutputBuf *out_buf, int32_t *jpeg_size) {
+  if ((info == NULL) || (out_buf == NULL) ||
+      (out_buf->output_adr_handle == 0U) || (jpeg_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. info=%p out_buf=%p jpeg_size=%p",
+                     "jpeg.c", __LINE__, info, out_buf, jpeg_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeHandleToArea(
+      input_handle, info, (uint8_t *)(uintptr_t)out_buf->output_adr_handle,
+      out_buf->output_buf_size, jpeg_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeBase64Handle(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    const EsfCodecJpegInfo *info, int32_t *base64_size) {
+  if ((input_handle == (EsfMemoryManagerHandle)0) ||
+      (output_handle == (EsfMemoryManagerHandle)0) || (info == NULL) ||
+      (base64_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. input_handle=%" PRIu32
+                     " output_handle=%" PRIu32 " info=%p base64_size=%p",
+                     "jpeg.c", __LINE__, input_handle, output_handle, info,
+                     base64_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeHandleBase64(input_handle, output_handle, info,
+                                        base64_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeParallel(
+    const EsfCodecJpegEncParam *enc_param, int32_t thread_num,
+    int32_t *jpeg_size) {
+  if ((enc_param == (const EsfCodecJpegEncParam *)NULL) ||
+      (jpeg_size == (int32_t *)NULL) || (thread_num < 1) ||
+      (thread_num > ESF_CODEC_JPEG_THREAD_NUM_MAX)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. enc_param=%p thread_num=%" PRId32
+                     " jpeg_size=%p",
+                     "jpeg.c", __LINE__, enc_param, thread_num, jpeg_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeSliced(enc_param, thread_num, jpeg_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncoderCreate(
+    const EsfCodecJpegInfo *info, EsfCodecJpegEncoderHandle *encoder) {
+  if ((info == NULL) || (encoder == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. info=%p encoder=%p", "jpeg.c",
+                     __LINE__, info, encoder);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegCreateEncoder(info, encoder);
+}
+
+EsfCodecJpegError EsfCodecJpegEncoderEncode(
+    EsfCodecJpegEncoderHandle encoder, uint64_t input_adr_handle,
+    const EsfCodecJpegOutputBuf *out_buf, int32_t *jpeg_size) {
+  if ((encoder == NULL) || (input_adr_handle == 0U) || (out_buf == NULL) ||
+      (out_buf->output_adr_handle == 0U) || (jpeg_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. encoder=%p out_buf=%p "
+                     "jpeg_size=%p",
+                     "jpeg.c", __LINE__, encoder, out_buf, jpeg_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeWithEncoder(
+      encoder, (uint8_t *)(uintptr_t)input_adr_handle, 0,
+      (uint8_t *)(uintptr_t)out_buf->output_adr_handle, 0,
+      out_buf->output_buf_size, jpeg_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncoderEncodeHandle(
+    EsfCodecJpegEncoderHandle encoder, EsfMemoryManagerHandle input_handle,
+    EsfMemoryManagerHandle output_handle, int32_t *jpeg_size) {
+  if ((encoder == NULL) || (input_handle == (EsfMemoryManagerHandle)0) ||
+      (output_handle == (EsfMemoryManagerHandle)0) || (jpeg_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. encoder=%p input_handle=%" PRIu32
+                     " output_handle=%" PRIu32 " jpeg_size=%p",
+                     "jpeg.c", __LINE__, encoder, input_handle, output_handle,
+                     jpeg_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeHandleWithEncoder(encoder, input_handle,
+                                             output_handle, jpeg_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncoderDestroy(
+    EsfCodecJpegEncoderHandle encoder) {
+  if (encoder == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. encoder=%p",
+                     "jpeg.c", __LINE__, encoder);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegDestroyEncoder(encoder);
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeHandleWithThumbnail(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    EsfMemoryManagerHandle thumbnail_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegThumbnailInfo *thumbnail_info, int32_t *jpeg_size,
+    int32_t *thumbnail_size) {
+  if ((info == NULL) || (thumbnail_info == NULL) || (jpeg_size == NULL) ||
+      (thumbnail_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. info=%p thumbnail_info=%p "
+                     "jpeg_size=%p thumbnail_size=%p",
+                     "jpeg.c", __LINE__, info, thumbnail_info, jpeg_size,
+                     thumbnail_size);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeHandleThumbnail(input_handle, output_handle,
+                                           thumbnail_handle, info,
+                                           thumbnail_info, jpeg_size,
+                                           thumbnail_size);
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeTargetSize(
+    const EsfCodecJpegEncParam *enc_param, int32_t target_size,
+    int32_t *jpeg_size, int32_t *quality) {
+  if ((enc_param == (const EsfCodecJpegEncParam *)NULL) ||
+      (jpeg_size == (int32_t *)NULL) || (quality == (int32_t *)NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. enc_param=%p jpeg_size=%p "
+                     "quality=%p",
+                     "jpeg.c", __LINE__, enc_param, jpeg_size, quality);
+    return kJpegParamError;
+  }
+
+  return EsfCodecJpegEncodeToSize(enc_param, target_size, jpeg_size, quality);
+}
@@ -12,10 +12,20 @@
 #include <setjmp.h>
 // clang-format on
 #include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #if defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG)
 #include "libjpeg/jpeglib.h"
@@ -29,6 +39,7 @@
 
 #include "jpeg.h"
 #include "memory_manager.h"
+#include "utility_counter.h"
 #include "utility_log.h"
 #include "utility_log_module_id.h"
 
@@ -38,6 +49,38 @@
 #define STATIC
 #endif  // JPEG_REMOVE_STATIC
 
+// Size of the Base64 characters of one block of
+// CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE bytes, with room for
+// the last group and the null terminator.
+#define ESF_CODEC_JPEG_BASE64_BLOCK_SIZE                                    \
+  (((CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE + 2) / 3) * 4 + 5)
+
+// Room for the headers of a slice on top of its share of the output area.
+#define ESF_CODEC_JPEG_SLICE_HEADER_SIZE (1024)
+
+// Largest restart interval the DRI marker can hold (in MCUs).
+#define ESF_CODEC_JPEG_RESTART_INTERVAL_MAX (65535)
+
+// The trial image of EsfCodecJpegEncodeToSize() is made of tiles of about one
+// MCU of the JPEG image, one in ESF_CODEC_JPEG_TRIAL_STEP across and down.
+// Its bytes are counted in a buffer of ESF_CODEC_JPEG_TRIAL_BUFFER_SIZE.
+#define ESF_CODEC_JPEG_TRIAL_STEP (4)
+#define ESF_CODEC_JPEG_TRIAL_BUFFER_SIZE (4096)
+// Fewest tiles across and down the trial image; in fewer, the edges between
+// the tiles take a share of the size that the image does not have.
+#define ESF_CODEC_JPEG_TRIAL_TILE_MIN (8)
+// Low qualities of the trial encode, below those spaced from quality_max,
+// where the size changes fastest.
+#define ESF_CODEC_JPEG_TRIAL_QUALITY_LOW (10)
+#define ESF_CODEC_JPEG_TRIAL_QUALITY_MIN (3)
+
+// Number of successful encodes and distribution of their output size.
+static UTILITY_COUNTER_DEFINE(s_jpeg_encode_counter, "codec.jpeg.encode");
+static UTILITY_COUNTER_DEFINE(s_jpeg_encode_failed_counter,
+                              "codec.jpeg.encode_failed");
+static UTILITY_HISTOGRAM_DEFINE(s_jpeg_output_size_counter,
+                                "codec.jpeg.output_bytes");
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -91,14 +134,55 @@ STATIC boolean EsfCodecJpegEmptyOutputBufferCallback(j_compress_ptr cinfo);
 STATIC boolean
 EsfCodecJpegEmptyOutputBufferCallbackFileIo(j_compress_ptr cinfo);
 
+// """Base64 encodes JPEG data of the temporary storage buffer into the output.
+// The first data_size bytes of cinfo->dest->tmp_output_buffer are encoded with
+// the Base64 context of the destination manager. When the output is a mapped
+// area, the characters are written into it directly; otherwise they are put in
+// base64_output and written with EsfMemoryManagerFwrite(). The number of
+// characters is added to jpeg_size.
+// Args:
+//     dest (EsfCodecJpegDestManager *): JPEG destination manager.
+//     data_size (size_t): Size of the JPEG data to encode.
+//     final (bool): Terminates the Base64 string after the data.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegOutputBufferFullError: If the output area is insufficient.
+//     kJpegOtherError: If Base64 encoding or writing fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegWriteBase64(EsfCodecJpegDestManager *dest,
+                                                 size_t data_size, bool final);
+
+// """Callback called at the end of Jpeg encoding. This is for Base64 output.
+// Encodes the JPEG data remaining in the buffer and terminates the Base64
+// string with EsfCodecJpegWriteBase64(). If an error occurs, store it in
+// cinfo->dest->succeed.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//     codec state.
+// """
+STATIC void EsfCodecJpegTermDestinationCallbackBase64(j_compress_ptr cinfo);
+
+// """A callback function used in the JPEG compression process.
+// This is for Base64 output. Encodes the full temporary storage buffer with
+// EsfCodecJpegWriteBase64() and resets cinfo->dest->pub.next_output_byte and
+// cinfo->dest->pub.free_in_buffer to the whole buffer. If an error occurs,
+// store it in cinfo->dest->succeed and return false.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//       codec state.
+// Returns:
+//     On success: true
+//     On error: false
+// """
+STATIC boolean
+EsfCodecJpegEmptyOutputBufferCallbackBase64(j_compress_ptr cinfo);
+
 // """A callback function used in the JPEG library to handle error exits.
 
 // The function first casts the 'err' member of the 'cinfo' structure to a
-// pointer of type 'EsfCodecJpegErrorManager'. It then frees the memory pointed
-// to by 'scan_line_ptr' member of the 'error_manager' structure. Sets the value
-// of 'scan_line_ptr' member to NULL. Jumps to the location specified by the
-// 'setjmp_buffer' member of the 'error_manager' structure using the longjmp
-// function.
+// pointer of type 'EsfCodecJpegErrorManager'. It then jumps to the location
+// specified by the 'setjmp_buffer' member of the 'error_manager' structure
+// using the longjmp function.
 
 // Args:
 //     cinfo (j_common_ptr): A pointer to a j_common_ptr structure containing
@@ -130,6 +214,49 @@ STATIC void EsfCodecJpegErrorExitCallback(j_common_ptr cinfo);
 STATIC EsfCodecJpegError EsfCodecJpegCheckParam(
     const EsfCodecJpegEncParam *enc_param, EsfCodecJpegAccessType access_type);
 
+// """Gets the region of the input image to encode and the JPEG image size.
+
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): Encoding parameters checked
+//       by EsfCodecJpegCheckParam().
+//     region (EsfCodecJpegRegion *): The region; the whole image when
+//       enc_param->roi is all zero.
+//     output_width (int32_t *): Width of the JPEG image.
+//     output_height (int32_t *): Height of the JPEG image.
+// """
+STATIC void EsfCodecJpegGetRegion(const EsfCodecJpegEncParam *enc_param,
+                                  EsfCodecJpegRegion *region,
+                                  int32_t *output_width,
+                                  int32_t *output_height);
+
+// """Gets the offset of a column in a line of the input image.
+
+// Args:
+//     format (EsfCodecJpegInputFormat): Input image format.
+//     x (int32_t): Column (in pixels).
+
+// Returns:
+//     Offset of the column (in bytes); in each plane for planar formats.
+// """
+STATIC size_t EsfCodecJpegColumnOffset(EsfCodecJpegInputFormat format,
+                                       int32_t x);
+
+// """Interleave one row of the three planes of an RGB planar image.
+
+// Writes width packed RGB pixels. Uses the vector unit of the CPU when the
+// build targets one with byte shuffles (SSSE3, NEON).
+
+// Args:
+//     red (const uint8_t *): Row of the red plane.
+//     green (const uint8_t *): Row of the green plane.
+//     blue (const uint8_t *): Row of the blue plane.
+//     width (int32_t): Width of the image.
+//     converted_image (JSAMPROW): Packed RGB row of width * 3 bytes.
+// """
+STATIC void EsfCodecJpegInterleaveRgb(const uint8_t *red, const uint8_t *green,
+                                      const uint8_t *blue, int32_t width,
+                                      JSAMPROW converted_image);
+
 // """Convert an RGB planar image to a packed RGB image.
 
 // This function takes an input RGB planar image and converts it to a packed RGB
@@ -154,33 +281,6 @@ STATIC EsfCodecJpegError EsfCodecJpegRgbPlanarToRgbPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, JSAMPROW converted_image);
 
-// """Convert an RGB planar image to a packed RGB image.
-
-// This is for FileIO access. This function takes an input RGB planar image and
-// converts it to a packed RGB image. The input image is represented as three
-// separate planes for each color channel (red, green, and blue). The output
-// image is a single plane with the RGB values packed together.
-
-// Args:
-//     input_file_handle (EsfMemoryManagerHandle): Input side MemoryManager's
-//       FileIO handle.
-//     width (int32_t): Width of the image.
-//     height (int32_t): Height of the image.
-//     stride (int32_t): Stride of the image (number of bytes per row).
-//     target_line (int32_t): Target line to convert.
-//     swap_red_blue (bool): Whether to swap the red and blue color channels.
-//     converted_image (JSAMPROW): Pointer to the converted image buffer.
-
-// Returns:
-//     kJpegSuccess: If the conversion was successful.
-//     kJpegParamError: If any of the input parameters are invalid.
-//     kJpegMemAllocError: If memory allocation fails.
-//     kJpegOtherError: If an error occurs in the MemoryManager.
-// """
-STATIC EsfCodecJpegError EsfCodecJpegRgbPlanarToRgbPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image);
-
 // """Copy RGB packed image data to a converted image buffer.
 
 // This function takes an input RGB packed image and copies the specified line
@@ -207,36 +307,6 @@ STATIC EsfCodecJpegError EsfCodecJpegCopyRgbPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, bool swap_red_blue, JSAMPROW converted_image);
 
-// """Copy RGB packed image data to a converted image buffer.
-
-// This is for FileIO access. This function takes an input RGB packed image and
-// copies the specified line of pixels to a converted image buffer. The width,
-// height, stride, target_line, swap_red_blue, and converted_image parameters
-// are used to determine the source and destination locations for the pixel
-// data. The function checks for valid input parameters and returns an error
-// code if any of the parameters are invalid.
-
-// Args:
-//     input_file_handle (EsfMemoryManagerHandle): Input side MemoryManager's
-//       FileIO handle.
-//     width (int32_t): Width of the image.
-//     height (int32_t): Height of the image.
-//     stride (int32_t): Stride of the image (number of bytes per row).
-//     target_line (int32_t): Target line to convert.
-//     swap_red_blue (bool): Whether to swap the red and blue color channels.
-//     converted_image (JSAMPROW): Pointer to the converted image buffer.
-
-// Returns:
-//     kJpegSuccess: if the conversion was successful.
-//     kJpegParamError: if any of the input parameters are invalid.
-//     kJpegMemAllocError: If memory allocation fails.
-//     kJpegOtherError: If an error occurs in the MemoryManager.
-// """
-STATIC EsfCodecJpegError EsfCodecJpegCopyRgbPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, bool swap_red_blue,
-    JSAMPROW converted_image);
-
 // """Copy a grayscale image line from the source image to the target image.
 
 // This function takes a grayscale image, specified by the 'image' parameter,
@@ -269,41 +339,6 @@ STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScale(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, JSAMPROW converted_image);
 
-// """Copy a grayscale image line from the source image to the target image.
-
-// This is for FileIO access. This function takes a grayscale image, specified
-// by the 'image' parameter, and copies a single line of pixels from the source
-// image to the target image. The width and height of the source image are
-// specified by the 'width' and 'height' parameters, respectively. The stride
-// parameter specifies the number of bytes between each line in the source
-// image. The target_line parameter specifies the line number in the source
-// image that should be copied to the target image. The converted_image
-// parameter is a pointer to the target image where the line will be copied to.
-//
-// If any of the input parameters are invalid (e.g., width or height is zero,
-// image or converted_image is NULL, target_line is out of range, or stride is
-// less than width), the function returns kJpegParamError. Otherwise, it copies
-// the line of pixels and returns kJpegSuccess.
-
-// Args:
-//     input_file_handle (EsfMemoryManagerHandle): Input side MemoryManager's
-//       FileIO handle.
-//     width (int32_t): Width of the image.
-//     height (int32_t): Height of the image.
-//     stride (int32_t): Stride of the image (number of bytes per row).
-//     target_line (int32_t): Target line to convert.
-//     converted_image (JSAMPROW): Pointer to the converted image buffer.
-
-// Returns:
-//     kJpegSuccess: if the conversion was successful.
-//     kJpegParamError: if any of the input parameters are invalid.
-//     kJpegMemAllocError: If memory allocation fails.
-//     kJpegOtherError: If an error occurs in the MemoryManager.
-// """
-STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScaleFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image);
-
 // """Converts an NV12 image to a packed YUV format.
 
 // This function converts an NV12 image to a packed YUV format.
@@ -332,92 +367,227 @@ STATIC EsfCodecJpegError EsfCodecJpegNv12ToYuvPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, JSAMPROW converted_image);
 
-// """Converts an NV12 image to a packed YUV format.
+// """Convert a line of an image in various formats to a JPEG-compatible format.
 
-// This is for FileIO access. This function converts an NV12 image to a packed
-// YUV format. It takes in the image data, width, height, stride, target line,
-// and a pointer to the converted image buffer. If any of the input parameters
-// are invalid, it returns a kJpegParamError. The function first checks if the
-// input parameters are valid. If not, it returns an error. It then calculates
-// the pointers to the Y and U/V planes based on the target line and stride.
-// Next, it loops through each pixel in the width of the image and copies the Y,
-// U, and V values to the converted image buffer. Finally, it returns
-// kJpegSuccess to indicate that the conversion was successful.
+// This function takes an input image in various formats (RGB planar, RGB
+// packed, BGR packed, grayscale, YUV) and converts one line of it to a format
+// compatible with the JPEG compression algorithm.
 
 // Args:
-//     input_file_handle (EsfMemoryManagerHandle): Input side MemoryManager's
-//       FileIO handle.
+//     format (EsfCodecJpegInputFormat): The input format of the image.
+//     image (const uint8_t *): Pointer to the input image data.
 //     width (int32_t): Width of the image.
 //     height (int32_t): Height of the image.
 //     stride (int32_t): Stride of the image (number of bytes per row).
 //     target_line (int32_t): Target line to convert.
-//     converted_image (JSAMPROW): Pointer to the converted image buffer.
+//     converted_image (JSAMPROW): Buffer for the converted line, of width
+//       samples of each component.
 
 // Returns:
 //     kJpegSuccess: if the conversion was successful.
 //     kJpegParamError: if any of the input parameters are invalid.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegConvertLine(
+    EsfCodecJpegInputFormat format, const uint8_t *image, int32_t width,
+    int32_t height, int32_t stride, int32_t target_line,
+    JSAMPROW converted_image);
+
+// """Determines if libjpeg can take the lines of an input format as they are.
+
+// RGB packed and grayscale lines, and BGR packed lines with libjpeg-turbo,
+// already have the layout libjpeg expects, so they are passed without being
+// converted or copied.
+
+// Args:
+//     format (EsfCodecJpegInputFormat): The input format of the image.
+
+// Returns:
+//     true:  If the lines need no conversion.
+//     false: If the lines have to be converted with EsfCodecJpegConvertLine().
+// """
+STATIC bool EsfCodecJpegIsDirectInput(EsfCodecJpegInputFormat format);
+
+// """Reads the input lines of a strip with FileIO.
+
+// This is for FileIO access. Reads lines [line, line + lines) of each plane of
+// the input with one EsfMemoryManagerFpread() per plane, and stores them with
+// the layout of an image of the given number of lines, so that the strip can
+// be converted like an image in memory. Only the columns of the region of the
+// compress manager are read, and each line of the strip starts with the
+// first of them.
+
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager.
+//     line (int32_t): First line of the strip in the input image.
+//     lines (int32_t): Number of lines of the strip.
+//     strip (uint8_t *): Buffer of CalculateInputBufferSize(stride, lines,
+//       format) bytes.
+
+// Returns:
+//     kJpegSuccess: If the strip was read.
+//     kJpegParamError: If the input format is invalid.
+//     kJpegOtherError: If an error occurs in the MemoryManager.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegReadStripFileIo(
+    EsfCodecJpegCompressManager *compress_manager, int32_t line, int32_t lines,
+    uint8_t *strip);
+
+// """Passes all lines of the input image to libjpeg.
+
+// Feeds the image in strips of one MCU height (max_v_samp_factor * DCTSIZE
+// lines, the lines libjpeg compresses together) with one
+// jpeg_write_scanlines() call per strip. Lines that libjpeg can take as they
+// are point into the image; the others are converted into the scratch area
+// of the compress manager. For FileIO access, each strip is read with
+// EsfCodecJpegReadStripFileIo() into the same scratch area. Only the region
+// of the compress manager is passed; a region that is scaled down is passed
+// with EsfCodecJpegWriteScaledStrips(). The lines are also added to the
+// thumbnail of the compress manager, if any.
+
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager after jpeg_start_compress().
+
+// Returns:
+//     kJpegSuccess: If all lines were compressed.
+//     kJpegParamError: If any of the parameters are invalid.
 //     kJpegMemAllocError: If memory allocation fails.
 //     kJpegOtherError: If an error occurs in the MemoryManager.
+//     Others: The error stored by the destination manager.
 // """
-STATIC EsfCodecJpegError EsfCodecJpegNv12ToYuvPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image);
+STATIC EsfCodecJpegError EsfCodecJpegWriteStrips(
+    EsfCodecJpegCompressManager *compress_manager);
 
-// """Convert a line of an image in various formats to a JPEG-compatible format.
+// """Passes the region of the input image to libjpeg scaled down.
 
-// This function takes an input image in various formats (RGB planar, RGB
-// packed, BGR packed, grayscale, YUV) and converts it to a format compatible
-// with the JPEG compression algorithm. The converted image is stored in a
-// temporary buffer and returned as a JSAMPROW pointer.
+// The input lines of the region are converted (and, for FileIO access, read
+// with EsfCodecJpegReadStripFileIo() in strips) into the scratch area of the
+// compress manager and added to the scaled image one after another with
+// EsfCodecJpegAddScaledLine(), so the image is shrunk while it is read and no
+// full size copy is made.
 
 // Args:
-//     format (EsfCodecJpegInputFormat): The input format of the image.
-//     image (const uint8_t *): Pointer to the input image data.
-//     width (int32_t): Width of the image.
-//     height (int32_t): Height of the image.
-//     stride (int32_t): Stride of the image (number of bytes per row).
-//     target_line (int32_t): Target line to convert.
-//     result (EsfCodecJpegError *): Pointer to a variable to store the error
-//       code.
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager after jpeg_start_compress().
 
 // Returns:
-//     A pointer to the converted image data, or NULL if an error occurred. The
-//     caller is responsible for freeing the memory allocated for the converted
-//     image.
+//     The same values as EsfCodecJpegWriteStrips().
 // """
-STATIC JSAMPROW EsfCodecJpegConvertLine(EsfCodecJpegInputFormat format,
-                                        const uint8_t *image, int32_t width,
-                                        int32_t height, int32_t stride,
-                                        int32_t target_line,
-                                        EsfCodecJpegError *result);
+STATIC EsfCodecJpegError EsfCodecJpegWriteScaledStrips(
+    EsfCodecJpegCompressManager *compress_manager);
 
-// """Convert a line of an image in various formats to a JPEG-compatible format.
+// """Gets the first input line of an output line of the scaled image.
+
+// Args:
+//     compress_manager (const EsfCodecJpegCompressManager *): JPEG
+//       compression manager.
+//     line (int32_t): Output line, counted from first_line.
+
+// Returns:
+//     The input line.
+// """
+STATIC int32_t EsfCodecJpegScaledLineStart(
+    const EsfCodecJpegCompressManager *compress_manager, int32_t line);
+
+// """Prepares the scaler of the compress manager for a scaled image.
 
-// This is for FileIO access. This function takes an input image in various
-// formats (RGB planar, RGB packed, BGR packed, grayscale, YUV) and converts it
-// to a format compatible with the JPEG compression algorithm. The converted
-// image is stored in a temporary buffer and returned as a JSAMPROW pointer.
+// The sums, the output strip and a line for converting input lines are taken
+// from the scratch area, followed by extra_size bytes for the caller.
 
 // Args:
-//     format (EsfCodecJpegInputFormat): The input format of the image.
-//     input_file_handle (EsfMemoryManagerHandle): Input side MemoryManager's
-//       FileIO handle.
-//     width (int32_t): Width of the image.
-//     height (int32_t): Height of the image.
-//     stride (int32_t): Stride of the image (number of bytes per row).
-//     target_line (int32_t): Target line to convert.
-//     result (EsfCodecJpegError *): Pointer to a variable to store the error
-//       code.
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager after jpeg_start_compress().
+//     extra_size (size_t): Size of the area of the caller.
+//     extra (uint8_t **): The area of the caller. May be NULL when extra_size
+//       is 0.
+
+// Returns:
+//     kJpegSuccess: If the scaler is ready.
+//     kJpegParamError: If the scaled size is larger than the region.
+//     kJpegMemAllocError: If memory allocation fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegStartScaledLines(
+    EsfCodecJpegCompressManager *compress_manager, size_t extra_size,
+    uint8_t **extra);
+
+// """Adds the next input line of the region to the scaled image.
+
+// Each output sample is the rounded average of the box of input samples it
+// covers. The boxes of neighbouring samples do not overlap, and their sizes
+// differ by at most one line or column when the scale does not divide the
+// region. The line is added to the sums of the output line whose box it is
+// in; after the last line of the box the output line is stored in the strip,
+// and a full strip, or the last one, is passed to libjpeg. Lines after the
+// last box are ignored.
+
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager after EsfCodecJpegStartScaledLines().
+//     source (const JSAMPLE *): Input line in the layout of libjpeg, with
+//       region_width pixels from the first column of the region.
+
+// Returns:
+//     kJpegSuccess: If the line was added.
+//     Others: The error stored by the destination manager.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegAddScaledLine(
+    EsfCodecJpegCompressManager *compress_manager, const JSAMPLE *source);
+
+// """Gets the scratch area of the compress manager.
+// The area is kept until EsfCodecJpegDestroyManager(), so that a manager that
+// encodes several images allocates it once. It is reallocated when it is
+// smaller than size.
+
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager.
+//     size (size_t): Size needed.
+
+// Returns:
+//     The scratch area, or NULL if memory allocation fails.
+// """
+STATIC uint8_t *EsfCodecJpegGetScratch(
+    EsfCodecJpegCompressManager *compress_manager, size_t size);
+
+// """Split one line of the interleaved UV plane of an NV12 image.
+
+// Args:
+//     u_v (const uint8_t *): Line of the UV plane, U first.
+//     count (int32_t): Number of U/V pairs.
+//     u (JSAMPROW): Buffer for count U samples.
+//     v (JSAMPROW): Buffer for count V samples.
+// """
+STATIC void EsfCodecJpegDeinterleaveUv(const uint8_t *u_v, int32_t count,
+                                       JSAMPROW u, JSAMPROW v);
+
+// """Passes the planes of an NV12 image to libjpeg as raw data.
+
+// NV12 is already YCbCr 4:2:0, the sampling libjpeg uses for YCbCr, so the
+// planes go straight to the DCT stage with jpeg_write_raw_data() and neither
+// color conversion nor downsampling runs. Works on one MCU height of Y lines
+// (and half as many chroma lines) at a time. Y lines point into the image
+// when its width fills whole blocks; otherwise they are copied with the last
+// sample repeated up to the block boundary, as libjpeg pads the other
+// formats. U and V are split into a scratch area padded the same way. Lines
+// below the image repeat its last line. For FileIO access, each strip is read
+// with EsfCodecJpegReadStripFileIo() first. The scratch area is the one of
+// the compress manager. The thumbnail of the compress manager, if any, gets
+// the lines converted to packed YCbCr.
+
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager after jpeg_start_compress() with raw_data_in set.
 
 // Returns:
-//     A pointer to the converted image data, or NULL if an error occurred. The
-//     caller is responsible for freeing the memory allocated for the converted
-//     image.
+//     kJpegSuccess: If all lines were compressed.
+//     kJpegParamError: If any of the parameters are invalid.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: If an error occurs in the MemoryManager.
+//     Others: The error stored by the destination manager.
 // """
-STATIC JSAMPROW EsfCodecJpegConvertLineFileIo(
-    EsfCodecJpegInputFormat format, EsfMemoryManagerHandle input_file_handle,
-    int32_t width, int32_t height, int32_t stride, int32_t target_line,
-    EsfCodecJpegError *result);
+STATIC EsfCodecJpegError EsfCodecJpegWriteRawData(
+    EsfCodecJpegCompressManager *compress_manager);
 
 // """Determines if the file_handle is FileIO handle.
 
@@ -438,63 +608,466 @@ STATIC bool EsfCodecJpegIsFileHandle(EsfMemoryManagerHandle file_handle);
 
 STATIC int32_t CalculateInputBufferSize(int32_t stride, int32_t height,
                                  EsfCodecJpegInputFormat input_fmt);
-/****************************************************************************
- * Private Functions
- ****************************************************************************/
-STATIC void EsfCodecJpegTermDestinationCallback(j_compress_ptr cinfo) {
-  return;
-}
 
-STATIC void EsfCodecJpegTermDestinationCallbackFileIo(j_compress_ptr cinfo) {
-  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+// """Runs one JPEG encode with Base64 output on prepared buffers.
+// Creates a compress manager, sets up the Base64 destination manager with
+// EsfCodecJpegSetDestManagerBase64() and compresses the image. The input is
+// read from enc_param->input_adr_handle, or with FileIO from input_file_handle
+// when it is not 0.
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): Encoding parameters.
+//     input_file_handle (EsfMemoryManagerHandle): Input side FileIO handle, or
+//       0 for memory access.
+//     buffer (uint8_t *): Buffer for one block of JPEG data.
+//     base64_output (char *): See EsfCodecJpegSetDestManagerBase64().
+//     base64_output_size (size_t): Size of base64_output.
+//     output_file_handle (EsfMemoryManagerHandle): Output side FileIO handle,
+//       or 0 when the output area is base64_output itself.
+//     output_size_max (size_t): Size of the output area.
+//     base64_size (int32_t *): Size of the Base64 string, including the null
+//       terminator.
+// Returns:
+//     The same values as EsfCodecJpegEncodeHandleBase64().
+// """
+STATIC EsfCodecJpegError EsfCodecJpegEncodeBase64(
+    const EsfCodecJpegEncParam *enc_param,
+    EsfMemoryManagerHandle input_file_handle, uint8_t *buffer,
+    char *base64_output, size_t base64_output_size,
+    EsfMemoryManagerHandle output_file_handle, size_t output_size_max,
+    int32_t *base64_size);
+
+// """Gets how a handle is accessed and the size of its area.
+// A handle that can be mapped must not be an OtherHeap handle, and one that
+// cannot must be a LargeHeap handle used with FileIO.
+// Args:
+//     handle (EsfMemoryManagerHandle): MemoryManager's handle.
+//     support (EsfMemoryManagerMapSupport *): Whether the handle can be mapped.
+//     allocate_size (int32_t *): Size of the area of the handle.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegParamError: If the target area of the handle is not supported.
+//     kJpegOtherError: If the MemoryManager fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegGetHandleArea(
+    EsfMemoryManagerHandle handle, EsfMemoryManagerMapSupport *support,
+    int32_t *allocate_size);
+
+// """Callback called when the buffer of a slice is full.
+// The buffer of cinfo->dest (tmp_output_buffer) is doubled with realloc(), up
+// to jpeg_size_max bytes. If it cannot grow, store the error in
+// cinfo->dest->succeed and return false.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//       codec state.
+// Returns:
+//     On success: true
+//     On error: false
+// """
+STATIC boolean EsfCodecJpegEmptyOutputBufferCallbackSlice(j_compress_ptr cinfo);
 
-  size_t data_size = dest->tmp_output_buffer_size - dest->pub.free_in_buffer;
-  size_t rsize = 0;
-  if (data_size > 0) {
-    EsfMemoryManagerResult result = EsfMemoryManagerFwrite(
-        dest->output_file_handle, dest->tmp_output_buffer, data_size, &rsize);
-    if (result != kEsfMemoryManagerResultSuccess) {
-      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:FileIO write failed. result=%d",
-                       "jpeg_internal.c", __LINE__, result);
-      dest->succeed = kJpegOtherError;
-    } else {
-      dest->jpeg_size += rsize;
-    }
-  }
+// """Callback called at the end of the Jpeg encoding of a slice.
+// Stores the size of the JPEG data in cinfo->dest->jpeg_size.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//     codec state.
+// """
+STATIC void EsfCodecJpegTermDestinationCallbackSlice(j_compress_ptr cinfo);
 
-  return;
-}
+// """Encodes one slice of the image into a JPEG image of its own.
+// The JPEG image is stored in slice->buffer, which the caller frees.
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters of
+//       the whole image.
+//     restart_interval (unsigned int): Restart interval written in the
+//       header (in MCUs).
+//     slice (EsfCodecJpegSlice *): Slice to encode.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     Otherwise the error of encoding, as EsfCodecJpegCompressImage().
+// """
+STATIC EsfCodecJpegError EsfCodecJpegEncodeSlice(
+    const EsfCodecJpegEncParam *enc_param, unsigned int restart_interval,
+    EsfCodecJpegSlice *slice);
 
-STATIC boolean EsfCodecJpegEmptyOutputBufferCallback(j_compress_ptr cinfo) {
-  ((EsfCodecJpegDestManager *)(cinfo->dest))->succeed =
-      kJpegOutputBufferFullError;
-  return (boolean) false;
-}
+// """Thread function that encodes the slices of an EsfCodecJpegSliceWorker.
+// Args:
+//     arg (void *): EsfCodecJpegSliceWorker.
+// Returns:
+//     NULL.
+// """
+STATIC void *EsfCodecJpegSliceThread(void *arg);
 
-STATIC boolean
-EsfCodecJpegEmptyOutputBufferCallbackFileIo(j_compress_ptr cinfo) {
-  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+// """Finds the frame header and the start of the entropy-coded data of a
+// JPEG image.
+// Args:
+//     jpeg (const uint8_t *): JPEG image.
+//     size (size_t): Size of jpeg.
+//     sof_offset (size_t *): Offset of the SOFn marker.
+//     data_offset (size_t *): Offset of the data after the SOS segment.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegOtherError: If the image has no frame or scan header.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegFindScanData(const uint8_t *jpeg,
+                                                  size_t size,
+                                                  size_t *sof_offset,
+                                                  size_t *data_offset);
+
+// """Joins the JPEG images of the slices into one JPEG image.
+// The headers of the first slice with the height of the whole image are
+// followed by the entropy-coded data of each slice, RSTn markers between the
+// slices and EOI.
+// Args:
+//     slices (const EsfCodecJpegSlice *): Encoded slices.
+//     slice_num (int32_t): Number of slices.
+//     height (int32_t): Height of the whole image.
+//     output (uint8_t *): Output area.
+//     output_size (size_t): Size of output.
+//     jpeg_size (size_t *): Size of the JPEG image.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegOutputBufferFullError: If output is insufficient.
+//     kJpegOtherError: If a slice is not a JPEG image as expected.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegJoinSlices(const EsfCodecJpegSlice *slices,
+                                                int32_t slice_num,
+                                                int32_t height,
+                                                uint8_t *output,
+                                                size_t output_size,
+                                                size_t *jpeg_size);
+
+// """Finishes the JPEG image of a compress manager and gets its size.
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager whose lines were all passed to libjpeg.
+//     output_size (int32_t *): Size of the JPEG image.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     Others: The error stored by the destination manager.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegFinishImage(
+    EsfCodecJpegCompressManager *compress_manager, int32_t *output_size);
 
-  size_t rsize = 0;
-  EsfMemoryManagerResult result =
-      EsfMemoryManagerFwrite(dest->output_file_handle, dest->tmp_output_buffer,
-                             dest->tmp_output_buffer_size, &rsize);
-  if (result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:FileIO write failed. result=%d",
-                     "jpeg_internal.c", __LINE__, result);
-    dest->succeed = kJpegOtherError;
-    return (boolean) false;
-  }
+// """Compresses an image and its thumbnail reading the input once.
+// The lines of compress_manager are added to thumbnail as they are passed to
+// libjpeg, as EsfCodecJpegCompressImage() does for one image.
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager of the full size image.
+//     thumbnail (EsfCodecJpegCompressManager *): JPEG compression manager of
+//       a scaled copy of the same region.
+//     output_size (int32_t *): Size of the full size image.
+//     thumbnail_size (int32_t *): Size of the thumbnail.
+// Returns:
+//     The same values as EsfCodecJpegCompressImage().
+// """
+STATIC EsfCodecJpegError EsfCodecJpegCompressImages(
+    EsfCodecJpegCompressManager *compress_manager,
+    EsfCodecJpegCompressManager *thumbnail, int32_t *output_size,
+    int32_t *thumbnail_size);
 
-  dest->jpeg_size += rsize;
-  dest->pub.next_output_byte =
-      dest->tmp_output_buffer;  // Return to the beginning of tmp_output_buffer
-  size_t remaining_buffer_size = dest->jpeg_size_max - dest->jpeg_size;
+// """Creates a JPEG encoder context from encoding parameters.
+// The address and the output area of enc_param are not used.
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters.
+//     encoder (EsfCodecJpegEncoderHandle *): Pointer to store the context.
+// Returns:
+//     The same values as EsfCodecJpegCreateEncoder().
+// """
+STATIC EsfCodecJpegError EsfCodecJpegCreateEncoderWithParam(
+    const EsfCodecJpegEncParam *enc_param, EsfCodecJpegEncoderHandle *encoder);
 
-  if (remaining_buffer_size == 0) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Jpeg output buffer is full.",
-                     "jpeg_internal.c", __LINE__);
-    dest->succeed = kJpegOutputBufferFullError;
+// """Sets the output of the next image of a JPEG encoder context.
+// The FileIO write buffer of the context is allocated on first use.
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context.
+//     output (const EsfCodecJpegOutputArea *): Output of the image.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegParamError: If the output area is invalid.
+//     kJpegMemAllocError: If memory allocation fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegSetEncoderOutput(
+    EsfCodecJpegEncoderHandle encoder, const EsfCodecJpegOutputArea *output);
+
+// """Sets the input of the next image of a JPEG encoder context.
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context.
+//     image (uint8_t *): Input image when input_file_handle is 0.
+//     input_file_handle (EsfMemoryManagerHandle): Opened input FileIO handle,
+//       or 0.
+// """
+STATIC void EsfCodecJpegSetEncoderInput(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image,
+    EsfMemoryManagerHandle input_file_handle);
+
+// """Aborts the images of a compress manager and its thumbnail after an error
+// in the OSS, keeping their parameters and tables.
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager of the full size image.
+//     thumbnail (EsfCodecJpegCompressManager *): JPEG compression manager of
+//       the thumbnail.
+// """
+STATIC void EsfCodecJpegAbortEncoders(
+    EsfCodecJpegCompressManager *compress_manager,
+    EsfCodecJpegCompressManager *thumbnail);
+
+// """Maps a handle, or opens it for FileIO when it cannot be mapped.
+// Args:
+//     handle (EsfMemoryManagerHandle): MemoryManager's handle.
+//     size (int32_t): Size to map, or 0 for the whole area of the handle.
+//     data (uint8_t **): The mapped area, or NULL for FileIO.
+//     file_handle (EsfMemoryManagerHandle *): handle for FileIO, or 0 when it
+//       is mapped.
+//     area_size (int32_t *): Size of the area of the handle.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegParamError: If the target area of the handle is not supported.
+//     kJpegOtherError: If the MemoryManager fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegOpenHandle(
+    EsfMemoryManagerHandle handle, int32_t size, uint8_t **data,
+    EsfMemoryManagerHandle *file_handle, int32_t *area_size);
+
+// """Unmaps or closes a handle opened with EsfCodecJpegOpenHandle().
+// Args:
+//     handle (EsfMemoryManagerHandle): MemoryManager's handle.
+//     data (uint8_t **): The mapped area.
+//     file_handle (EsfMemoryManagerHandle): handle for FileIO, or 0 when it
+//       is mapped.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegOtherError: If the MemoryManager fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegCloseHandle(
+    EsfMemoryManagerHandle handle, uint8_t **data,
+    EsfMemoryManagerHandle file_handle);
+
+// """Callback called when the buffer of a trial image is full.
+// Counts the bytes of the buffer in cinfo->dest->jpeg_size and reuses it.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//       codec state.
+// Returns:
+//     true
+// """
+STATIC boolean EsfCodecJpegEmptyOutputBufferCallbackCount(j_compress_ptr cinfo);
+
+// """Callback called at the end of the Jpeg encoding of a trial image.
+// Adds the bytes left in the buffer to cinfo->dest->jpeg_size.
+// Args:
+//     cinfo (j_compress_ptr): a pointer to a structure containing the JPEG
+//     codec state.
+// """
+STATIC void EsfCodecJpegTermDestinationCallbackCount(j_compress_ptr cinfo);
+
+// """Sets a destination manager that counts the bytes of a JPEG image in
+// jpeg_size without keeping them.
+// Args:
+//     buffer (uint8_t *): Buffer the JPEG data is written to and dropped from.
+//     size (size_t): Size of buffer.
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager.
+// """
+STATIC void EsfCodecJpegSetDestManagerCount(
+    uint8_t *buffer, size_t size,
+    EsfCodecJpegCompressManager *compress_manager);
+
+// """Encodes the image of a compress manager at a quality and counts its
+// bytes without keeping them. The tables are not written.
+// Args:
+//     compress_manager (EsfCodecJpegCompressManager *): JPEG compression
+//       manager with the parameters set.
+//     buffer (uint8_t *): Buffer the JPEG data is written to and dropped from.
+//     buffer_size (size_t): Size of buffer.
+//     quality (int32_t): Image quality.
+//     jpeg_size (size_t *): Size of the JPEG image.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     Otherwise the error of writing the lines.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegCountImageSize(
+    EsfCodecJpegCompressManager *compress_manager, uint8_t *buffer,
+    size_t buffer_size, int32_t quality, size_t *jpeg_size);
+
+// """Copies tiles on a grid of the region of an image into a smaller image of
+// the same format.
+// One tile is taken from each step x step block of tiles, at a place that
+// changes from block to block (see EsfCodecJpegMosaicTile()), and the tiles
+// are placed next to each other.
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters of
+//       the image.
+//     tile (int32_t): Width and height of a tile (in pixels), even.
+//     step (int32_t): Tiles between the tiles that are copied.
+//     mosaic (uint8_t **): The smaller image, which the caller frees.
+//     mosaic_param (EsfCodecJpegEncParam *): JPEG encoding parameters of the
+//       smaller image, with the scale of enc_param.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegMemAllocError: If memory allocation fails.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegMakeMosaic(
+    const EsfCodecJpegEncParam *enc_param, int32_t tile, int32_t step,
+    uint8_t **mosaic, EsfCodecJpegEncParam *mosaic_param);
+
+// """Gets the tile that is taken from a block of tiles of the mosaic.
+// The place is hashed from the block, so that the tiles do not line up with
+// a pattern of the image that repeats every few blocks, and is the same on
+// every call.
+// Args:
+//     column (int32_t): Column of the block.
+//     row (int32_t): Row of the block.
+//     step (int32_t): Tiles across and down a block.
+//     x (int32_t *): Column of the tile in the block, 0 to step - 1.
+//     y (int32_t *): Row of the tile in the block, 0 to step - 1.
+// """
+STATIC void EsfCodecJpegMosaicTile(int32_t column, int32_t row, int32_t step,
+                                   int32_t *x, int32_t *y);
+
+// """Marks the tables that no component of an image uses as sent, so that
+// jpeg_write_tables() writes only the tables of the image (the chroma tables
+// of a grayscale image are set up, but not written with it).
+// Args:
+//     jpeg_object (struct jpeg_compress_struct *): JPEG compression object
+//       with its parameters set.
+// """
+STATIC void EsfCodecJpegMarkUnusedTables(
+    struct jpeg_compress_struct *jpeg_object);
+
+// """Makes the size model of an image from a trial encode.
+// The trial image is a mosaic of tiles of about one MCU of the JPEG image
+// (see EsfCodecJpegMakeMosaic()), so each block is coded as in the image. It
+// is encoded at quality_max, at two evenly spaced lower qualities and at
+// ESF_CODEC_JPEG_TRIAL_QUALITY_LOW and ESF_CODEC_JPEG_TRIAL_QUALITY_MIN, where
+// the size changes fastest. Images of fewer than
+// ESF_CODEC_JPEG_TRIAL_TILE_MIN * 2 tiles across or down are their own trial
+// image.
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters.
+//     quality_max (int32_t): Highest quality of the image.
+//     model (EsfCodecJpegSizeModel *): The size model.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     Otherwise the error of encoding the trial image.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegEstimateSizeModel(
+    const EsfCodecJpegEncParam *enc_param, int32_t quality_max,
+    EsfCodecJpegSizeModel *model);
+
+// """Gets the size of a JPEG image at a quality from a size model.
+// Qualities outside the points are extrapolated from the nearest two.
+// Args:
+//     model (const EsfCodecJpegSizeModel *): Size model of the image.
+//     quality (int32_t): Image quality.
+// Returns:
+//     The estimated size.
+// """
+STATIC double EsfCodecJpegModelSize(const EsfCodecJpegSizeModel *model,
+                                    int32_t quality);
+
+// """Adds the size of a JPEG image at a quality to a size model, in place of
+// the size at that quality if the model has one. A model that has
+// ESF_CODEC_JPEG_SIZE_MODEL_POINT_NUM points is left as it is.
+// Args:
+//     model (EsfCodecJpegSizeModel *): Size model of the image.
+//     quality (int32_t): Image quality.
+//     size (double): Size of the image at quality.
+// """
+STATIC void EsfCodecJpegModelAddPoint(EsfCodecJpegSizeModel *model,
+                                      int32_t quality, double size);
+
+// """Gets the highest quality whose JPEG image is estimated to fit in a
+// size.
+// Args:
+//     model (const EsfCodecJpegSizeModel *): Size model of the image.
+//     size (int32_t): Size the image should fit in.
+//     quality_max (int32_t): Highest quality.
+// Returns:
+//     The quality, 1 to quality_max.
+// """
+STATIC int32_t EsfCodecJpegModelQuality(const EsfCodecJpegSizeModel *model,
+                                        int32_t size, int32_t quality_max);
+
+// """Encodes an image with a JPEG encoder context at a quality.
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context.
+//     image (uint8_t *): Input image.
+//     quality (int32_t): Image quality.
+//     output (uint8_t *): Output area.
+//     output_size (int32_t): Size of output.
+//     jpeg_size (int32_t *): Size of the JPEG image.
+//     estimated_size (double *): Size of the JPEG image, or when output is
+//       insufficient, the size estimated from the lines encoded until then.
+// Returns:
+//     The same values as EsfCodecJpegEncodeWithEncoder(), and
+//     kJpegOutputBufferFullError whenever output is insufficient.
+// """
+STATIC EsfCodecJpegError EsfCodecJpegEncodeWithQuality(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image, int32_t quality,
+    uint8_t *output, int32_t output_size, int32_t *jpeg_size,
+    double *estimated_size);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+STATIC void EsfCodecJpegTermDestinationCallback(j_compress_ptr cinfo) {
+  return;
+}
+
+STATIC void EsfCodecJpegTermDestinationCallbackFileIo(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  size_t data_size = dest->tmp_output_buffer_size - dest->pub.free_in_buffer;
+  size_t rsize = 0;
+  if (data_size > 0) {
+    EsfMemoryManagerResult result = EsfMemoryManagerFwrite(
+        dest->output_file_handle, dest->tmp_output_buffer, data_size, &rsize);
+    if (result != kEsfMemoryManagerResultSuccess) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:FileIO write failed. result=%d",
+                       "jpeg_internal.c", __LINE__, result);
+      dest->succeed = kJpegOtherError;
+    } else {
+      dest->jpeg_size += rsize;
+    }
+  }
+
+  return;
+}
+
+STATIC boolean EsfCodecJpegEmptyOutputBufferCallback(j_compress_ptr cinfo) {
+  ((EsfCodecJpegDestManager *)(cinfo->dest))->succeed =
+      kJpegOutputBufferFullError;
+  return (boolean) false;
+}
+
+STATIC boolean
+EsfCodecJpegEmptyOutputBufferCallbackFileIo(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  size_t rsize = 0;
+  EsfMemoryManagerResult result =
+      EsfMemoryManagerFwrite(dest->output_file_handle, dest->tmp_output_buffer,
+                             dest->tmp_output_buffer_size, &rsize);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:FileIO write failed. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    dest->succeed = kJpegOtherError;
+    return (boolean) false;
+  }
+
+  dest->jpeg_size += rsize;
+  dest->pub.next_output_byte =
+      dest->tmp_output_buffer;  // Return to the beginning of tmp_output_buffer
+  size_t remaining_buffer_size = dest->jpeg_size_max - dest->jpeg_size;
+
+  if (remaining_buffer_size == 0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Jpeg output buffer is full.",
+                     "jpeg_internal.c", __LINE__);
+    dest->succeed = kJpegOutputBufferFullError;
     return (boolean) false;
   } else if (remaining_buffer_size >=
              CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE) {
@@ -511,11 +1084,92 @@ EsfCodecJpegEmptyOutputBufferCallbackFileIo(j_compress_ptr cinfo) {
   return (boolean) true;
 }
 
+STATIC EsfCodecJpegError EsfCodecJpegWriteBase64(EsfCodecJpegDestManager *dest,
+                                                 size_t data_size, bool final) {
+  char *out = dest->base64_output;
+  size_t out_size = dest->base64_output_size;
+  if (dest->output_file_handle == 0) {
+    // Write straight after the characters of the previous blocks.
+    out += dest->jpeg_size;
+    out_size = dest->jpeg_size_max - dest->jpeg_size;
+  }
+
+  size_t update_size = out_size;
+  EsfCodecBase64ResultEnum base64_result = EsfCodecBase64EncodeUpdate(
+      &dest->base64_context, dest->tmp_output_buffer, data_size, out,
+      &update_size);
+  size_t final_size = 0;
+  if ((base64_result == kEsfCodecBase64ResultSuccess) && final) {
+    final_size = out_size - update_size;
+    base64_result = EsfCodecBase64EncodeFinal(&dest->base64_context,
+                                              out + update_size, &final_size);
+  }
+  if (base64_result == kEsfCodecBase64ResultExceedsOutBuffer) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Base64 output buffer is full.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegOutputBufferFullError;
+  } else if (base64_result != kEsfCodecBase64ResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Base64 encoding failed. base64_result=%d",
+                     "jpeg_internal.c", __LINE__, base64_result);
+    return kJpegOtherError;
+  }
+
+  size_t write_size = update_size + final_size;
+  if (dest->output_file_handle != 0) {
+    if (write_size > dest->jpeg_size_max - dest->jpeg_size) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Base64 output buffer is full.",
+                       "jpeg_internal.c", __LINE__);
+      return kJpegOutputBufferFullError;
+    }
+    size_t rsize = 0;
+    EsfMemoryManagerResult result = EsfMemoryManagerFwrite(
+        dest->output_file_handle, out, write_size, &rsize);
+    if ((result != kEsfMemoryManagerResultSuccess) || (rsize != write_size)) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:FileIO write failed. result=%d rsize=%zu",
+                       "jpeg_internal.c", __LINE__, result, rsize);
+      return kJpegOtherError;
+    }
+  }
+
+  dest->jpeg_size += write_size;
+  return kJpegSuccess;
+}
+
+STATIC void EsfCodecJpegTermDestinationCallbackBase64(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  size_t data_size = dest->tmp_output_buffer_size - dest->pub.free_in_buffer;
+  EsfCodecJpegError result = EsfCodecJpegWriteBase64(dest, data_size, true);
+  if (result != kJpegSuccess) {
+    dest->succeed = result;
+  }
+
+  return;
+}
+
+STATIC boolean
+EsfCodecJpegEmptyOutputBufferCallbackBase64(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  EsfCodecJpegError result =
+      EsfCodecJpegWriteBase64(dest, dest->tmp_output_buffer_size, false);
+  if (result != kJpegSuccess) {
+    dest->succeed = result;
+    return (boolean) false;
+  }
+
+  // The block is encoded; reuse the buffer from its beginning.
+  dest->pub.next_output_byte = dest->tmp_output_buffer;
+  dest->pub.free_in_buffer = dest->tmp_output_buffer_size;
+
+  return (boolean) true;
+}
+
 STATIC void EsfCodecJpegErrorExitCallback(j_common_ptr cinfo) {
   EsfCodecJpegErrorManager *error_manager =
       (EsfCodecJpegErrorManager *)(cinfo->err);
-  free(error_manager->scan_line_ptr);
-  error_manager->scan_line_ptr = NULL;
   longjmp(error_manager->setjmp_buffer, 1);
 }
 
@@ -546,9 +1200,129 @@ STATIC EsfCodecJpegError EsfCodecJpegCheckParam(
     }
   }
 
+  const EsfCodecJpegRegion *roi = &enc_param->roi;
+  if ((roi->x != 0) || (roi->y != 0) || (roi->width != 0) ||
+      (roi->height != 0)) {
+    // NV12 shares a U/V pair among 2x2 pixels, so the region starts on one.
+    bool odd_start = (enc_param->input_fmt == kJpegInputYuv_8) &&
+                     (((roi->x | roi->y) & 1) != 0);
+    if ((roi->x < 0) || (roi->y < 0) || (roi->width <= 0) ||
+        (roi->height <= 0) || (roi->width > enc_param->width - roi->x) ||
+        (roi->height > enc_param->height - roi->y) || odd_start) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:Parameter error. roi x=%" PRId32 " y=%" PRId32
+                       " width=%" PRId32 " height=%" PRId32,
+                       "jpeg_internal.c", __LINE__, roi->x, roi->y,
+                       roi->width, roi->height);
+      return kJpegParamError;
+    }
+  }
+
+  if (((enc_param->scale_numerator != 0) ||
+       (enc_param->scale_denominator != 0)) &&
+      ((enc_param->scale_numerator <= 0) ||
+       (enc_param->scale_numerator > enc_param->scale_denominator))) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. scale=%" PRId32 "/%" PRId32,
+                     "jpeg_internal.c", __LINE__, enc_param->scale_numerator,
+                     enc_param->scale_denominator);
+    return kJpegParamError;
+  }
+
   return kJpegSuccess;
 }
 
+STATIC void EsfCodecJpegGetRegion(const EsfCodecJpegEncParam *enc_param,
+                                  EsfCodecJpegRegion *region,
+                                  int32_t *output_width,
+                                  int32_t *output_height) {
+  *region = enc_param->roi;
+  if ((region->width == 0) || (region->height == 0)) {
+    region->x = 0;
+    region->y = 0;
+    region->width = enc_param->width;
+    region->height = enc_param->height;
+  }
+
+  *output_width = region->width;
+  *output_height = region->height;
+  if (enc_param->scale_numerator != enc_param->scale_denominator) {
+    // Rounded up, so that every input pixel is covered.
+    int64_t numerator = enc_param->scale_numerator;
+    int64_t denominator = enc_param->scale_denominator;
+    int64_t round = denominator - 1;
+    *output_width =
+        (int32_t)(((region->width * numerator) + round) / denominator);
+    *output_height =
+        (int32_t)(((region->height * numerator) + round) / denominator);
+  }
+}
+
+STATIC size_t EsfCodecJpegColumnOffset(EsfCodecJpegInputFormat format,
+                                       int32_t x) {
+  switch (format) {
+    case kJpegInputRgbPacked_8:
+    case kJpegInputBgrPacked_8:
+      return (size_t)x * 3;
+    default:
+      return (size_t)x;
+  }
+}
+
+STATIC void EsfCodecJpegInterleaveRgb(const uint8_t *red, const uint8_t *green,
+                                      const uint8_t *blue, int32_t width,
+                                      JSAMPROW converted_image) {
+  int32_t j = 0;
+#if defined(__SSSE3__)
+  // 16 pixels make three 16 byte blocks. Each block takes its bytes from the
+  // three planes with one shuffle per plane; -1 clears the byte.
+  const __m128i r0 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1,
+                                   4, -1, -1, 5);
+  const __m128i g0 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1,
+                                   -1, 4, -1, -1);
+  const __m128i b0 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3,
+                                   -1, -1, 4, -1);
+  const __m128i r1 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9,
+                                   -1, -1, 10, -1);
+  const __m128i g1 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1,
+                                   9, -1, -1, 10);
+  const __m128i b1 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1,
+                                   -1, 9, -1, -1);
+  const __m128i r2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14,
+                                   -1, -1, 15, -1, -1);
+  const __m128i g2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1,
+                                   14, -1, -1, 15, -1);
+  const __m128i b2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1,
+                                   -1, 14, -1, -1, 15);
+  for (; j + 16 <= width; j += 16) {
+    __m128i r = _mm_loadu_si128((const __m128i *)(red + j));
+    __m128i g = _mm_loadu_si128((const __m128i *)(green + j));
+    __m128i b = _mm_loadu_si128((const __m128i *)(blue + j));
+    __m128i *out = (__m128i *)&converted_image[j * 3];
+    __m128i block = _mm_or_si128(_mm_shuffle_epi8(r, r0),
+                                 _mm_shuffle_epi8(g, g0));
+    _mm_storeu_si128(out + 0, _mm_or_si128(block, _mm_shuffle_epi8(b, b0)));
+    block = _mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1));
+    _mm_storeu_si128(out + 1, _mm_or_si128(block, _mm_shuffle_epi8(b, b1)));
+    block = _mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2));
+    _mm_storeu_si128(out + 2, _mm_or_si128(block, _mm_shuffle_epi8(b, b2)));
+  }
+#elif defined(__ARM_NEON)
+  for (; j + 16 <= width; j += 16) {
+    uint8x16x3_t rgb;
+    rgb.val[0] = vld1q_u8(red + j);
+    rgb.val[1] = vld1q_u8(green + j);
+    rgb.val[2] = vld1q_u8(blue + j);
+    vst3q_u8(&converted_image[j * 3], rgb);
+  }
+#endif
+  for (; j < width; j++) {
+    converted_image[(j * 3) + 0] = red[j];
+    converted_image[(j * 3) + 1] = green[j];
+    converted_image[(j * 3) + 2] = blue[j];
+  }
+}
+
 STATIC EsfCodecJpegError EsfCodecJpegRgbPlanarToRgbPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, JSAMPROW converted_image) {
@@ -569,137 +1343,11 @@ STATIC EsfCodecJpegError EsfCodecJpegRgbPlanarToRgbPacked(
   const uint8_t *green = &image[(target_line * stride) + (stride * height)];
   const uint8_t *blue = &image[(target_line * stride) + (stride * height * 2)];
 
-  for (int32_t j = 0; j < width; j++) {
-    converted_image[(j * 3) + 0] = *red;
-    converted_image[(j * 3) + 1] = *green;
-    converted_image[(j * 3) + 2] = *blue;
-    ++red;
-    ++green;
-    ++blue;
-  }
+  EsfCodecJpegInterleaveRgb(red, green, blue, width, converted_image);
 
   return kJpegSuccess;
 }
 
-STATIC EsfCodecJpegError EsfCodecJpegRgbPlanarToRgbPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image) {
-  if ((width == 0) || (height == 0) || (converted_image == (JSAMPROW)NULL) ||
-      (target_line < 0) || (target_line >= height) || (stride < width)) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. width=%" PRId32 " height=%" PRId32
-                     " converted_image=%p target_line=%" PRId32
-                     " stride=%" PRId32,
-                     "jpeg_internal.c", __LINE__, width, height,
-                     converted_image, target_line, stride);
-    return kJpegParamError;
-  }
-
-  EsfCodecJpegError jpeg_result = kJpegSuccess;
-  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
-  off_t offset = 0;
-  off_t result_offset = 0;
-  size_t result_size = 0;
-  uint8_t *red = NULL;
-  uint8_t *green = NULL;
-  uint8_t *blue = NULL;
-
-  // Red -------------------------------------------------
-  offset = target_line * stride;
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  red = malloc(width);
-  if (red == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, red, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  // -------------------------------------------------
-
-  // Green -------------------------------------------------
-  offset = (target_line * stride) + (stride * height);
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  green = malloc(width);
-  if (green == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, green, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  // -------------------------------------------------
-
-  // Blue -------------------------------------------------
-  offset = (target_line * stride) + (stride * height * 2);
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-
-  blue = malloc(width);
-  if (blue == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, blue, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  // -------------------------------------------------
-
-  for (int32_t j = 0; j < width; j++) {
-    converted_image[(j * 3) + 0] = *(red + j);
-    converted_image[(j * 3) + 1] = *(green + j);
-    converted_image[(j * 3) + 2] = *(blue + j);
-  }
-
-exit:
-  free(red);
-  free(green);
-  free(blue);
-
-  return jpeg_result;
-}
-
 STATIC EsfCodecJpegError EsfCodecJpegCopyRgbPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, bool swap_red_blue, JSAMPROW converted_image) {
@@ -730,82 +1378,18 @@ STATIC EsfCodecJpegError EsfCodecJpegCopyRgbPacked(
   return kJpegSuccess;
 }
 
-STATIC EsfCodecJpegError EsfCodecJpegCopyRgbPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, bool swap_red_blue,
-    JSAMPROW converted_image) {
-  if ((width == 0) || (height == 0) || (converted_image == (JSAMPROW)NULL) ||
-      (target_line < 0) || (target_line >= height) || (stride < width * 3)) {
+STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScale(
+    const uint8_t *image, int32_t width, int32_t height, int32_t stride,
+    int32_t target_line, JSAMPROW converted_image) {
+  if ((width == 0) || (height == 0) || (image == (const uint8_t *)NULL) ||
+      (converted_image == (JSAMPROW)NULL) || (target_line < 0) ||
+      (target_line >= height) || (stride < width)) {
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
                      "%s-%d:Parameter error. width=%" PRId32 " height=%" PRId32
-                     " converted_image=%p target_line=%" PRId32
+                     " image=%p "
+                     "converted_image=%p target_line=%" PRId32
                      " stride=%" PRId32,
-                     "jpeg_internal.c", __LINE__, width, height,
-                     converted_image, target_line, stride);
-    return kJpegParamError;
-  }
-
-  EsfCodecJpegError jpeg_result = kJpegSuccess;
-  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
-  off_t offset = 0;
-  off_t result_offset = 0;
-  size_t result_size = 0;
-  uint8_t *image = NULL;
-
-  offset = target_line * stride;
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  image = malloc(width * 3);
-  if (image == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, image,
-                                                (width * 3), &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-
-  for (int32_t j = 0; j < width * 3; j += 3) {
-    converted_image[j + 1] = image[j + 1];  // G
-    if (swap_red_blue) {
-      converted_image[j + 0] = image[j + 2];
-      converted_image[j + 2] = image[j + 0];
-    } else {
-      converted_image[j + 0] = image[j + 0];
-      converted_image[j + 2] = image[j + 2];
-    }
-  }
-
-exit:
-  free(image);
-
-  return jpeg_result;
-}
-
-STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScale(
-    const uint8_t *image, int32_t width, int32_t height, int32_t stride,
-    int32_t target_line, JSAMPROW converted_image) {
-  if ((width == 0) || (height == 0) || (image == (const uint8_t *)NULL) ||
-      (converted_image == (JSAMPROW)NULL) || (target_line < 0) ||
-      (target_line >= height) || (stride < width)) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. width=%" PRId32 " height=%" PRId32
-                     " image=%p "
-                     "converted_image=%p target_line=%" PRId32
-                     " stride=%" PRId32,
-                     "jpeg_internal.c", __LINE__, width, height, image,
+                     "jpeg_internal.c", __LINE__, width, height, image,
                      converted_image, target_line, stride);
     return kJpegParamError;
   }
@@ -817,62 +1401,6 @@ STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScale(
   return kJpegSuccess;
 }
 
-STATIC EsfCodecJpegError EsfCodecJpegCopyGrayScaleFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image) {
-  if ((width == 0) || (height == 0) || (converted_image == (JSAMPROW)NULL) ||
-      (target_line < 0) || (target_line >= height) || (stride < width)) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. width=%" PRId32 " height=%" PRId32
-                     " converted_image=%p target_line=%" PRId32
-                     " stride=%" PRId32,
-                     "jpeg_internal.c", __LINE__, width, height,
-                     converted_image, target_line, stride);
-    return kJpegParamError;
-  }
-
-  EsfCodecJpegError jpeg_result = kJpegSuccess;
-  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
-  off_t offset = 0;
-  off_t result_offset = 0;
-  size_t result_size = 0;
-  uint8_t *image = NULL;
-
-  offset = target_line * stride;
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  image = malloc(width);
-  if (image == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, image, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-
-  for (int32_t j = 0; j < width; j++) {
-    converted_image[j] = image[j];
-  }
-
-exit:
-  free(image);
-
-  return jpeg_result;
-}
-
 STATIC EsfCodecJpegError EsfCodecJpegNv12ToYuvPacked(
     const uint8_t *image, int32_t width, int32_t height, int32_t stride,
     int32_t target_line, JSAMPROW converted_image) {
@@ -905,352 +1433,785 @@ STATIC EsfCodecJpegError EsfCodecJpegNv12ToYuvPacked(
   return kJpegSuccess;
 }
 
-STATIC EsfCodecJpegError EsfCodecJpegNv12ToYuvPackedFileIo(
-    EsfMemoryManagerHandle input_file_handle, int32_t width, int32_t height,
-    int32_t stride, int32_t target_line, JSAMPROW converted_image) {
-  if ((width == 0) || (height == 0) || (converted_image == (JSAMPROW)NULL) ||
-      (target_line < 0) || (target_line >= height) || (stride < width)) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. width=%" PRId32 " height=%" PRId32
-                     " converted_image=%p target_line=%" PRId32
-                     " stride=%" PRId32,
-                     "jpeg_internal.c", __LINE__, width, height,
-                     converted_image, target_line, stride);
-    return kJpegParamError;
-  }
-
-  EsfCodecJpegError jpeg_result = kJpegSuccess;
-  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
-  off_t offset = 0;
-  off_t result_offset = 0;
-  size_t result_size = 0;
-  uint8_t *y = NULL;
-  uint8_t *u_v = NULL;
-
-  // Y -------------------------------------------------
-  offset = target_line * stride;
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  y = malloc(width);
-  if (y == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, y, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  // -------------------------------------------------
-
-  // UV -------------------------------------------------
-  offset = (stride * height) + (target_line / 2 * stride);
-  memory_manager_result = EsfMemoryManagerFseek(input_file_handle, offset,
-                                                SEEK_SET, &result_offset);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO seek failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  u_v = malloc(width);
-  if (u_v == NULL) {
-    jpeg_result = kJpegMemAllocError;
-    goto exit;
-  }
-  memory_manager_result = EsfMemoryManagerFread(input_file_handle, u_v, width,
-                                                &result_size);
-  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:FileIO read failed. memory_manager_result=%d",
-                     "jpeg_internal.c", __LINE__, memory_manager_result);
-    jpeg_result = kJpegOtherError;
-    goto exit;
-  }
-  // -------------------------------------------------
-  uint8_t *u_v_tmp = u_v;
-  for (int32_t j = 0; j < width; j++) {
-    converted_image[(j * 3) + 0] = *(y + j);
-    converted_image[(j * 3) + 1] = u_v_tmp[0];
-    converted_image[(j * 3) + 2] = u_v_tmp[1];
-    if (j % 2 == 1) {
-      u_v_tmp += 2;
-    }
-  }
-
-exit:
-  free(y);
-  free(u_v);
-
-  return jpeg_result;
-}
-
-STATIC JSAMPROW EsfCodecJpegConvertLine(EsfCodecJpegInputFormat format,
-                                        const uint8_t *image, int32_t width,
-                                        int32_t height, int32_t stride,
-                                        int32_t target_line,
-                                        EsfCodecJpegError *result) {
-  if (result == (EsfCodecJpegError *)NULL) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. result=%p ",
-                     "jpeg_internal.c", __LINE__, result);
-    return (JSAMPROW)NULL;
-  }
-
-  JSAMPROW tmp_image = (JSAMPROW)NULL;
+STATIC EsfCodecJpegError EsfCodecJpegConvertLine(
+    EsfCodecJpegInputFormat format, const uint8_t *image, int32_t width,
+    int32_t height, int32_t stride, int32_t target_line,
+    JSAMPROW converted_image) {
+  EsfCodecJpegError result = kJpegSuccess;
 
   switch (format) {
     case kJpegInputRgbPlanar_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegRgbPlanarToRgbPacked(image, width, height, stride,
-                                                   target_line, tmp_image);
-      }
+      result = EsfCodecJpegRgbPlanarToRgbPacked(image, width, height, stride,
+                                                target_line, converted_image);
       break;
     case kJpegInputRgbPacked_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
-                                            target_line, false, tmp_image);
-      }
+      result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
+                                         target_line, false, converted_image);
       break;
     case kJpegInputBgrPacked_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
 #if defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG)
-        *result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
-                                            target_line, true, tmp_image);
+      result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
+                                         target_line, true, converted_image);
 #elif defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG_TURBO)
-        *result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
-                                            target_line, false, tmp_image);
+      result = EsfCodecJpegCopyRgbPacked(image, width, height, stride,
+                                         target_line, false, converted_image);
 #endif
-      }
       break;
     case kJpegInputGray_8:
-      tmp_image = (JSAMPROW)malloc((width));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegCopyGrayScale(image, width, height, stride,
-                                            target_line, tmp_image);
-      }
+      result = EsfCodecJpegCopyGrayScale(image, width, height, stride,
+                                         target_line, converted_image);
       break;
     case kJpegInputYuv_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegNv12ToYuvPacked(image, width, height, stride,
-                                              target_line, tmp_image);
-      }
+      result = EsfCodecJpegNv12ToYuvPacked(image, width, height, stride,
+                                           target_line, converted_image);
       break;
     default:
       WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. format=%d",
                        "jpeg_internal.c", __LINE__, format);
-      *result = kJpegParamError;
+      result = kJpegParamError;
       break;
   }
 
-  if (*result != kJpegSuccess) {
+  if (result != kJpegSuccess) {
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Error. *result=%d format=%d"
+                     "%s-%d:Error. result=%d format=%d"
                      " image=%p width=%" PRId32 " height=%" PRId32
                      " stride=%" PRId32 " target_line=%" PRId32,
-                     "jpeg_internal.c", __LINE__, *result, format, image, width,
+                     "jpeg_internal.c", __LINE__, result, format, image, width,
                      height, stride, target_line);
-    free(tmp_image);
-    tmp_image = (JSAMPROW)NULL;
   }
 
-  return tmp_image;
+  return result;
 }
 
-STATIC JSAMPROW EsfCodecJpegConvertLineFileIo(
-    EsfCodecJpegInputFormat format, EsfMemoryManagerHandle input_file_handle,
-    int32_t width, int32_t height, int32_t stride, int32_t target_line,
-    EsfCodecJpegError *result) {
-  if (result == (EsfCodecJpegError *)NULL) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. result=%p ",
-                     "jpeg_internal.c", __LINE__, result);
-    return (JSAMPROW)NULL;
+STATIC bool EsfCodecJpegIsDirectInput(EsfCodecJpegInputFormat format) {
+  switch (format) {
+    case kJpegInputRgbPacked_8:
+    case kJpegInputGray_8:
+      return true;
+    case kJpegInputBgrPacked_8:
+#if defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG_TURBO)
+      // Read as JCS_EXT_BGR.
+      return true;
+#else
+      return false;
+#endif
+    default:
+      return false;
   }
+}
 
-  JSAMPROW tmp_image = (JSAMPROW)NULL;
-
-  switch (format) {
+STATIC EsfCodecJpegError EsfCodecJpegReadStripFileIo(
+    EsfCodecJpegCompressManager *compress_manager, int32_t line, int32_t lines,
+    uint8_t *strip) {
+  int32_t width = compress_manager->region_width;
+  int32_t height = compress_manager->image_height;
+  off_t stride = compress_manager->stride;
+  off_t column = (off_t)EsfCodecJpegColumnOffset(compress_manager->format,
+                                                 compress_manager->region_x);
+
+  // Planes of the strip: where they start in the input and in the strip,
+  // how many lines they have and how many bytes of a line are used.
+  struct {
+    off_t offset;
+    size_t strip_offset;
+    int32_t lines;
+    size_t line_size;
+  } planes[3];
+  int32_t plane_num = 0;
+
+  switch (compress_manager->format) {
     case kJpegInputRgbPlanar_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegRgbPlanarToRgbPackedFileIo(
-            input_file_handle, width, height, stride, target_line, tmp_image);
+      for (plane_num = 0; plane_num < 3; plane_num++) {
+        planes[plane_num].offset =
+            (stride * height * plane_num) + (stride * line) + column;
+        planes[plane_num].strip_offset = (size_t)(stride * lines * plane_num);
+        planes[plane_num].lines = lines;
+        planes[plane_num].line_size = (size_t)width;
       }
       break;
     case kJpegInputRgbPacked_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegCopyRgbPackedFileIo(input_file_handle, width,
-                                                  height, stride, target_line,
-                                                  false, tmp_image);
-      }
-      break;
     case kJpegInputBgrPacked_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-#if defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG)
-        *result = EsfCodecJpegCopyRgbPackedFileIo(input_file_handle, width,
-                                                  height, stride, target_line,
-                                                  true, tmp_image);
-#elif defined(CONFIG_EXTERNAL_CODEC_JPEG_OSS_LIBJPEG_TURBO)
-        *result = EsfCodecJpegCopyRgbPackedFileIo(input_file_handle, width,
-                                                  height, stride, target_line,
-                                                  false, tmp_image);
-#endif
-      }
-      break;
     case kJpegInputGray_8:
-      tmp_image = (JSAMPROW)malloc((width));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegCopyGrayScaleFileIo(
-            input_file_handle, width, height, stride, target_line, tmp_image);
-      }
+      planes[0].offset = (stride * line) + column;
+      planes[0].strip_offset = 0;
+      planes[0].lines = lines;
+      planes[0].line_size = (size_t)width *
+          ((compress_manager->format == kJpegInputGray_8) ? 1 : 3);
+      plane_num = 1;
       break;
     case kJpegInputYuv_8:
-      tmp_image = (JSAMPROW)malloc((width * 3));
-      if (tmp_image == NULL) {
-        *result = kJpegMemAllocError;
-      } else {
-        *result = EsfCodecJpegNv12ToYuvPackedFileIo(
-            input_file_handle, width, height, stride, target_line, tmp_image);
-      }
+      // Y, then interleaved UV with one line for every two lines of Y.
+      planes[0].offset = (stride * line) + column;
+      planes[0].strip_offset = 0;
+      planes[0].lines = lines;
+      planes[0].line_size = (size_t)width;
+      planes[1].offset = (stride * height) + (stride * (line / 2)) + column;
+      planes[1].strip_offset = (size_t)(stride * lines);
+      planes[1].lines = (lines + 1) / 2;
+      planes[1].line_size = (size_t)((width + 1) & ~1);
+      plane_num = 2;
       break;
     default:
       WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. format=%d",
-                       "jpeg_internal.c", __LINE__, format);
-      *result = kJpegParamError;
-      break;
+                       "jpeg_internal.c", __LINE__, compress_manager->format);
+      return kJpegParamError;
   }
 
-  if (*result != kJpegSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Error. *result=%d format=%d"
-                     " width=%" PRId32 " height=%" PRId32 " stride=%" PRId32
-                     " target_line=%" PRId32,
-                     "jpeg_internal.c", __LINE__, *result, format, width,
-                     height, stride, target_line);
-    free(tmp_image);
-    tmp_image = (JSAMPROW)NULL;
+  for (int32_t i = 0; i < plane_num; i++) {
+    // The padding after the last line of a plane is not read.
+    size_t read_size = ((size_t)(planes[i].lines - 1) * (size_t)stride) +
+                       planes[i].line_size;
+    size_t result_size = 0;
+    EsfMemoryManagerResult memory_manager_result = EsfMemoryManagerFpread(
+        compress_manager->input_file_handle, &strip[planes[i].strip_offset],
+        read_size, planes[i].offset, &result_size);
+    if ((memory_manager_result != kEsfMemoryManagerResultSuccess) ||
+        (result_size != read_size)) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:FileIO read failed. memory_manager_result=%d "
+                       "result_size=%zu",
+                       "jpeg_internal.c", __LINE__, memory_manager_result,
+                       result_size);
+      return kJpegOtherError;
+    }
   }
 
-  return tmp_image;
+  return kJpegSuccess;
 }
 
-STATIC bool EsfCodecJpegIsFileHandle(EsfMemoryManagerHandle file_handle) {
-  // Check Large Heap
-  EsfMemoryManagerHandleInfo info = {0};
-  EsfMemoryManagerResult result = EsfMemoryManagerGetHandleInfo(file_handle,
-                                                                &info);
-  if (result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to get handle info.",
-                     "jpeg_internal.c", __LINE__);
-    return false;
+STATIC EsfCodecJpegError EsfCodecJpegWriteStrips(
+    EsfCodecJpegCompressManager *compress_manager) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegDestManager *dest =
+      (EsfCodecJpegDestManager *)(jpeg_object->dest);
+  EsfCodecJpegInputFormat format = compress_manager->format;
+  bool file_io = (compress_manager->access_type == kEsfCodecJpegFileIoAccess);
+  bool direct = EsfCodecJpegIsDirectInput(format);
+  int32_t width = (int32_t)jpeg_object->image_width;
+  int32_t height = (int32_t)jpeg_object->image_height;
+  int32_t stride = compress_manager->stride;
+
+  if ((width != compress_manager->region_width) ||
+      (compress_manager->output_height != compress_manager->region_height)) {
+    return EsfCodecJpegWriteScaledStrips(compress_manager);
   }
-  if (info.target_area != kEsfMemoryManagerTargetLargeHeap) {
-    return false;
+
+  size_t line_size = (size_t)width * (size_t)jpeg_object->input_components;
+
+  // Lines passed as they are skip the checks of EsfCodecJpegConvertLine().
+  if (direct && ((!file_io && (compress_manager->image == NULL)) ||
+                 (stride < 0) || ((size_t)stride < line_size))) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. image=%p width=%" PRId32
+                     " stride=%" PRId32,
+                     "jpeg_internal.c", __LINE__, compress_manager->image,
+                     width, stride);
+    return kJpegParamError;
   }
 
-  // Check FileIO
-  EsfMemoryManagerMapSupport support = kEsfMemoryManagerMapIsSupport;
-  result = EsfMemoryManagerIsMapSupport(file_handle, &support);
-  if (result != kEsfMemoryManagerResultSuccess) {
-    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to check map support.",
-                     "jpeg_internal.c", __LINE__);
-    return false;
+  // libjpeg compresses max_v_samp_factor * DCTSIZE lines at a time.
+  int32_t strip_height = jpeg_object->max_v_samp_factor * DCTSIZE;
+  if ((strip_height <= 0) || (strip_height > MAX_SAMP_FACTOR * DCTSIZE)) {
+    strip_height = DCTSIZE;
   }
-  if (support == kEsfMemoryManagerMapIsSupport) {
-    return false;
+
+  // Scratch area: the lines read with FileIO, then the converted lines.
+  size_t read_area_size = 0;
+  if (file_io) {
+    int32_t size = CalculateInputBufferSize(stride, strip_height, format);
+    if (size < 0) {
+      return kJpegParamError;
+    }
+    read_area_size = (size_t)size;
+  }
+  size_t convert_area_size = direct ? 0 : line_size * (size_t)strip_height;
+  uint8_t *work = NULL;
+  if ((read_area_size + convert_area_size) > 0) {
+    work = EsfCodecJpegGetScratch(compress_manager,
+                                  read_area_size + convert_area_size);
+    if (work == NULL) {
+      return kJpegMemAllocError;
+    }
   }
 
-  return true;
-}
+  EsfCodecJpegError jpeg_result = kJpegSuccess;
+  JSAMPROW rows[MAX_SAMP_FACTOR * DCTSIZE];
+  for (int32_t line = 0; line < height; line += strip_height) {
+    int32_t lines = height - line;
+    if (lines > strip_height) {
+      lines = strip_height;
+    }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-EsfCodecJpegCompressManager *EsfCodecJpegCreateManager(
-    EsfCodecJpegAccessType access_type) {
-  EsfCodecJpegCompressManager *compress_manager =
-      (EsfCodecJpegCompressManager *)calloc(
-          1, sizeof(EsfCodecJpegCompressManager));
-  struct jpeg_compress_struct *jpeg_object =
-      (struct jpeg_compress_struct *)calloc(
-          1, sizeof(struct jpeg_compress_struct));
-  EsfCodecJpegErrorManager *error_manager =
-      (EsfCodecJpegErrorManager *)calloc(1, sizeof(EsfCodecJpegErrorManager));
-  EsfCodecJpegDestManager *dest_manager =
-      (EsfCodecJpegDestManager *)calloc(1, sizeof(EsfCodecJpegDestManager));
+    // The strip as an image of its own with FileIO, the image itself with
+    // memory access. Either starts at the first column of the region.
+    const uint8_t *image = compress_manager->image;
+    int32_t image_height = compress_manager->image_height;
+    int32_t first_line = compress_manager->region_y +
+                         compress_manager->first_line + line;
+    if (file_io) {
+      jpeg_result = EsfCodecJpegReadStripFileIo(compress_manager, first_line,
+                                                lines, work);
+      if (jpeg_result != kJpegSuccess) {
+        return jpeg_result;
+      }
+      image = work;
+      image_height = lines;
+      first_line = 0;
+    } else {
+      image += EsfCodecJpegColumnOffset(format, compress_manager->region_x);
+    }
 
-  if ((compress_manager == (EsfCodecJpegCompressManager *)NULL) ||
-      (jpeg_object == (struct jpeg_compress_struct *)NULL) ||
-      (error_manager == (EsfCodecJpegErrorManager *)NULL) ||
-      (dest_manager == (EsfCodecJpegDestManager *)NULL)) {
-    WRITE_DLOG_ERROR(
-        MODULE_ID_SYSTEM,
-        "%s-%d:Parameter error. compress_manager=%p jpeg_object=%p "
-        "error_manager=%p "
-        "dest_manager=%p",
-        "jpeg_internal.c", __LINE__, compress_manager, jpeg_object,
-        error_manager, dest_manager);
-    free(compress_manager);
-    free(jpeg_object);
-    free(error_manager);
-    free(dest_manager);
-    return (EsfCodecJpegCompressManager *)NULL;
-  } else {
-    jpeg_object->err = jpeg_std_error(&(error_manager->pub));
-    error_manager->pub.error_exit = EsfCodecJpegErrorExitCallback;
-    compress_manager->jpeg_object = jpeg_object;
-    compress_manager->error_manager = error_manager;
-    compress_manager->dest_manager = dest_manager;
-    compress_manager->access_type = access_type;
-    return compress_manager;
+    for (int32_t i = 0; i < lines; i++) {
+      if (direct) {
+        rows[i] = (JSAMPROW)(uintptr_t)&image[(size_t)(first_line + i) *
+                                              (size_t)stride];
+      } else {
+        rows[i] = &work[read_area_size + (line_size * (size_t)i)];
+        jpeg_result = EsfCodecJpegConvertLine(format, image, width,
+                                              image_height, stride,
+                                              first_line + i, rows[i]);
+        if (jpeg_result != kJpegSuccess) {
+          return jpeg_result;
+        }
+      }
+    }
+    jpeg_write_scanlines(jpeg_object, rows, (JDIMENSION)lines);
+
+    // The thumbnail takes the same lines.
+    if (compress_manager->thumbnail != NULL) {
+      for (int32_t i = 0; i < lines; i++) {
+        jpeg_result =
+            EsfCodecJpegAddScaledLine(compress_manager->thumbnail, rows[i]);
+        if (jpeg_result != kJpegSuccess) {
+          return jpeg_result;
+        }
+      }
+    }
+
+    if (dest->succeed != kJpegSuccess) {
+      return dest->succeed;
+    }
   }
+
+  return kJpegSuccess;
 }
 
-EsfCodecJpegError EsfCodecJpegDestroyManager(
+STATIC void EsfCodecJpegDeinterleaveUv(const uint8_t *u_v, int32_t count,
+                                       JSAMPROW u, JSAMPROW v) {
+  int32_t j = 0;
+#if defined(__SSE2__)
+  const __m128i low = _mm_set1_epi16(0x00FF);
+  for (; j + 16 <= count; j += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)&u_v[j * 2]);
+    __m128i b = _mm_loadu_si128((const __m128i *)&u_v[(j * 2) + 16]);
+    _mm_storeu_si128((__m128i *)&u[j],
+                     _mm_packus_epi16(_mm_and_si128(a, low),
+                                      _mm_and_si128(b, low)));
+    _mm_storeu_si128((__m128i *)&v[j],
+                     _mm_packus_epi16(_mm_srli_epi16(a, 8),
+                                      _mm_srli_epi16(b, 8)));
+  }
+#elif defined(__ARM_NEON)
+  for (; j + 16 <= count; j += 16) {
+    uint8x16x2_t pairs = vld2q_u8(&u_v[j * 2]);
+    vst1q_u8(&u[j], pairs.val[0]);
+    vst1q_u8(&v[j], pairs.val[1]);
+  }
+#endif
+  for (; j < count; j++) {
+    u[j] = u_v[j * 2];
+    v[j] = u_v[(j * 2) + 1];
+  }
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegWriteRawData(
     EsfCodecJpegCompressManager *compress_manager) {
-  if (compress_manager == (EsfCodecJpegCompressManager *)NULL) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegDestManager *dest =
+      (EsfCodecJpegDestManager *)(jpeg_object->dest);
+  bool file_io = (compress_manager->access_type == kEsfCodecJpegFileIoAccess);
+  int32_t width = (int32_t)jpeg_object->image_width;
+  int32_t height = (int32_t)jpeg_object->image_height;
+  int32_t stride = compress_manager->stride;
+  // A U/V pair covers two pixels, also the last one of an odd width.
+  int32_t chroma_width = (width + 1) / 2;
+
+  if ((!file_io && (compress_manager->image == NULL)) ||
+      (stride < chroma_width * 2) || (jpeg_object->num_components != 3)) {
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. compress_manager=%p",
-                     "jpeg_internal.c", __LINE__, compress_manager);
+                     "%s-%d:Parameter error. image=%p width=%" PRId32
+                     " stride=%" PRId32,
+                     "jpeg_internal.c", __LINE__, compress_manager->image,
+                     width, stride);
     return kJpegParamError;
   }
 
-  jpeg_destroy_compress(compress_manager->jpeg_object);
+  // Lines of each component per jpeg_write_raw_data() call, and samples per
+  // line including the padding up to the block boundary.
+  int32_t strip_height = jpeg_object->max_v_samp_factor * DCTSIZE;
+  int32_t chroma_strip_height =
+      jpeg_object->comp_info[1].v_samp_factor * DCTSIZE;
+  size_t y_line_size =
+      (size_t)jpeg_object->comp_info[0].width_in_blocks * DCTSIZE;
+  size_t chroma_line_size =
+      (size_t)jpeg_object->comp_info[1].width_in_blocks * DCTSIZE;
+  if ((strip_height > MAX_SAMP_FACTOR * DCTSIZE) ||
+      (chroma_strip_height * 2 != strip_height) ||
+      (y_line_size < (size_t)width) ||
+      (chroma_line_size < (size_t)chroma_width)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Unexpected sampling. strip_height=%" PRId32,
+                     "jpeg_internal.c", __LINE__, strip_height);
+    return kJpegParamError;
+  }
+  bool y_direct = (y_line_size == (size_t)width);
+
+  // Scratch area: the lines read with FileIO, padded Y lines, U and V lines.
+  size_t read_area_size = 0;
+  if (file_io) {
+    int32_t size = CalculateInputBufferSize(stride, strip_height,
+                                            kJpegInputYuv_8);
+    if (size < 0) {
+      return kJpegParamError;
+    }
+    read_area_size = (size_t)size;
+  }
+  size_t y_area_size = y_direct ? 0 : y_line_size * (size_t)strip_height;
+  size_t chroma_area_size = chroma_line_size * (size_t)chroma_strip_height;
+  uint8_t *work = EsfCodecJpegGetScratch(
+      compress_manager, read_area_size + y_area_size + (chroma_area_size * 2));
+  if (work == NULL) {
+    return kJpegMemAllocError;
+  }
+  uint8_t *y_area = &work[read_area_size];
+  uint8_t *u_area = &y_area[y_area_size];
+  uint8_t *v_area = &u_area[chroma_area_size];
+
+  EsfCodecJpegError jpeg_result = kJpegSuccess;
+  JSAMPROW y_rows[MAX_SAMP_FACTOR * DCTSIZE];
+  JSAMPROW u_rows[MAX_SAMP_FACTOR * DCTSIZE];
+  JSAMPROW v_rows[MAX_SAMP_FACTOR * DCTSIZE];
+  JSAMPARRAY planes[3] = {y_rows, u_rows, v_rows};
+  for (int32_t line = 0; line < height; line += strip_height) {
+    int32_t lines = height - line;
+    if (lines > strip_height) {
+      lines = strip_height;
+    }
+
+    // The strip as an image of its own with FileIO, the image itself with
+    // memory access. Either starts at the first column of the region.
+    const uint8_t *image = compress_manager->image;
+    int32_t image_height = compress_manager->image_height;
+    int32_t first_line = compress_manager->region_y +
+                         compress_manager->first_line + line;
+    if (file_io) {
+      jpeg_result = EsfCodecJpegReadStripFileIo(compress_manager, first_line,
+                                                lines, work);
+      if (jpeg_result != kJpegSuccess) {
+        return jpeg_result;
+      }
+      image = work;
+      image_height = lines;
+      first_line = 0;
+    } else {
+      image += compress_manager->region_x;
+    }
+
+    for (int32_t i = 0; i < strip_height; i++) {
+      if (i >= lines) {
+        y_rows[i] = y_rows[lines - 1];
+        continue;
+      }
+      const uint8_t *y = &image[(size_t)(first_line + i) * (size_t)stride];
+      if (y_direct) {
+        y_rows[i] = (JSAMPROW)(uintptr_t)y;
+      } else {
+        y_rows[i] = &y_area[y_line_size * (size_t)i];
+        memcpy(y_rows[i], y, (size_t)width);
+        memset(&y_rows[i][width], y[width - 1], y_line_size - (size_t)width);
+      }
+    }
+
+    const uint8_t *u_v_plane =
+        &image[((size_t)stride * (size_t)image_height) +
+               ((size_t)(first_line / 2) * (size_t)stride)];
+    int32_t chroma_lines = (lines + 1) / 2;
+    for (int32_t i = 0; i < chroma_strip_height; i++) {
+      if (i >= chroma_lines) {
+        u_rows[i] = u_rows[chroma_lines - 1];
+        v_rows[i] = v_rows[chroma_lines - 1];
+        continue;
+      }
+      u_rows[i] = &u_area[chroma_line_size * (size_t)i];
+      v_rows[i] = &v_area[chroma_line_size * (size_t)i];
+      EsfCodecJpegDeinterleaveUv(&u_v_plane[(size_t)i * (size_t)stride],
+                                 chroma_width, u_rows[i], v_rows[i]);
+      size_t padding = chroma_line_size - (size_t)chroma_width;
+      memset(&u_rows[i][chroma_width], u_rows[i][chroma_width - 1], padding);
+      memset(&v_rows[i][chroma_width], v_rows[i][chroma_width - 1], padding);
+    }
+
+    jpeg_write_raw_data(jpeg_object, planes, (JDIMENSION)strip_height);
+
+    // The thumbnail takes the lines converted to packed YCbCr.
+    EsfCodecJpegCompressManager *thumbnail = compress_manager->thumbnail;
+    if (thumbnail != NULL) {
+      for (int32_t i = 0; i < lines; i++) {
+        jpeg_result = EsfCodecJpegConvertLine(
+            kJpegInputYuv_8, image, width, image_height, stride,
+            first_line + i, thumbnail->scaler.converted);
+        if (jpeg_result != kJpegSuccess) {
+          return jpeg_result;
+        }
+        jpeg_result =
+            EsfCodecJpegAddScaledLine(thumbnail, thumbnail->scaler.converted);
+        if (jpeg_result != kJpegSuccess) {
+          return jpeg_result;
+        }
+      }
+    }
+
+    if (dest->succeed != kJpegSuccess) {
+      return dest->succeed;
+    }
+  }
+
+  return kJpegSuccess;
+}
+
+STATIC int32_t EsfCodecJpegScaledLineStart(
+    const EsfCodecJpegCompressManager *compress_manager, int32_t line) {
+  int64_t output_line = (int64_t)compress_manager->first_line + line;
+  return compress_manager->region_y +
+         (int32_t)((output_line * compress_manager->region_height) /
+                   compress_manager->output_height);
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegStartScaledLines(
+    EsfCodecJpegCompressManager *compress_manager, size_t extra_size,
+    uint8_t **extra) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegScaler *scaler = &compress_manager->scaler;
+  int32_t components = jpeg_object->input_components;
+  int32_t width = compress_manager->region_width;
+  int32_t output_width = (int32_t)jpeg_object->image_width;
+  int32_t output_height = compress_manager->output_height;
+
+  if ((output_width <= 0) || (output_height <= 0) ||
+      (output_width > width) ||
+      (output_height > compress_manager->region_height)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. width=%" PRId32
+                     " height=%" PRId32 " output_width=%" PRId32
+                     " output_height=%" PRId32,
+                     "jpeg_internal.c", __LINE__, width,
+                     compress_manager->region_height, output_width,
+                     output_height);
+    return kJpegParamError;
+  }
+
+  int32_t strip_height = jpeg_object->max_v_samp_factor * DCTSIZE;
+  if ((strip_height <= 0) || (strip_height > MAX_SAMP_FACTOR * DCTSIZE)) {
+    strip_height = DCTSIZE;
+  }
+
+  // Scratch area: the sums of the output line, the columns, the output strip,
+  // the converted line, then the area of the caller.
+  size_t output_line_size = (size_t)output_width * (size_t)components;
+  size_t sums_size = output_line_size * sizeof(uint32_t);
+  size_t columns_size = (size_t)(output_width + 1) * sizeof(int32_t);
+  size_t strip_size = output_line_size * (size_t)strip_height;
+  size_t converted_size = (size_t)width * (size_t)components;
+  uint8_t *work = EsfCodecJpegGetScratch(
+      compress_manager, sums_size + columns_size + strip_size +
+                            converted_size + extra_size);
+  if (work == NULL) {
+    return kJpegMemAllocError;
+  }
+  scaler->sums = (uint32_t *)(uintptr_t)work;
+  scaler->columns = (int32_t *)(uintptr_t)&work[sums_size];
+  scaler->strip = &work[sums_size + columns_size];
+  scaler->converted = &scaler->strip[strip_size];
+  if (extra != NULL) {
+    *extra = &scaler->converted[converted_size];
+  }
+
+  for (int32_t x = 0; x <= output_width; x++) {
+    scaler->columns[x] = (int32_t)(((int64_t)x * width) / output_width);
+  }
+  memset(scaler->sums, 0, sums_size);
+  scaler->strip_height = strip_height;
+  scaler->strip_lines = 0;
+  scaler->line = 0;
+  scaler->box_first = EsfCodecJpegScaledLineStart(compress_manager, 0);
+  scaler->box_end = EsfCodecJpegScaledLineStart(compress_manager, 1);
+  scaler->input_line = scaler->box_first;
+
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegAddScaledLine(
+    EsfCodecJpegCompressManager *compress_manager, const JSAMPLE *source) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegScaler *scaler = &compress_manager->scaler;
+  int32_t components = jpeg_object->input_components;
+  int32_t output_width = (int32_t)jpeg_object->image_width;
+  int32_t height = (int32_t)jpeg_object->image_height;
+
+  if (scaler->line >= height) {
+    return kJpegSuccess;
+  }
+
+  uint32_t *sum = scaler->sums;
+  for (int32_t x = 0; x < output_width; x++) {
+    for (int32_t c = 0; c < components; c++) {
+      uint32_t value = 0;
+      for (int32_t j = scaler->columns[x]; j < scaler->columns[x + 1]; j++) {
+        value += source[(j * components) + c];
+      }
+      sum[c] += value;
+    }
+    sum += components;
+  }
+
+  scaler->input_line++;
+  if (scaler->input_line < scaler->box_end) {
+    return kJpegSuccess;
+  }
+
+  // The box is complete; the output line is its rounded average.
+  size_t output_line_size = (size_t)output_width * (size_t)components;
+  JSAMPROW row = &scaler->strip[output_line_size * (size_t)scaler->strip_lines];
+  uint32_t box_height = (uint32_t)(scaler->box_end - scaler->box_first);
+  for (int32_t x = 0; x < output_width; x++) {
+    uint32_t area = box_height * (uint32_t)(scaler->columns[x + 1] -
+                                            scaler->columns[x]);
+    for (int32_t c = 0; c < components; c++) {
+      size_t index = ((size_t)x * (size_t)components) + (size_t)c;
+      row[index] = (JSAMPLE)((scaler->sums[index] + (area / 2)) / area);
+    }
+  }
+  memset(scaler->sums, 0, output_line_size * sizeof(uint32_t));
+  scaler->strip_lines++;
+  scaler->line++;
+  scaler->box_first = scaler->box_end;
+  scaler->box_end = EsfCodecJpegScaledLineStart(compress_manager,
+                                                scaler->line + 1);
+
+  if ((scaler->strip_lines == scaler->strip_height) ||
+      (scaler->line == height)) {
+    JSAMPROW rows[MAX_SAMP_FACTOR * DCTSIZE];
+    for (int32_t i = 0; i < scaler->strip_lines; i++) {
+      rows[i] = &scaler->strip[output_line_size * (size_t)i];
+    }
+    jpeg_write_scanlines(jpeg_object, rows, (JDIMENSION)scaler->strip_lines);
+    scaler->strip_lines = 0;
+
+    EsfCodecJpegDestManager *dest =
+        (EsfCodecJpegDestManager *)(jpeg_object->dest);
+    if (dest->succeed != kJpegSuccess) {
+      return dest->succeed;
+    }
+  }
+
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegWriteScaledStrips(
+    EsfCodecJpegCompressManager *compress_manager) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegInputFormat format = compress_manager->format;
+  bool file_io = (compress_manager->access_type == kEsfCodecJpegFileIoAccess);
+  bool direct = EsfCodecJpegIsDirectInput(format);
+  int32_t width = compress_manager->region_width;
+  int32_t stride = compress_manager->stride;
+
+  size_t line_size = (size_t)width * (size_t)jpeg_object->input_components;
+
+  // Lines passed as they are skip the checks of EsfCodecJpegConvertLine().
+  if (direct && ((!file_io && (compress_manager->image == NULL)) ||
+                 (stride < 0) || ((size_t)stride < line_size))) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. image=%p width=%" PRId32
+                     " stride=%" PRId32,
+                     "jpeg_internal.c", __LINE__, compress_manager->image,
+                     width, stride);
+    return kJpegParamError;
+  }
+
+  // Input lines read at a time, plus the line an NV12 read starts early so
+  // that it is on a line of the UV plane.
+  int32_t strip_height = MAX_SAMP_FACTOR * DCTSIZE;
+  size_t read_area_size = 0;
+  if (file_io) {
+    int32_t size = CalculateInputBufferSize(stride, strip_height + 1, format);
+    if (size < 0) {
+      return kJpegParamError;
+    }
+    read_area_size = (size_t)size;
+  }
+  uint8_t *read_area = NULL;
+  EsfCodecJpegError jpeg_result = EsfCodecJpegStartScaledLines(
+      compress_manager, read_area_size, &read_area);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+
+  int32_t begin = compress_manager->scaler.box_first;
+  int32_t end = EsfCodecJpegScaledLineStart(
+      compress_manager, (int32_t)jpeg_object->image_height);
+  for (int32_t line = begin; line < end; line += strip_height) {
+    int32_t lines = end - line;
+    if (lines > strip_height) {
+      lines = strip_height;
+    }
+
+    // The strip as an image of its own with FileIO, the image itself with
+    // memory access. Either starts at the first column of the region.
+    const uint8_t *image = compress_manager->image;
+    int32_t image_height = compress_manager->image_height;
+    int32_t first_line = line;
+    if (file_io) {
+      int32_t read_line = line;
+      if (format == kJpegInputYuv_8) {
+        read_line &= ~1;
+      }
+      jpeg_result = EsfCodecJpegReadStripFileIo(
+          compress_manager, read_line, line + lines - read_line, read_area);
+      if (jpeg_result != kJpegSuccess) {
+        return jpeg_result;
+      }
+      image = read_area;
+      image_height = line + lines - read_line;
+      first_line = line - read_line;
+    } else {
+      image += EsfCodecJpegColumnOffset(format, compress_manager->region_x);
+    }
+
+    for (int32_t i = 0; i < lines; i++) {
+      const JSAMPLE *source = NULL;
+      if (direct) {
+        source = &image[(size_t)(first_line + i) * (size_t)stride];
+      } else {
+        source = compress_manager->scaler.converted;
+        jpeg_result = EsfCodecJpegConvertLine(
+            format, image, width, image_height, stride, first_line + i,
+            compress_manager->scaler.converted);
+        if (jpeg_result != kJpegSuccess) {
+          return jpeg_result;
+        }
+      }
+      jpeg_result = EsfCodecJpegAddScaledLine(compress_manager, source);
+      if (jpeg_result != kJpegSuccess) {
+        return jpeg_result;
+      }
+    }
+  }
+
+  return kJpegSuccess;
+}
+
+STATIC uint8_t *EsfCodecJpegGetScratch(
+    EsfCodecJpegCompressManager *compress_manager, size_t size) {
+  if (compress_manager->scratch_size < size) {
+    free(compress_manager->scratch);
+    compress_manager->scratch = (uint8_t *)malloc(size);
+    if (compress_manager->scratch == NULL) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:Failed to malloc scratch area. size=%zu",
+                       "jpeg_internal.c", __LINE__, size);
+      compress_manager->scratch_size = 0;
+      return NULL;
+    }
+    compress_manager->scratch_size = size;
+  }
+
+  return compress_manager->scratch;
+}
+
+STATIC bool EsfCodecJpegIsFileHandle(EsfMemoryManagerHandle file_handle) {
+  // Check Large Heap
+  EsfMemoryManagerHandleInfo info = {0};
+  EsfMemoryManagerResult result = EsfMemoryManagerGetHandleInfo(file_handle,
+                                                                &info);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to get handle info.",
+                     "jpeg_internal.c", __LINE__);
+    return false;
+  }
+  if (info.target_area != kEsfMemoryManagerTargetLargeHeap) {
+    return false;
+  }
+
+  // Check FileIO
+  EsfMemoryManagerMapSupport support = kEsfMemoryManagerMapIsSupport;
+  result = EsfMemoryManagerIsMapSupport(file_handle, &support);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to check map support.",
+                     "jpeg_internal.c", __LINE__);
+    return false;
+  }
+  if (support == kEsfMemoryManagerMapIsSupport) {
+    return false;
+  }
+
+  return true;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+EsfCodecJpegCompressManager *EsfCodecJpegCreateManager(
+    EsfCodecJpegAccessType access_type) {
+  EsfCodecJpegCompressManager *compress_manager =
+      (EsfCodecJpegCompressManager *)calloc(
+          1, sizeof(EsfCodecJpegCompressManager));
+  struct jpeg_compress_struct *jpeg_object =
+      (struct jpeg_compress_struct *)calloc(
+          1, sizeof(struct jpeg_compress_struct));
+  EsfCodecJpegErrorManager *error_manager =
+      (EsfCodecJpegErrorManager *)calloc(1, sizeof(EsfCodecJpegErrorManager));
+  EsfCodecJpegDestManager *dest_manager =
+      (EsfCodecJpegDestManager *)calloc(1, sizeof(EsfCodecJpegDestManager));
+
+  if ((compress_manager == (EsfCodecJpegCompressManager *)NULL) ||
+      (jpeg_object == (struct jpeg_compress_struct *)NULL) ||
+      (error_manager == (EsfCodecJpegErrorManager *)NULL) ||
+      (dest_manager == (EsfCodecJpegDestManager *)NULL)) {
+    WRITE_DLOG_ERROR(
+        MODULE_ID_SYSTEM,
+        "%s-%d:Parameter error. compress_manager=%p jpeg_object=%p "
+        "error_manager=%p "
+        "dest_manager=%p",
+        "jpeg_internal.c", __LINE__, compress_manager, jpeg_object,
+        error_manager, dest_manager);
+    free(compress_manager);
+    free(jpeg_object);
+    free(error_manager);
+    free(dest_manager);
+    return (EsfCodecJpegCompressManager *)NULL;
+  } else {
+    jpeg_object->err = jpeg_std_error(&(error_manager->pub));
+    error_manager->pub.error_exit = EsfCodecJpegErrorExitCallback;
+    compress_manager->jpeg_object = jpeg_object;
+    compress_manager->error_manager = error_manager;
+    compress_manager->dest_manager = dest_manager;
+    compress_manager->access_type = access_type;
+    return compress_manager;
+  }
+}
+
+EsfCodecJpegError EsfCodecJpegDestroyManager(
+    EsfCodecJpegCompressManager *compress_manager) {
+  if (compress_manager == (EsfCodecJpegCompressManager *)NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. compress_manager=%p",
+                     "jpeg_internal.c", __LINE__, compress_manager);
+    return kJpegParamError;
+  }
+
+  jpeg_destroy_compress(compress_manager->jpeg_object);
   free(compress_manager->jpeg_object);
   compress_manager->jpeg_object = (struct jpeg_compress_struct *)NULL;
 
@@ -1260,6 +2221,9 @@ EsfCodecJpegError EsfCodecJpegDestroyManager(
   free(compress_manager->error_manager);
   compress_manager->error_manager = (EsfCodecJpegErrorManager *)NULL;
 
+  free(compress_manager->scratch);
+  compress_manager->scratch = (uint8_t *)NULL;
+
   free(compress_manager);
 
   return kJpegSuccess;
@@ -1307,8 +2271,16 @@ EsfCodecJpegError EsfCodecJpegSetParam(
 
   jpeg_set_defaults(compress_manager->jpeg_object);
 
-  compress_manager->jpeg_object->image_width = enc_param->width;
-  compress_manager->jpeg_object->image_height = enc_param->height;
+  EsfCodecJpegRegion region = {0};
+  int32_t output_width = 0;
+  int32_t output_height = 0;
+  EsfCodecJpegGetRegion(enc_param, &region, &output_width, &output_height);
+  // A scaled image may keep its size when it is small, but is still passed
+  // through the scaler; see EsfCodecJpegAddScaledLine().
+  bool scaled = (enc_param->scale_numerator != enc_param->scale_denominator);
+
+  compress_manager->jpeg_object->image_width = (JDIMENSION)output_width;
+  compress_manager->jpeg_object->image_height = (JDIMENSION)output_height;
   compress_manager->jpeg_object->input_components =
       (enc_param->input_fmt == kJpegInputGray_8) ? 1 : 3;
   compress_manager->jpeg_object->dct_method = JDCT_IFAST;
@@ -1320,6 +2292,19 @@ EsfCodecJpegError EsfCodecJpegSetParam(
    */
   compress_manager->jpeg_object->do_fancy_downsampling = (boolean) false;
 #endif
+  if ((enc_param->input_fmt == kJpegInputYuv_8) && !scaled) {
+    // NV12 is YCbCr 4:2:0 already; hand its planes to the DCT stage as they
+    // are with EsfCodecJpegWriteRawData(). Scaled lines are converted to
+    // packed YCbCr instead.
+    struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+    jpeg_object->raw_data_in = (boolean) true;
+    jpeg_object->comp_info[0].h_samp_factor = 2;
+    jpeg_object->comp_info[0].v_samp_factor = 2;
+    jpeg_object->comp_info[1].h_samp_factor = 1;
+    jpeg_object->comp_info[1].v_samp_factor = 1;
+    jpeg_object->comp_info[2].h_samp_factor = 1;
+    jpeg_object->comp_info[2].v_samp_factor = 1;
+  }
   compress_manager->jpeg_object->dest =
       (struct jpeg_destination_mgr *)(compress_manager->dest_manager);
 
@@ -1329,6 +2314,13 @@ EsfCodecJpegError EsfCodecJpegSetParam(
   compress_manager->image = (uint8_t *)(uintptr_t)enc_param->input_adr_handle;
   compress_manager->format = enc_param->input_fmt;
   compress_manager->stride = enc_param->stride;
+  compress_manager->image_height = enc_param->height;
+  compress_manager->region_x = region.x;
+  compress_manager->region_y = region.y;
+  compress_manager->region_width = region.width;
+  compress_manager->region_height = region.height;
+  compress_manager->output_height = output_height;
+  compress_manager->first_line = 0;
 
   return kJpegSuccess;
 }
@@ -1357,6 +2349,7 @@ EsfCodecJpegError EsfCodecJpegSetDestManager(
   compress_manager->dest_manager->tmp_output_buffer_size = 0;
   compress_manager->dest_manager->jpeg_size = 0;
   compress_manager->dest_manager->jpeg_size_max = size;
+  compress_manager->dest_manager->base64 = false;
 
   return kJpegSuccess;
 }
@@ -1384,6 +2377,7 @@ EsfCodecJpegError EsfCodecJpegSetDestManagerFileIo(
   compress_manager->dest_manager->tmp_output_buffer = buffer;
   compress_manager->dest_manager->tmp_output_buffer_size = size;
   compress_manager->dest_manager->jpeg_size = 0;
+  compress_manager->dest_manager->base64 = false;
 
   {
     EsfMemoryManagerHandleInfo info = {0};
@@ -1400,6 +2394,40 @@ EsfCodecJpegError EsfCodecJpegSetDestManagerFileIo(
   return kJpegSuccess;
 }
 
+EsfCodecJpegError EsfCodecJpegSetDestManagerBase64(
+    uint8_t *buffer, size_t size, char *base64_output,
+    size_t base64_output_size, EsfMemoryManagerHandle output_file_handle,
+    size_t output_size_max, EsfCodecJpegCompressManager *compress_manager) {
+  if ((buffer == NULL) || (base64_output == NULL) ||
+      (compress_manager == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. buffer=%p base64_output=%p "
+                     "compress_manager=%p",
+                     "jpeg_internal.c", __LINE__, buffer, base64_output,
+                     compress_manager);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegDestManager *dest = compress_manager->dest_manager;
+  dest->pub.init_destination = EsfCodecJpegTermDestinationCallback;
+  dest->pub.empty_output_buffer = EsfCodecJpegEmptyOutputBufferCallbackBase64;
+  dest->pub.term_destination = EsfCodecJpegTermDestinationCallbackBase64;
+  dest->pub.next_output_byte = (JOCTET *)buffer;
+  dest->pub.free_in_buffer = size;
+  dest->succeed = kJpegSuccess;
+  dest->output_file_handle = output_file_handle;
+  dest->tmp_output_buffer = buffer;
+  dest->tmp_output_buffer_size = size;
+  dest->jpeg_size = 0;
+  dest->jpeg_size_max = output_size_max;
+  dest->base64 = true;
+  (void)EsfCodecBase64EncodeInit(&dest->base64_context);
+  dest->base64_output = base64_output;
+  dest->base64_output_size = base64_output_size;
+
+  return kJpegSuccess;
+}
+
 EsfCodecJpegError EsfCodecJpegCompressImage(
     int32_t *output_size, EsfCodecJpegCompressManager *compress_manager) {
   if ((output_size == (int32_t *)NULL) ||
@@ -1418,45 +2446,23 @@ EsfCodecJpegError EsfCodecJpegCompressImage(
 
   jpeg_start_compress(jpeg_object, (boolean) true);
 
-  while (jpeg_object->next_scanline < jpeg_object->image_height) {
-    EsfCodecJpegError result = kJpegSuccess;
-    JSAMPROW scan_line = NULL;
-    if (compress_manager->access_type == kEsfCodecJpegMemoryAccess) {
-      scan_line = EsfCodecJpegConvertLine(
-          compress_manager->format, compress_manager->image,
-          jpeg_object->image_width, jpeg_object->image_height,
-          compress_manager->stride, jpeg_object->next_scanline, &result);
-    } else {
-      scan_line = EsfCodecJpegConvertLineFileIo(
-          compress_manager->format, compress_manager->input_file_handle,
-          jpeg_object->image_width, jpeg_object->image_height,
-          compress_manager->stride, jpeg_object->next_scanline, &result);
-    }
-    if (result != kJpegSuccess) {
-      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                       "%s-%d:Failed to covert line. result=%d",
-                       "jpeg_internal.c", __LINE__, result);
-      free(scan_line);
-      return result;
-    }
+  EsfCodecJpegError result = jpeg_object->raw_data_in
+                                 ? EsfCodecJpegWriteRawData(compress_manager)
+                                 : EsfCodecJpegWriteStrips(compress_manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during encoding. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    jpeg_abort((j_common_ptr)jpeg_object);
+    UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
+    return result;
+  }
 
-    ((EsfCodecJpegErrorManager *)(jpeg_object->err))->scan_line_ptr = scan_line;
-    JSAMPROW array[1] = {scan_line};
-    jpeg_write_scanlines(jpeg_object, array, 1);
-    free(scan_line);
-    ((EsfCodecJpegErrorManager *)(jpeg_object->err))->scan_line_ptr =
-        (JSAMPROW)NULL;
+  return EsfCodecJpegFinishImage(compress_manager, output_size);
+}
 
-    if (((EsfCodecJpegDestManager *)(jpeg_object->dest))->succeed !=
-        kJpegSuccess) {
-      WRITE_DLOG_ERROR(
-          MODULE_ID_SYSTEM, "%s-%d:Error during encoding. succeed=%d",
-          "jpeg_internal.c", __LINE__,
-          ((EsfCodecJpegDestManager *)(jpeg_object->dest))->succeed);
-      jpeg_abort((j_common_ptr)jpeg_object);
-      return ((EsfCodecJpegDestManager *)(jpeg_object->dest))->succeed;
-    }
-  }
+STATIC EsfCodecJpegError EsfCodecJpegFinishImage(
+    EsfCodecJpegCompressManager *compress_manager, int32_t *output_size) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
 
   jpeg_finish_compress(jpeg_object);
 
@@ -1466,20 +2472,60 @@ EsfCodecJpegError EsfCodecJpegCompressImage(
                      "%s-%d:Error during encoding. succeed=%d",
                      "jpeg_internal.c", __LINE__,
                      ((EsfCodecJpegDestManager *)(jpeg_object->dest))->succeed);
+    UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
     return ((EsfCodecJpegDestManager *)(jpeg_object->dest))->succeed;
   }
 
-  if (compress_manager->access_type == kEsfCodecJpegMemoryAccess) {
-    *output_size =
-        ((EsfCodecJpegDestManager *)(jpeg_object->dest))->jpeg_size_max -
-        jpeg_object->dest->free_in_buffer;
+  // A destination that writes straight into memory does not count jpeg_size,
+  // whatever the input access is.
+  EsfCodecJpegDestManager *dest =
+      (EsfCodecJpegDestManager *)(jpeg_object->dest);
+  if ((dest->output_file_handle == 0) && !dest->base64) {
+    *output_size = dest->jpeg_size_max - jpeg_object->dest->free_in_buffer;
   } else {
-    *output_size = ((EsfCodecJpegDestManager *)(jpeg_object->dest))->jpeg_size;
+    *output_size = dest->jpeg_size;
   }
 
+  UTILITY_COUNTER_INC(s_jpeg_encode_counter);
+  UTILITY_HISTOGRAM_OBSERVE(s_jpeg_output_size_counter, (uint64_t)*output_size);
   return kJpegSuccess;
 }
 
+STATIC EsfCodecJpegError EsfCodecJpegCompressImages(
+    EsfCodecJpegCompressManager *compress_manager,
+    EsfCodecJpegCompressManager *thumbnail, int32_t *output_size,
+    int32_t *thumbnail_size) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+
+  jpeg_start_compress(jpeg_object, (boolean) true);
+  jpeg_start_compress(thumbnail->jpeg_object, (boolean) true);
+
+  EsfCodecJpegError result = EsfCodecJpegStartScaledLines(thumbnail, 0, NULL);
+  if (result == kJpegSuccess) {
+    compress_manager->thumbnail = thumbnail;
+    result = jpeg_object->raw_data_in
+                 ? EsfCodecJpegWriteRawData(compress_manager)
+                 : EsfCodecJpegWriteStrips(compress_manager);
+    compress_manager->thumbnail = NULL;
+  }
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during encoding. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    jpeg_abort((j_common_ptr)jpeg_object);
+    jpeg_abort((j_common_ptr)thumbnail->jpeg_object);
+    UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
+    return result;
+  }
+
+  result = EsfCodecJpegFinishImage(compress_manager, output_size);
+  if (result != kJpegSuccess) {
+    jpeg_abort((j_common_ptr)thumbnail->jpeg_object);
+    return result;
+  }
+
+  return EsfCodecJpegFinishImage(thumbnail, thumbnail_size);
+}
+
 bool EsfCodecJpegIsFileHandleOpen(EsfMemoryManagerHandle file_handle) {
   if (!EsfCodecJpegIsFileHandle(file_handle)) {
     return false;
@@ -1703,28 +2749,1639 @@ EsfCodecJpegError EsfCodecJpegEncodeHandleFileIo(
   return jpeg_result;
 }
 
-STATIC int32_t CalculateInputBufferSize(int32_t stride, int32_t height,
-                                 EsfCodecJpegInputFormat input_fmt) {
-  if (stride < (int32_t)0 || height <= (int32_t)0) {
+EsfCodecJpegError EsfCodecJpegEncodeHandleBase64(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    const EsfCodecJpegInfo *info, int32_t *base64_size) {
+  if ((input_handle == (EsfMemoryManagerHandle)0) ||
+      (output_handle == (EsfMemoryManagerHandle)0) || (info == NULL) ||
+      (base64_size == NULL)) {
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                     "%s-%d:Parameter error. stride=%" PRId32 " height=%" PRId32,
-                     "jpeg_internal.c", __LINE__, stride, height);
-    return -1;
+                     "%s-%d:Parameter error. input_handle=%" PRIu32
+                     " output_handle=%" PRIu32 " info=%p base64_size=%p",
+                     "jpeg_internal.c", __LINE__, input_handle, output_handle,
+                     info, base64_size);
+    return kJpegParamError;
   }
 
-  switch (input_fmt) {
-    case kJpegInputRgbPlanar_8:
-      return (stride * height * 3);
-    case kJpegInputRgbPacked_8:
-    case kJpegInputBgrPacked_8:
-    case kJpegInputGray_8:
-      return (stride * height);
-    case kJpegInputYuv_8:
-      return ((stride * height) + (stride * height) / 2);
-    default:
-      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                       "%s-%d:Parameter error. input_fmt=%d", "jpeg_internal.c",
-                       __LINE__, input_fmt);
-      return -1;
+  EsfMemoryManagerMapSupport in_support = kEsfMemoryManagerMapIsSupport;
+  int32_t in_area_size = 0;
+  EsfCodecJpegError jpeg_result =
+      EsfCodecJpegGetHandleArea(input_handle, &in_support, &in_area_size);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
   }
+
+  EsfMemoryManagerMapSupport out_support = kEsfMemoryManagerMapIsSupport;
+  int32_t out_area_size = 0;
+  jpeg_result =
+      EsfCodecJpegGetHandleArea(output_handle, &out_support, &out_area_size);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+
+  EsfCodecJpegEncParam enc_param = {.input_fmt = info->input_fmt,
+                                    .width = info->width,
+                                    .height = info->height,
+                                    .stride = info->stride,
+                                    .quality = info->quality};
+  int32_t input_buf_size = CalculateInputBufferSize(
+      enc_param.stride, enc_param.height, enc_param.input_fmt);
+  if (input_buf_size < 0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:CalculateInputBufferSize failed. "
+                     "input_buf_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, input_buf_size);
+    return kJpegParamError;
+  }
+
+  // One block of JPEG data, followed by its Base64 characters when they have
+  // to be written with FileIO.
+  size_t work_size = CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE;
+  if (out_support != kEsfMemoryManagerMapIsSupport) {
+    work_size += ESF_CODEC_JPEG_BASE64_BLOCK_SIZE;
+  }
+  uint8_t *work = (uint8_t *)malloc(work_size);
+  if (work == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to malloc work area.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegMemAllocError;
+  }
+
+  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
+  uint8_t *input_data = NULL;
+  EsfMemoryManagerHandle input_file_handle = 0;
+  if (in_support == kEsfMemoryManagerMapIsSupport) {
+    memory_manager_result = EsfMemoryManagerMap(
+        input_handle, NULL, input_buf_size, (void **)&input_data);
+    enc_param.input_adr_handle = (uint64_t)(uintptr_t)input_data;
+  } else {
+    memory_manager_result = EsfMemoryManagerFopen(input_handle);
+    input_file_handle = input_handle;
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to open input. memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, memory_manager_result);
+    free(work);
+    return kJpegOtherError;
+  }
+
+  char *output_data = NULL;
+  char *base64_output = NULL;
+  size_t base64_output_size = 0;
+  EsfMemoryManagerHandle output_file_handle = 0;
+  if (out_support == kEsfMemoryManagerMapIsSupport) {
+    memory_manager_result = EsfMemoryManagerMap(
+        output_handle, NULL, out_area_size, (void **)&output_data);
+    base64_output = output_data;
+    base64_output_size = (size_t)out_area_size;
+  } else {
+    memory_manager_result = EsfMemoryManagerFopen(output_handle);
+    output_file_handle = output_handle;
+    base64_output =
+        (char *)(work + CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE);
+    base64_output_size = ESF_CODEC_JPEG_BASE64_BLOCK_SIZE;
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to open output. memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, memory_manager_result);
+    jpeg_result = kJpegOtherError;
+    goto close_input;
+  }
+  enc_param.out_buf.output_adr_handle = (uint64_t)(uintptr_t)base64_output;
+  enc_param.out_buf.output_buf_size = out_area_size;
+
+  jpeg_result = EsfCodecJpegEncodeBase64(
+      &enc_param, input_file_handle, work, base64_output, base64_output_size,
+      output_file_handle, (size_t)out_area_size, base64_size);
+  if (jpeg_result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfCodecJpegEncodeBase64 failed. jpeg_result=%d",
+                     "jpeg_internal.c", __LINE__, jpeg_result);
+  }
+
+  if (output_file_handle != 0) {
+    memory_manager_result = EsfMemoryManagerFclose(output_handle);
+  } else {
+    memory_manager_result = EsfMemoryManagerUnmap(output_handle,
+                                                  (void **)&output_data);
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to close output. memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, memory_manager_result);
+    if (jpeg_result == kJpegSuccess) {
+      jpeg_result = kJpegOtherError;
+    }
+  }
+
+close_input:
+  if (input_file_handle != 0) {
+    memory_manager_result = EsfMemoryManagerFclose(input_handle);
+  } else {
+    memory_manager_result = EsfMemoryManagerUnmap(input_handle,
+                                                  (void **)&input_data);
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to close input. memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, memory_manager_result);
+    if (jpeg_result == kJpegSuccess) {
+      jpeg_result = kJpegOtherError;
+    }
+  }
+
+  free(work);
+  return jpeg_result;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegEncodeBase64(
+    const EsfCodecJpegEncParam *enc_param,
+    EsfMemoryManagerHandle input_file_handle, uint8_t *buffer,
+    char *base64_output, size_t base64_output_size,
+    EsfMemoryManagerHandle output_file_handle, size_t output_size_max,
+    int32_t *base64_size) {
+  EsfCodecJpegCompressManager *manager = EsfCodecJpegCreateManager(
+      (input_file_handle != 0) ? kEsfCodecJpegFileIoAccess
+                               : kEsfCodecJpegMemoryAccess);
+  if (manager == (EsfCodecJpegCompressManager *)NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to create jpeg manager.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegMemAllocError;
+  }
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during jpeg encoding.",
+                     "jpeg_internal.c", __LINE__);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return kJpegOssInternalError;
+  }
+
+  EsfCodecJpegError result = EsfCodecJpegSetParam(enc_param, manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set jpeg parameter. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return result;
+  }
+  manager->input_file_handle = input_file_handle;
+
+  result = EsfCodecJpegSetDestManagerBase64(
+      buffer, CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE,
+      base64_output, base64_output_size, output_file_handle, output_size_max,
+      manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set dest manager. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return result;
+  }
+
+  int32_t tmp_size = 0;
+  result = EsfCodecJpegCompressImage(&tmp_size, manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to compress image. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return result;
+  }
+
+  result = EsfCodecJpegDestroyManager(manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to destroy jpeg manager.",
+                     "jpeg_internal.c", __LINE__);
+    return result;
+  }
+
+  *base64_size = tmp_size;
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegGetHandleArea(
+    EsfMemoryManagerHandle handle, EsfMemoryManagerMapSupport *support,
+    int32_t *allocate_size) {
+  EsfMemoryManagerResult result = EsfMemoryManagerIsMapSupport(handle,
+                                                               support);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfMemoryManagerIsMapSupport func failed. "
+                     "memory_manager_result=%d handle=%" PRIu32,
+                     "jpeg_internal.c", __LINE__, result, handle);
+    return kJpegOtherError;
+  }
+
+  EsfMemoryManagerHandleInfo info = {kEsfMemoryManagerTargetLargeHeap, 0};
+  result = EsfMemoryManagerGetHandleInfo(handle, &info);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfMemoryManagerGetHandleInfo failed. "
+                     "memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    return kJpegOtherError;
+  }
+
+  if ((*support == kEsfMemoryManagerMapIsSupport)
+          ? (info.target_area == kEsfMemoryManagerTargetOtherHeap)
+          : (info.target_area != kEsfMemoryManagerTargetLargeHeap)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Invalid handle target area. target_area=%d",
+                     "jpeg_internal.c", __LINE__, info.target_area);
+    return kJpegParamError;
+  }
+
+  *allocate_size = info.allocate_size;
+  return kJpegSuccess;
+}
+
+STATIC int32_t CalculateInputBufferSize(int32_t stride, int32_t height,
+                                 EsfCodecJpegInputFormat input_fmt) {
+  if (stride < (int32_t)0 || height <= (int32_t)0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. stride=%" PRId32 " height=%" PRId32,
+                     "jpeg_internal.c", __LINE__, stride, height);
+    return -1;
+  }
+
+  switch (input_fmt) {
+    case kJpegInputRgbPlanar_8:
+      return (stride * height * 3);
+    case kJpegInputRgbPacked_8:
+    case kJpegInputBgrPacked_8:
+    case kJpegInputGray_8:
+      return (stride * height);
+    case kJpegInputYuv_8:
+      return ((stride * height) + (stride * height) / 2);
+    default:
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:Parameter error. input_fmt=%d", "jpeg_internal.c",
+                       __LINE__, input_fmt);
+      return -1;
+  }
+}
+
+STATIC boolean EsfCodecJpegEmptyOutputBufferCallbackSlice(
+    j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  size_t size = dest->tmp_output_buffer_size;
+  if (size >= dest->jpeg_size_max) {
+    dest->succeed = kJpegOutputBufferFullError;
+    return (boolean) false;
+  }
+  size_t new_size = size * 2;
+  if (new_size > dest->jpeg_size_max) {
+    new_size = dest->jpeg_size_max;
+  }
+  JOCTET *buffer = (JOCTET *)realloc(dest->tmp_output_buffer, new_size);
+  if (buffer == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to realloc slice buffer. size=%zu",
+                     "jpeg_internal.c", __LINE__, new_size);
+    dest->succeed = kJpegMemAllocError;
+    return (boolean) false;
+  }
+
+  dest->tmp_output_buffer = buffer;
+  dest->tmp_output_buffer_size = new_size;
+  dest->pub.next_output_byte = &buffer[size];
+  dest->pub.free_in_buffer = new_size - size;
+  return (boolean) true;
+}
+
+STATIC void EsfCodecJpegTermDestinationCallbackSlice(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  dest->jpeg_size = dest->tmp_output_buffer_size - dest->pub.free_in_buffer;
+  return;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegEncodeSlice(
+    const EsfCodecJpegEncParam *enc_param, unsigned int restart_interval,
+    EsfCodecJpegSlice *slice) {
+  // The slice gets its share of the output area at first and may grow up to
+  // the whole output area.
+  EsfCodecJpegRegion region = {0};
+  int32_t output_width = 0;
+  int32_t output_height = 0;
+  EsfCodecJpegGetRegion(enc_param, &region, &output_width, &output_height);
+  size_t size_max = (size_t)enc_param->out_buf.output_buf_size;
+  size_t size = (size_t)(((uint64_t)size_max * (uint64_t)slice->lines) /
+                         (uint64_t)output_height) +
+                ESF_CODEC_JPEG_SLICE_HEADER_SIZE;
+  if (size > size_max) {
+    size = size_max;
+  }
+  uint8_t *buffer = (uint8_t *)malloc(size);
+  if (buffer == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to malloc slice buffer. size=%zu",
+                     "jpeg_internal.c", __LINE__, size);
+    return kJpegMemAllocError;
+  }
+
+  EsfCodecJpegCompressManager *manager =
+      EsfCodecJpegCreateManager(kEsfCodecJpegMemoryAccess);
+  if (manager == (EsfCodecJpegCompressManager *)NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to create jpeg manager.",
+                     "jpeg_internal.c", __LINE__);
+    free(buffer);
+    return kJpegMemAllocError;
+  }
+  EsfCodecJpegDestManager *dest = manager->dest_manager;
+  (void)EsfCodecJpegSetDestManager(buffer, size, manager);
+  dest->pub.empty_output_buffer = EsfCodecJpegEmptyOutputBufferCallbackSlice;
+  dest->pub.term_destination = EsfCodecJpegTermDestinationCallbackSlice;
+  dest->tmp_output_buffer = buffer;
+  dest->tmp_output_buffer_size = size;
+  dest->jpeg_size_max = size_max;
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    // The buffer may have been moved by realloc(); dest holds it.
+    EsfCodecJpegError result = (dest->succeed != kJpegSuccess)
+                                   ? dest->succeed
+                                   : kJpegOssInternalError;
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Error during jpeg encoding. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    free(dest->tmp_output_buffer);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return result;
+  }
+
+  EsfCodecJpegError result = EsfCodecJpegSetParam(enc_param, manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set jpeg parameter. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    free(buffer);
+    (void)EsfCodecJpegDestroyManager(manager);
+    return result;
+  }
+
+  // The lines of the slice only, with the restart interval of the whole
+  // image. The slices are joined by their entropy-coded data, so they must
+  // all use the standard Huffman tables.
+  struct jpeg_compress_struct *jpeg_object = manager->jpeg_object;
+  manager->first_line = slice->first_line;
+  jpeg_object->image_height = (JDIMENSION)slice->lines;
+  jpeg_object->restart_interval = restart_interval;
+  jpeg_object->optimize_coding = (boolean) false;
+
+  jpeg_start_compress(jpeg_object, (boolean) true);
+
+  result = jpeg_object->raw_data_in ? EsfCodecJpegWriteRawData(manager)
+                                    : EsfCodecJpegWriteStrips(manager);
+  if (result == kJpegSuccess) {
+    jpeg_finish_compress(jpeg_object);
+    result = dest->succeed;
+  } else {
+    jpeg_abort((j_common_ptr)jpeg_object);
+  }
+
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Error during encoding. result=%d"
+                     " first_line=%" PRId32,
+                     "jpeg_internal.c", __LINE__, result, slice->first_line);
+    free(dest->tmp_output_buffer);
+  } else {
+    slice->buffer = dest->tmp_output_buffer;
+    slice->size = dest->jpeg_size;
+  }
+
+  (void)EsfCodecJpegDestroyManager(manager);
+  return result;
+}
+
+STATIC void *EsfCodecJpegSliceThread(void *arg) {
+  EsfCodecJpegSliceWorker *worker = (EsfCodecJpegSliceWorker *)arg;
+
+  for (int32_t i = worker->first; i < worker->slice_num; i += worker->step) {
+    worker->slices[i].result = EsfCodecJpegEncodeSlice(
+        worker->enc_param, worker->restart_interval, &worker->slices[i]);
+  }
+
+  return NULL;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegFindScanData(const uint8_t *jpeg,
+                                                  size_t size,
+                                                  size_t *sof_offset,
+                                                  size_t *data_offset) {
+  bool sof_found = false;
+
+  // Marker segments after SOI: 0xFF, marker, 2-byte big-endian length that
+  // counts itself.
+  size_t offset = 2;
+  while ((offset + 4) <= size) {
+    if (jpeg[offset] != 0xFF) {
+      break;
+    }
+    uint8_t marker = jpeg[offset + 1];
+    size_t length = ((size_t)jpeg[offset + 2] << 8) | jpeg[offset + 3];
+    if ((marker >= 0xC0) && (marker <= 0xC2)) {
+      *sof_offset = offset;
+      sof_found = true;
+    }
+    offset += 2 + length;
+    if (marker == 0xDA) {
+      if (!sof_found || (offset > size)) {
+        break;
+      }
+      *data_offset = offset;
+      return kJpegSuccess;
+    }
+  }
+
+  WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:No scan found. offset=%zu",
+                   "jpeg_internal.c", __LINE__, offset);
+  return kJpegOtherError;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegJoinSlices(const EsfCodecJpegSlice *slices,
+                                                int32_t slice_num,
+                                                int32_t height,
+                                                uint8_t *output,
+                                                size_t output_size,
+                                                size_t *jpeg_size) {
+  size_t offset = 0;
+
+  for (int32_t i = 0; i < slice_num; i++) {
+    const uint8_t *jpeg = slices[i].buffer;
+    size_t size = slices[i].size;
+    size_t sof_offset = 0;
+    size_t data_offset = 0;
+    if ((EsfCodecJpegFindScanData(jpeg, size, &sof_offset, &data_offset) !=
+         kJpegSuccess) ||
+        (size < data_offset + 2) || (jpeg[size - 2] != 0xFF) ||
+        (jpeg[size - 1] != JPEG_EOI)) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:Unexpected JPEG data. slice=%" PRId32
+                       " size=%zu",
+                       "jpeg_internal.c", __LINE__, i, size);
+      return kJpegOtherError;
+    }
+
+    // The headers of the first slice, then the data of each slice without
+    // EOI, followed by RSTn or by EOI after the last slice.
+    size_t begin = (i == 0) ? 0 : data_offset;
+    size_t copy_size = size - 2 - begin;
+    if ((output_size - offset) < (copy_size + 2)) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:Output buffer full. output_size=%zu",
+                       "jpeg_internal.c", __LINE__, output_size);
+      return kJpegOutputBufferFullError;
+    }
+    memcpy(&output[offset], &jpeg[begin], copy_size);
+    if (i == 0) {
+      // Image height of the frame header: SOFn, length, precision, height.
+      output[sof_offset + 5] = (uint8_t)((uint32_t)height >> 8);
+      output[sof_offset + 6] = (uint8_t)height;
+    }
+    offset += copy_size;
+    output[offset++] = 0xFF;
+    output[offset++] =
+        (i == slice_num - 1) ? JPEG_EOI : (uint8_t)(JPEG_RST0 + (i % 8));
+  }
+
+  *jpeg_size = offset;
+  return kJpegSuccess;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeSliced(
+    const EsfCodecJpegEncParam *enc_param, int32_t thread_num,
+    int32_t *jpeg_size) {
+  if ((enc_param == (const EsfCodecJpegEncParam *)NULL) ||
+      (jpeg_size == (int32_t *)NULL) || (thread_num < 1) ||
+      (thread_num > ESF_CODEC_JPEG_THREAD_NUM_MAX) ||
+      (EsfCodecJpegCheckParam(enc_param, kEsfCodecJpegMemoryAccess) !=
+       kJpegSuccess) ||
+      (enc_param->out_buf.output_buf_size <= 0)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. enc_param=%p thread_num=%" PRId32
+                     " jpeg_size=%p",
+                     "jpeg_internal.c", __LINE__, enc_param, thread_num,
+                     jpeg_size);
+    return kJpegParamError;
+  }
+
+  // MCUs of the default sampling: 4:2:0 for color, one block for gray. The
+  // slices are lines of the JPEG image, after cropping and scaling.
+  EsfCodecJpegRegion region = {0};
+  int32_t output_width = 0;
+  int32_t output_height = 0;
+  EsfCodecJpegGetRegion(enc_param, &region, &output_width, &output_height);
+  int32_t mcu_size =
+      (enc_param->input_fmt == kJpegInputGray_8) ? DCTSIZE : DCTSIZE * 2;
+  int32_t mcus_per_row = (output_width + mcu_size - 1) / mcu_size;
+  int32_t mcu_rows = (output_height + mcu_size - 1) / mcu_size;
+
+  // Slices of whole MCU rows, one per thread unless a slice would be longer
+  // than the restart interval can express.
+  int32_t slice_num = (thread_num < mcu_rows) ? thread_num : mcu_rows;
+  int32_t slice_rows = (mcu_rows + slice_num - 1) / slice_num;
+  int32_t slice_rows_max = ESF_CODEC_JPEG_RESTART_INTERVAL_MAX / mcus_per_row;
+  if (slice_rows > slice_rows_max) {
+    slice_rows = slice_rows_max;
+  }
+  slice_num = (mcu_rows + slice_rows - 1) / slice_rows;
+  if (thread_num > slice_num) {
+    thread_num = slice_num;
+  }
+
+  EsfCodecJpegSlice *slices =
+      (EsfCodecJpegSlice *)calloc((size_t)slice_num, sizeof(*slices));
+  if (slices == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to malloc slices.",
+                     "jpeg_internal.c", __LINE__);
+    UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
+    return kJpegMemAllocError;
+  }
+  for (int32_t i = 0; i < slice_num; i++) {
+    slices[i].first_line = i * slice_rows * mcu_size;
+    slices[i].lines = output_height - slices[i].first_line;
+    if (slices[i].lines > slice_rows * mcu_size) {
+      slices[i].lines = slice_rows * mcu_size;
+    }
+  }
+
+  EsfCodecJpegSliceWorker workers[ESF_CODEC_JPEG_THREAD_NUM_MAX];
+  pthread_t threads[ESF_CODEC_JPEG_THREAD_NUM_MAX];
+  bool started[ESF_CODEC_JPEG_THREAD_NUM_MAX] = {false};
+  for (int32_t i = 0; i < thread_num; i++) {
+    workers[i].enc_param = enc_param;
+    workers[i].slices = slices;
+    workers[i].slice_num = slice_num;
+    workers[i].first = i;
+    workers[i].step = thread_num;
+    workers[i].restart_interval =
+        (slice_num > 1) ? (unsigned int)(slice_rows * mcus_per_row) : 0U;
+  }
+
+  // Worker 0 runs on the calling thread, and so does any worker whose thread
+  // could not be started.
+  for (int32_t i = 1; i < thread_num; i++) {
+    started[i] = (pthread_create(&threads[i], NULL, EsfCodecJpegSliceThread,
+                                 &workers[i]) == 0);
+    if (!started[i]) {
+      WRITE_DLOG_WARN(MODULE_ID_SYSTEM,
+                      "%s-%d:Failed to create thread. worker=%" PRId32,
+                      "jpeg_internal.c", __LINE__, i);
+    }
+  }
+  for (int32_t i = 0; i < thread_num; i++) {
+    if (!started[i]) {
+      (void)EsfCodecJpegSliceThread(&workers[i]);
+    }
+  }
+  for (int32_t i = 1; i < thread_num; i++) {
+    if (started[i]) {
+      (void)pthread_join(threads[i], NULL);
+    }
+  }
+
+  EsfCodecJpegError result = kJpegSuccess;
+  for (int32_t i = 0; (i < slice_num) && (result == kJpegSuccess); i++) {
+    result = slices[i].result;
+  }
+  size_t output_size = 0;
+  if (result == kJpegSuccess) {
+    result = EsfCodecJpegJoinSlices(
+        slices, slice_num, output_height,
+        (uint8_t *)(uintptr_t)enc_param->out_buf.output_adr_handle,
+        (size_t)enc_param->out_buf.output_buf_size, &output_size);
+  }
+
+  for (int32_t i = 0; i < slice_num; i++) {
+    free(slices[i].buffer);
+  }
+  free(slices);
+
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to encode slices. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
+    return result;
+  }
+
+  *jpeg_size = (int32_t)output_size;
+  UTILITY_COUNTER_INC(s_jpeg_encode_counter);
+  UTILITY_HISTOGRAM_OBSERVE(s_jpeg_output_size_counter, (uint64_t)*jpeg_size);
+  return kJpegSuccess;
+}
+
+EsfCodecJpegError EsfCodecJpegCreateEncoder(
+    const EsfCodecJpegInfo *info, EsfCodecJpegEncoderHandle *encoder) {
+  if ((info == NULL) || (encoder == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. info=%p encoder=%p",
+                     "jpeg_internal.c", __LINE__, info, encoder);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegEncParam enc_param = {.input_adr_handle = 0,
+                                    .input_fmt = info->input_fmt,
+                                    .width = info->width,
+                                    .height = info->height,
+                                    .stride = info->stride,
+                                    .quality = info->quality};
+  return EsfCodecJpegCreateEncoderWithParam(&enc_param, encoder);
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegCreateEncoderWithParam(
+    const EsfCodecJpegEncParam *enc_param,
+    EsfCodecJpegEncoderHandle *encoder) {
+  struct EsfCodecJpegEncoder *context = (struct EsfCodecJpegEncoder *)calloc(
+      1, sizeof(struct EsfCodecJpegEncoder));
+  if (context == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to malloc encoder.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegMemAllocError;
+  }
+
+  // Created for FileIO access so that no addresses are needed yet; the
+  // access type is set for each image.
+  EsfCodecJpegCompressManager *manager =
+      EsfCodecJpegCreateManager(kEsfCodecJpegFileIoAccess);
+  if (manager == (EsfCodecJpegCompressManager *)NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to create jpeg manager.",
+                     "jpeg_internal.c", __LINE__);
+    free(context);
+    return kJpegMemAllocError;
+  }
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during jpeg setup.",
+                     "jpeg_internal.c", __LINE__);
+    (void)EsfCodecJpegDestroyManager(manager);
+    free(context);
+    return kJpegOssInternalError;
+  }
+
+  EsfCodecJpegError result = EsfCodecJpegSetParam(enc_param, manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set jpeg parameter. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    (void)EsfCodecJpegDestroyManager(manager);
+    free(context);
+    return result;
+  }
+
+  context->compress_manager = manager;
+  *encoder = context;
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegSetEncoderOutput(
+    EsfCodecJpegEncoderHandle encoder, const EsfCodecJpegOutputArea *output) {
+  EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  if ((output->file_handle != 0) && (encoder->write_buffer == NULL)) {
+    encoder->write_buffer = (uint8_t *)malloc(
+        CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE);
+    if (encoder->write_buffer == NULL) {
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to malloc write buffer.",
+                       "jpeg_internal.c", __LINE__);
+      return kJpegMemAllocError;
+    }
+  }
+
+  EsfCodecJpegError result = kJpegSuccess;
+  if (output->file_handle != 0) {
+    result = EsfCodecJpegSetDestManagerFileIo(
+        encoder->write_buffer,
+        CONFIG_EXTERNAL_CODEC_JPEG_FILE_IO_WRITE_BUFFER_SIZE,
+        output->file_handle, manager);
+  } else {
+    result = EsfCodecJpegSetDestManager(output->area, (size_t)output->size,
+                                        manager);
+  }
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set dest manager. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+  }
+
+  return result;
+}
+
+STATIC void EsfCodecJpegSetEncoderInput(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image,
+    EsfMemoryManagerHandle input_file_handle) {
+  EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  manager->image = image;
+  manager->input_file_handle = input_file_handle;
+  manager->access_type = (input_file_handle != 0) ? kEsfCodecJpegFileIoAccess
+                                                  : kEsfCodecJpegMemoryAccess;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeWithEncoder(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image,
+    EsfMemoryManagerHandle input_file_handle, uint8_t *output,
+    EsfMemoryManagerHandle output_file_handle, int32_t output_size,
+    int32_t *jpeg_size) {
+  if ((encoder == NULL) || (jpeg_size == NULL) ||
+      ((input_file_handle == 0) && (image == NULL)) ||
+      ((output_file_handle == 0) && ((output == NULL) || (output_size <= 0)))) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. encoder=%p image=%p output=%p "
+                     "output_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, encoder, image, output,
+                     output_size);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  EsfCodecJpegOutputArea output_area = {output, output_file_handle,
+                                        output_size};
+  EsfCodecJpegError result =
+      EsfCodecJpegSetEncoderOutput(encoder, &output_area);
+  if (result != kJpegSuccess) {
+    return result;
+  }
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during jpeg encoding.",
+                     "jpeg_internal.c", __LINE__);
+    // Back to the idle state with the parameters and tables kept.
+    jpeg_abort((j_common_ptr)manager->jpeg_object);
+    return kJpegOssInternalError;
+  }
+
+  EsfCodecJpegSetEncoderInput(encoder, image, input_file_handle);
+
+  return EsfCodecJpegCompressImage(jpeg_size, manager);
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeWithThumbnail(
+    EsfCodecJpegEncoderHandle encoder, EsfCodecJpegEncoderHandle thumbnail,
+    uint8_t *image, EsfMemoryManagerHandle input_file_handle,
+    const EsfCodecJpegOutputArea *output,
+    const EsfCodecJpegOutputArea *thumbnail_output, int32_t *jpeg_size,
+    int32_t *thumbnail_size) {
+  if ((encoder == NULL) || (thumbnail == NULL) || (output == NULL) ||
+      (thumbnail_output == NULL) || (jpeg_size == NULL) ||
+      (thumbnail_size == NULL) ||
+      ((input_file_handle == 0) && (image == NULL)) ||
+      ((output->file_handle == 0) &&
+       ((output->area == NULL) || (output->size <= 0))) ||
+      ((thumbnail_output->file_handle == 0) &&
+       ((thumbnail_output->area == NULL) || (thumbnail_output->size <= 0)))) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. encoder=%p thumbnail=%p image=%p "
+                     "output=%p thumbnail_output=%p",
+                     "jpeg_internal.c", __LINE__, encoder, thumbnail, image,
+                     output, thumbnail_output);
+    return kJpegParamError;
+  }
+
+  // The thumbnail is made from the lines of the full size image as they are
+  // passed to libjpeg, so it must be a scaled copy of the same region.
+  EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  EsfCodecJpegCompressManager *thumbnail_manager = thumbnail->compress_manager;
+  if ((thumbnail_manager->format != manager->format) ||
+      (thumbnail_manager->region_width != manager->region_width) ||
+      (thumbnail_manager->region_height != manager->region_height) ||
+      ((int32_t)manager->jpeg_object->image_width != manager->region_width) ||
+      (manager->output_height != manager->region_height)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. The thumbnail is not made from "
+                     "the same image.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegError result = EsfCodecJpegSetEncoderOutput(encoder, output);
+  if (result != kJpegSuccess) {
+    return result;
+  }
+  result = EsfCodecJpegSetEncoderOutput(thumbnail, thumbnail_output);
+  if (result != kJpegSuccess) {
+    return result;
+  }
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    EsfCodecJpegAbortEncoders(manager, thumbnail_manager);
+    return kJpegOssInternalError;
+  }
+  if (setjmp(thumbnail_manager->error_manager->setjmp_buffer)) {
+    EsfCodecJpegAbortEncoders(manager, thumbnail_manager);
+    return kJpegOssInternalError;
+  }
+
+  EsfCodecJpegSetEncoderInput(encoder, image, input_file_handle);
+
+  return EsfCodecJpegCompressImages(manager, thumbnail_manager, jpeg_size,
+                                    thumbnail_size);
+}
+
+STATIC void EsfCodecJpegAbortEncoders(
+    EsfCodecJpegCompressManager *compress_manager,
+    EsfCodecJpegCompressManager *thumbnail) {
+  WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during jpeg encoding.",
+                   "jpeg_internal.c", __LINE__);
+  // Back to the idle state with the parameters and tables kept.
+  compress_manager->thumbnail = NULL;
+  jpeg_abort((j_common_ptr)compress_manager->jpeg_object);
+  jpeg_abort((j_common_ptr)thumbnail->jpeg_object);
+  UTILITY_COUNTER_INC(s_jpeg_encode_failed_counter);
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegOpenHandle(
+    EsfMemoryManagerHandle handle, int32_t size, uint8_t **data,
+    EsfMemoryManagerHandle *file_handle, int32_t *area_size) {
+  EsfMemoryManagerMapSupport support = kEsfMemoryManagerMapIsSupport;
+  EsfCodecJpegError jpeg_result =
+      EsfCodecJpegGetHandleArea(handle, &support, area_size);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+
+  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
+  *data = NULL;
+  *file_handle = 0;
+  if (support == kEsfMemoryManagerMapIsSupport) {
+    memory_manager_result = EsfMemoryManagerMap(
+        handle, NULL, (size > 0) ? size : *area_size, (void **)data);
+  } else {
+    memory_manager_result = EsfMemoryManagerFopen(handle);
+    *file_handle = handle;
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to open handle. handle=%" PRIu32
+                     " memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, handle,
+                     memory_manager_result);
+    return kJpegOtherError;
+  }
+
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegCloseHandle(
+    EsfMemoryManagerHandle handle, uint8_t **data,
+    EsfMemoryManagerHandle file_handle) {
+  EsfMemoryManagerResult memory_manager_result = kEsfMemoryManagerResultSuccess;
+  if (file_handle != 0) {
+    memory_manager_result = EsfMemoryManagerFclose(handle);
+  } else {
+    memory_manager_result = EsfMemoryManagerUnmap(handle, (void **)data);
+  }
+  if (memory_manager_result != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to close handle. handle=%" PRIu32
+                     " memory_manager_result=%d",
+                     "jpeg_internal.c", __LINE__, handle,
+                     memory_manager_result);
+    return kJpegOtherError;
+  }
+
+  return kJpegSuccess;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeHandleWithEncoder(
+    EsfCodecJpegEncoderHandle encoder, EsfMemoryManagerHandle input_handle,
+    EsfMemoryManagerHandle output_handle, int32_t *jpeg_size) {
+  if ((encoder == NULL) || (input_handle == (EsfMemoryManagerHandle)0) ||
+      (output_handle == (EsfMemoryManagerHandle)0) || (jpeg_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. encoder=%p input_handle=%" PRIu32
+                     " output_handle=%" PRIu32 " jpeg_size=%p",
+                     "jpeg_internal.c", __LINE__, encoder, input_handle,
+                     output_handle, jpeg_size);
+    return kJpegParamError;
+  }
+
+  const EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  int32_t input_buf_size = CalculateInputBufferSize(
+      manager->stride, manager->image_height, manager->format);
+  if (input_buf_size < 0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:CalculateInputBufferSize failed. "
+                     "input_buf_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, input_buf_size);
+    return kJpegParamError;
+  }
+
+  uint8_t *input_data = NULL;
+  EsfMemoryManagerHandle input_file_handle = 0;
+  int32_t in_area_size = 0;
+  EsfCodecJpegError jpeg_result =
+      EsfCodecJpegOpenHandle(input_handle, input_buf_size, &input_data,
+                             &input_file_handle, &in_area_size);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+
+  uint8_t *output_data = NULL;
+  EsfMemoryManagerHandle output_file_handle = 0;
+  int32_t out_area_size = 0;
+  jpeg_result = EsfCodecJpegOpenHandle(output_handle, 0, &output_data,
+                                       &output_file_handle, &out_area_size);
+  if (jpeg_result != kJpegSuccess) {
+    goto close_input;
+  }
+
+  jpeg_result = EsfCodecJpegEncodeWithEncoder(
+      encoder, input_data, input_file_handle, output_data, output_file_handle,
+      out_area_size, jpeg_size);
+  if (jpeg_result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfCodecJpegEncodeWithEncoder failed. "
+                     "jpeg_result=%d",
+                     "jpeg_internal.c", __LINE__, jpeg_result);
+  }
+
+  if ((EsfCodecJpegCloseHandle(output_handle, &output_data,
+                               output_file_handle) != kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+close_input:
+  if ((EsfCodecJpegCloseHandle(input_handle, &input_data,
+                               input_file_handle) != kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+  return jpeg_result;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeHandleToArea(
+    EsfMemoryManagerHandle input_handle, const EsfCodecJpegInfo *info,
+    uint8_t *output, int32_t output_size, int32_t *jpeg_size) {
+  if ((input_handle == (EsfMemoryManagerHandle)0) || (info == NULL) ||
+      (output == NULL) || (output_size <= 0) || (jpeg_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. input_handle=%" PRIu32
+                     " info=%p output=%p output_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, input_handle, info, output,
+                     output_size);
+    return kJpegParamError;
+  }
+
+  int32_t input_buf_size =
+      CalculateInputBufferSize(info->stride, info->height, info->input_fmt);
+  if (input_buf_size < 0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:CalculateInputBufferSize failed. "
+                     "input_buf_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, input_buf_size);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegEncoderHandle encoder = NULL;
+  EsfCodecJpegError jpeg_result = EsfCodecJpegCreateEncoder(info, &encoder);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+
+  uint8_t *input_data = NULL;
+  EsfMemoryManagerHandle input_file_handle = 0;
+  int32_t area_size = 0;
+  jpeg_result = EsfCodecJpegOpenHandle(input_handle, input_buf_size,
+                                       &input_data, &input_file_handle,
+                                       &area_size);
+  if (jpeg_result != kJpegSuccess) {
+    goto destroy;
+  }
+
+  // The JPEG data goes straight to the output area; no handle is allocated
+  // for it.
+  jpeg_result = EsfCodecJpegEncodeWithEncoder(encoder, input_data,
+                                              input_file_handle, output, 0,
+                                              output_size, jpeg_size);
+  if (jpeg_result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfCodecJpegEncodeWithEncoder failed. "
+                     "jpeg_result=%d",
+                     "jpeg_internal.c", __LINE__, jpeg_result);
+  }
+
+  if ((EsfCodecJpegCloseHandle(input_handle, &input_data,
+                               input_file_handle) != kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+destroy:
+  (void)EsfCodecJpegDestroyEncoder(encoder);
+
+  return jpeg_result;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeHandleThumbnail(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    EsfMemoryManagerHandle thumbnail_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegThumbnailInfo *thumbnail_info, int32_t *jpeg_size,
+    int32_t *thumbnail_size) {
+  if ((input_handle == (EsfMemoryManagerHandle)0) ||
+      (output_handle == (EsfMemoryManagerHandle)0) ||
+      (thumbnail_handle == (EsfMemoryManagerHandle)0) || (info == NULL) ||
+      (thumbnail_info == NULL) || (jpeg_size == NULL) ||
+      (thumbnail_size == NULL)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. input_handle=%" PRIu32
+                     " output_handle=%" PRIu32 " thumbnail_handle=%" PRIu32
+                     " info=%p thumbnail_info=%p",
+                     "jpeg_internal.c", __LINE__, input_handle, output_handle,
+                     thumbnail_handle, info, thumbnail_info);
+    return kJpegParamError;
+  }
+
+  if ((thumbnail_info->scale_numerator <= 0) ||
+      (thumbnail_info->scale_numerator >= thumbnail_info->scale_denominator)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. scale=%" PRId32 "/%" PRId32,
+                     "jpeg_internal.c", __LINE__,
+                     thumbnail_info->scale_numerator,
+                     thumbnail_info->scale_denominator);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegEncParam enc_param = {.input_adr_handle = 0,
+                                    .input_fmt = info->input_fmt,
+                                    .width = info->width,
+                                    .height = info->height,
+                                    .stride = info->stride,
+                                    .quality = info->quality};
+  EsfCodecJpegEncParam thumbnail_param = enc_param;
+  thumbnail_param.quality = thumbnail_info->quality;
+  thumbnail_param.scale_numerator = thumbnail_info->scale_numerator;
+  thumbnail_param.scale_denominator = thumbnail_info->scale_denominator;
+
+  int32_t input_buf_size = CalculateInputBufferSize(
+      enc_param.stride, enc_param.height, enc_param.input_fmt);
+  if (input_buf_size < 0) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:CalculateInputBufferSize failed. "
+                     "input_buf_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, input_buf_size);
+    return kJpegParamError;
+  }
+
+  EsfCodecJpegEncoderHandle encoder = NULL;
+  EsfCodecJpegError jpeg_result =
+      EsfCodecJpegCreateEncoderWithParam(&enc_param, &encoder);
+  if (jpeg_result != kJpegSuccess) {
+    return jpeg_result;
+  }
+  EsfCodecJpegEncoderHandle thumbnail = NULL;
+  jpeg_result = EsfCodecJpegCreateEncoderWithParam(&thumbnail_param,
+                                                   &thumbnail);
+  if (jpeg_result != kJpegSuccess) {
+    (void)EsfCodecJpegDestroyEncoder(encoder);
+    return jpeg_result;
+  }
+
+  uint8_t *input_data = NULL;
+  EsfMemoryManagerHandle input_file_handle = 0;
+  int32_t area_size = 0;
+  EsfCodecJpegOutputArea output = {NULL, 0, 0};
+  EsfCodecJpegOutputArea thumbnail_output = {NULL, 0, 0};
+  jpeg_result = EsfCodecJpegOpenHandle(input_handle, input_buf_size,
+                                       &input_data, &input_file_handle,
+                                       &area_size);
+  if (jpeg_result != kJpegSuccess) {
+    goto destroy;
+  }
+  jpeg_result =
+      EsfCodecJpegOpenHandle(output_handle, 0, &output.area,
+                             &output.file_handle, &output.size);
+  if (jpeg_result != kJpegSuccess) {
+    goto close_input;
+  }
+  jpeg_result = EsfCodecJpegOpenHandle(thumbnail_handle, 0,
+                                       &thumbnail_output.area,
+                                       &thumbnail_output.file_handle,
+                                       &thumbnail_output.size);
+  if (jpeg_result != kJpegSuccess) {
+    goto close_output;
+  }
+
+  jpeg_result = EsfCodecJpegEncodeWithThumbnail(
+      encoder, thumbnail, input_data, input_file_handle, &output,
+      &thumbnail_output, jpeg_size, thumbnail_size);
+  if (jpeg_result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:EsfCodecJpegEncodeWithThumbnail failed. "
+                     "jpeg_result=%d",
+                     "jpeg_internal.c", __LINE__, jpeg_result);
+  }
+
+  if ((EsfCodecJpegCloseHandle(thumbnail_handle, &thumbnail_output.area,
+                               thumbnail_output.file_handle) !=
+       kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+close_output:
+  if ((EsfCodecJpegCloseHandle(output_handle, &output.area,
+                               output.file_handle) != kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+close_input:
+  if ((EsfCodecJpegCloseHandle(input_handle, &input_data,
+                               input_file_handle) != kJpegSuccess) &&
+      (jpeg_result == kJpegSuccess)) {
+    jpeg_result = kJpegOtherError;
+  }
+
+destroy:
+  (void)EsfCodecJpegDestroyEncoder(thumbnail);
+  (void)EsfCodecJpegDestroyEncoder(encoder);
+
+  return jpeg_result;
+}
+
+EsfCodecJpegError EsfCodecJpegDestroyEncoder(
+    EsfCodecJpegEncoderHandle encoder) {
+  if (encoder == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Parameter error. encoder=%p",
+                     "jpeg_internal.c", __LINE__, encoder);
+    return kJpegParamError;
+  }
+
+  (void)EsfCodecJpegDestroyManager(encoder->compress_manager);
+  free(encoder->write_buffer);
+  free(encoder);
+
+  return kJpegSuccess;
+}
+
+STATIC boolean EsfCodecJpegEmptyOutputBufferCallbackCount(
+    j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  dest->jpeg_size += dest->tmp_output_buffer_size;
+  dest->pub.next_output_byte = dest->tmp_output_buffer;
+  dest->pub.free_in_buffer = dest->tmp_output_buffer_size;
+  return (boolean) true;
+}
+
+STATIC void EsfCodecJpegTermDestinationCallbackCount(j_compress_ptr cinfo) {
+  EsfCodecJpegDestManager *dest = ((EsfCodecJpegDestManager *)(cinfo->dest));
+
+  dest->jpeg_size += dest->tmp_output_buffer_size - dest->pub.free_in_buffer;
+  return;
+}
+
+STATIC void EsfCodecJpegSetDestManagerCount(
+    uint8_t *buffer, size_t size,
+    EsfCodecJpegCompressManager *compress_manager) {
+  EsfCodecJpegDestManager *dest = compress_manager->dest_manager;
+  (void)EsfCodecJpegSetDestManager(buffer, size, compress_manager);
+  dest->pub.empty_output_buffer = EsfCodecJpegEmptyOutputBufferCallbackCount;
+  dest->pub.term_destination = EsfCodecJpegTermDestinationCallbackCount;
+  dest->tmp_output_buffer = buffer;
+  dest->tmp_output_buffer_size = size;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegCountImageSize(
+    EsfCodecJpegCompressManager *compress_manager, uint8_t *buffer,
+    size_t buffer_size, int32_t quality, size_t *jpeg_size) {
+  struct jpeg_compress_struct *jpeg_object = compress_manager->jpeg_object;
+  EsfCodecJpegSetDestManagerCount(buffer, buffer_size, compress_manager);
+  jpeg_set_quality(jpeg_object, quality, (boolean) true);
+  jpeg_suppress_tables(jpeg_object, (boolean) true);
+  jpeg_start_compress(jpeg_object, (boolean) false);
+
+  EsfCodecJpegError result = jpeg_object->raw_data_in
+                                 ? EsfCodecJpegWriteRawData(compress_manager)
+                                 : EsfCodecJpegWriteStrips(compress_manager);
+  if (result != kJpegSuccess) {
+    jpeg_abort((j_common_ptr)jpeg_object);
+    return result;
+  }
+
+  jpeg_finish_compress(jpeg_object);
+  *jpeg_size = compress_manager->dest_manager->jpeg_size;
+  return kJpegSuccess;
+}
+
+STATIC void EsfCodecJpegMosaicTile(int32_t column, int32_t row, int32_t step,
+                                   int32_t *x, int32_t *y) {
+  uint32_t hash =
+      ((uint32_t)column * 0x9E3779B1U) ^ ((uint32_t)row * 0x85EBCA77U);
+  hash ^= hash >> 15;
+  hash *= 0x2C1B3C6DU;
+  hash ^= hash >> 12;
+  *x = (int32_t)((hash & 0xFFFFU) % (uint32_t)step);
+  *y = (int32_t)((hash >> 16) % (uint32_t)step);
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegMakeMosaic(
+    const EsfCodecJpegEncParam *enc_param, int32_t tile, int32_t step,
+    uint8_t **mosaic, EsfCodecJpegEncParam *mosaic_param) {
+  EsfCodecJpegRegion region = {0};
+  int32_t output_width = 0;
+  int32_t output_height = 0;
+  EsfCodecJpegGetRegion(enc_param, &region, &output_width, &output_height);
+
+  EsfCodecJpegInputFormat format = enc_param->input_fmt;
+  int32_t columns = (region.width / tile) / step;
+  int32_t rows = (region.height / tile) / step;
+  int32_t width = columns * tile;
+  int32_t height = rows * tile;
+  int32_t stride = (int32_t)EsfCodecJpegColumnOffset(format, width);
+  size_t tile_size = EsfCodecJpegColumnOffset(format, tile);
+  uint8_t *image =
+      (uint8_t *)malloc((size_t)CalculateInputBufferSize(stride, height,
+                                                         format));
+  if (image == NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to malloc mosaic.",
+                     "jpeg_internal.c", __LINE__);
+    return kJpegMemAllocError;
+  }
+
+  // Each plane in turn; the interleaved chroma plane of NV12 has half the
+  // lines.
+  const uint8_t *source =
+      (const uint8_t *)(uintptr_t)enc_param->input_adr_handle;
+  int32_t plane_num = 1;
+  if (format == kJpegInputRgbPlanar_8) {
+    plane_num = 3;
+  } else if (format == kJpegInputYuv_8) {
+    plane_num = 2;
+  }
+  for (int32_t plane = 0; plane < plane_num; plane++) {
+    int32_t divisor = ((format == kJpegInputYuv_8) && (plane == 1)) ? 2 : 1;
+    int32_t tile_lines = tile / divisor;
+    const uint8_t *source_plane =
+        &source[(size_t)enc_param->stride * (size_t)enc_param->height *
+                (size_t)plane];
+    uint8_t *plane_start = &image[(size_t)stride * (size_t)height * plane];
+    for (int32_t line = 0; line < (height / divisor); line++) {
+      int32_t row = line / tile_lines;
+      uint8_t *line_start = &plane_start[(size_t)line * (size_t)stride];
+      for (int32_t column = 0; column < columns; column++) {
+        int32_t tile_x = 0;
+        int32_t tile_y = 0;
+        EsfCodecJpegMosaicTile(column, row, step, &tile_x, &tile_y);
+        int32_t x = region.x + (((column * step) + tile_x) * tile);
+        int32_t source_line =
+            ((region.y + (((row * step) + tile_y) * tile)) / divisor) +
+            (line % tile_lines);
+        memcpy(&line_start[(size_t)column * tile_size],
+               &source_plane[((size_t)source_line * (size_t)enc_param->stride) +
+                             EsfCodecJpegColumnOffset(format, x)],
+               tile_size);
+      }
+    }
+  }
+
+  *mosaic_param = *enc_param;
+  mosaic_param->input_adr_handle = (uint64_t)(uintptr_t)image;
+  mosaic_param->width = width;
+  mosaic_param->height = height;
+  mosaic_param->stride = stride;
+  mosaic_param->roi = (EsfCodecJpegRegion){0, 0, 0, 0};
+  *mosaic = image;
+  return kJpegSuccess;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegEstimateSizeModel(
+    const EsfCodecJpegEncParam *enc_param, int32_t quality_max,
+    EsfCodecJpegSizeModel *model) {
+  EsfCodecJpegRegion region = {0};
+  int32_t output_width = 0;
+  int32_t output_height = 0;
+  EsfCodecJpegGetRegion(enc_param, &region, &output_width, &output_height);
+
+  // Tiles of the input that are scaled to about 16 pixels, an MCU of 4:2:0,
+  // and whose blocks line up with those of the image when not scaled.
+  int64_t numerator = 1;
+  int64_t denominator = 1;
+  if (enc_param->scale_numerator != enc_param->scale_denominator) {
+    numerator = enc_param->scale_numerator;
+    denominator = enc_param->scale_denominator;
+  }
+  int32_t tile = (int32_t)(((2 * DCTSIZE * denominator) + numerator - 1) /
+                           numerator);
+  tile = (tile + 1) & ~1;
+  int32_t step = ESF_CODEC_JPEG_TRIAL_STEP;
+  while ((step > 1) &&
+         (((region.width / tile) < (step * ESF_CODEC_JPEG_TRIAL_TILE_MIN)) ||
+          ((region.height / tile) < (step * ESF_CODEC_JPEG_TRIAL_TILE_MIN)))) {
+    step /= 2;
+  }
+
+  EsfCodecJpegEncParam trial_param = *enc_param;
+  uint8_t *mosaic = NULL;
+  if (step > 1) {
+    EsfCodecJpegError result = EsfCodecJpegMakeMosaic(enc_param, tile, step,
+                                                      &mosaic, &trial_param);
+    if (result != kJpegSuccess) {
+      return result;
+    }
+  }
+  int32_t trial_width = 0;
+  int32_t trial_height = 0;
+  EsfCodecJpegGetRegion(&trial_param, &region, &trial_width, &trial_height);
+
+  EsfCodecJpegCompressManager *manager =
+      EsfCodecJpegCreateManager(kEsfCodecJpegMemoryAccess);
+  if (manager == (EsfCodecJpegCompressManager *)NULL) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Failed to create jpeg manager.",
+                     "jpeg_internal.c", __LINE__);
+    free(mosaic);
+    return kJpegMemAllocError;
+  }
+
+  if (setjmp(manager->error_manager->setjmp_buffer)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:Error during jpeg encoding.",
+                     "jpeg_internal.c", __LINE__);
+    (void)EsfCodecJpegDestroyManager(manager);
+    free(mosaic);
+    return kJpegOssInternalError;
+  }
+
+  EsfCodecJpegError result = EsfCodecJpegSetParam(&trial_param, manager);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to set jpeg parameter. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    (void)EsfCodecJpegDestroyManager(manager);
+    free(mosaic);
+    return result;
+  }
+
+  // The tables take the same bytes at every quality, in the trial image and
+  // in the image, so they are counted once and left out of the trial image.
+  uint8_t buffer[ESF_CODEC_JPEG_TRIAL_BUFFER_SIZE];
+  EsfCodecJpegSetDestManagerCount(buffer, sizeof(buffer), manager);
+  jpeg_suppress_tables(manager->jpeg_object, (boolean) false);
+  EsfCodecJpegMarkUnusedTables(manager->jpeg_object);
+  jpeg_write_tables(manager->jpeg_object);
+
+  // The image size is ratio times the trial size, plus the tables.
+  double ratio = ((double)output_width * (double)output_height) /
+                 ((double)trial_width * (double)trial_height);
+  double header = (double)manager->dest_manager->jpeg_size;
+  const int32_t qualities[ESF_CODEC_JPEG_TRIAL_QUALITY_NUM] = {
+      quality_max, (quality_max * 2) / 3, quality_max / 3,
+      ESF_CODEC_JPEG_TRIAL_QUALITY_LOW, ESF_CODEC_JPEG_TRIAL_QUALITY_MIN};
+  model->point_num = 0;
+  for (int32_t i = 0; (i < ESF_CODEC_JPEG_TRIAL_QUALITY_NUM) &&
+                      (result == kJpegSuccess);
+       i++) {
+    int32_t quality = qualities[i];
+    if ((quality < 1) || ((model->point_num > 0) &&
+                          (quality >= model->quality[model->point_num - 1]))) {
+      continue;
+    }
+    size_t size = 0;
+    result = EsfCodecJpegCountImageSize(manager, buffer, sizeof(buffer),
+                                        quality, &size);
+    model->quality[model->point_num] = quality;
+    model->size[model->point_num] = header + (ratio * (double)size);
+    model->point_num++;
+  }
+  (void)EsfCodecJpegDestroyManager(manager);
+  free(mosaic);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to encode trial image. result=%d",
+                     "jpeg_internal.c", __LINE__, result);
+    return result;
+  }
+
+  return kJpegSuccess;
+}
+
+STATIC void EsfCodecJpegMarkUnusedTables(
+    struct jpeg_compress_struct *jpeg_object) {
+  bool quant_used[NUM_QUANT_TBLS] = {false};
+  bool huff_used[NUM_HUFF_TBLS] = {false};
+  for (int32_t ci = 0; ci < jpeg_object->num_components; ci++) {
+    const jpeg_component_info *component = &jpeg_object->comp_info[ci];
+    quant_used[component->quant_tbl_no] = true;
+    huff_used[component->dc_tbl_no] = true;
+    huff_used[component->ac_tbl_no] = true;
+  }
+  for (int32_t i = 0; i < NUM_QUANT_TBLS; i++) {
+    if ((jpeg_object->quant_tbl_ptrs[i] != NULL) && !quant_used[i]) {
+      jpeg_object->quant_tbl_ptrs[i]->sent_table = (boolean) true;
+    }
+  }
+  for (int32_t i = 0; i < NUM_HUFF_TBLS; i++) {
+    if ((jpeg_object->dc_huff_tbl_ptrs[i] != NULL) && !huff_used[i]) {
+      jpeg_object->dc_huff_tbl_ptrs[i]->sent_table = (boolean) true;
+    }
+    if ((jpeg_object->ac_huff_tbl_ptrs[i] != NULL) && !huff_used[i]) {
+      jpeg_object->ac_huff_tbl_ptrs[i]->sent_table = (boolean) true;
+    }
+  }
+}
+
+STATIC double EsfCodecJpegModelSize(const EsfCodecJpegSizeModel *model,
+                                    int32_t quality) {
+  if (model->point_num == 1) {
+    return model->size[0] * (double)jpeg_quality_scaling(model->quality[0]) /
+           (double)jpeg_quality_scaling(quality);
+  }
+
+  // The curve through the two points around quality, or through the two
+  // nearest points outside them.
+  int32_t i = 0;
+  while ((i < (model->point_num - 2)) && (quality < model->quality[i + 1])) {
+    i++;
+  }
+  double log_high = log((double)jpeg_quality_scaling(model->quality[i]));
+  double log_low = log((double)jpeg_quality_scaling(model->quality[i + 1]));
+  double t = (log((double)jpeg_quality_scaling(quality)) - log_high) /
+             (log_low - log_high);
+  return exp(log(model->size[i]) +
+             (t * (log(model->size[i + 1]) - log(model->size[i]))));
+}
+
+STATIC void EsfCodecJpegModelAddPoint(EsfCodecJpegSizeModel *model,
+                                      int32_t quality, double size) {
+  int32_t i = 0;
+  while ((i < model->point_num) && (model->quality[i] > quality)) {
+    i++;
+  }
+  if ((i < model->point_num) && (model->quality[i] == quality)) {
+    model->size[i] = size;
+    return;
+  }
+  if (model->point_num == ESF_CODEC_JPEG_SIZE_MODEL_POINT_NUM) {
+    return;
+  }
+  memmove(&model->quality[i + 1], &model->quality[i],
+          sizeof(model->quality[0]) * (size_t)(model->point_num - i));
+  memmove(&model->size[i + 1], &model->size[i],
+          sizeof(model->size[0]) * (size_t)(model->point_num - i));
+  model->quality[i] = quality;
+  model->size[i] = size;
+  model->point_num++;
+}
+
+STATIC int32_t EsfCodecJpegModelQuality(const EsfCodecJpegSizeModel *model,
+                                        int32_t size, int32_t quality_max) {
+  // The size grows with the quality.
+  int32_t quality = quality_max;
+  while ((quality > 1) && (EsfCodecJpegModelSize(model, quality) > size)) {
+    quality--;
+  }
+
+  return quality;
+}
+
+STATIC EsfCodecJpegError EsfCodecJpegEncodeWithQuality(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image, int32_t quality,
+    uint8_t *output, int32_t output_size, int32_t *jpeg_size,
+    double *estimated_size) {
+  EsfCodecJpegCompressManager *manager = encoder->compress_manager;
+  struct jpeg_compress_struct *jpeg_object = manager->jpeg_object;
+  jpeg_set_quality(jpeg_object, quality, (boolean) true);
+
+  EsfCodecJpegError result = EsfCodecJpegEncodeWithEncoder(
+      encoder, image, 0, output, 0, output_size, jpeg_size);
+  if (result == kJpegSuccess) {
+    *estimated_size = (double)*jpeg_size;
+  } else if (manager->dest_manager->succeed == kJpegOutputBufferFullError) {
+    // jpeg_abort() keeps next_scanline; the lines encoded so far filled the
+    // output.
+    double lines = (jpeg_object->next_scanline > 0U)
+                       ? (double)jpeg_object->next_scanline
+                       : 1.0;
+    *estimated_size =
+        (double)output_size * (double)jpeg_object->image_height / lines;
+    result = kJpegOutputBufferFullError;
+  }
+
+  return result;
+}
+
+EsfCodecJpegError EsfCodecJpegEncodeToSize(
+    const EsfCodecJpegEncParam *enc_param, int32_t target_size,
+    int32_t *jpeg_size, int32_t *quality) {
+  if ((enc_param == (const EsfCodecJpegEncParam *)NULL) ||
+      (jpeg_size == (int32_t *)NULL) || (quality == (int32_t *)NULL) ||
+      (target_size <= 0) ||
+      (EsfCodecJpegCheckParam(enc_param, kEsfCodecJpegMemoryAccess) !=
+       kJpegSuccess) ||
+      (enc_param->out_buf.output_buf_size <= 0)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Parameter error. enc_param=%p target_size=%" PRId32
+                     " jpeg_size=%p quality=%p",
+                     "jpeg_internal.c", __LINE__, enc_param, target_size,
+                     jpeg_size, quality);
+    return kJpegParamError;
+  }
+
+  uint8_t *image = (uint8_t *)(uintptr_t)enc_param->input_adr_handle;
+  uint8_t *output = (uint8_t *)(uintptr_t)enc_param->out_buf.output_adr_handle;
+  int32_t output_size = enc_param->out_buf.output_buf_size;
+  int32_t size_max = (target_size < output_size) ? target_size : output_size;
+  int32_t size_min =
+      size_max - (int32_t)(((int64_t)size_max *
+                            ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE) /
+                           100);
+  int32_t quality_max = (enc_param->quality > 0) ? enc_param->quality : 1;
+
+  EsfCodecJpegSizeModel model = {0};
+  EsfCodecJpegError result =
+      EsfCodecJpegEstimateSizeModel(enc_param, quality_max, &model);
+  if (result != kJpegSuccess) {
+    return result;
+  }
+
+  EsfCodecJpegEncoderHandle encoder = NULL;
+  result = EsfCodecJpegCreateEncoderWithParam(enc_param, &encoder);
+  if (result != kJpegSuccess) {
+    return result;
+  }
+
+  // First pass, aimed at the middle of the tolerance.
+  int32_t goal = size_min + ((size_max - size_min) / 2);
+  int32_t pass_quality = EsfCodecJpegModelQuality(&model, goal, quality_max);
+  int32_t size = 0;
+  double estimated_size = 0.0;
+  result = EsfCodecJpegEncodeWithQuality(encoder, image, pass_quality, output,
+                                         output_size, &size, &estimated_size);
+  bool fits = (result == kJpegSuccess) && (size <= size_max);
+  if ((fits && ((size >= size_min) || (pass_quality == quality_max))) ||
+      ((result != kJpegSuccess) && (result != kJpegOutputBufferFullError))) {
+    goto destroy;
+  }
+
+  // Second pass, with the size of the first one as a point of the model, so
+  // that qualities next to it are interpolated between the measured size and
+  // the estimate. Part of the error of the trial encode is shared by every
+  // quality, so the other points take half of it (on a log scale).
+  double correction =
+      sqrt(estimated_size / EsfCodecJpegModelSize(&model, pass_quality));
+  for (int32_t i = 0; i < model.point_num; i++) {
+    model.size[i] *= correction;
+  }
+  EsfCodecJpegModelAddPoint(&model, pass_quality, estimated_size);
+  if (!fits) {
+    // The last pass, so aimed at the bottom of the tolerance.
+    goal = size_min;
+    int32_t second_quality =
+        EsfCodecJpegModelQuality(&model, goal, quality_max);
+    if (second_quality >= pass_quality) {
+      second_quality = pass_quality - 1;
+    }
+    if (second_quality < 1) {
+      result = kJpegOutputBufferFullError;
+      goto destroy;
+    }
+    pass_quality = second_quality;
+    result = EsfCodecJpegEncodeWithQuality(encoder, image, pass_quality,
+                                           output, output_size, &size,
+                                           &estimated_size);
+    if ((result == kJpegSuccess) && (size > size_max)) {
+      result = kJpegOutputBufferFullError;
+    }
+  } else {
+    // Encoded behind the first image, which is kept when this one does not
+    // fit, so aimed at the top half of the tolerance.
+    goal += (size_max - goal) / 2;
+    int32_t second_quality =
+        EsfCodecJpegModelQuality(&model, goal, quality_max);
+    int32_t room = output_size - size;
+    if (room > size_max) {
+      room = size_max;
+    }
+    if ((second_quality > pass_quality) && (room >= size_min)) {
+      int32_t second_size = 0;
+      EsfCodecJpegError second_result = EsfCodecJpegEncodeWithQuality(
+          encoder, image, second_quality, &output[size], room, &second_size,
+          &estimated_size);
+      if (second_result == kJpegSuccess) {
+        memmove(output, &output[size], (size_t)second_size);
+        size = second_size;
+        pass_quality = second_quality;
+      } else if (second_result != kJpegOutputBufferFullError) {
+        result = second_result;
+      }
+    }
+  }
+
+destroy:
+  (void)EsfCodecJpegDestroyEncoder(encoder);
+  if (result != kJpegSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:Failed to encode to size. result=%d"
+                     " target_size=%" PRId32,
+                     "jpeg_internal.c", __LINE__, result, target_size);
+    return result;
+  }
+
+  *jpeg_size = size;
+  *quality = pass_quality;
+  return kJpegSuccess;
 }
@@ -31,6 +31,7 @@ extern "C" {
 #endif /* __NuttX__ */
 #endif
 
+#include "base64/include/base64_stream.h"
 #include "jpeg.h"
 
 // JPEG destination manager structure of libjpeg/libjpeg-turbo.
@@ -47,6 +48,16 @@ typedef struct {
       tmp_output_buffer_size;  // Buffer size for temporarily storing JPEG data.
   size_t jpeg_size;            // Total size of the JPEG data
   size_t jpeg_size_max;        // Max size of the JPEG data
+
+  // Base64 output. When base64 is true, each block flushed from
+  // tmp_output_buffer is Base64 encoded on the spot, and jpeg_size and
+  // jpeg_size_max count Base64 characters instead of JPEG bytes.
+  bool base64;
+  EsfCodecBase64EncodeContext base64_context;
+  // Mapped output area when output_file_handle is 0, otherwise a buffer for
+  // the characters of one block that are then written with FileIO.
+  char *base64_output;
+  size_t base64_output_size;  // Size of base64_output.
 } EsfCodecJpegDestManager;
 
 // JPEG error manager structure of libjpeg/libjpeg-turbo.
@@ -56,10 +67,6 @@ typedef struct {
 
   // Buffer for restoring when returning from longjmp().
   jmp_buf setjmp_buffer;
-
-  // Use to release the area allocated by EsfCodecJpegConvertLine() in case of
-  // an error.
-  JSAMPROW scan_line_ptr;
 } EsfCodecJpegErrorManager;
 
 // Methods of accessing input/output data.
@@ -68,8 +75,25 @@ typedef enum {
   kEsfCodecJpegFileIoAccess   // FileIO access
 } EsfCodecJpegAccessType;
 
-// JPEG compress manager structure of libjpeg/libjpeg-turbo.
+// State of a scaled image that is passed to libjpeg one input line at a time
+// with EsfCodecJpegAddScaledLine(). The areas are in the scratch area of the
+// compress manager.
 typedef struct {
+  uint32_t *sums;     // Sums of the samples of the output line being made.
+  int32_t *columns;   // First input column of each output column, and the
+                      // end of the last one.
+  JSAMPLE *strip;     // Output lines not yet passed to libjpeg.
+  JSAMPLE *converted;  // One input line converted to the libjpeg layout.
+  int32_t strip_height;  // Output lines passed to libjpeg at a time.
+  int32_t strip_lines;   // Output lines in strip.
+  int32_t line;          // Output line being made, counted from first_line.
+  int32_t input_line;    // Next input line.
+  int32_t box_first;     // First input line of the output line.
+  int32_t box_end;       // Input line after the last one of the output line.
+} EsfCodecJpegScaler;
+
+// JPEG compress manager structure of libjpeg/libjpeg-turbo.
+typedef struct EsfCodecJpegCompressManager {
   // Pointer to a JPEG compression object.
   struct jpeg_compress_struct *jpeg_object;
 
@@ -87,12 +111,103 @@ typedef struct {
 
   // Stride of the input image (in bytes).
   int32_t stride;
+
+  // Height of the whole input image.
+  int32_t image_height;
+
+  // Region of the input image that is encoded, scaled to
+  // jpeg_object->image_width x output_height pixels. The region equals the
+  // JPEG image size when it is not scaled.
+  int32_t region_x;
+  int32_t region_y;
+  int32_t region_width;
+  int32_t region_height;
+  int32_t output_height;
+
+  // First line of the JPEG image that is encoded; jpeg_object->image_height
+  // lines are encoded from it. Not 0 for a slice of the image.
+  int32_t first_line;
   EsfMemoryManagerHandle
       input_file_handle;  // Input side MemoryManager's FileIO handle.
   EsfCodecJpegAccessType access_type;  // Methods of accessing input/output
                                        // data.
+
+  // Scratch area for the lines passed to libjpeg, kept for the next image.
+  uint8_t *scratch;
+  size_t scratch_size;
+
+  // State of the scaled image.
+  EsfCodecJpegScaler scaler;
+
+  // Compress manager of a scaled image that gets each input line of this one
+  // as it is passed to libjpeg, or NULL.
+  struct EsfCodecJpegCompressManager *thumbnail;
 } EsfCodecJpegCompressManager;
 
+// JPEG encoder context of EsfCodecJpegEncoderCreate(). The compression object
+// keeps its parameters and tables from one image to the next; the image and
+// the destination are set for each image.
+struct EsfCodecJpegEncoder {
+  // JPEG compress manager, also holding the scratch area for the lines.
+  EsfCodecJpegCompressManager *compress_manager;
+
+  // Buffer for writing the JPEG data with FileIO, allocated on first use.
+  uint8_t *write_buffer;
+};
+
+// Output of one JPEG image of EsfCodecJpegEncodeWithThumbnail().
+typedef struct {
+  uint8_t *area;  // Output area when file_handle is 0.
+  EsfMemoryManagerHandle file_handle;  // Opened output FileIO handle, or 0.
+  int32_t size;                        // Size of area.
+} EsfCodecJpegOutputArea;
+
+// A horizontal slice of the image for EsfCodecJpegEncodeSliced(). Each slice
+// is encoded into a JPEG image of its own.
+typedef struct {
+  int32_t first_line;  // First line of the slice in the JPEG image.
+  int32_t lines;       // Number of lines of the slice.
+
+  // JPEG image of the slice, allocated by the worker, and its size.
+  uint8_t *buffer;
+  size_t size;
+
+  // The result of encoding the slice.
+  EsfCodecJpegError result;
+} EsfCodecJpegSlice;
+
+// Work of one thread of EsfCodecJpegEncodeSliced(): slices first, first +
+// step, first + 2 * step and so on.
+typedef struct {
+  const EsfCodecJpegEncParam *enc_param;
+  EsfCodecJpegSlice *slices;
+  int32_t slice_num;
+  int32_t first;
+  int32_t step;
+  // Restart interval of the whole image (in MCUs), 0 for a single slice.
+  unsigned int restart_interval;
+} EsfCodecJpegSliceWorker;
+
+// Number of qualities of the trial encode of EsfCodecJpegEncodeToSize():
+// quality_max, two evenly spaced below it, ESF_CODEC_JPEG_TRIAL_QUALITY_LOW
+// and ESF_CODEC_JPEG_TRIAL_QUALITY_MIN.
+#define ESF_CODEC_JPEG_TRIAL_QUALITY_NUM (5)
+
+// Points of a size model: the trial qualities and one encoded pass.
+#define ESF_CODEC_JPEG_SIZE_MODEL_POINT_NUM \
+  (ESF_CODEC_JPEG_TRIAL_QUALITY_NUM + 1)
+
+// Model of the size of a JPEG image against its quality, used by
+// EsfCodecJpegEncodeToSize(). Sizes of the image at a few qualities, estimated
+// from a trial encode or measured by a pass, are joined by curves on which
+// log(size) is linear in log(scaling), where scaling is the scale factor of
+// the quantization tables for the quality (jpeg_quality_scaling()).
+typedef struct {
+  int32_t quality[ESF_CODEC_JPEG_SIZE_MODEL_POINT_NUM];  // From the highest.
+  double size[ESF_CODEC_JPEG_SIZE_MODEL_POINT_NUM];
+  int32_t point_num;
+} EsfCodecJpegSizeModel;
+
 // """Create a new instance of EsfCodecJpegCompressManager.
 
 // This function allocates memory for the EsfCodecJpegCompressManager structure,
@@ -190,6 +305,33 @@ EsfCodecJpegError EsfCodecJpegSetDestManagerFileIo(
     uint8_t *buffer, size_t size, EsfMemoryManagerHandle output_file_handle,
     EsfCodecJpegCompressManager *compress_manager);
 
+// """Sets Base64 output parameters in the JPEG output manager.
+// JPEG data is collected in buffer and Base64 encoded into the output each
+// time buffer fills up, so that the JPEG image itself is never stored.
+// Args:
+//     buffer (uint8_t *): Buffer for one block of JPEG data. NULL input is
+//       not allowed.
+//     size (size_t): Size of buffer.
+//     base64_output (char *): Output area when output_file_handle is 0,
+//       otherwise a buffer for the Base64 characters of one block. It needs
+//       (size + 2) / 3 * 4 + 5 bytes then. NULL input is not allowed.
+//     base64_output_size (size_t): Size of base64_output.
+//     output_file_handle (EsfMemoryManagerHandle): Output side MemoryManager's
+//       FileIO handle, or 0 when the output area is base64_output itself.
+//     output_size_max (size_t): Size of the output area, including the null
+//       terminator of the Base64 string.
+//     compress_manager (EsfCodecJpegCompressManager *): Pointer to JPEG
+//       compression manager. Null input is not allowed.
+// Returns:
+//     kJpegSuccess: On normal termination, it returns.
+//     kJpegParamError: - If the arguments buffer, base64_output or
+//                          compress_manager are NULL, it returns.
+// """
+EsfCodecJpegError EsfCodecJpegSetDestManagerBase64(
+    uint8_t *buffer, size_t size, char *base64_output,
+    size_t base64_output_size, EsfMemoryManagerHandle output_file_handle,
+    size_t output_size_max, EsfCodecJpegCompressManager *compress_manager);
+
 // """Compresses an image using the JPEG codec.
 
 // This function compresses an image using the JPEG codec. It takes as input
@@ -303,6 +445,293 @@ EsfCodecJpegError EsfCodecJpegEncodeHandleFileIo(
     EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
     const EsfCodecJpegInfo *info, int32_t *jpeg_size);
 
+// """Executes JPEG encoding with Base64 output. Each handle is mapped when
+// the MemoryManager supports it and opened for FileIO otherwise, so any mix of
+// input and output handles is accepted.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     output_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle.
+//     info (const struct EsfCodecJpegInfo *):
+//       Pointer to the JPEG encoding parameters. NULL assignment is not
+//       allowed.
+//     base64_size (int32_t *):
+//       Pointer to store the size of the Base64 string, including the null
+//       terminator. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When info is NULL.
+//                      When the value of info is invalid.
+//                      When base64_size is NULL.
+//                      When input_handle or output_handle is not a
+//                        LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient for
+//       the Base64 string, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleBase64(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    const EsfCodecJpegInfo *info, int32_t *base64_size);
+
+// """Encodes an image in horizontal slices on several threads.
+// The image is cut at MCU row boundaries into slices of restart_interval MCUs,
+// each slice is encoded by a worker with a JPEG compression object of its own,
+// and the entropy-coded data of the slices is joined with RSTn markers into
+// one baseline JPEG image. The calling thread encodes slices as well.
+
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters.
+//       NULL assignment not allowed.
+//     thread_num (int32_t): Number of threads, 1 to
+//       ESF_CODEC_JPEG_THREAD_NUM_MAX.
+//     jpeg_size (int32_t *): Pointer to store the size of the resulting JPEG
+//       image. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When an argument is invalid.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeSliced(
+    const EsfCodecJpegEncParam *enc_param, int32_t thread_num,
+    int32_t *jpeg_size);
+
+// """Creates a JPEG encoder context.
+// Sets the parameters of info to a new compress manager once. The input and
+// output are given for each image.
+
+// Args:
+//     info (const struct EsfCodecJpegInfo *): JPEG encoding parameters. NULL
+//       assignment is not allowed.
+//     encoder (EsfCodecJpegEncoderHandle *): Pointer to store the context.
+//       NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When the value of info is invalid.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+// """
+EsfCodecJpegError EsfCodecJpegCreateEncoder(
+    const EsfCodecJpegInfo *info, EsfCodecJpegEncoderHandle *encoder);
+
+// """Encodes one image with a JPEG encoder context.
+// The input is read from image, or with FileIO when input_file_handle is not
+// 0. The JPEG image is written to output, or with FileIO when
+// output_file_handle is not 0. On an error in the OSS, the compression object
+// is aborted so that the context can encode the next image.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment is not allowed.
+//     image (uint8_t *): Input image when input_file_handle is 0.
+//     input_file_handle (EsfMemoryManagerHandle): Opened input FileIO handle,
+//       or 0.
+//     output (uint8_t *): Output area when output_file_handle is 0.
+//     output_file_handle (EsfMemoryManagerHandle): Opened output FileIO
+//       handle, or 0.
+//     output_size (int32_t): Size of output.
+//     jpeg_size (int32_t *): Pointer to store the size of the resulting JPEG
+//       image. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When the input or output is invalid.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeWithEncoder(
+    EsfCodecJpegEncoderHandle encoder, uint8_t *image,
+    EsfMemoryManagerHandle input_file_handle, uint8_t *output,
+    EsfMemoryManagerHandle output_file_handle, int32_t output_size,
+    int32_t *jpeg_size);
+
+// """Encodes the image of a MemoryManager handle with a JPEG encoder context.
+// Each handle is mapped when the MemoryManager supports it and opened for
+// FileIO otherwise, as EsfCodecJpegEncodeHandleBase64().
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment is not allowed.
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     output_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle.
+//     jpeg_size (int32_t *):
+//       Pointer to store the size of the resulting JPEG image. NULL assignment
+//       is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When input_handle or output_handle is not a
+//                        LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleWithEncoder(
+    EsfCodecJpegEncoderHandle encoder, EsfMemoryManagerHandle input_handle,
+    EsfMemoryManagerHandle output_handle, int32_t *jpeg_size);
+
+// """Encodes the image of a MemoryManager handle into an output area.
+// The input handle is mapped when the MemoryManager supports it and opened
+// for FileIO otherwise, and the JPEG image is written to output directly.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     info (const EsfCodecJpegInfo *): JPEG encoding parameters. NULL
+//       assignment is not allowed.
+//     output (uint8_t *): Output area. NULL assignment is not allowed.
+//     output_size (int32_t): Size of output.
+//     jpeg_size (int32_t *): Pointer to store the size of the resulting JPEG
+//       image. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When the value of info is invalid.
+//                      When input_handle is not a LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the output area is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleToArea(
+    EsfMemoryManagerHandle input_handle, const EsfCodecJpegInfo *info,
+    uint8_t *output, int32_t output_size, int32_t *jpeg_size);
+
+// """Encodes one image and a scaled down copy of it with two JPEG encoder
+// contexts.
+// The input is read once: each line passed to the compress manager of
+// encoder is also added to the scaled image of thumbnail, which must be
+// created for the same input with a scale factor. On an error in the OSS,
+// both compression objects are aborted.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context of the full
+//       size image. NULL assignment is not allowed.
+//     thumbnail (EsfCodecJpegEncoderHandle): JPEG encoder context of the
+//       scaled image. NULL assignment is not allowed.
+//     image (uint8_t *): Input image when input_file_handle is 0.
+//     input_file_handle (EsfMemoryManagerHandle): Opened input FileIO handle,
+//       or 0.
+//     output (const EsfCodecJpegOutputArea *): Output of the full size
+//       image. NULL assignment is not allowed.
+//     thumbnail_output (const EsfCodecJpegOutputArea *): Output of the
+//       scaled image. NULL assignment is not allowed.
+//     jpeg_size (int32_t *): Pointer to store the size of the full size
+//       image. NULL assignment is not allowed.
+//     thumbnail_size (int32_t *): Pointer to store the size of the scaled
+//       image. NULL assignment is not allowed.
+
+// Returns:
+//     The same values as EsfCodecJpegEncodeWithEncoder().
+// """
+EsfCodecJpegError EsfCodecJpegEncodeWithThumbnail(
+    EsfCodecJpegEncoderHandle encoder, EsfCodecJpegEncoderHandle thumbnail,
+    uint8_t *image, EsfMemoryManagerHandle input_file_handle,
+    const EsfCodecJpegOutputArea *output,
+    const EsfCodecJpegOutputArea *thumbnail_output, int32_t *jpeg_size,
+    int32_t *thumbnail_size);
+
+// """Encodes the image of a MemoryManager handle and a thumbnail of it.
+// Creates the JPEG encoder contexts of the two images and encodes them with
+// EsfCodecJpegEncodeWithThumbnail(). Each handle is mapped when the
+// MemoryManager supports it and opened for FileIO otherwise.
+
+// Args:
+//     input_handle (EsfMemoryManagerHandle):
+//       Input side MemoryManager's handle.
+//     output_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle of the full size image.
+//     thumbnail_handle (EsfMemoryManagerHandle):
+//       Output side MemoryManager's handle of the thumbnail.
+//     info (const EsfCodecJpegInfo *): JPEG encoding parameters. NULL
+//       assignment is not allowed.
+//     thumbnail_info (const EsfCodecJpegThumbnailInfo *): Scale factor and
+//       quality of the thumbnail. NULL assignment is not allowed.
+//     jpeg_size (int32_t *): Pointer to store the size of the full size
+//       image. NULL assignment is not allowed.
+//     thumbnail_size (int32_t *): Pointer to store the size of the
+//       thumbnail. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When the value of info or thumbnail_info is invalid.
+//                      When a handle is not a LargeHeap handle.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If an output buffer is insufficient during
+//       JPEG compression, return.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeHandleThumbnail(
+    EsfMemoryManagerHandle input_handle, EsfMemoryManagerHandle output_handle,
+    EsfMemoryManagerHandle thumbnail_handle, const EsfCodecJpegInfo *info,
+    const EsfCodecJpegThumbnailInfo *thumbnail_info, int32_t *jpeg_size,
+    int32_t *thumbnail_size);
+
+// """Encodes an image into a JPEG image of about target_size bytes.
+// The quality is estimated from a size model made by trial encodes of tiles
+// sampled from the region (see EsfCodecJpegEstimateSizeModel()), and the
+// image is encoded once at that quality. When it does not land between
+// (100 - ESF_CODEC_JPEG_TARGET_SIZE_TOLERANCE)% of target_size and
+// target_size, a second pass is made with the size of the first one added
+// to the model. A second pass to a higher quality is encoded behind the
+// first image, which is kept if the second one does not fit, so the image
+// may still be smaller than the tolerance.
+
+// Args:
+//     enc_param (const EsfCodecJpegEncParam *): JPEG encoding parameters.
+//       quality is the highest quality used. NULL assignment is not allowed.
+//     target_size (int32_t): Largest size of the JPEG image. Limited to the
+//       size of the output buffer.
+//     jpeg_size (int32_t *): Pointer to store the size of the resulting JPEG
+//       image. NULL assignment is not allowed.
+//     quality (int32_t *): Pointer to store the quality of the resulting JPEG
+//       image. NULL assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When an argument is invalid.
+//     kJpegOssInternalError: An error occurred internally in the OSS.
+//     kJpegMemAllocError: If memory allocation fails.
+//     kJpegOtherError: Other Errors.
+//     kJpegOutputBufferFullError: If the image does not fit in target_size
+//       after the second pass.
+// """
+EsfCodecJpegError EsfCodecJpegEncodeToSize(
+    const EsfCodecJpegEncParam *enc_param, int32_t target_size,
+    int32_t *jpeg_size, int32_t *quality);
+
+// """Destroys a JPEG encoder context.
+
+// Args:
+//     encoder (EsfCodecJpegEncoderHandle): JPEG encoder context. NULL
+//       assignment is not allowed.
+
+// Returns:
+//     kJpegSuccess: Normal termination.
+//     kJpegParamError: When encoder is NULL.
+// """
+EsfCodecJpegError EsfCodecJpegDestroyEncoder(
+    EsfCodecJpegEncoderHandle encoder);
+
 #ifdef __cplusplus
 }
 #endif
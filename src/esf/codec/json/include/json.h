@@ -72,6 +72,28 @@ typedef EsfJsonHandleImpl* EsfJsonHandle;
 //    kEsfJsonOutOfMemory: Memory allocation failure.
 EsfJsonErrorCode EsfJsonOpen(EsfJsonHandle* handle);
 
+// """Gets the handle of JSON API whose JSON values live in an arena.
+
+// Works like EsfJsonOpen, but every JSON value created through the handle is
+// carved out of a per-handle arena instead of being allocated one by one.
+// EsfJsonClose releases the arena in one step. Suited to the open, build,
+// serialize, close pattern.
+
+// Args:
+//    handle (EsfJsonHandle*): JSON API Handle.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+
+// Note:
+//    Memory freed by the JSON values before EsfJsonClose is not reused, so
+//    long lived handles that are modified repeatedly should use EsfJsonOpen.
+//    JSON values must not be moved between handles.
+EsfJsonErrorCode EsfJsonOpenArena(EsfJsonHandle* handle);
+
 // """Release the handle of JSON API.
 
 // Release allocates memory.
@@ -86,6 +108,28 @@ EsfJsonErrorCode EsfJsonOpen(EsfJsonHandle* handle);
 //    kEsfJsonInvalidArgument: Arg parameter error.
 EsfJsonErrorCode EsfJsonClose(EsfJsonHandle handle);
 
+// """Release all JSON Values of the handle and keep the handle for reuse.
+
+// Equivalent to EsfJsonClose followed by EsfJsonOpen, but the JSON Value
+// container keeps its capacity, a handle opened with EsfJsonOpenArena keeps
+// all of its arena chunks, and the buffer of EsfJsonSerialize is reused while
+// the serialized string fits. A handle reset every cycle by a periodic
+// producer stops allocating once it reaches its steady state size.
+
+// Args:
+//    handle (EsfJsonHandle): JSON API Handle.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonHandleError: Handle not yet acquired error.
+//    kEsfJsonInternalError: Internal error.
+
+// Note:
+//    JSON Value IDs obtained before the reset become invalid, as does the
+//    string returned by EsfJsonSerialize.
+EsfJsonErrorCode EsfJsonReset(EsfJsonHandle handle);
+
 // json
 //  """Converts JSON Value to a string.
 
@@ -716,6 +760,64 @@ EsfJsonErrorCode EsfJsonValueCopy(EsfJsonHandle handle, EsfJsonValue source,
 EsfJsonErrorCode EsfJsonValueTypeGet(EsfJsonHandle handle, EsfJsonValue value,
                                      EsfJsonValueType* type);
 
+// """Retrieves a JSON Value by a JSON Pointer path.
+
+// Resolves a JSON Pointer (RFC 6901) such as "/deployments/0/modules/3/hash"
+// relative to root in a single walk. Only the referenced JSON Value gets a
+// JSON Value ID, the values on the way are not registered.
+
+// Args:
+//    handle (EsfJsonHandle): JSON API Handle.
+//      NULL is not acceptable.
+//    root (EsfJsonValue): JSON Value ID the pointer is relative to.
+//    pointer (const char*): JSON Pointer. "" refers to root itself.
+//      NULL is not acceptable.
+//    value (EsfJsonValue*): JSON Value ID.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error or malformed pointer.
+//    kEsfJsonHandleError: Handle not yet acquired error.
+//    kEsfJsonValueTypeError: The pointer goes through a scalar value.
+//    kEsfJsonValueNotFound: JSON Value not found.
+//    kEsfJsonIndexExceed: Excess of index error.
+//    kEsfJsonValueLimit: JSON Value ID excess error.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+EsfJsonErrorCode EsfJsonPointerGet(EsfJsonHandle handle, EsfJsonValue root,
+                                   const char* pointer, EsfJsonValue* value);
+
+// """Sets a JSON Value at a JSON Pointer path.
+
+// Resolves the parent of the JSON Pointer (RFC 6901) relative to root and sets
+// value there. The parent must exist. If it is an object, the member named by
+// the last token is set like EsfJsonObjectSet. If it is an array, the last
+// token is an index: an existing element is replaced like EsfJsonArrayReplace,
+// and the index equal to the number of elements or "-" appends like
+// EsfJsonArrayAppend.
+
+// Args:
+//    handle (EsfJsonHandle): JSON API Handle.
+//      NULL is not acceptable.
+//    root (EsfJsonValue): JSON Value ID the pointer is relative to.
+//    pointer (const char*): JSON Pointer. "" is not acceptable.
+//      NULL is not acceptable.
+//    value (EsfJsonValue): JSON Value ID to set.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error or malformed pointer.
+//    kEsfJsonInternalError:  Internal error.
+//    kEsfJsonHandleError: Handle not yet acquired error.
+//    kEsfJsonValueTypeError: The pointer goes through a scalar value.
+//    kEsfJsonValueNotFound: JSON Value not found.
+//    kEsfJsonIndexExceed: Excess of index error.
+//    kEsfJsonParentAlreadyExists: Parent already exists error.
+//    kEsfJsonValueDuplicated: Duplicate EsfJsonValue error.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+EsfJsonErrorCode EsfJsonPointerSet(EsfJsonHandle handle, EsfJsonValue root,
+                                   const char* pointer, EsfJsonValue value);
+
 #ifdef __cplusplus
 }
 #endif
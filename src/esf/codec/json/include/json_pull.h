@@ -0,0 +1,204 @@
+/*
+* SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef ESF_CODEC_JSON_JSON_PULL_H_
+#define ESF_CODEC_JSON_JSON_PULL_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "json.h"
+#include "memory_manager.h"
+
+// Handle of a pull parser.
+typedef struct EsfJsonPullParserImpl* EsfJsonPullParser;
+
+// Events reported by EsfJsonPullNext.
+typedef enum EsfJsonPullEvent {
+  kEsfJsonPullEventObjectBegin,  // '{'
+  kEsfJsonPullEventObjectEnd,    // '}'
+  kEsfJsonPullEventArrayBegin,   // '['
+  kEsfJsonPullEventArrayEnd,     // ']'
+  kEsfJsonPullEventKey,          // Member name. Use EsfJsonPullGetString.
+  kEsfJsonPullEventString,       // Use EsfJsonPullGetString.
+  kEsfJsonPullEventNumber,       // Use EsfJsonPullGetNumber.
+  kEsfJsonPullEventBoolean,      // Use EsfJsonPullGetBoolean.
+  kEsfJsonPullEventNull,
+  kEsfJsonPullEventEndOfDocument,
+} EsfJsonPullEvent;
+
+// """Starts pull parsing of the JSON string stored in a Memory Manager handle.
+//
+// Unlike EsfJsonDeserialize, the string is not loaded into memory as a whole
+// and no JSON Value is built. The parser reads the string incrementally and
+// reports it as a sequence of events through EsfJsonPullNext. Only the values
+// the caller asks for with EsfJsonPullMaterialize become JSON Values.
+//
+// Args:
+// mem_handle (EsfMemoryManagerHandle): Memory Manager handle storing the JSON
+// string
+// mem_size (size_t): Size of the JSON string in bytes. Parsing also stops at
+// a NULL terminator within this size.
+// parser (EsfJsonPullParser*): Created parser
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - If mem_handle supports EsfMemoryManagerMap, it is mapped until
+// EsfJsonPullClose and the string is read from its beginning.
+// - Otherwise pass mem_handle in a state already opened with
+// EsfMemoryManagerFopen, with the seek position at the beginning of the
+// string. The string is read with EsfMemoryManagerFread in blocks of
+// CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE bytes.
+// - Do not access mem_handle until EsfJsonPullClose is called.
+// """
+EsfJsonErrorCode EsfJsonPullOpen(EsfMemoryManagerHandle mem_handle,
+                                 size_t mem_size, EsfJsonPullParser* parser);
+
+// """Starts pull parsing of a JSON string in memory.
+//
+// Same as EsfJsonPullOpen, but the string is read directly from str.
+//
+// Args:
+// str (const char*): JSON string
+// len (size_t): Length of str. Parsing also stops at a NULL terminator within
+// this length.
+// parser (EsfJsonPullParser*): Created parser
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - str must stay valid until EsfJsonPullClose is called.
+// """
+EsfJsonErrorCode EsfJsonPullOpenString(const char* str, size_t len,
+                                       EsfJsonPullParser* parser);
+
+// """Releases a pull parser.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - JSON Values obtained with EsfJsonPullMaterialize remain valid.
+// """
+EsfJsonErrorCode EsfJsonPullClose(EsfJsonPullParser parser);
+
+// """Advances the parser to the next event.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+// event (EsfJsonPullEvent*): Event read
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - If the string is not valid JSON, kEsfJsonInvalidArgument is returned and
+// every following call returns it as well.
+// - After kEsfJsonPullEventEndOfDocument, the same event is returned again.
+// """
+EsfJsonErrorCode EsfJsonPullNext(EsfJsonPullParser parser,
+                                 EsfJsonPullEvent* event);
+
+// """Gets the string of the current kEsfJsonPullEventKey or
+// kEsfJsonPullEventString event.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+// str (const char**): Unescaped, NULL terminated string
+// len (size_t*): Length of str excluding the NULL terminator. NULL is
+// acceptable.
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - str is valid until the next call of EsfJsonPullNext.
+// """
+EsfJsonErrorCode EsfJsonPullGetString(EsfJsonPullParser parser,
+                                      const char** str, size_t* len);
+
+// """Gets the number of the current kEsfJsonPullEventNumber event.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+// num (double*): Number
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+// """
+EsfJsonErrorCode EsfJsonPullGetNumber(EsfJsonPullParser parser, double* num);
+
+// """Gets the value of the current kEsfJsonPullEventBoolean event.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+// boolean (bool*): Value
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+// """
+EsfJsonErrorCode EsfJsonPullGetBoolean(EsfJsonPullParser parser,
+                                       bool* boolean);
+
+// """Skips the rest of the current Object or Array.
+//
+// Call this right after kEsfJsonPullEventObjectBegin or
+// kEsfJsonPullEventArrayBegin. The parser moves past the matching end without
+// reporting the events in between, so the next EsfJsonPullNext returns the
+// event that follows the Object or Array.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - The skipped text is only scanned for brackets and strings, it is not
+// validated.
+// - Calling this API after any other event does nothing.
+// """
+EsfJsonErrorCode EsfJsonPullSkip(EsfJsonPullParser parser);
+
+// """Builds the current value as a JSON Value.
+//
+// After a scalar event, the JSON Value holds that scalar. After
+// kEsfJsonPullEventObjectBegin or kEsfJsonPullEventArrayBegin, the parser
+// reads up to the matching end and the JSON Value holds the whole Object or
+// Array. The next EsfJsonPullNext returns the event that follows it.
+// The handle must be obtained with EsfJsonOpen before calling this API.
+//
+// Args:
+// parser (EsfJsonPullParser): Parser obtained with EsfJsonPullOpen
+// handle (EsfJsonHandle): Handle for the JSON API
+// value (EsfJsonValue*): Created JSON Value
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - kEsfJsonPullEventKey, the end events and kEsfJsonPullEventEndOfDocument
+// cannot be materialized. kEsfJsonInvalidArgument is returned for them.
+// - The created JSON Value is released by EsfJsonClose.
+// """
+EsfJsonErrorCode EsfJsonPullMaterialize(EsfJsonPullParser parser,
+                                        EsfJsonHandle handle,
+                                        EsfJsonValue* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ESF_CODEC_JSON_JSON_PULL_H_
@@ -0,0 +1,130 @@
+/*
+* SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef ESF_CODEC_JSON_JSON_STRUCT_H_
+#define ESF_CODEC_JSON_JSON_STRUCT_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "json.h"
+
+// """Gets the size [Byte] of a member of a structure.
+//
+// Args:
+// type : The type name of the structure.
+// member : The member name.
+//
+// Examples:
+// ESF_JSON_STRUCT_MEMBER_SIZEOF(Structure, member);
+// """
+#define ESF_JSON_STRUCT_MEMBER_SIZEOF(type, member) \
+  (sizeof(((type*)NULL)->member))
+
+// Type of a structure member.
+typedef enum EsfJsonStructMemberType {
+  kEsfJsonStructMemberBoolean,  // bool, JSON boolean.
+  kEsfJsonStructMemberInt32,    // int32_t, JSON number.
+  kEsfJsonStructMemberUint32,   // uint32_t, JSON number.
+  kEsfJsonStructMemberReal,     // double, JSON number.
+  kEsfJsonStructMemberString,   // char array, JSON string.
+  kEsfJsonStructMemberObject,   // Nested structure, JSON object.
+} EsfJsonStructMemberType;
+
+struct EsfJsonStructInfo;
+
+// Describes one member of a structure and the JSON object member it maps to.
+typedef struct EsfJsonStructMemberInfo {
+  // Name of the JSON object member.
+  const char* name;
+
+  // Type of the structure member.
+  EsfJsonStructMemberType type;
+
+  // Value obtained using offsetof().
+  size_t offset;
+
+  // Size of the structure member. For kEsfJsonStructMemberString it is the
+  // size of the char array including the NULL terminator.
+  // Use ESF_JSON_STRUCT_MEMBER_SIZEOF to set the value of this member.
+  size_t size;
+
+  // Layout of the nested structure for kEsfJsonStructMemberObject, otherwise
+  // NULL.
+  const struct EsfJsonStructInfo* object;
+} EsfJsonStructMemberInfo;
+
+// Describes a structure.
+typedef struct EsfJsonStructInfo {
+  // The length of the "items" array.
+  size_t items_num;
+
+  // The array that stores member information.
+  const EsfJsonStructMemberInfo* items;
+} EsfJsonStructInfo;
+
+// """Converts a structure to a JSON string.
+//
+// Writes the JSON object described by info directly from the structure in a
+// single pass. No JSON Value is created, so no handle is needed. Members are
+// written in the order of info->items.
+//
+// Args:
+// info (const EsfJsonStructInfo*): Layout of the structure
+// data (const void*): Structure to convert
+// buf (char*): Buffer for the NULL terminated JSON string. NULL is acceptable
+// if buf_size is 0.
+// buf_size (size_t): Size of buf
+// len (size_t*): Length of the JSON string excluding the NULL terminator
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - len is set even if buf is too small. In that case kEsfJsonOutOfMemory is
+// returned and buf holds as much of the string as fits. Call with buf_size 0
+// to get the size to allocate.
+// - A string member must be NULL terminated within its size.
+// - kEsfJsonInvalidArgument is returned for real numbers that are NaN or
+// infinite, which JSON cannot represent.
+// """
+EsfJsonErrorCode EsfJsonStructEncode(const EsfJsonStructInfo* info,
+                                     const void* data, char* buf,
+                                     size_t buf_size, size_t* len);
+
+// """Converts a JSON string to a structure.
+//
+// Reads the JSON object with a pull parser and stores the members described
+// by info directly into the structure. No JSON Value is created, so no handle
+// is needed.
+//
+// Args:
+// info (const EsfJsonStructInfo*): Layout of the structure
+// str (const char*): JSON string
+// len (size_t): Length of str. Parsing also stops at a NULL terminator within
+// this length.
+// data (void*): Structure to store into
+//
+// Returns:
+// enum EsfJsonErrorCode: Error code indicating the processing result
+//
+// Notes:
+// - JSON object members not described by info are skipped. Structure members
+// missing from the JSON object are left unchanged.
+// - kEsfJsonValueTypeError is returned if a JSON value does not match the type
+// of its structure member, including integers out of range and strings that
+// do not fit in their char array. data may be partially updated on error.
+// """
+EsfJsonErrorCode EsfJsonStructDecode(const EsfJsonStructInfo* info,
+                                     const char* str, size_t len, void* data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ESF_CODEC_JSON_JSON_STRUCT_H_
@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "json_internal.h"
 #include "parson/lib/parson.h"
@@ -18,6 +19,8 @@
 static const EsfJsonHandleImpl kEsfJsonHandleDefault = {
     .json_value = NULL,
     .serialized_str = NULL,
+    .arena = NULL,
+    .serialized_capacity = 0,
 };
 
 EsfJsonErrorCode EsfJsonOpen(EsfJsonHandle* handle) {
@@ -53,6 +56,35 @@ EsfJsonErrorCode EsfJsonOpen(EsfJsonHandle* handle) {
   return kEsfJsonSuccess;
 }
 
+EsfJsonErrorCode EsfJsonOpenArena(EsfJsonHandle* handle) {
+  ESF_JSON_TRACE("entry");
+  // Parameter check.
+  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
+    ESF_JSON_ERR("handle NULL.");
+    return kEsfJsonInvalidArgument;
+  }
+
+  EsfJsonArena* arena = NULL;
+  EsfJsonErrorCode ret = EsfJsonArenaCreate(&arena);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonArenaCreate func failed. ret = %u.", ret);
+    return ret;
+  }
+
+  EsfJsonHandle tmp_handle = ESF_JSON_HANDLE_INITIALIZER;
+  ret = EsfJsonOpen(&tmp_handle);
+  if (ret != kEsfJsonSuccess) {
+    EsfJsonArenaDestroy(arena);
+    ESF_JSON_ERR("EsfJsonOpen func failed. ret = %u.", ret);
+    return ret;
+  }
+  tmp_handle->arena = arena;
+
+  *handle = tmp_handle;
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
 EsfJsonErrorCode EsfJsonClose(EsfJsonHandle handle) {
   ESF_JSON_TRACE("entry");
   // Parameter check.
@@ -62,6 +94,24 @@ EsfJsonErrorCode EsfJsonClose(EsfJsonHandle handle) {
   }
 
   EsfJsonErrorCode ret = kEsfJsonInternalError;
+  if (handle->arena != NULL) {
+    // Every JSON value lives in the arena, so there is nothing to free one by
+    // one.
+    ret = EsfJsonValueContainerDiscard(handle->json_value);
+    if (ret != kEsfJsonSuccess) {
+      ESF_JSON_ERR(
+          "EsfJsonValueContainerDiscard func failed. ret = %u, "
+          "handle->json_value = %p",
+          ret, handle->json_value);
+    }
+    EsfJsonArenaDestroy(handle->arena);
+    free(handle->serialized_str);
+    ESF_JSON_DEBUG("handle close %p", handle);
+    free(handle);
+    ESF_JSON_TRACE("exit");
+    return kEsfJsonSuccess;
+  }
+
   // Free handle processing
   ret = EsfJsonValueContainerFree(handle->json_value);
   if (ret != kEsfJsonSuccess) {
@@ -71,18 +121,46 @@ EsfJsonErrorCode EsfJsonClose(EsfJsonHandle handle) {
         ret, handle->json_value);
   }
 
-  if (handle->serialized_str != NULL) {
-    json_free_serialized_string(handle->serialized_str);
-  }
+  free(handle->serialized_str);
   ESF_JSON_DEBUG("handle close %p", handle);
   free(handle);
   ESF_JSON_TRACE("exit");
   return kEsfJsonSuccess;
 }
 
+EsfJsonErrorCode EsfJsonReset(EsfJsonHandle handle) {
+  ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
+  // Parameter check.
+  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
+    ESF_JSON_ERR("Parameter error. handle = %p", handle);
+    return kEsfJsonHandleError;
+  }
+
+  EsfJsonErrorCode ret = kEsfJsonInternalError;
+  // JSON values of an arena are released with the arena in one step.
+  ret = EsfJsonValueContainerReset(handle->json_value, handle->arena == NULL);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR(
+        "EsfJsonValueContainerReset func failed. ret = %u, handle->json_value "
+        "= %p",
+        ret, handle->json_value);
+    return kEsfJsonInternalError;
+  }
+
+  if (handle->arena != NULL) {
+    EsfJsonArenaReset(handle->arena);
+  }
+
+  ESF_JSON_DEBUG("handle reset %p", handle);
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
 EsfJsonErrorCode EsfJsonSerialize(EsfJsonHandle handle, EsfJsonValue value,
                                   const char** str) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -105,20 +183,44 @@ EsfJsonErrorCode EsfJsonSerialize(EsfJsonHandle handle, EsfJsonValue value,
     return ret;
   }
 
-  char* serialized_str = NULL;
-  serialized_str = json_serialize_to_string(data);
-  if (serialized_str == NULL) {
-    ESF_JSON_ERR("json_serialize_to_string func failed.");
-    return kEsfJsonOutOfMemory;
-  }
-  ret = EsfJsonSerializeFree(handle);
-  if (ret != kEsfJsonSuccess) {
-    json_free_serialized_string(serialized_str);
-    ESF_JSON_ERR("EsfJsonSerializeFree func failed. ret = %u", ret);
-    return kEsfJsonHandleError;
+  size_t serialized_size = json_serialization_size(data);
+  if (serialized_size == 0) {
+    ESF_JSON_ERR("json_serialization_size func failed. data = %p", data);
+    return kEsfJsonInternalError;
   }
+  if (handle->serialized_str != NULL &&
+      serialized_size <= handle->serialized_capacity) {
+    // Reuse the buffer of the previous serialization.
+    if (json_serialize_to_buffer(data, handle->serialized_str,
+                                 handle->serialized_capacity) != JSONSuccess) {
+      ESF_JSON_ERR("json_serialize_to_buffer func failed. data = %p", data);
+      return kEsfJsonInternalError;
+    }
+  } else {
+    // The buffer is taken from stdlib even for an arena handle, so that it
+    // is kept across EsfJsonReset.
+    char* serialized_str = (char*)malloc(serialized_size);
+    if (serialized_str == NULL) {
+      ESF_JSON_ERR("Failed to allocate memory for serialized_str. size = %zu",
+                   serialized_size);
+      return kEsfJsonOutOfMemory;
+    }
+    if (json_serialize_to_buffer(data, serialized_str, serialized_size) !=
+        JSONSuccess) {
+      free(serialized_str);
+      ESF_JSON_ERR("json_serialize_to_buffer func failed. data = %p", data);
+      return kEsfJsonInternalError;
+    }
+    ret = EsfJsonSerializeFree(handle);
+    if (ret != kEsfJsonSuccess) {
+      free(serialized_str);
+      ESF_JSON_ERR("EsfJsonSerializeFree func failed. ret = %u", ret);
+      return kEsfJsonHandleError;
+    }
 
-  handle->serialized_str = serialized_str;
+    handle->serialized_str = serialized_str;
+    handle->serialized_capacity = serialized_size;
+  }
 
   *str = handle->serialized_str;
   ESF_JSON_DEBUG("JSON Value serialize ID = %" PRId32 ", data = %p", value,
@@ -129,6 +231,7 @@ EsfJsonErrorCode EsfJsonSerialize(EsfJsonHandle handle, EsfJsonValue value,
 
 EsfJsonErrorCode EsfJsonSerializeFree(EsfJsonHandle handle) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -138,8 +241,9 @@ EsfJsonErrorCode EsfJsonSerializeFree(EsfJsonHandle handle) {
   if (handle->serialized_str == NULL) {
     // Do nothing.
   } else {
-    json_free_serialized_string(handle->serialized_str);
+    free(handle->serialized_str);
     handle->serialized_str = NULL;
+    handle->serialized_capacity = 0;
   }
 
   ESF_JSON_TRACE("exit");
@@ -149,6 +253,7 @@ EsfJsonErrorCode EsfJsonSerializeFree(EsfJsonHandle handle) {
 EsfJsonErrorCode EsfJsonDeserialize(EsfJsonHandle handle, const char* str,
                                     EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -188,6 +293,7 @@ EsfJsonErrorCode EsfJsonDeserialize(EsfJsonHandle handle, const char* str,
 
 EsfJsonErrorCode EsfJsonObjectInit(EsfJsonHandle handle, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -228,6 +334,7 @@ EsfJsonErrorCode EsfJsonObjectInit(EsfJsonHandle handle, EsfJsonValue* value) {
 EsfJsonErrorCode EsfJsonObjectGet(EsfJsonHandle handle, EsfJsonValue parent,
                                   const char* key, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -287,6 +394,7 @@ EsfJsonErrorCode EsfJsonObjectGet(EsfJsonHandle handle, EsfJsonValue parent,
 EsfJsonErrorCode EsfJsonObjectSet(EsfJsonHandle handle, EsfJsonValue parent,
                                   const char* key, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -378,6 +486,7 @@ EsfJsonErrorCode EsfJsonObjectSet(EsfJsonHandle handle, EsfJsonValue parent,
 EsfJsonErrorCode EsfJsonObjectRemove(EsfJsonHandle handle, EsfJsonValue parent,
                                      const char* key) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -450,6 +559,7 @@ EsfJsonErrorCode EsfJsonObjectRemove(EsfJsonHandle handle, EsfJsonValue parent,
 
 EsfJsonErrorCode EsfJsonObjectClear(EsfJsonHandle handle, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -535,6 +645,7 @@ EsfJsonErrorCode EsfJsonObjectClear(EsfJsonHandle handle, EsfJsonValue value) {
 
 int32_t EsfJsonObjectCount(EsfJsonHandle handle, EsfJsonValue parent) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -578,6 +689,7 @@ EsfJsonErrorCode EsfJsonObjectGetAt(EsfJsonHandle handle, EsfJsonValue parent,
                                     int32_t index, const char** key,
                                     EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -650,6 +762,7 @@ EsfJsonErrorCode EsfJsonObjectGetAt(EsfJsonHandle handle, EsfJsonValue parent,
 
 EsfJsonErrorCode EsfJsonArrayInit(EsfJsonHandle handle, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -691,6 +804,7 @@ EsfJsonErrorCode EsfJsonArrayInit(EsfJsonHandle handle, EsfJsonValue* value) {
 EsfJsonErrorCode EsfJsonArrayGet(EsfJsonHandle handle, EsfJsonValue parent,
                                  int32_t index, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -754,6 +868,7 @@ EsfJsonErrorCode EsfJsonArrayGet(EsfJsonHandle handle, EsfJsonValue parent,
 EsfJsonErrorCode EsfJsonArrayAppend(EsfJsonHandle handle, EsfJsonValue parent,
                                     EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -817,6 +932,7 @@ EsfJsonErrorCode EsfJsonArrayAppend(EsfJsonHandle handle, EsfJsonValue parent,
 EsfJsonErrorCode EsfJsonArrayReplace(EsfJsonHandle handle, EsfJsonValue parent,
                                      int32_t index, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -916,6 +1032,7 @@ EsfJsonErrorCode EsfJsonArrayReplace(EsfJsonHandle handle, EsfJsonValue parent,
 EsfJsonErrorCode EsfJsonArrayRemove(EsfJsonHandle handle, EsfJsonValue parent,
                                     int32_t index) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -991,6 +1108,7 @@ EsfJsonErrorCode EsfJsonArrayRemove(EsfJsonHandle handle, EsfJsonValue parent,
 
 EsfJsonErrorCode EsfJsonArrayClear(EsfJsonHandle handle, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1075,6 +1193,7 @@ EsfJsonErrorCode EsfJsonArrayClear(EsfJsonHandle handle, EsfJsonValue value) {
 
 int32_t EsfJsonArrayCount(EsfJsonHandle handle, EsfJsonValue parent) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1118,6 +1237,7 @@ int32_t EsfJsonArrayCount(EsfJsonHandle handle, EsfJsonValue parent) {
 EsfJsonErrorCode EsfJsonStringInit(EsfJsonHandle handle, const char* str,
                                    EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1159,6 +1279,7 @@ EsfJsonErrorCode EsfJsonStringInit(EsfJsonHandle handle, const char* str,
 EsfJsonErrorCode EsfJsonStringGet(EsfJsonHandle handle, EsfJsonValue value,
                                   const char** str) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1197,6 +1318,7 @@ EsfJsonErrorCode EsfJsonStringGet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonStringSet(EsfJsonHandle handle, EsfJsonValue value,
                                   const char* str) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1264,6 +1386,7 @@ EsfJsonErrorCode EsfJsonStringSet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonIntegerInit(EsfJsonHandle handle, int32_t num,
                                     EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1309,6 +1432,7 @@ EsfJsonErrorCode EsfJsonIntegerInit(EsfJsonHandle handle, int32_t num,
 EsfJsonErrorCode EsfJsonRealInit(EsfJsonHandle handle, double num,
                                  EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1351,6 +1475,7 @@ EsfJsonErrorCode EsfJsonRealInit(EsfJsonHandle handle, double num,
 EsfJsonErrorCode EsfJsonIntegerGet(EsfJsonHandle handle, EsfJsonValue value,
                                    int32_t* num) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1391,6 +1516,7 @@ EsfJsonErrorCode EsfJsonIntegerGet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonRealGet(EsfJsonHandle handle, EsfJsonValue value,
                                 double* num) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1430,6 +1556,7 @@ EsfJsonErrorCode EsfJsonRealGet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonIntegerSet(EsfJsonHandle handle, EsfJsonValue value,
                                    int32_t num) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1496,6 +1623,7 @@ EsfJsonErrorCode EsfJsonIntegerSet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonRealSet(EsfJsonHandle handle, EsfJsonValue value,
                                 double num) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1558,6 +1686,7 @@ EsfJsonErrorCode EsfJsonRealSet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonBooleanInit(EsfJsonHandle handle, bool boolean,
                                     EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1604,6 +1733,7 @@ EsfJsonErrorCode EsfJsonBooleanInit(EsfJsonHandle handle, bool boolean,
 EsfJsonErrorCode EsfJsonBooleanGet(EsfJsonHandle handle, EsfJsonValue value,
                                    bool* boolean) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1644,6 +1774,7 @@ EsfJsonErrorCode EsfJsonBooleanGet(EsfJsonHandle handle, EsfJsonValue value,
 EsfJsonErrorCode EsfJsonBooleanSet(EsfJsonHandle handle, EsfJsonValue value,
                                    bool boolean) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1710,6 +1841,7 @@ EsfJsonErrorCode EsfJsonBooleanSet(EsfJsonHandle handle, EsfJsonValue value,
 
 EsfJsonErrorCode EsfJsonNullInit(EsfJsonHandle handle, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1750,6 +1882,7 @@ EsfJsonErrorCode EsfJsonNullInit(EsfJsonHandle handle, EsfJsonValue* value) {
 
 EsfJsonErrorCode EsfJsonNullSet(EsfJsonHandle handle, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1812,6 +1945,7 @@ EsfJsonErrorCode EsfJsonNullSet(EsfJsonHandle handle, EsfJsonValue value) {
 EsfJsonErrorCode EsfJsonValueCopy(EsfJsonHandle handle, EsfJsonValue source,
                                   EsfJsonValue* destination) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1864,6 +1998,7 @@ EsfJsonErrorCode EsfJsonValueCopy(EsfJsonHandle handle, EsfJsonValue source,
 EsfJsonErrorCode EsfJsonValueTypeGet(EsfJsonHandle handle, EsfJsonValue value,
                                      EsfJsonValueType* type) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   // Parameter check.
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("Parameter error. handle = %p", handle);
@@ -1897,3 +2032,190 @@ EsfJsonErrorCode EsfJsonValueTypeGet(EsfJsonHandle handle, EsfJsonValue value,
   ESF_JSON_TRACE("exit");
   return kEsfJsonSuccess;
 }
+
+EsfJsonErrorCode EsfJsonPointerGet(EsfJsonHandle handle, EsfJsonValue root,
+                                   const char* pointer, EsfJsonValue* value) {
+  ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
+  // Parameter check.
+  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
+    ESF_JSON_ERR("Parameter error. handle = %p", handle);
+    return kEsfJsonHandleError;
+  }
+
+  if (pointer == NULL || value == NULL) {
+    ESF_JSON_ERR("Parameter error. pointer = %p, value = %p", pointer, value);
+    return kEsfJsonInvalidArgument;
+  }
+
+  JSON_Value* data = NULL;
+  EsfJsonErrorCode ret = kEsfJsonInternalError;
+  ret = EsfJsonValueFind(handle->json_value, root, &data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR(
+        "EsfJsonValueFind func failed. ret = %u, handle->json_value = %p, "
+        "root = %" PRId32 "",
+        ret, handle->json_value, root);
+    return ret;
+  }
+
+  JSON_Value* find_data = NULL;
+  ret = EsfJsonPointerResolve(data, pointer, strlen(pointer), &find_data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonPointerResolve func failed. ret = %u, pointer = %s",
+                 ret, pointer);
+    return ret;
+  }
+
+  EsfJsonValue value_id = ESF_JSON_VALUE_INVALID;
+  // Add to handle if JSON Value not managed.
+  ret = EsfJsonValueNotManagedAdd(handle->json_value, find_data, &value_id);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR(
+        "EsfJsonValueNotManagedAdd func failed. ret = %u, handle->json_value = "
+        "%p, find_data = %p.",
+        ret, handle->json_value, find_data);
+    return ret;
+  }
+
+  *value = value_id;
+  ESF_JSON_DEBUG("JSON Pointer Get Info root ID = %" PRId32
+                 ", pointer = %s, get ID = %" PRId32 "",
+                 root, pointer, value_id);
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPointerSet(EsfJsonHandle handle, EsfJsonValue root,
+                                   const char* pointer, EsfJsonValue value) {
+  ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
+  // Parameter check.
+  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
+    ESF_JSON_ERR("Parameter error. handle = %p", handle);
+    return kEsfJsonHandleError;
+  }
+
+  if (pointer == NULL || pointer[0] != '/') {
+    ESF_JSON_ERR("Parameter error. pointer = %p", pointer);
+    return kEsfJsonInvalidArgument;
+  }
+
+  JSON_Value* root_data = NULL;
+  EsfJsonErrorCode ret = kEsfJsonInternalError;
+  ret = EsfJsonValueFind(handle->json_value, root, &root_data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR(
+        "EsfJsonValueFind func failed. ret = %u, handle->json_value = %p, "
+        "root = %" PRId32 "",
+        ret, handle->json_value, root);
+    return ret;
+  }
+
+  // Everything before the last "/" refers to the parent.
+  const char* last = strrchr(pointer, '/');
+  JSON_Value* parent_data = NULL;
+  ret = EsfJsonPointerResolve(root_data, pointer, (size_t)(last - pointer),
+                              &parent_data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonPointerResolve func failed. ret = %u, pointer = %s",
+                 ret, pointer);
+    return ret;
+  }
+
+  JSON_Value* data = NULL;
+  ret = EsfJsonValueNotHaveParentGet(handle->json_value, value, &data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR(
+        "EsfJsonValueNotHaveParentGet func failed. ret = %u handle->json_value "
+        "= %p, value = %" PRId32 "",
+        ret, handle->json_value, value);
+    return ret;
+  }
+
+  if (!EsfJsonCanJsonAddToJson(handle->json_value, data, parent_data)) {
+    ESF_JSON_ERR(
+        "EsfJsonCanJsonAddToJson func return false handle->json_value = %p, "
+        "data = %p, parent_data = %p.",
+        handle->json_value, data, parent_data);
+    return kEsfJsonValueDuplicated;
+  }
+
+  size_t token_len = strlen(last + 1);
+  char* token = (char*)malloc(token_len + 1);
+  if (token == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for token.");
+    return kEsfJsonOutOfMemory;
+  }
+  ret = EsfJsonPointerTokenDecode(last + 1, token_len, token);
+  if (ret != kEsfJsonSuccess) {
+    free(token);
+    return ret;
+  }
+
+  JSON_Value* tmp_data = NULL;
+  JSON_Object* object_data = json_value_get_object(parent_data);
+  JSON_Array* array_data = json_value_get_array(parent_data);
+  int32_t index = 0;
+  if (object_data != NULL) {
+    tmp_data = json_object_get_value(object_data, token);
+  } else if (array_data != NULL) {
+    size_t count = json_array_get_count(array_data);
+    if (strcmp(token, "-") == 0) {
+      index = (int32_t)count;
+    } else {
+      ret = EsfJsonPointerIndexParse(token, &index);
+    }
+    if (ret == kEsfJsonSuccess && (size_t)index > count) {
+      ESF_JSON_ERR("Array index out of range. index = %" PRId32, index);
+      ret = kEsfJsonIndexExceed;
+    }
+    if (ret == kEsfJsonSuccess && (size_t)index < count) {
+      tmp_data = json_array_get_value(array_data, (size_t)index);
+    }
+  } else {
+    ESF_JSON_ERR("Parent is not a container. parent_data = %p.", parent_data);
+    ret = kEsfJsonValueTypeError;
+  }
+
+  if (ret == kEsfJsonSuccess && tmp_data != NULL) {
+    // Recursive deletion JSON value.
+    ret = EsfJsonValueRecursiveRemove(handle->json_value, tmp_data);
+    if (ret == kEsfJsonSuccess) {
+      ret = EsfJsonValueLookupRemove(handle->json_value, tmp_data);
+    }
+    if (ret != kEsfJsonSuccess) {
+      ESF_JSON_ERR(
+          "Failed to remove the old JSON value. ret = %u, handle->json_value "
+          "= %p, tmp_data = %p",
+          ret, handle->json_value, tmp_data);
+      ret = kEsfJsonInternalError;
+    }
+  }
+
+  if (ret == kEsfJsonSuccess) {
+    JSON_Status parson_ret = JSONSuccess;
+    if (object_data != NULL) {
+      parson_ret = json_object_set_value(object_data, token, data);
+    } else if (tmp_data != NULL) {
+      parson_ret = json_array_replace_value(array_data, (size_t)index, data);
+    } else {
+      parson_ret = json_array_append_value(array_data, data);
+    }
+    if (parson_ret == JSONFailure) {
+      ESF_JSON_ERR("Failed to set the JSON value. parent_data = %p, data = %p",
+                   parent_data, data);
+      ret = kEsfJsonOutOfMemory;
+    }
+  }
+  free(token);
+  if (ret != kEsfJsonSuccess) {
+    return ret;
+  }
+
+  ESF_JSON_DEBUG("JSON Pointer Set Info root ID = %" PRId32
+                 " pointer = %s Set ID = %" PRId32 "",
+                 root, pointer, value);
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
@@ -0,0 +1,304 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "json_arena.h"
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "json_internal.h"
+#include "parson/lib/parson.h"
+
+// Alignment of every arena allocation.
+#define ESF_JSON_ARENA_ALIGN (alignof(max_align_t))
+#define ESF_JSON_ARENA_ROUND_UP(size) \
+  (((size) + ESF_JSON_ARENA_ALIGN - 1) & ~(ESF_JSON_ARENA_ALIGN - 1))
+// Chunks double in size up to this many times ESF_JSON_ARENA_CHUNK_SIZE, which
+// keeps the chunk list short for large documents.
+#define ESF_JSON_ARENA_CHUNK_GROWTH_MAX (16)
+// Allocations larger than this get a chunk of their own.
+#define ESF_JSON_ARENA_LARGE_MIN (ESF_JSON_ARENA_CHUNK_SIZE / 4)
+// Chunks of large allocations are rounded up to this, so that one still fits
+// when the allocation grows a little from one reset to the next.
+#define ESF_JSON_ARENA_LARGE_ROUND_UP(size)                       \
+  (((size) + ESF_JSON_ARENA_LARGE_MIN - 1) / ESF_JSON_ARENA_LARGE_MIN * \
+   ESF_JSON_ARENA_LARGE_MIN)
+
+typedef struct EsfJsonArenaChunk EsfJsonArenaChunk;
+
+// Memory block that allocations are carved from.
+struct EsfJsonArenaChunk {
+  // Next chunk of the same list.
+  EsfJsonArenaChunk* next;
+  // Size of buf.
+  size_t capacity;
+  // Bytes of buf in use.
+  size_t used;
+  // Offset of the most recent allocation. Freeing it gives the space back.
+  size_t last;
+  alignas(max_align_t) unsigned char buf[];
+};
+
+// A reset rewinds the chunks instead of freeing them. Small allocations fill
+// the small chunks in list order and each large allocation takes the next
+// large chunk, so a workload that repeats after a reset is served by the same
+// chunks without allocating again.
+struct EsfJsonArena {
+  // Chunks serving small allocations, in the order they were added.
+  EsfJsonArenaChunk* small_head;
+  // Small chunk being filled. NULL until the first small allocation after a
+  // reset.
+  EsfJsonArenaChunk* small_current;
+  // Chunks holding one large allocation each, in the order they were taken.
+  EsfJsonArenaChunk* large_head;
+  // Link to the first large chunk not taken since the last reset.
+  EsfJsonArenaChunk** large_next;
+  // Capacity of the next small allocation chunk.
+  size_t next_capacity;
+};
+
+// Arena that parson allocations of the calling thread go to. NULL means stdlib.
+static _Thread_local EsfJsonArena* s_current_arena = NULL;
+
+static pthread_once_t s_allocator_once = PTHREAD_ONCE_INIT;
+
+// """Allocate a chunk with room for capacity bytes.
+
+// Args:
+//    capacity (size_t): Usable size of the chunk.
+
+// Returns:
+//    The new chunk, or NULL on memory allocation failure.
+static EsfJsonArenaChunk* EsfJsonArenaChunkNew(size_t capacity) {
+  EsfJsonArenaChunk* chunk =
+      (EsfJsonArenaChunk*)malloc(sizeof(*chunk) + capacity);
+  if (chunk == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for chunk. capacity = %zu",
+                 capacity);
+    return NULL;
+  }
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  chunk->last = 0;
+  return chunk;
+}
+
+// """Free every chunk of a list.
+
+// Args:
+//    chunk (EsfJsonArenaChunk*): First chunk of the list. NULL is ignored.
+static void EsfJsonArenaChunkFreeList(EsfJsonArenaChunk* chunk) {
+  while (chunk != NULL) {
+    EsfJsonArenaChunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+}
+
+// """Return the chunk of a list that holds addr.
+
+// Args:
+//    chunk (EsfJsonArenaChunk*): First chunk of the list.
+//    addr (uintptr_t): Address to look up.
+
+// Returns:
+//    The chunk, or NULL if no chunk of the list holds addr.
+static EsfJsonArenaChunk* EsfJsonArenaChunkFind(EsfJsonArenaChunk* chunk,
+                                                uintptr_t addr) {
+  for (; chunk != NULL; chunk = chunk->next) {
+    uintptr_t begin = (uintptr_t)chunk->buf;
+    if (addr >= begin && addr < begin + chunk->capacity) {
+      return chunk;
+    }
+  }
+  return NULL;
+}
+
+// """Allocate from the next large chunk.
+
+// Args:
+//    arena (EsfJsonArena*): Current arena.
+//    rounded (size_t): Size of the allocation, already rounded.
+
+// Returns:
+//    The allocation, or NULL on memory allocation failure.
+static void* EsfJsonArenaMallocLarge(EsfJsonArena* arena, size_t rounded) {
+  EsfJsonArenaChunk** link = arena->large_next;
+  EsfJsonArenaChunk* chunk = *link;
+  if (chunk != NULL && chunk->capacity < rounded) {
+    // The workload has grown; replace the chunk rather than keep both.
+    *link = chunk->next;
+    free(chunk);
+    chunk = NULL;
+  }
+  if (chunk == NULL) {
+    chunk = EsfJsonArenaChunkNew(ESF_JSON_ARENA_LARGE_ROUND_UP(rounded));
+    if (chunk == NULL) {
+      return NULL;
+    }
+    chunk->next = *link;
+    *link = chunk;
+  }
+  chunk->used = rounded;
+  chunk->last = 0;
+  arena->large_next = &chunk->next;
+  return chunk->buf;
+}
+
+// Allocation function installed into parson.
+static void* EsfJsonArenaMalloc(size_t size) {
+  EsfJsonArena* arena = s_current_arena;
+  if (arena == NULL) {
+    return malloc(size);
+  }
+
+  size_t rounded = ESF_JSON_ARENA_ROUND_UP(size == 0 ? 1 : size);
+  EsfJsonArenaChunk* current = arena->small_current;
+  if (current != NULL && current->capacity - current->used >= rounded) {
+    current->last = current->used;
+    current->used += rounded;
+    return current->buf + current->last;
+  }
+
+  if (rounded > ESF_JSON_ARENA_LARGE_MIN) {
+    // Large allocation. Give it a chunk of its own, so that the free space of
+    // the current small chunk is not wasted.
+    return EsfJsonArenaMallocLarge(arena, rounded);
+  }
+
+  // Move on to the next small chunk, which a reset may have kept. Every small
+  // chunk has room for a small allocation.
+  EsfJsonArenaChunk* chunk =
+      (current != NULL) ? current->next : arena->small_head;
+  if (chunk == NULL) {
+    chunk = EsfJsonArenaChunkNew(arena->next_capacity);
+    if (chunk == NULL) {
+      return NULL;
+    }
+    if (arena->next_capacity <
+        ESF_JSON_ARENA_CHUNK_SIZE * ESF_JSON_ARENA_CHUNK_GROWTH_MAX) {
+      arena->next_capacity *= 2;
+    }
+    if (current != NULL) {
+      current->next = chunk;
+    } else {
+      arena->small_head = chunk;
+    }
+  }
+  arena->small_current = chunk;
+  chunk->used = rounded;
+  chunk->last = 0;
+  return chunk->buf;
+}
+
+// Free function installed into parson.
+static void EsfJsonArenaFree(void* ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  EsfJsonArena* arena = s_current_arena;
+  if (arena != NULL) {
+    uintptr_t addr = (uintptr_t)ptr;
+    EsfJsonArenaChunk* chunk = EsfJsonArenaChunkFind(arena->small_head, addr);
+    if (chunk != NULL) {
+      // Arena memory is released with the arena. Only the most recent
+      // allocation of the current chunk can be handed back, which covers the
+      // temporary buffers parson frees right after allocating them.
+      if (chunk == arena->small_current &&
+          addr == (uintptr_t)chunk->buf + chunk->last) {
+        chunk->used = chunk->last;
+      }
+      return;
+    }
+    if (EsfJsonArenaChunkFind(arena->large_head, addr) != NULL) {
+      return;
+    }
+  }
+  // Memory allocated while no arena was current.
+  free(ptr);
+}
+
+static void EsfJsonArenaInstallAllocator(void) {
+  // Without a current arena the functions fall back to stdlib, so values
+  // allocated before the installation can still be freed.
+  json_set_allocation_functions(EsfJsonArenaMalloc, EsfJsonArenaFree);
+}
+
+EsfJsonErrorCode EsfJsonArenaCreate(EsfJsonArena** arena) {
+  ESF_JSON_TRACE("entry");
+  if (arena == NULL) {
+    ESF_JSON_ERR("Parameter error. arena = %p", arena);
+    return kEsfJsonInvalidArgument;
+  }
+
+  int ret = pthread_once(&s_allocator_once, EsfJsonArenaInstallAllocator);
+  if (ret != 0) {
+    ESF_JSON_ERR("pthread_once func failed. ret = %d", ret);
+    return kEsfJsonInternalError;
+  }
+
+  EsfJsonArena* tmp_arena = (EsfJsonArena*)malloc(sizeof(*tmp_arena));
+  if (tmp_arena == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for tmp_arena.");
+    return kEsfJsonOutOfMemory;
+  }
+  tmp_arena->small_head = NULL;
+  tmp_arena->small_current = NULL;
+  tmp_arena->large_head = NULL;
+  tmp_arena->large_next = &tmp_arena->large_head;
+  tmp_arena->next_capacity = ESF_JSON_ARENA_CHUNK_SIZE;
+
+  *arena = tmp_arena;
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
+void EsfJsonArenaDestroy(EsfJsonArena* arena) {
+  ESF_JSON_TRACE("entry");
+  if (arena == NULL) {
+    return;
+  }
+  if (s_current_arena == arena) {
+    s_current_arena = NULL;
+  }
+  EsfJsonArenaChunkFreeList(arena->small_head);
+  EsfJsonArenaChunkFreeList(arena->large_head);
+  free(arena);
+  ESF_JSON_TRACE("exit");
+}
+
+void EsfJsonArenaReset(EsfJsonArena* arena) {
+  ESF_JSON_TRACE("entry");
+  if (arena == NULL) {
+    return;
+  }
+  for (EsfJsonArenaChunk* chunk = arena->small_head; chunk != NULL;
+       chunk = chunk->next) {
+    chunk->used = 0;
+    chunk->last = 0;
+  }
+  for (EsfJsonArenaChunk* chunk = arena->large_head; chunk != NULL;
+       chunk = chunk->next) {
+    chunk->used = 0;
+    chunk->last = 0;
+  }
+  arena->small_current = NULL;
+  arena->large_next = &arena->large_head;
+  ESF_JSON_TRACE("exit");
+}
+
+EsfJsonArena* EsfJsonArenaEnter(EsfJsonHandle handle) {
+  EsfJsonArena* prev = s_current_arena;
+  s_current_arena = (handle != ESF_JSON_HANDLE_INITIALIZER) ? handle->arena
+                                                            : NULL;
+  return prev;
+}
+
+void EsfJsonArenaLeave(EsfJsonArena** prev) { s_current_arena = *prev; }
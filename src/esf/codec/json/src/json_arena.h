@@ -0,0 +1,77 @@
+/*
+* SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+#ifndef ESF_CODEC_JSON_JSON_ARENA_H_
+#define ESF_CODEC_JSON_JSON_ARENA_H_
+
+#include <stddef.h>
+
+#include "json.h"
+
+// Size of an arena chunk. Allocations that do not fit get a chunk of their own.
+#ifdef CONFIG_EXTERNAL_CODEC_JSON_ARENA_CHUNK_SIZE
+#define ESF_JSON_ARENA_CHUNK_SIZE (CONFIG_EXTERNAL_CODEC_JSON_ARENA_CHUNK_SIZE)
+#else
+#define ESF_JSON_ARENA_CHUNK_SIZE (4096)
+#endif
+
+typedef struct EsfJsonArena EsfJsonArena;
+
+// Makes the arena of handle the target of parson allocations made by the
+// calling thread until the end of the enclosing block. Put it at the top of
+// every API that takes a handle.
+#define ESF_JSON_ARENA_SCOPE(handle)                                \
+  EsfJsonArena* esf_json_arena_scope_prev                           \
+      __attribute__((cleanup(EsfJsonArenaLeave), unused)) =         \
+          EsfJsonArenaEnter(handle)
+
+// """Create an arena.
+
+// Installs the arena aware allocation functions into parson on first use.
+
+// Args:
+//    arena (EsfJsonArena**): Created arena.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+EsfJsonErrorCode EsfJsonArenaCreate(EsfJsonArena** arena);
+
+// """Release an arena and everything allocated from it in one step.
+
+// Args:
+//    arena (EsfJsonArena*): Arena to release. NULL is ignored.
+void EsfJsonArenaDestroy(EsfJsonArena* arena);
+
+// """Release everything allocated from an arena but keep its chunks.
+
+// The chunks are rewound and reused in the same order, so a workload that
+// repeats after the reset is served without allocating again. The arena keeps
+// as many chunks as the largest workload since its creation needed.
+
+// Args:
+//    arena (EsfJsonArena*): Arena to reset. NULL is ignored.
+void EsfJsonArenaReset(EsfJsonArena* arena);
+
+// """Make the arena of handle current for the calling thread.
+
+// Args:
+//    handle (EsfJsonHandle): JSON API Handle. A NULL handle or a handle
+//      without an arena makes stdlib the allocator.
+
+// Returns:
+//    The arena that was current before the call.
+EsfJsonArena* EsfJsonArenaEnter(EsfJsonHandle handle);
+
+// """Restore the arena that was current before EsfJsonArenaEnter.
+
+// Args:
+//    prev (EsfJsonArena**): Value returned by EsfJsonArenaEnter.
+void EsfJsonArenaLeave(EsfJsonArena** prev);
+
+#endif  // ESF_CODEC_JSON_JSON_ARENA_H_
@@ -44,6 +44,7 @@ EsfJsonErrorCode EsfJsonSerializeFileIO(EsfJsonHandle handle,
                                         EsfMemoryManagerHandle mem_handle,
                                         size_t* mem_size) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     return kEsfJsonHandleError;
@@ -78,7 +79,6 @@ EsfJsonErrorCode EsfJsonSerializeFileIO(EsfJsonHandle handle,
     return ret;
   }
   EsfJsonErrorCode result = kEsfJsonSuccess;
-  char* serialized_str = NULL;
   do {
     JSON_Value* data = NULL;
     result = EsfJsonValueFind(handle->json_value, value, &data);
@@ -89,48 +89,25 @@ EsfJsonErrorCode EsfJsonSerializeFileIO(EsfJsonHandle handle,
           result, handle->json_value, value);
       break;
     }
-    serialized_str = json_serialize_to_string(data);
-    if (serialized_str == NULL) {
-      ESF_JSON_ERR("json_serialize_to_string func failed.");
-      result = kEsfJsonOutOfMemory;
-      break;
-    }
-
-    bool is_included = false;
-    result = EsfJsonSerializeIncludesFileIO(handle, value, &is_included);
-    if (result != kEsfJsonSuccess) {
-      json_free_serialized_string(serialized_str);
-      ESF_JSON_ERR(
-          "EsfJsonSerializeIncludesFileIO func failed. ret = %u, handle = %p, "
-          "value = %" PRId32 "",
-          result, handle, value);
-      break;
-    }
-    result = EsfJsonSerializeUsingMemoryManagerFileIO(
-        handle->json_value, mem_handle, false, serialized_str, is_included,
-        mem_size);
+    result = EsfJsonSerializeStreamFileIO(handle->json_value, data,
+                                          mem_handle, false, mem_size);
     if (result != kEsfJsonSuccess) {
       ESF_JSON_ERR(
-          "EsfJsonSerializeUsingMemoryManager func failed. ret = %u, "
-          "handle->json_value = %p, mem_handle = %" PRIu32
-          "mem_handle_open = %d, serialized_str = %p, is_included = %d",
-          result, handle->json_value, mem_handle, false, serialized_str,
-          is_included);
-      json_free_serialized_string(serialized_str);
+          "EsfJsonSerializeStreamFileIO func failed. ret = %u, "
+          "handle->json_value = %p, mem_handle = %" PRIu32 "",
+          result, handle->json_value, mem_handle);
       break;
     }
   } while (0);
 
   ret = EsfJsonMutexUnlock(&mutex);
   if (ret != kEsfJsonSuccess) {
-    json_free_serialized_string(serialized_str);
     ESF_JSON_ERR("EsfJsonMutexUnlock func failed. ret = %u", ret);
     return ret;
   }
   if (result != kEsfJsonSuccess) {
     return result;
   }
-  json_free_serialized_string(serialized_str);
   ESF_JSON_DEBUG("JSON Value serialize FileIO ID = %" PRId32
                  ", mem_handle = %" PRIu32 ", mem_size = %zu.",
                  value, mem_handle, *mem_size);
@@ -142,6 +119,7 @@ EsfJsonErrorCode EsfJsonSerializeIncludesFileIO(EsfJsonHandle handle,
                                                 EsfJsonValue value,
                                                 bool* is_included) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     return kEsfJsonHandleError;
@@ -176,6 +154,7 @@ EsfJsonErrorCode EsfJsonStringInitFileIO(EsfJsonHandle handle,
                                          EsfMemoryManagerHandle mem_handle,
                                          size_t mem_size, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     return kEsfJsonHandleError;
@@ -291,6 +270,7 @@ EsfJsonErrorCode EsfJsonStringSetFileIO(EsfJsonHandle handle,
                                         EsfMemoryManagerHandle mem_handle,
                                         size_t mem_size) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     return kEsfJsonHandleError;
@@ -19,6 +19,7 @@
 
 size_t EsfJsonSerializeSizeGet(EsfJsonHandle handle, EsfJsonValue value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     ESF_JSON_TRACE("exit.");
@@ -62,6 +63,7 @@ EsfJsonErrorCode EsfJsonSerializeHandle(EsfJsonHandle handle,
                                         EsfMemoryManagerHandle mem_handle,
                                         size_t* serialized_size) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   EsfJsonErrorCode result = kEsfJsonInternalError;
   // 1. validate parameters
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
@@ -131,6 +133,7 @@ EsfJsonErrorCode EsfJsonSerializeIncludesHandle(EsfJsonHandle handle,
                                                 EsfJsonValue value,
                                                 bool* is_included) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
     ESF_JSON_ERR("handle NULL.");
     ESF_JSON_TRACE("exit.");
@@ -169,6 +172,7 @@ EsfJsonErrorCode EsfJsonStringInitHandle(EsfJsonHandle handle,
                                          EsfMemoryManagerHandle mem_handle,
                                          size_t mem_size, EsfJsonValue* value) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   EsfJsonErrorCode result = kEsfJsonInternalError;
   // 1. validate parameters
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
@@ -238,6 +242,7 @@ EsfJsonErrorCode EsfJsonStringSetHandle(EsfJsonHandle handle,
                                         EsfMemoryManagerHandle mem_handle,
                                         size_t mem_size) {
   ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
   EsfJsonErrorCode result = kEsfJsonInternalError;
   // 1. validate parameters
   if (handle == ESF_JSON_HANDLE_INITIALIZER) {
@@ -10,6 +10,16 @@
 #include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "json.h"
 #include "json_fileio.h"
@@ -171,35 +181,6 @@ JSON_STATIC EsfJsonErrorCode EsfJsonObjectRecursiveCheck(
 JSON_STATIC EsfJsonErrorCode EsfJsonArrayRecursiveCheck(
     EsfJsonValueContainer* json_value, JSON_Value* data, bool* is_included);
 
-// """Serializes a JSON value container to a string using file I/O operations.
-// This function takes a JSON value container and serializes it into a string,
-// utilizing file I/O operations for conversion. It writes the serialized data
-// to a memory manager handle and updates the size of written data.
-
-// Args:
-//    json_value Pointer to the EsfJsonValueContainer that holds the JSON data
-//      to be serialized.
-//    mem_handle Handle to the memory manager where the serialized data will be
-//      written.
-//    mem_handle_open memory manager handle open request (true:open request)
-//    serialized_str Pointer to a character pointer where the serialized string
-//      will be stored.
-//    wsize Pointer to a size_t variable where the size of written data will be
-//      updated.
-//    serialize_size Pointer to a size_t variable where the total size of
-//      serialized data will be accumulated.
-
-// Returns:
-// EsfJsonErrorCode indicating the success or failure of the operation.
-//    kEsfJsonSuccess: Serialization was successful.
-//    kEsfJsonInvalidArgument: One or more input parameters are NULL.
-//    kEsfJsonOutOfMemory: Memory allocation failed.
-//    kEsfJsonInternalError: An internal error occurred during serialization.
-JSON_STATIC EsfJsonErrorCode EsfJsonSerializeConversionStringFileIO(
-    EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
-    bool mem_handle_open, char** serialized_str, size_t* wsize,
-    size_t* serialize_size);
-
 // """Serializes a JSON value into a string with memory mapping.
 // This function serializes a given JSON value container into a string while
 // managing memory through a specified memory manager handle. It processes
@@ -249,12 +230,97 @@ JSON_STATIC EsfJsonErrorCode EsfJsonSerializeConversionStringMemMap(
 JSON_STATIC size_t EsfJsonFindEmptyMemHandleInfo(
     EsfJsonValueContainer* container, EsfJsonValue value);
 
+// """Get the position in the data array of a JSON value ID.
+
+// Args:
+//    json_value (const EsfJsonValueContainer*): JSON value array info.
+//    value (EsfJsonValue): JSON Value ID.
+
+// Returns:
+//    The position of the JSON value ID, or -1 if it is not registered.
+JSON_STATIC int32_t EsfJsonValueIdToOffset(
+    const EsfJsonValueContainer* json_value, EsfJsonValue value);
+
+// """Search the index for a JSON value.
+
+// Args:
+//    json_value (const EsfJsonValueContainer*): JSON value array info.
+//    data (const JSON_Value*): JSON Value.
+
+// Returns:
+//    The index slot referring to the JSON value, or -1 if it is not indexed.
+JSON_STATIC int32_t EsfJsonValueIndexFind(
+    const EsfJsonValueContainer* json_value, const JSON_Value* data);
+
+// """Make sure the index can take one more JSON value.
+
+// Grows the index, or rebuilds it to drop deleted slots, when one more entry
+// would push the load factor over 3/4.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+JSON_STATIC EsfJsonErrorCode EsfJsonValueIndexReserve(
+    EsfJsonValueContainer* json_value);
+
+// """Add the JSON value at a position of the data array to the index.
+
+// The JSON value must not be indexed yet and EsfJsonValueIndexReserve must
+// have been called beforehand.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+//    offset (int32_t): Position in the data array.
+JSON_STATIC void EsfJsonValueIndexInsert(EsfJsonValueContainer* json_value,
+                                         int32_t offset);
+
+// """Free every JSON value of the container that has no parent.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+JSON_STATIC EsfJsonErrorCode EsfJsonValueContainerFreeValues(
+    EsfJsonValueContainer* json_value);
+
+// """Get the length of the leading bytes of a string that need no special
+// handling.
+
+// Scans 32 (AVX2) or 16 (SSE2, NEON) bytes at a time where the target
+// supports it, and one byte at a time for the rest.
+
+// Args:
+//    str (const char*): String. NULL is not acceptable.
+//    len (size_t): Length of str.
+//    escape (bool): true to stop at the bytes serialization escapes: '"',
+//      '\\', '/' and control characters. false to stop at the bytes a parser
+//      handles one by one: '"', '\\', control characters and non-ASCII bytes.
+
+// Returns:
+//    The offset of the first such byte, or len if there is none.
+JSON_STATIC size_t EsfJsonStringSpan(const char* str, size_t len,
+                                     bool escape);
+
+// Index slot values that do not refer to a position in the data array.
+#define ESF_JSON_INDEX_EMPTY (-1)
+#define ESF_JSON_INDEX_DELETED (-2)
+// The number of index slots of a new container.
+#define ESF_JSON_INDEX_CAPACITY_MIN (32)
+
 // EsfJsonValueContainer default value.
 static const EsfJsonValueContainer kEsfJsonValueContainerDefault = {
     .data = NULL,
     .capacity = 16,
     .size = 0,
     .last_id = ESF_JSON_VALUE_MAX,
+    .index = NULL,
+    .index_capacity = ESF_JSON_INDEX_CAPACITY_MIN,
+    .index_used = 0,
     .mem_info = {{0}},
 };
 
@@ -278,15 +344,13 @@ EsfJsonErrorCode EsfJsonValueFind(EsfJsonValueContainer* json_value,
     return kEsfJsonInvalidArgument;
   }
 
-  int32_t i = 0;
   // JSON value ID search
-  for (i = 0; i < json_value->size; ++i) {
-    if (json_value->data[i].id == value) {
-      *data = json_value->data[i].data;
-      ESF_JSON_TRACE("JSON Value found is %p.", json_value->data[i].data);
-      ESF_JSON_TRACE("exit");
-      return kEsfJsonSuccess;
-    }
+  int32_t offset = EsfJsonValueIdToOffset(json_value, value);
+  if (offset >= 0) {
+    *data = json_value->data[offset].data;
+    ESF_JSON_TRACE("JSON Value found is %p.", json_value->data[offset].data);
+    ESF_JSON_TRACE("exit");
+    return kEsfJsonSuccess;
   }
 
   // Not found.
@@ -305,15 +369,14 @@ EsfJsonErrorCode EsfJsonValueLookup(EsfJsonValueContainer* json_value,
     return kEsfJsonInvalidArgument;
   }
 
-  int32_t i = 0;
   // JSON value search.
-  for (i = 0; i < json_value->size; ++i) {
-    if (json_value->data[i].data == data) {
-      *value = json_value->data[i].id;
-      ESF_JSON_TRACE("JSON Value ID found is %d.", json_value->data[i].id);
-      ESF_JSON_TRACE("exit");
-      return kEsfJsonSuccess;
-    }
+  int32_t slot = EsfJsonValueIndexFind(json_value, data);
+  if (slot >= 0) {
+    int32_t offset = json_value->index[slot];
+    *value = json_value->data[offset].id;
+    ESF_JSON_TRACE("JSON Value ID found is %d.", json_value->data[offset].id);
+    ESF_JSON_TRACE("exit");
+    return kEsfJsonSuccess;
   }
 
   // Not found.
@@ -331,23 +394,23 @@ EsfJsonErrorCode EsfJsonValueLookupRemove(EsfJsonValueContainer* json_value,
     return kEsfJsonInvalidArgument;
   }
 
-  int32_t i = 0;
   // JSON value search and remove.
-  for (i = 0; i < json_value->size; ++i) {
-    if (json_value->data[i].data == data) {
-      ESF_JSON_TRACE("Deleted JSON Value ID = %d, data = %p",
-                     json_value->data[i].id, json_value->data[i].data);
-      for (int j = 0; j < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++j) {
-        if (json_value->mem_info[j].id == json_value->data[i].id) {
-          json_value->mem_info[j].id = ESF_JSON_VALUE_INVALID;
-          break;
-        }
+  int32_t slot = EsfJsonValueIndexFind(json_value, data);
+  if (slot >= 0) {
+    int32_t i = json_value->index[slot];
+    ESF_JSON_TRACE("Deleted JSON Value ID = %d, data = %p",
+                   json_value->data[i].id, json_value->data[i].data);
+    for (int j = 0; j < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++j) {
+      if (json_value->mem_info[j].id == json_value->data[i].id) {
+        json_value->mem_info[j].id = ESF_JSON_VALUE_INVALID;
+        break;
       }
-      json_value->data[i].id = ESF_JSON_VALUE_INVALID;
-      json_value->data[i].data = NULL;
-      ESF_JSON_TRACE("exit");
-      return kEsfJsonSuccess;
     }
+    json_value->data[i].id = ESF_JSON_VALUE_INVALID;
+    json_value->data[i].data = NULL;
+    json_value->index[slot] = ESF_JSON_INDEX_DELETED;
+    ESF_JSON_TRACE("exit");
+    return kEsfJsonSuccess;
   }
 
   // Not found.
@@ -394,12 +457,22 @@ EsfJsonErrorCode EsfJsonValueAdd(EsfJsonValueContainer* json_value,
     }
   }
 
+  EsfJsonErrorCode ret = EsfJsonValueIndexReserve(json_value);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonValueIndexReserve func failed. ret = %u", ret);
+    return ret;
+  }
+
   // JSON data add.
   ++(json_value->size);
   json_value->last_id = json_value->size;
   int32_t offset = (json_value->size) - 1;
   json_value->data[offset].data = data;
   json_value->data[offset].id = json_value->last_id;
+  // A JSON value that is already registered keeps resolving to its first ID.
+  if (EsfJsonValueIndexFind(json_value, data) < 0) {
+    EsfJsonValueIndexInsert(json_value, offset);
+  }
   *value = json_value->data[offset].id;
   ESF_JSON_TRACE("Add JSON Value ID = %d", json_value->data[offset].id);
 
@@ -417,25 +490,36 @@ EsfJsonErrorCode EsfJsonValueReplace(EsfJsonValueContainer* json_value,
     return kEsfJsonInvalidArgument;
   }
 
-  int32_t i = 0;
   // JSON value ID search and Replace.
-  for (i = 0; i < json_value->size; ++i) {
-    if (json_value->data[i].id == value) {
-      for (int j = 0; j < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++j) {
-        if (json_value->mem_info[j].id == json_value->data[i].id) {
-          json_value->mem_info[j].id = ESF_JSON_VALUE_INVALID;
-          break;
-        }
-      }
-      json_value->data[i].data = data;
-      ESF_JSON_TRACE("exit");
-      return kEsfJsonSuccess;
-    }
+  int32_t i = EsfJsonValueIdToOffset(json_value, value);
+  if (i < 0) {
+    // Not found.
+    ESF_JSON_ERR("JSON value ID not found.");
+    return kEsfJsonValueNotFound;
   }
 
-  // Not found.
-  ESF_JSON_ERR("JSON value ID not found.");
-  return kEsfJsonValueNotFound;
+  EsfJsonErrorCode ret = EsfJsonValueIndexReserve(json_value);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonValueIndexReserve func failed. ret = %u", ret);
+    return ret;
+  }
+
+  for (int j = 0; j < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++j) {
+    if (json_value->mem_info[j].id == json_value->data[i].id) {
+      json_value->mem_info[j].id = ESF_JSON_VALUE_INVALID;
+      break;
+    }
+  }
+  int32_t slot = EsfJsonValueIndexFind(json_value, json_value->data[i].data);
+  if (slot >= 0 && json_value->index[slot] == i) {
+    json_value->index[slot] = ESF_JSON_INDEX_DELETED;
+  }
+  json_value->data[i].data = data;
+  if (EsfJsonValueIndexFind(json_value, data) < 0) {
+    EsfJsonValueIndexInsert(json_value, i);
+  }
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
 }
 
 EsfJsonErrorCode EsfJsonValueContainerInit(EsfJsonValueContainer** json_value) {
@@ -480,7 +564,20 @@ EsfJsonErrorCode EsfJsonValueContainerInit(EsfJsonValueContainer** json_value) {
     tmp_esf_json_value_data[j].data = NULL;
   }
 
+  int32_t* tmp_index = (int32_t*)malloc(
+      sizeof(*tmp_index) * (kEsfJsonValueContainerDefault.index_capacity));
+  if (tmp_index == NULL) {
+    free(tmp_esf_json_value_data);
+    free(tmp_esf_json_value_container);
+    ESF_JSON_ERR("Failed to allocate memory for tmp_index.");
+    return kEsfJsonOutOfMemory;
+  }
+  for (j = 0; j < tmp_esf_json_value_container->index_capacity; ++j) {
+    tmp_index[j] = ESF_JSON_INDEX_EMPTY;
+  }
+
   tmp_esf_json_value_container->data = tmp_esf_json_value_data;
+  tmp_esf_json_value_container->index = tmp_index;
   *json_value = tmp_esf_json_value_container;
 
   ESF_JSON_TRACE("exit");
@@ -495,51 +592,64 @@ EsfJsonErrorCode EsfJsonValueContainerFree(EsfJsonValueContainer* json_value) {
     return kEsfJsonInvalidArgument;
   }
 
-  int32_t i = 0;
-  // Delete valid data.
-  for (i = 0; i < json_value->size; ++i) {
-    if (json_value->data[i].data == NULL &&
-        json_value->data[i].id == ESF_JSON_VALUE_INVALID) {
-      // Go to the next loop without doing anything.
-      continue;
-    } else {
-      JSON_Value* parent_data = NULL;
-      parent_data = json_value_get_parent(json_value->data[i].data);
-      if (parent_data != NULL) {
-        continue;
-      } else {
-        EsfJsonErrorCode ret = kEsfJsonInternalError;
-        // Recursive deletion JSON value.
-        ret = EsfJsonValueRecursiveRemove(json_value, json_value->data[i].data);
-        if (ret != kEsfJsonSuccess) {
-          ESF_JSON_ERR(
-              "EsfJsonValueRecursiveRemove func failed. ret = %u, json_value "
-              "= "
-              "%p, json_value->data[i].data = %p.",
-              ret, json_value, json_value->data[i].data);
-          return kEsfJsonInternalError;
-        }
+  EsfJsonErrorCode ret = EsfJsonValueContainerFreeValues(json_value);
+  if (ret != kEsfJsonSuccess) {
+    return ret;
+  }
+  free(json_value->index);
+  free(json_value->data);
+  free(json_value);
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
 
-        // Remove data saving
-        JSON_Value* remove_data = json_value->data[i].data;
-        ret = EsfJsonValueLookupRemove(json_value, json_value->data[i].data);
-        if (ret != kEsfJsonSuccess) {
-          ESF_JSON_ERR(
-              "EsfJsonValueLookupRemove func failed. ret = %u, json_value = "
-              "%p, json_value->data[i].data = %p.",
-              ret, json_value, json_value->data[i].data);
-          return kEsfJsonInternalError;
-        }
-        json_value_free(remove_data);
-      }
-    }
+EsfJsonErrorCode EsfJsonValueContainerDiscard(
+    EsfJsonValueContainer* json_value) {
+  ESF_JSON_TRACE("entry");
+  // Parameter check.
+  if (json_value == NULL) {
+    ESF_JSON_ERR("Parameter error. json_value = %p", json_value);
+    return kEsfJsonInvalidArgument;
   }
+  free(json_value->index);
   free(json_value->data);
   free(json_value);
   ESF_JSON_TRACE("exit");
   return kEsfJsonSuccess;
 }
 
+EsfJsonErrorCode EsfJsonValueContainerReset(EsfJsonValueContainer* json_value,
+                                            bool free_values) {
+  ESF_JSON_TRACE("entry");
+  // Parameter check.
+  if (json_value == NULL) {
+    ESF_JSON_ERR("Parameter error. json_value = %p", json_value);
+    return kEsfJsonInvalidArgument;
+  }
+  if (free_values) {
+    EsfJsonErrorCode ret = EsfJsonValueContainerFreeValues(json_value);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+  }
+  // The data array and the index keep their capacity.
+  for (int32_t i = 0; i < json_value->size; ++i) {
+    json_value->data[i].id = ESF_JSON_VALUE_INVALID;
+    json_value->data[i].data = NULL;
+  }
+  json_value->size = 0;
+  json_value->last_id = kEsfJsonValueContainerDefault.last_id;
+  for (int32_t i = 0; i < json_value->index_capacity; ++i) {
+    json_value->index[i] = ESF_JSON_INDEX_EMPTY;
+  }
+  json_value->index_used = 0;
+  for (int i = 0; i < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++i) {
+    json_value->mem_info[i] = kEsfJsonMemoryDefault;
+  }
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
 EsfJsonValueType EsfJsonValueTypeConvert(JSON_Value_Type json_type) {
   ESF_JSON_TRACE("entry");
   switch (json_type) {
@@ -600,6 +710,50 @@ EsfJsonErrorCode EsfJsonValueRecursiveRemove(EsfJsonValueContainer* json_value,
   }
 }
 
+JSON_STATIC EsfJsonErrorCode EsfJsonValueContainerFreeValues(
+    EsfJsonValueContainer* json_value) {
+  int32_t i = 0;
+  // Delete valid data.
+  for (i = 0; i < json_value->size; ++i) {
+    if (json_value->data[i].data == NULL &&
+        json_value->data[i].id == ESF_JSON_VALUE_INVALID) {
+      // Go to the next loop without doing anything.
+      continue;
+    } else {
+      JSON_Value* parent_data = NULL;
+      parent_data = json_value_get_parent(json_value->data[i].data);
+      if (parent_data != NULL) {
+        continue;
+      } else {
+        EsfJsonErrorCode ret = kEsfJsonInternalError;
+        // Recursive deletion JSON value.
+        ret = EsfJsonValueRecursiveRemove(json_value, json_value->data[i].data);
+        if (ret != kEsfJsonSuccess) {
+          ESF_JSON_ERR(
+              "EsfJsonValueRecursiveRemove func failed. ret = %u, json_value "
+              "= "
+              "%p, json_value->data[i].data = %p.",
+              ret, json_value, json_value->data[i].data);
+          return kEsfJsonInternalError;
+        }
+
+        // Remove data saving
+        JSON_Value* remove_data = json_value->data[i].data;
+        ret = EsfJsonValueLookupRemove(json_value, json_value->data[i].data);
+        if (ret != kEsfJsonSuccess) {
+          ESF_JSON_ERR(
+              "EsfJsonValueLookupRemove func failed. ret = %u, json_value = "
+              "%p, json_value->data[i].data = %p.",
+              ret, json_value, json_value->data[i].data);
+          return kEsfJsonInternalError;
+        }
+        json_value_free(remove_data);
+      }
+    }
+  }
+  return kEsfJsonSuccess;
+}
+
 JSON_STATIC EsfJsonErrorCode EsfJsonObjectRecursiveRemove(
     EsfJsonValueContainer* json_value, JSON_Value* data) {
   ESF_JSON_TRACE("entry");
@@ -922,15 +1076,248 @@ bool EsfJsonCanJsonAddToJson(EsfJsonValueContainer* json_value,
     ESF_JSON_ERR("Identical data not allowed.");
     return false;
   }
-  // Get parent json of parent json.
-  JSON_Value* parent_parent_data = json_value_get_parent(parent_data);
-  if (parent_parent_data == NULL) {
-    // No parent json.
-    ESF_JSON_TRACE("exit");
-    return true;
+  // Get parent json of parent json.
+  JSON_Value* parent_parent_data = json_value_get_parent(parent_data);
+  if (parent_parent_data == NULL) {
+    // No parent json.
+    ESF_JSON_TRACE("exit");
+    return true;
+  }
+  // Check for can add the parent of the parent.
+  return EsfJsonCanJsonAddToJson(json_value, data, parent_parent_data);
+}
+
+const char* EsfJsonEscapeGet(char c, char* buf) {
+  switch (c) {
+    case '\"':
+      return "\\\"";
+    case '\\':
+      return "\\\\";
+    case '/':
+      return "\\/";
+    case '\b':
+      return "\\b";
+    case '\f':
+      return "\\f";
+    case '\n':
+      return "\\n";
+    case '\r':
+      return "\\r";
+    case '\t':
+      return "\\t";
+    default:
+      if ((unsigned char)c < 0x20) {
+        snprintf(buf, ESF_JSON_ESCAPE_MAX_SIZE, "\\u%04x", (unsigned char)c);
+        return buf;
+      }
+      return NULL;
+  }
+}
+
+JSON_STATIC size_t EsfJsonStringSpan(const char* str, size_t len,
+                                     bool escape) {
+  const unsigned char* s = (const unsigned char*)str;
+  size_t i = 0;
+#if defined(__AVX2__)
+  {
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i slash = _mm256_set1_epi8('/');
+    const __m256i control_max = _mm256_set1_epi8(0x1F);
+    for (; i + 32 <= len; i += 32) {
+      __m256i v = _mm256_loadu_si256((const __m256i*)(s + i));
+      __m256i hit = _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                                    _mm256_cmpeq_epi8(v, backslash));
+      // max(v, 0x1F) == 0x1F holds for the control characters only.
+      hit = _mm256_or_si256(
+          hit, _mm256_cmpeq_epi8(_mm256_max_epu8(v, control_max), control_max));
+      uint32_t mask = 0;
+      if (escape) {
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, slash));
+        mask = (uint32_t)_mm256_movemask_epi8(hit);
+      } else {
+        // The top bit of each byte marks the non-ASCII bytes.
+        mask = (uint32_t)_mm256_movemask_epi8(hit) |
+               (uint32_t)_mm256_movemask_epi8(v);
+      }
+      if (mask != 0) {
+        return i + (size_t)__builtin_ctz(mask);
+      }
+    }
+  }
+#endif
+#if defined(__SSE2__)
+  {
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i slash = _mm_set1_epi8('/');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= len; i += 16) {
+      __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+      __m128i hit =
+          _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash));
+      hit = _mm_or_si128(
+          hit, _mm_cmpeq_epi8(_mm_max_epu8(v, control_max), control_max));
+      uint32_t mask = 0;
+      if (escape) {
+        hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, slash));
+        mask = (uint32_t)_mm_movemask_epi8(hit);
+      } else {
+        mask = (uint32_t)_mm_movemask_epi8(hit) |
+               (uint32_t)_mm_movemask_epi8(v);
+      }
+      if (mask != 0) {
+        return i + (size_t)__builtin_ctz(mask);
+      }
+    }
+  }
+#elif defined(__ARM_NEON)
+  {
+    const uint8x16_t quote = vdupq_n_u8('\"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t slash = vdupq_n_u8('/');
+    const uint8x16_t control_end = vdupq_n_u8(0x20);
+    const uint8x16_t ascii_end = vdupq_n_u8(0x80);
+    for (; i + 16 <= len; i += 16) {
+      uint8x16_t v = vld1q_u8(s + i);
+      uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+      hit = vorrq_u8(hit, vcltq_u8(v, control_end));
+      hit = vorrq_u8(hit, escape ? vceqq_u8(v, slash) : vcgeq_u8(v, ascii_end));
+      // Narrow each byte of the compare result to 4 bits so that the 16
+      // results fit in one 64-bit lane.
+      uint64_t mask = vget_lane_u64(
+          vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+      if (mask != 0) {
+        return i + (size_t)__builtin_ctzll(mask) / 4;
+      }
+    }
+  }
+#endif
+  for (; i < len; ++i) {
+    unsigned char c = s[i];
+    if (c == '\"' || c == '\\' || c < 0x20 ||
+        (escape ? c == '/' : c >= 0x80)) {
+      break;
+    }
+  }
+  return i;
+}
+
+size_t EsfJsonEscapeSpan(const char* str, size_t len) {
+  return EsfJsonStringSpan(str, len, true);
+}
+
+size_t EsfJsonPlainSpan(const char* str, size_t len) {
+  return EsfJsonStringSpan(str, len, false);
+}
+
+EsfJsonErrorCode EsfJsonPointerTokenDecode(const char* token, size_t len,
+                                           char* buf) {
+  size_t out = 0;
+  for (size_t i = 0; i < len; ++i) {
+    if (token[i] != '~') {
+      buf[out++] = token[i];
+      continue;
+    }
+    if (i + 1 < len && token[i + 1] == '0') {
+      buf[out++] = '~';
+    } else if (i + 1 < len && token[i + 1] == '1') {
+      buf[out++] = '/';
+    } else {
+      ESF_JSON_ERR("Invalid escape in JSON Pointer token.");
+      return kEsfJsonInvalidArgument;
+    }
+    ++i;
+  }
+  buf[out] = '\0';
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPointerIndexParse(const char* token, int32_t* index) {
+  // RFC 6901 array indexes have no sign and no leading zeros.
+  if (token[0] < '0' || token[0] > '9' ||
+      (token[0] == '0' && token[1] != '\0')) {
+    ESF_JSON_ERR("Invalid array index. token = %s", token);
+    return kEsfJsonInvalidArgument;
+  }
+  int64_t tmp_index = 0;
+  for (const char* p = token; *p != '\0'; ++p) {
+    if (*p < '0' || *p > '9') {
+      ESF_JSON_ERR("Invalid array index. token = %s", token);
+      return kEsfJsonInvalidArgument;
+    }
+    tmp_index = tmp_index * 10 + (*p - '0');
+    if (tmp_index > INT32_MAX) {
+      ESF_JSON_ERR("Array index out of range. token = %s", token);
+      return kEsfJsonIndexExceed;
+    }
+  }
+  *index = (int32_t)tmp_index;
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPointerResolve(JSON_Value* data, const char* pointer,
+                                       size_t len, JSON_Value** found) {
+  ESF_JSON_TRACE("entry.");
+  if (data == NULL || pointer == NULL || found == NULL) {
+    ESF_JSON_ERR("Parameter error. data = %p, pointer = %p, found = %p", data,
+                 pointer, found);
+    return kEsfJsonInvalidArgument;
+  }
+  if (len > 0 && pointer[0] != '/') {
+    ESF_JSON_ERR("JSON Pointer must start with '/'.");
+    return kEsfJsonInvalidArgument;
+  }
+
+  // Scratch for the decoded tokens, which are never longer than the pointer.
+  char* token = (char*)malloc(len + 1);
+  if (token == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for token.");
+    return kEsfJsonOutOfMemory;
+  }
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  const char* end = pointer + len;
+  const char* p = pointer;
+  while (ret == kEsfJsonSuccess && p < end) {
+    const char* begin = p + 1;
+    const char* next = memchr(begin, '/', (size_t)(end - begin));
+    if (next == NULL) {
+      next = end;
+    }
+    ret = EsfJsonPointerTokenDecode(begin, (size_t)(next - begin), token);
+    if (ret != kEsfJsonSuccess) {
+      break;
+    }
+    JSON_Value_Type type = json_value_get_type(data);
+    if (type == JSONObject) {
+      data = json_object_get_value(json_value_get_object(data), token);
+      if (data == NULL) {
+        ESF_JSON_ERR("Object member not found. key = %s", token);
+        ret = kEsfJsonValueNotFound;
+      }
+    } else if (type == JSONArray) {
+      int32_t index = 0;
+      ret = EsfJsonPointerIndexParse(token, &index);
+      if (ret == kEsfJsonSuccess) {
+        data = json_array_get_value(json_value_get_array(data), (size_t)index);
+        if (data == NULL) {
+          ESF_JSON_ERR("Array index out of range. index = %" PRId32, index);
+          ret = kEsfJsonIndexExceed;
+        }
+      }
+    } else {
+      ESF_JSON_ERR("JSON Pointer goes through a scalar. token = %s", token);
+      ret = kEsfJsonValueTypeError;
+    }
+    p = next;
+  }
+  free(token);
+  if (ret != kEsfJsonSuccess) {
+    return ret;
   }
-  // Check for can add the parent of the parent.
-  return EsfJsonCanJsonAddToJson(json_value, data, parent_parent_data);
+  *found = data;
+  ESF_JSON_TRACE("exit.");
+  return kEsfJsonSuccess;
 }
 
 EsfJsonErrorCode EsfJsonConvertedStringSizeGet(
@@ -1177,55 +1564,6 @@ JSON_STATIC EsfJsonErrorCode EsfJsonReplacementStringSizeGet(
   return kEsfJsonSuccess;
 }
 
-EsfJsonErrorCode EsfJsonSerializeUsingMemoryManagerFileIO(
-    EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
-    bool mem_handle_open, char* serialized_str, bool is_included,
-    size_t* serialized_size) {
-  ESF_JSON_TRACE("entry.");
-  if (json_value == NULL || serialized_str == NULL || serialized_size == NULL) {
-    ESF_JSON_ERR(
-        "Parameter error. json_value = %p, serialized_str = %p, "
-        "serialized_size = %p",
-        json_value, serialized_str, serialized_size);
-    return kEsfJsonInvalidArgument;
-  }
-  size_t wsize = 0;
-  size_t serialize_size = 0;
-  if (is_included == true) {
-    EsfJsonErrorCode ret = EsfJsonSerializeConversionStringFileIO(
-        json_value, mem_handle, mem_handle_open, &serialized_str, &wsize,
-        &serialize_size);
-    if (ret != kEsfJsonSuccess) {
-      ESF_JSON_ERR(
-          "EsfJsonSerializeConversionStringFileIO func failed. ret = %u, "
-          "json_value "
-          "= %p, mem_handle = %" PRIu32 ", serialized_str = %p",
-          ret, json_value, mem_handle, serialized_str);
-      return kEsfJsonInternalError;
-    }
-
-  } else {
-    // Do nothing.
-  }
-  size_t serialized_len = strlen(serialized_str) + 1;
-  EsfMemoryManagerResult result = EsfMemoryManagerFwrite(
-      mem_handle, serialized_str, serialized_len, &wsize);
-  if (result != kEsfMemoryManagerResultSuccess) {
-    ESF_JSON_ERR(
-        "EsfMemoryManagerFwrite func failed. ret = %u, mem_handle = %" PRIu32
-        ", buf = %p, size = %zu, wsize = %zu",
-        result, mem_handle, serialized_str, serialized_len, wsize);
-    return kEsfJsonInternalError;
-  }
-  serialize_size += wsize;
-  if (serialize_size != 0) {
-    serialize_size -= 1;
-  }
-  *serialized_size = serialize_size;
-  ESF_JSON_TRACE("exit.");
-  return kEsfJsonSuccess;
-}
-
 EsfJsonErrorCode EsfJsonSerializeUsingMemoryManagerMemMap(
     EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
     void* mem_data, char* serialized_str, bool is_included,
@@ -1444,159 +1782,6 @@ EsfJsonErrorCode EsfJsonStringSetHandleInternal(
   return kEsfJsonSuccess;
 }
 
-JSON_STATIC EsfJsonErrorCode EsfJsonSerializeConversionStringFileIO(
-    EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
-    bool mem_handle_open, char** serialized_str, size_t* wsize,
-    size_t* serialize_size) {
-  ESF_JSON_TRACE("entry.");
-  if (json_value == NULL || serialized_str == NULL || wsize == NULL ||
-      serialize_size == NULL) {
-    ESF_JSON_ERR(
-        "Parameter error. json_value = %p, serialized_str = %p, wsize = %p, "
-        "serialize_size = %p.",
-        json_value, serialized_str, wsize, serialize_size);
-    return kEsfJsonInvalidArgument;
-  }
-  char* buf = (char*)malloc(CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE);
-  if (buf == NULL) {
-    ESF_JSON_ERR("Failed to allocate memory for buf.");
-    return kEsfJsonOutOfMemory;
-  }
-  EsfJsonErrorCode ret = kEsfJsonSuccess;
-  EsfMemoryManagerResult mem_ret = kEsfMemoryManagerResultSuccess;
-  for (int i = 0; i < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++i) {
-    if (ret == kEsfJsonSuccess &&
-        json_value->mem_info[i].id != ESF_JSON_VALUE_INVALID) {
-      char convert_str[REPLACEMENT_STRING_MAX_SIZE];
-      int str_len = snprintf(convert_str, sizeof(convert_str),
-                             REPLACEMENT_STRING "%" PRId32 "",
-                             json_value->mem_info[i].id);
-      if (str_len < 0) {
-        ESF_JSON_ERR("Failed to get string size.");
-        ret = kEsfJsonInternalError;
-        break;
-      }
-      if (str_len > (int)sizeof(convert_str)) {
-        ESF_JSON_ERR("Buffer size exceeded.");
-        ret = kEsfJsonInternalError;
-        break;
-      }
-      char* search_p;
-      search_p = strstr(*serialized_str, convert_str);
-      if (search_p == NULL) {
-        continue;
-      } else {
-        size_t tmp_size = (size_t)(search_p - *serialized_str);
-        EsfMemoryManagerResult result = EsfMemoryManagerFwrite(
-            mem_handle, *serialized_str, tmp_size, wsize);
-        if (result != kEsfMemoryManagerResultSuccess) {
-          ESF_JSON_ERR(
-              "EsfMemoryManagerFwrite func failed. ret = %u, mem_handle = "
-              "%" PRIu32 ", buf = %p, size = %zu, wsize = %zu",
-              result, mem_handle, *serialized_str, tmp_size, *wsize);
-          ret = kEsfJsonInternalError;
-          break;
-        }
-        *serialize_size += *wsize;
-        // open mem_handle:json_value->mem_info[i].data
-        if (mem_handle_open) {
-          mem_ret = EsfMemoryManagerFopen(json_value->mem_info[i].data);
-          if (mem_ret != kEsfMemoryManagerResultSuccess) {
-            ESF_JSON_ERR(
-                "EsfMemoryManagerFopen for json_value->mem_info[%d].data = "
-                "%" PRIu32 " failed. ret = %u",
-                i, json_value->mem_info[i].data, mem_ret);
-            ret = kEsfJsonInternalError;
-            break;
-          }
-        }
-        off_t offset = 0;
-        result = EsfMemoryManagerFseek(json_value->mem_info[i].data,
-                                       json_value->mem_info[i].offset, SEEK_SET,
-                                       &offset);
-        if (result != kEsfMemoryManagerResultSuccess) {
-          ESF_JSON_ERR(
-              "EsfMemoryManagerFseek func failed. ret = %u, json_value = "
-              "%" PRIu32 ", offset = %jd, res_offset = %jd",
-              ret, json_value->mem_info[i].data,
-              (intmax_t)json_value->mem_info[i].offset, (intmax_t)offset);
-          // Close mem_handle:json_value->mem_info[i].data
-          if (mem_handle_open) {
-            mem_ret = EsfMemoryManagerFclose(json_value->mem_info[i].data);
-            if (mem_ret != kEsfMemoryManagerResultSuccess) {
-              ESF_JSON_ERR(
-                  "EsfMemoryManagerFclose for json_value->mem_info[%d].data = "
-                  "%" PRIu32 " failed. ret = %u",
-                  i, json_value->mem_info[i].data, mem_ret);
-            }
-          }
-          ret = kEsfJsonInternalError;
-          break;
-        }
-        size_t written_size = 0;
-        while (json_value->mem_info[i].size != written_size) {
-          size_t size = json_value->mem_info[i].size - written_size;
-          if (size >= CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE) {
-            size = CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE;
-          } else {
-            // Do nothing.
-          }
-          size_t read_size = 0;
-          result = EsfMemoryManagerFread(json_value->mem_info[i].data, buf,
-                                         size, &read_size);
-          if (result != kEsfMemoryManagerResultSuccess) {
-            ESF_JSON_ERR(
-                "EsfMemoryManagerFread func failed. ret = %u, mem_handle = "
-                "%" PRIu32 ", buf = %p, size = %zu, rsize = %zu",
-                result, json_value->mem_info[i].data, buf,
-                json_value->mem_info[i].size, read_size);
-            ret = kEsfJsonInternalError;
-            break;
-          }
-          result = EsfMemoryManagerFwrite(mem_handle, buf, read_size, wsize);
-          if (result != kEsfMemoryManagerResultSuccess) {
-            ESF_JSON_ERR(
-                "EsfMemoryManagerFwrite func failed. ret = %u, mem_handle = "
-                "%" PRIu32 ", buf = %p, size = %zu, wsize = %zu",
-                result, mem_handle, buf, read_size, *wsize);
-            ret = kEsfJsonInternalError;
-            break;
-          }
-          if (read_size != *wsize) {
-            ESF_JSON_ERR("Export size does not match read size.");
-            ret = kEsfJsonInternalError;
-            break;
-          }
-          written_size += *wsize;
-          *serialize_size += *wsize;
-        }
-        *serialized_str = search_p + str_len;
-        // Close mem_handle:json_value->mem_info[i].data
-        if (mem_handle_open) {
-          mem_ret = EsfMemoryManagerFclose(json_value->mem_info[i].data);
-          if (mem_ret != kEsfMemoryManagerResultSuccess) {
-            ESF_JSON_ERR(
-                "EsfMemoryManagerFclose for json_value->mem_info[%d].data = "
-                "%" PRIu32 " failed. ret = %u",
-                i, json_value->mem_info[i].data, mem_ret);
-            ret = kEsfJsonInternalError;
-            break;
-          }
-        }
-      }
-    } else {
-      break;
-    }
-  }
-  free(buf);
-  if (ret != kEsfJsonSuccess) {
-    ESF_JSON_TRACE("exit.");
-    return ret;
-  }
-  ESF_JSON_TRACE("exit.");
-  return kEsfJsonSuccess;
-}
-
 JSON_STATIC EsfJsonErrorCode EsfJsonSerializeConversionStringMemMap(
     EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
     void** mem_data, char** serialized_str, size_t* wsize,
@@ -1742,120 +1927,6 @@ EsfJsonErrorCode EsfJsonSerializeHandleMemMap(EsfJsonHandle handle,
   }
   // 3. Json Serialize
   EsfJsonErrorCode result = kEsfJsonSuccess;
-  char* serialized_str = NULL;
-  do {
-    JSON_Value* data = NULL;
-    result = EsfJsonValueFind(handle->json_value, value, &data);
-    if (result != kEsfJsonSuccess) {
-      ESF_JSON_ERR(
-          "EsfJsonValueFind func failed. ret = %u, handle->json_value = %p, "
-          "value = %" PRId32 "",
-          result, handle->json_value, value);
-      break;
-    }
-    serialized_str = json_serialize_to_string(data);
-    if (serialized_str == NULL) {
-      ESF_JSON_ERR("json_serialize_to_string func failed.");
-      result = kEsfJsonOutOfMemory;
-      break;
-    }
-
-    bool is_included = false;
-    result = EsfJsonSerializeIncludesHandle(handle, value, &is_included);
-    if (result != kEsfJsonSuccess) {
-      json_free_serialized_string(serialized_str);
-      ESF_JSON_ERR(
-          "EsfJsonSerializeIncludesHandle func failed. ret = %u, handle = %p, "
-          "value = %" PRId32 "",
-          result, handle, value);
-      break;
-    }
-    result = EsfJsonSerializeUsingMemoryManagerMemMap(
-        handle->json_value, mem_handle, mem_data, serialized_str, is_included,
-        serialized_size);
-    if (result != kEsfJsonSuccess) {
-      ESF_JSON_ERR(
-          "EsfJsonSerializeUsingMemoryManagerMemMap func failed. ret = %u, "
-          "handle->json_value = %p, mem_handle = %" PRIu32
-          ", mem_data = %p, serialized_str = %p, is_included = %d",
-          result, handle->json_value, mem_handle, mem_data, serialized_str,
-          is_included);
-      json_free_serialized_string(serialized_str);
-      break;
-    }
-  } while (0);
-  // 4. unmap mem_handle
-  mem_ret = EsfMemoryManagerUnmap(mem_handle, &mem_data);
-  if (mem_ret != kEsfMemoryManagerResultSuccess) {
-    ESF_JSON_ERR("EsfMemoryManagerUnmap for mem handle failed. ret = %u",
-                 mem_ret);
-    if (result == kEsfJsonSuccess) {
-      result = kEsfJsonInternalError;
-    }
-  }
-  ret = EsfJsonMutexUnlock(&mem_mutex);
-  if (ret != kEsfJsonSuccess) {
-    json_free_serialized_string(serialized_str);
-    ESF_JSON_ERR("EsfJsonMutexUnlock func failed. ret = %u", ret);
-    ESF_JSON_TRACE("exit.");
-    return ret;
-  }
-  if (result != kEsfJsonSuccess) {
-    ESF_JSON_TRACE("exit.");
-    return result;
-  }
-  json_free_serialized_string(serialized_str);
-  ESF_JSON_DEBUG("JSON Value serialize mem handle ID = %" PRId32
-                 ", mem_handle = %" PRIu32 ", serialized_size = %zu.",
-                 value, mem_handle, *serialized_size);
-
-  ESF_JSON_TRACE("exit.");
-  return kEsfJsonSuccess;
-}
-
-EsfJsonErrorCode EsfJsonSerializeHandleFileIO(EsfJsonHandle handle,
-                                              EsfJsonValue value,
-                                              EsfMemoryManagerHandle mem_handle,
-                                              size_t* serialized_size) {
-  ESF_JSON_TRACE("entry");
-  // 1. validate parameters
-  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
-    ESF_JSON_ERR("json handle NULL.");
-    ESF_JSON_TRACE("exit.");
-    return kEsfJsonHandleError;
-  }
-  if (serialized_size == NULL) {
-    ESF_JSON_ERR("Parameter error. serialized_size = %p", serialized_size);
-    ESF_JSON_TRACE("exit.");
-    return kEsfJsonInvalidArgument;
-  }
-  if (mem_handle == (EsfMemoryManagerHandle)0) {
-    ESF_JSON_ERR("mem handle NULL");
-    ESF_JSON_TRACE("exit.");
-    return kEsfJsonHandleError;
-  }
-  EsfJsonErrorCode ret = kEsfJsonInternalError;
-  ret = EsfJsonMutexLock(&mem_mutex);
-  if (ret != kEsfJsonSuccess) {
-    ESF_JSON_ERR("EsfJsonMutexLock func failed. ret = %u", ret);
-    ESF_JSON_TRACE("exit.");
-    return ret;
-  }
-  // 2. open mem_handle
-  EsfMemoryManagerResult mem_ret = EsfMemoryManagerFopen(mem_handle);
-  if (mem_ret != kEsfMemoryManagerResultSuccess) {
-    ESF_JSON_ERR("EsfMemoryManagerFopen for mem handle failed. ret = %u",
-                 mem_ret);
-    ret = EsfJsonMutexUnlock(&mem_mutex);
-    if (ret != kEsfJsonSuccess) {
-      ESF_JSON_ERR("EsfJsonMutexUnlock func failed. ret = %u", ret);
-    }
-    ESF_JSON_TRACE("exit.");
-    return kEsfJsonInternalError;
-  }
-  // 3. Json Serialize
-  EsfJsonErrorCode result = kEsfJsonSuccess;
-  char* serialized_str = NULL;
   do {
     JSON_Value* data = NULL;
     result = EsfJsonValueFind(handle->json_value, value, &data);
@@ -1866,34 +1937,13 @@ EsfJsonErrorCode EsfJsonSerializeHandleFileIO(EsfJsonHandle handle,
           result, handle->json_value, value);
       break;
     }
-    serialized_str = json_serialize_to_string(data);
-    if (serialized_str == NULL) {
-      ESF_JSON_ERR("json_serialize_to_string func failed.");
-      result = kEsfJsonOutOfMemory;
-      break;
-    }
-
-    bool is_included = false;
-    result = EsfJsonSerializeIncludesHandle(handle, value, &is_included);
-    if (result != kEsfJsonSuccess) {
-      json_free_serialized_string(serialized_str);
-      ESF_JSON_ERR(
-          "EsfJsonSerializeIncludesHandle func failed. ret = %u, handle = %p, "
-          "value = %" PRId32 "",
-          result, handle, value);
-      break;
-    }
-    result = EsfJsonSerializeUsingMemoryManagerFileIO(
-        handle->json_value, mem_handle, true, serialized_str, is_included,
-        serialized_size);
+    result = EsfJsonSerializeStreamFileIO(handle->json_value, data,
+                                          mem_handle, true, serialized_size);
     if (result != kEsfJsonSuccess) {
       ESF_JSON_ERR(
-          "EsfJsonSerializeUsingMemoryManagerFileIO func failed. ret = %u, "
-          "handle->json_value = %p, mem_handle = %" PRIu32
-          "mem_handle_open = %d, serialized_str = %p, is_included = %d",
-          result, handle->json_value, mem_handle, true, serialized_str,
-          is_included);
-      json_free_serialized_string(serialized_str);
+          "EsfJsonSerializeStreamFileIO func failed. ret = %u, "
+          "handle->json_value = %p, mem_handle = %" PRIu32 "",
+          result, handle->json_value, mem_handle);
       break;
     }
   } while (0);
@@ -1908,7 +1958,6 @@ EsfJsonErrorCode EsfJsonSerializeHandleFileIO(EsfJsonHandle handle,
   }
   ret = EsfJsonMutexUnlock(&mem_mutex);
   if (ret != kEsfJsonSuccess) {
-    json_free_serialized_string(serialized_str);
     ESF_JSON_ERR("EsfJsonMutexUnlock func failed. ret = %u", ret);
     ESF_JSON_TRACE("exit.");
     return ret;
@@ -1917,7 +1966,6 @@ EsfJsonErrorCode EsfJsonSerializeHandleFileIO(EsfJsonHandle handle,
     ESF_JSON_TRACE("exit.");
     return result;
   }
-  json_free_serialized_string(serialized_str);
   ESF_JSON_DEBUG("JSON Value serialize mem handle ID = %" PRId32
                  ", mem_handle = %" PRIu32 ", serialized_size = %zu.",
                  value, mem_handle, *serialized_size);
@@ -2095,3 +2143,101 @@ JSON_STATIC size_t EsfJsonFindEmptyMemHandleInfo(
   ESF_JSON_TRACE("exit.");
   return i;
 }
+
+JSON_STATIC int32_t EsfJsonValueIdToOffset(
+    const EsfJsonValueContainer* json_value, EsfJsonValue value) {
+  // IDs are issued in order starting from 1, and a removed entry keeps its
+  // position with ESF_JSON_VALUE_INVALID as ID.
+  if (value < 1 || value > json_value->size) {
+    return -1;
+  }
+  int32_t offset = value - 1;
+  if (json_value->data[offset].id != value) {
+    return -1;
+  }
+  return offset;
+}
+
+// Spread the pointer bits over the index slots (MurmurHash3 finalizer).
+static uint32_t EsfJsonValueIndexHash(const JSON_Value* data) {
+  uint64_t key = (uint64_t)(uintptr_t)data;
+  key ^= key >> 33;
+  key *= UINT64_C(0xff51afd7ed558ccd);
+  key ^= key >> 33;
+  return (uint32_t)key;
+}
+
+JSON_STATIC int32_t EsfJsonValueIndexFind(
+    const EsfJsonValueContainer* json_value, const JSON_Value* data) {
+  if (json_value->index == NULL) {
+    return -1;
+  }
+  uint32_t mask = (uint32_t)json_value->index_capacity - 1U;
+  uint32_t slot = EsfJsonValueIndexHash(data) & mask;
+  for (int32_t n = 0; n < json_value->index_capacity; ++n) {
+    int32_t offset = json_value->index[slot];
+    if (offset == ESF_JSON_INDEX_EMPTY) {
+      break;
+    }
+    if (offset >= 0 && json_value->data[offset].data == data) {
+      return (int32_t)slot;
+    }
+    slot = (slot + 1U) & mask;
+  }
+  return -1;
+}
+
+JSON_STATIC EsfJsonErrorCode EsfJsonValueIndexReserve(
+    EsfJsonValueContainer* json_value) {
+  if ((json_value->index_used + 1) * 4 <= json_value->index_capacity * 3) {
+    return kEsfJsonSuccess;
+  }
+
+  // Size the new index so that it is at most half full after the rebuild.
+  int32_t live = 0;
+  for (int32_t i = 0; i < json_value->index_capacity; ++i) {
+    if (json_value->index[i] >= 0) {
+      ++live;
+    }
+  }
+  int32_t new_capacity = ESF_JSON_INDEX_CAPACITY_MIN;
+  while (new_capacity < (live + 1) * 2) {
+    new_capacity *= 2;
+  }
+
+  int32_t* new_index = (int32_t*)malloc(sizeof(*new_index) * new_capacity);
+  if (new_index == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for new_index.");
+    return kEsfJsonOutOfMemory;
+  }
+  for (int32_t i = 0; i < new_capacity; ++i) {
+    new_index[i] = ESF_JSON_INDEX_EMPTY;
+  }
+
+  int32_t* old_index = json_value->index;
+  int32_t old_capacity = json_value->index_capacity;
+  json_value->index = new_index;
+  json_value->index_capacity = new_capacity;
+  json_value->index_used = 0;
+  for (int32_t i = 0; i < old_capacity; ++i) {
+    if (old_index[i] >= 0) {
+      EsfJsonValueIndexInsert(json_value, old_index[i]);
+    }
+  }
+  free(old_index);
+  return kEsfJsonSuccess;
+}
+
+JSON_STATIC void EsfJsonValueIndexInsert(EsfJsonValueContainer* json_value,
+                                         int32_t offset) {
+  uint32_t mask = (uint32_t)json_value->index_capacity - 1U;
+  uint32_t slot =
+      EsfJsonValueIndexHash(json_value->data[offset].data) & mask;
+  while (json_value->index[slot] >= 0) {
+    slot = (slot + 1U) & mask;
+  }
+  if (json_value->index[slot] == ESF_JSON_INDEX_EMPTY) {
+    ++(json_value->index_used);
+  }
+  json_value->index[slot] = offset;
+}
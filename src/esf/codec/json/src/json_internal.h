@@ -10,6 +10,7 @@
 #include <pthread.h>
 
 #include "json.h"
+#include "json_arena.h"
 #include "json_fileio.h"
 #include "json_handle.h"
 #include "memory_manager.h"
@@ -61,6 +62,9 @@
 #define REPLACEMENT_STRING_MAX_SIZE 29
 #define REPLACEMENT_STRING "JSON_PLACEHOLDER_"
 #define JSON_VALUE_ID_STRING_MAX_SIZE 5
+// Size of the longest escape sequence of a character, "\u00XX", with the
+// terminator.
+#define ESF_JSON_ESCAPE_MAX_SIZE 7
 
 typedef struct EsfJsonValueData EsfJsonValueData;
 
@@ -92,6 +96,13 @@ struct EsfJsonValueContainer {
   int32_t size;
   // Last JSON Value ID.
   EsfJsonValue last_id;
+  // Open addressing index from JSON Value to its position in data. IDs are
+  // issued as position + 1, so the reverse direction needs no index.
+  int32_t* index;
+  // The number of index slots. Always a power of two.
+  int32_t index_capacity;
+  // The number of index slots that are in use or deleted.
+  int32_t index_used;
   // memory manager info.
   EsfJsonMemoryInfo mem_info[CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX];
 };
@@ -100,8 +111,12 @@ struct EsfJsonValueContainer {
 struct EsfJsonHandleImpl {
   // JSON data array.
   EsfJsonValueContainer* json_value;
-  // Serialization string.
+  // Serialization string. Allocated with malloc() also for an arena handle.
   char* serialized_str;
+  // Arena of the JSON values. NULL when stdlib allocates them.
+  EsfJsonArena* arena;
+  // Size of the buffer serialized_str points to. Reused while it fits.
+  size_t serialized_capacity;
 };
 
 // internal func
@@ -213,6 +228,38 @@ EsfJsonErrorCode EsfJsonValueContainerInit(EsfJsonValueContainer** json_value);
 //    kEsfJsonInternalError:  Internal error.
 EsfJsonErrorCode EsfJsonValueContainerFree(EsfJsonValueContainer* json_value);
 
+// """Release EsfJsonValueContainer without releasing the JSON values.
+
+// Used when the JSON values live in an arena that is released as a whole.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+//      information. NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error.
+EsfJsonErrorCode EsfJsonValueContainerDiscard(
+    EsfJsonValueContainer* json_value);
+
+// """Empty EsfJsonValueContainer for reuse.
+
+// Unregisters every JSON value but keeps the capacity of the data array and
+// the index.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+//      NULL is not acceptable.
+//    free_values (bool): Free the JSON values too. Pass false when they are
+//      released together with an arena.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Arg parameter error.
+//    kEsfJsonInternalError: Internal error.
+EsfJsonErrorCode EsfJsonValueContainerReset(EsfJsonValueContainer* json_value,
+                                            bool free_values);
+
 // """Convert JSON_Value_Type to EsfJsonValueType.
 
 // Args:
@@ -303,6 +350,101 @@ EsfJsonErrorCode EsfJsonValueNotManagedAdd(EsfJsonValueContainer* json_value,
 bool EsfJsonCanJsonAddToJson(EsfJsonValueContainer* json_value,
                              JSON_Value* data, JSON_Value* parent_data);
 
+// """Get the escape sequence of a character in a JSON string.
+
+// The sequences match the ones parson writes.
+
+// Args:
+//    c (char): Character.
+//    buf (char*): Buffer of ESF_JSON_ESCAPE_MAX_SIZE bytes for "\u00XX".
+//      NULL is not acceptable.
+
+// Returns:
+//    The escape sequence, or NULL if c is written as is.
+const char* EsfJsonEscapeGet(char c, char* buf);
+
+// """Get the length of the leading bytes of a string that are written as is
+// when serializing.
+
+// Use this to copy the plain runs of a string in one go, and
+// EsfJsonEscapeGet for the byte that ends each run.
+
+// Args:
+//    str (const char*): String. NULL is not acceptable.
+//    len (size_t): Length of str.
+
+// Returns:
+//    The offset of the first byte that needs an escape sequence, or len if
+//    there is none.
+size_t EsfJsonEscapeSpan(const char* str, size_t len);
+
+// """Get the length of the leading bytes of a JSON string body that a parser
+// can copy as is.
+
+// Args:
+//    str (const char*): String body after the opening quote. NULL is not
+//      acceptable.
+//    len (size_t): Length of str.
+
+// Returns:
+//    The offset of the first '"', '\\', control character or non-ASCII byte,
+//    or len if there is none.
+size_t EsfJsonPlainSpan(const char* str, size_t len);
+
+// """Decode a reference token of a JSON Pointer (RFC 6901).
+
+// Replaces "~1" with "/" and "~0" with "~".
+
+// Args:
+//    token (const char*): Reference token, without the leading "/".
+//      NULL is not acceptable.
+//    len (size_t): Length of token.
+//    buf (char*): Decoded NULL terminated token. At least len + 1 bytes.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed token.
+EsfJsonErrorCode EsfJsonPointerTokenDecode(const char* token, size_t len,
+                                           char* buf);
+
+// """Convert a decoded reference token to an array index.
+
+// Args:
+//    token (const char*): Decoded reference token.
+//      NULL is not acceptable.
+//    index (int32_t*): Array index.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: token is not an array index.
+//    kEsfJsonIndexExceed: Index out of the int32_t range.
+EsfJsonErrorCode EsfJsonPointerIndexParse(const char* token, int32_t* index);
+
+// """Resolve a JSON Pointer (RFC 6901) against a JSON value.
+
+// Walks the parson tree directly, no JSON Value ID is registered on the way.
+
+// Args:
+//    data (JSON_Value*): JSON value the pointer is relative to.
+//      NULL is not acceptable.
+//    pointer (const char*): JSON Pointer. "" refers to data itself.
+//      NULL is not acceptable.
+//    len (size_t): Number of characters of pointer to use.
+//    found (JSON_Value**): Referenced JSON value.
+//      NULL is not acceptable.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed pointer.
+//    kEsfJsonValueTypeError: The pointer goes through a scalar value.
+//    kEsfJsonValueNotFound: Object member not found.
+//    kEsfJsonIndexExceed: Array index out of range.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+EsfJsonErrorCode EsfJsonPointerResolve(JSON_Value* data, const char* pointer,
+                                       size_t len, JSON_Value** found);
+
 // """Get the number of characters in the substitution string when the
 // substitution string is converted to the replaced string.
 
@@ -339,39 +481,38 @@ EsfJsonErrorCode EsfJsonConvertedStringSizeGet(
 EsfJsonErrorCode EsfJsonCheckStringReplace(EsfJsonValueContainer* json_value,
                                            JSON_Value* data, bool* is_included);
 
-// """Serializes a JSON value using a memory manager and writes it to a file.
+// """Serializes a JSON value and streams it to a FileIO Memory Manager handle.
 //
-// This function takes a JSON value container and serializes it into a string,
-// utilizing a memory manager for handling the memory operations. The serialized
-// string is then written to a file. The function can optionally include
-// additional data during serialization based on the `is_included` flag.
+// Walks the JSON tree once and writes the JSON string, including the
+// terminating character, to mem_handle through a write buffer of
+// CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE bytes. String Values linked to a
+// Memory Manager handle are replaced by the contents of that handle at the
+// point where they are reached, so no serialized copy of the whole document
+// is ever built.
 //
 // Args:
 // json_value A pointer to the EsfJsonValueContainer that holds the JSON data to
 //            be serialized. Must not be NULL.
-// mem_handle A handle to the memory manager used for managing memory
-//            operations.
-// mem_handle_open memory manager handle open request (true:open request)
-// serialized_str A pointer to a character array where the serialized JSON
-//                string will be stored. Must not be NULL.
-// is_included A boolean flag indicating whether additional data should be
-//             included in the serialization.
-// erialized_size A pointer to a size_t variable where the size of the
-//                serialized data will be stored. Must not be NULL.
+// data The JSON value to serialize. Must not be NULL.
+// mem_handle The Memory Manager handle to write to, already opened.
+// mem_handle_open Open and close the handles linked to String Values around
+//                 their copy (true:open request)
+// serialized_size A pointer to a size_t variable where the size of the
+//                 serialized data, excluding the terminating character, will
+//                 be stored. Must not be NULL.
 //
 // Returns:
 // Returns an EsfJsonErrorCode indicating the success or failure of the
 // operation.
 //  - kEsfJsonSuccess: Serialization and writing were successful.
 //  - kEsfJsonInvalidArgument: One or more input parameters are NULL.
+//  - kEsfJsonOutOfMemory: Memory allocation failed.
 //  - kEsfJsonInternalError: An internal error occurred during serialization or
 //  writing.
-//
-// Notes:
 // """
-EsfJsonErrorCode EsfJsonSerializeUsingMemoryManagerFileIO(
-    EsfJsonValueContainer* json_value, EsfMemoryManagerHandle mem_handle,
-    bool mem_handle_open, char* serialized_str, bool is_included,
+EsfJsonErrorCode EsfJsonSerializeStreamFileIO(
+    EsfJsonValueContainer* json_value, const JSON_Value* data,
+    EsfMemoryManagerHandle mem_handle, bool mem_handle_open,
     size_t* serialized_size);
 
 // """Serializes a JSON value using a memory manager and memory map.
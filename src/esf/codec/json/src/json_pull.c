@@ -0,0 +1,1115 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "json_pull.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+#include "memory_manager.h"
+#include "parson/lib/parson.h"
+
+// Deepest nesting of Objects and Arrays the parser accepts.
+#define ESF_JSON_PULL_DEPTH_MAX (64)
+// Initial capacity of the token buffer.
+#define ESF_JSON_PULL_TOKEN_SIZE (64)
+// Value returned by EsfJsonPullPeek at the end of the input.
+#define ESF_JSON_PULL_EOF (-1)
+
+// What the parser expects next.
+typedef enum EsfJsonPullState {
+  kEsfJsonPullStateValue,       // Any value.
+  kEsfJsonPullStateFirstValue,  // First element of an Array, or ']'.
+  kEsfJsonPullStateFirstKey,    // First member of an Object, or '}'.
+  kEsfJsonPullStateKey,         // Member of an Object.
+  kEsfJsonPullStateCommaOrEnd,  // ',' or the end of the enclosing container.
+  kEsfJsonPullStateDone,        // Nothing but white space.
+} EsfJsonPullState;
+
+struct EsfJsonPullParserImpl {
+  // Source of the JSON string.
+  EsfMemoryManagerHandle mem_handle;
+  // Address of mem_handle while it is mapped, otherwise NULL.
+  void* map_address;
+  // Read buffer of CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE bytes for File I/O.
+  char* read_buf;
+  // Bytes available for parsing. Either map_address or read_buf.
+  const char* data;
+  // Number of valid bytes of data.
+  size_t data_size;
+  // Parse position in data.
+  size_t pos;
+  // Bytes of the string not read into read_buf yet.
+  size_t remaining;
+  // Unescaped string or number text of the current event.
+  char* token;
+  size_t token_len;
+  size_t token_capacity;
+  // Value of the current scalar event.
+  double number;
+  bool boolean;
+  // Current event and what comes next.
+  EsfJsonPullEvent event;
+  EsfJsonPullState state;
+  // Open containers, '{' or '['.
+  char stack[ESF_JSON_PULL_DEPTH_MAX];
+  int32_t depth;
+  // First error. Once set, every call returns it.
+  EsfJsonErrorCode error;
+};
+
+// """Latch an error of the parser.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    error (EsfJsonErrorCode): Error code.
+
+// Returns:
+//    The first error latched.
+static EsfJsonErrorCode EsfJsonPullFail(EsfJsonPullParser parser,
+                                        EsfJsonErrorCode error) {
+  if (parser->error == kEsfJsonSuccess) {
+    parser->error = error;
+  }
+  return parser->error;
+}
+
+// """Read the next block of the string into read_buf.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    true if bytes were read, false at the end of the input or on error.
+static bool EsfJsonPullFill(EsfJsonPullParser parser) {
+  if (parser->read_buf == NULL || parser->remaining == 0) {
+    return false;
+  }
+  size_t size = parser->remaining;
+  if (size > CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE) {
+    size = CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE;
+  }
+  size_t rsize = 0;
+  EsfMemoryManagerResult result = EsfMemoryManagerFread(
+      parser->mem_handle, parser->read_buf, size, &rsize);
+  if (result != kEsfMemoryManagerResultSuccess || rsize == 0) {
+    ESF_JSON_ERR(
+        "EsfMemoryManagerFread func failed. ret = %u, mem_handle = "
+        "%" PRIu32 ", size = %zu, rsize = %zu",
+        result, parser->mem_handle, size, rsize);
+    EsfJsonPullFail(parser, kEsfJsonInternalError);
+    return false;
+  }
+  parser->remaining -= rsize;
+  parser->data_size = rsize;
+  parser->pos = 0;
+  return true;
+}
+
+// """Look at the next byte of the input without consuming it.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    The byte, or ESF_JSON_PULL_EOF at the end of the input (a NULL
+//    terminator counts as the end) and on read errors.
+static int EsfJsonPullPeek(EsfJsonPullParser parser) {
+  if (parser->pos == parser->data_size && !EsfJsonPullFill(parser)) {
+    return ESF_JSON_PULL_EOF;
+  }
+  unsigned char c = (unsigned char)parser->data[parser->pos];
+  if (c == '\0') {
+    // Ignore everything after the terminator.
+    parser->data_size = parser->pos;
+    parser->remaining = 0;
+    return ESF_JSON_PULL_EOF;
+  }
+  return c;
+}
+
+// """Consume the next byte of the input.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    The byte, or ESF_JSON_PULL_EOF at the end of the input.
+static int EsfJsonPullGetc(EsfJsonPullParser parser) {
+  int c = EsfJsonPullPeek(parser);
+  if (c != ESF_JSON_PULL_EOF) {
+    parser->pos++;
+  }
+  return c;
+}
+
+// """Skip white space.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    The first byte after the white space, not consumed.
+static int EsfJsonPullSkipSpace(EsfJsonPullParser parser) {
+  for (;;) {
+    int c = EsfJsonPullPeek(parser);
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+      return c;
+    }
+    parser->pos++;
+  }
+}
+
+// """Append bytes to the token buffer.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    str (const char*): Bytes to append.
+//    len (size_t): Number of bytes.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+static EsfJsonErrorCode EsfJsonPullTokenAppend(EsfJsonPullParser parser,
+                                               const char* str, size_t len) {
+  // Keep room for the NULL terminator.
+  if (parser->token_len + len >= parser->token_capacity) {
+    size_t capacity = parser->token_capacity * 2;
+    while (parser->token_len + len >= capacity) {
+      capacity *= 2;
+    }
+    char* token = (char*)realloc(parser->token, capacity);
+    if (token == NULL) {
+      ESF_JSON_ERR("Failed to allocate memory for token. capacity = %zu",
+                   capacity);
+      return EsfJsonPullFail(parser, kEsfJsonOutOfMemory);
+    }
+    parser->token = token;
+    parser->token_capacity = capacity;
+  }
+  memcpy(parser->token + parser->token_len, str, len);
+  parser->token_len += len;
+  parser->token[parser->token_len] = '\0';
+  return kEsfJsonSuccess;
+}
+
+// """Append a byte to the token buffer.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    c (char): Byte to append.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+static EsfJsonErrorCode EsfJsonPullTokenPush(EsfJsonPullParser parser,
+                                             char c) {
+  return EsfJsonPullTokenAppend(parser, &c, 1);
+}
+
+// """Append a code point to the token buffer in UTF-8.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    cp (uint32_t): Code point.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+static EsfJsonErrorCode EsfJsonPullTokenPushUtf8(EsfJsonPullParser parser,
+                                                 uint32_t cp) {
+  char buf[4];
+  size_t len = 0;
+  if (cp < 0x80) {
+    buf[len++] = (char)cp;
+  } else if (cp < 0x800) {
+    buf[len++] = (char)(0xC0 | (cp >> 6));
+    buf[len++] = (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    buf[len++] = (char)(0xE0 | (cp >> 12));
+    buf[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    buf[len++] = (char)(0x80 | (cp & 0x3F));
+  } else {
+    buf[len++] = (char)(0xF0 | (cp >> 18));
+    buf[len++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+    buf[len++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    buf[len++] = (char)(0x80 | (cp & 0x3F));
+  }
+  return EsfJsonPullTokenAppend(parser, buf, len);
+}
+
+// """Read the rest of a UTF-8 sequence and append it to the token buffer.
+
+// Rejects what parson rejects: invalid lead or continuation bytes, overlong
+// forms, surrogates and code points above U+10FFFF.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    lead (int): First byte of the sequence, consumed already.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed input.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonPullReadUtf8(EsfJsonPullParser parser,
+                                            int lead) {
+  size_t len = 0;
+  uint32_t cp = 0;
+  uint32_t cp_min = 0;
+  if ((lead & 0xE0) == 0xC0) {
+    len = 2;
+    cp = (uint32_t)(lead & 0x1F);
+    cp_min = 0x80;
+  } else if ((lead & 0xF0) == 0xE0) {
+    len = 3;
+    cp = (uint32_t)(lead & 0x0F);
+    cp_min = 0x800;
+  } else if ((lead & 0xF8) == 0xF0) {
+    len = 4;
+    cp = (uint32_t)(lead & 0x07);
+    cp_min = 0x10000;
+  } else {
+    ESF_JSON_ERR("Invalid UTF-8 lead byte. c = 0x%02X", lead);
+    return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+  char buf[4];
+  buf[0] = (char)lead;
+  for (size_t i = 1; i < len; ++i) {
+    int c = EsfJsonPullGetc(parser);
+    if (c == ESF_JSON_PULL_EOF || (c & 0xC0) != 0x80) {
+      if (parser->error != kEsfJsonSuccess) {
+        return parser->error;
+      }
+      ESF_JSON_ERR("Invalid UTF-8 continuation byte. c = %d", c);
+      return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+    }
+    buf[i] = (char)c;
+    cp = (cp << 6) | (uint32_t)(c & 0x3F);
+  }
+  if (cp < cp_min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+    ESF_JSON_ERR("Invalid UTF-8 sequence. cp = 0x%" PRIX32, cp);
+    return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+  return EsfJsonPullTokenAppend(parser, buf, len);
+}
+
+// """Read the 4 hex digits of a \u escape.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    cp (uint32_t*): Value of the digits.
+
+// Returns:
+//    true on success, false on malformed input.
+static bool EsfJsonPullReadHex4(EsfJsonPullParser parser, uint32_t* cp) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    int c = EsfJsonPullGetc(parser);
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= (uint32_t)(c - '0');
+    } else if (c >= 'a' && c <= 'f') {
+      value |= (uint32_t)(c - 'a' + 10);
+    } else if (c >= 'A' && c <= 'F') {
+      value |= (uint32_t)(c - 'A' + 10);
+    } else {
+      return false;
+    }
+  }
+  *cp = value;
+  return true;
+}
+
+// """Read a string into the token buffer. The opening quote is consumed
+// already.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed input.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonPullReadString(EsfJsonPullParser parser) {
+  parser->token_len = 0;
+  parser->token[0] = '\0';
+  for (;;) {
+    // Copy the plain ASCII run of the current block in one go.
+    size_t start = parser->pos;
+    size_t run = EsfJsonPlainSpan(parser->data + start,
+                                  parser->data_size - start);
+    EsfJsonErrorCode ret =
+        EsfJsonPullTokenAppend(parser, parser->data + start, run);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+    parser->pos = start + run;
+
+    int c = EsfJsonPullGetc(parser);
+    if (c == '\"') {
+      return kEsfJsonSuccess;
+    }
+    if (c == ESF_JSON_PULL_EOF || c < 0x20) {
+      if (parser->error != kEsfJsonSuccess) {
+        return parser->error;
+      }
+      ESF_JSON_ERR("Unterminated string or control character. c = %d", c);
+      return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+    }
+    if (c >= 0x80) {
+      ret = EsfJsonPullReadUtf8(parser, c);
+      if (ret != kEsfJsonSuccess) {
+        return ret;
+      }
+      continue;
+    }
+    if (c != '\\') {
+      // The block ended in the middle of the string.
+      ret = EsfJsonPullTokenPush(parser, (char)c);
+      if (ret != kEsfJsonSuccess) {
+        return ret;
+      }
+      continue;
+    }
+
+    c = EsfJsonPullGetc(parser);
+    char unescaped = '\0';
+    switch (c) {
+      case '\"':
+      case '\\':
+      case '/':
+        unescaped = (char)c;
+        break;
+      case 'b':
+        unescaped = '\b';
+        break;
+      case 'f':
+        unescaped = '\f';
+        break;
+      case 'n':
+        unescaped = '\n';
+        break;
+      case 'r':
+        unescaped = '\r';
+        break;
+      case 't':
+        unescaped = '\t';
+        break;
+      case 'u': {
+        uint32_t cp = 0;
+        if (!EsfJsonPullReadHex4(parser, &cp)) {
+          ESF_JSON_ERR("Invalid \\u escape.");
+          return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+        }
+        if (cp >= 0xDC00 && cp <= 0xDFFF) {
+          ESF_JSON_ERR("Unpaired low surrogate. cp = 0x%04" PRIX32, cp);
+          return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+        }
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+          uint32_t low = 0;
+          if (EsfJsonPullGetc(parser) != '\\' ||
+              EsfJsonPullGetc(parser) != 'u' ||
+              !EsfJsonPullReadHex4(parser, &low) || low < 0xDC00 ||
+              low > 0xDFFF) {
+            ESF_JSON_ERR("Unpaired high surrogate. cp = 0x%04" PRIX32, cp);
+            return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+          }
+          cp = 0x10000 + (((cp - 0xD800) << 10) | (low - 0xDC00));
+        }
+        ret = EsfJsonPullTokenPushUtf8(parser, cp);
+        if (ret != kEsfJsonSuccess) {
+          return ret;
+        }
+        continue;
+      }
+      default:
+        ESF_JSON_ERR("Invalid escape sequence. c = %d", c);
+        return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+    }
+    ret = EsfJsonPullTokenPush(parser, unescaped);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+  }
+}
+
+// """Read a number and convert it like parson does.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed input.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+static EsfJsonErrorCode EsfJsonPullReadNumber(EsfJsonPullParser parser) {
+  parser->token_len = 0;
+  parser->token[0] = '\0';
+  // Collect the characters a number can consist of, then check the grammar:
+  // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  for (;;) {
+    int c = EsfJsonPullPeek(parser);
+    if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+          c == 'e' || c == 'E')) {
+      break;
+    }
+    EsfJsonErrorCode ret = EsfJsonPullTokenPush(parser, (char)c);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+    parser->pos++;
+  }
+
+  const char* p = parser->token;
+  bool valid = true;
+  if (*p == '-') {
+    ++p;
+  }
+  if (*p == '0') {
+    ++p;
+  } else if (*p >= '1' && *p <= '9') {
+    while (*p >= '0' && *p <= '9') ++p;
+  } else {
+    valid = false;
+  }
+  if (valid && *p == '.') {
+    ++p;
+    valid = (*p >= '0' && *p <= '9');
+    while (*p >= '0' && *p <= '9') ++p;
+  }
+  if (valid && (*p == 'e' || *p == 'E')) {
+    ++p;
+    if (*p == '+' || *p == '-') {
+      ++p;
+    }
+    valid = (*p >= '0' && *p <= '9');
+    while (*p >= '0' && *p <= '9') ++p;
+  }
+  if (!valid || *p != '\0') {
+    ESF_JSON_ERR("Invalid number. token = %s", parser->token);
+    return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+
+  errno = 0;
+  double number = strtod(parser->token, NULL);
+  if (errno == ERANGE && (number <= -HUGE_VAL || number >= HUGE_VAL)) {
+    ESF_JSON_ERR("Number out of range. token = %s", parser->token);
+    return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+  parser->number = number;
+  return kEsfJsonSuccess;
+}
+
+// """Consume a literal such as "true".
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    literal (const char*): Expected text.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed input.
+static EsfJsonErrorCode EsfJsonPullReadLiteral(EsfJsonPullParser parser,
+                                               const char* literal) {
+  for (const char* p = literal; *p != '\0'; ++p) {
+    if (EsfJsonPullGetc(parser) != (unsigned char)*p) {
+      ESF_JSON_ERR("Invalid literal. expected = %s", literal);
+      return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+    }
+  }
+  return kEsfJsonSuccess;
+}
+
+// """State after a value or the end of a container.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+static void EsfJsonPullValueDone(EsfJsonPullParser parser) {
+  parser->state = (parser->depth == 0) ? kEsfJsonPullStateDone
+                                       : kEsfJsonPullStateCommaOrEnd;
+}
+
+// """Open a container.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    open (char): '{' or '['.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Nesting too deep.
+static EsfJsonErrorCode EsfJsonPullPush(EsfJsonPullParser parser, char open) {
+  if (parser->depth >= ESF_JSON_PULL_DEPTH_MAX) {
+    ESF_JSON_ERR("Nesting too deep. depth = %" PRId32, parser->depth);
+    return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+  parser->stack[parser->depth++] = open;
+  if (open == '{') {
+    parser->event = kEsfJsonPullEventObjectBegin;
+    parser->state = kEsfJsonPullStateFirstKey;
+  } else {
+    parser->event = kEsfJsonPullEventArrayBegin;
+    parser->state = kEsfJsonPullStateFirstValue;
+  }
+  return kEsfJsonSuccess;
+}
+
+// """Close the innermost container.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+static void EsfJsonPullPop(EsfJsonPullParser parser) {
+  char open = parser->stack[--parser->depth];
+  parser->event = (open == '{') ? kEsfJsonPullEventObjectEnd
+                                : kEsfJsonPullEventArrayEnd;
+  EsfJsonPullValueDone(parser);
+}
+
+// """Read a value.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    c (int): First byte of the value, not consumed.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    Other: Error latched in the parser.
+static EsfJsonErrorCode EsfJsonPullReadValue(EsfJsonPullParser parser,
+                                             int c) {
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  switch (c) {
+    case '{':
+    case '[':
+      parser->pos++;
+      return EsfJsonPullPush(parser, (char)c);
+    case '\"':
+      parser->pos++;
+      ret = EsfJsonPullReadString(parser);
+      parser->event = kEsfJsonPullEventString;
+      break;
+    case 't':
+      ret = EsfJsonPullReadLiteral(parser, "true");
+      parser->boolean = true;
+      parser->event = kEsfJsonPullEventBoolean;
+      break;
+    case 'f':
+      ret = EsfJsonPullReadLiteral(parser, "false");
+      parser->boolean = false;
+      parser->event = kEsfJsonPullEventBoolean;
+      break;
+    case 'n':
+      ret = EsfJsonPullReadLiteral(parser, "null");
+      parser->event = kEsfJsonPullEventNull;
+      break;
+    default:
+      if (c == '-' || (c >= '0' && c <= '9')) {
+        ret = EsfJsonPullReadNumber(parser);
+        parser->event = kEsfJsonPullEventNumber;
+        break;
+      }
+      if (parser->error != kEsfJsonSuccess) {
+        return parser->error;
+      }
+      ESF_JSON_ERR("Unexpected character. c = %d", c);
+      return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+  }
+  EsfJsonPullValueDone(parser);
+  return ret;
+}
+
+// """Advance to the next event.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    Other: Error latched in the parser.
+static EsfJsonErrorCode EsfJsonPullAdvance(EsfJsonPullParser parser) {
+  for (;;) {
+    int c = EsfJsonPullSkipSpace(parser);
+    if (parser->error != kEsfJsonSuccess) {
+      return parser->error;
+    }
+    switch (parser->state) {
+      case kEsfJsonPullStateDone:
+        if (c != ESF_JSON_PULL_EOF) {
+          ESF_JSON_ERR("Unexpected data after the value. c = %d", c);
+          return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+        }
+        parser->event = kEsfJsonPullEventEndOfDocument;
+        return kEsfJsonSuccess;
+
+      case kEsfJsonPullStateCommaOrEnd: {
+        char open = parser->stack[parser->depth - 1];
+        if (c == ',') {
+          parser->pos++;
+          parser->state = (open == '{') ? kEsfJsonPullStateKey
+                                        : kEsfJsonPullStateValue;
+          continue;
+        }
+        if ((open == '{' && c == '}') || (open == '[' && c == ']')) {
+          parser->pos++;
+          EsfJsonPullPop(parser);
+          return kEsfJsonSuccess;
+        }
+        ESF_JSON_ERR("Expected ',' or the end of the container. c = %d", c);
+        return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+      }
+
+      case kEsfJsonPullStateFirstKey:
+        if (c == '}') {
+          parser->pos++;
+          EsfJsonPullPop(parser);
+          return kEsfJsonSuccess;
+        }
+        // Fall through.
+      case kEsfJsonPullStateKey: {
+        if (c != '\"') {
+          ESF_JSON_ERR("Expected a member name. c = %d", c);
+          return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+        }
+        parser->pos++;
+        EsfJsonErrorCode ret = EsfJsonPullReadString(parser);
+        if (ret != kEsfJsonSuccess) {
+          return ret;
+        }
+        if (EsfJsonPullSkipSpace(parser) != ':') {
+          ESF_JSON_ERR("Expected ':' after the member name.");
+          return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+        }
+        parser->pos++;
+        parser->event = kEsfJsonPullEventKey;
+        parser->state = kEsfJsonPullStateValue;
+        return kEsfJsonSuccess;
+      }
+
+      case kEsfJsonPullStateFirstValue:
+        if (c == ']') {
+          parser->pos++;
+          EsfJsonPullPop(parser);
+          return kEsfJsonSuccess;
+        }
+        // Fall through.
+      case kEsfJsonPullStateValue:
+      default:
+        return EsfJsonPullReadValue(parser, c);
+    }
+  }
+}
+
+// """Build the value of the current event, reading the contents of Objects
+// and Arrays.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    data (JSON_Value**): Built value.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Malformed input.
+//    kEsfJsonOutOfMemory: Memory allocation failure.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonPullBuild(EsfJsonPullParser parser,
+                                         JSON_Value** data) {
+  JSON_Value* tmp_data = NULL;
+  switch (parser->event) {
+    case kEsfJsonPullEventString:
+      tmp_data = json_value_init_string(parser->token);
+      break;
+    case kEsfJsonPullEventNumber:
+      tmp_data = json_value_init_number(parser->number);
+      break;
+    case kEsfJsonPullEventBoolean:
+      tmp_data = json_value_init_boolean(parser->boolean ? 1 : 0);
+      break;
+    case kEsfJsonPullEventNull:
+      tmp_data = json_value_init_null();
+      break;
+    case kEsfJsonPullEventObjectBegin:
+      tmp_data = json_value_init_object();
+      break;
+    case kEsfJsonPullEventArrayBegin:
+      tmp_data = json_value_init_array();
+      break;
+    default:
+      ESF_JSON_ERR("The event has no value. event = %d", parser->event);
+      return kEsfJsonInvalidArgument;
+  }
+  if (tmp_data == NULL) {
+    // json_value_init_string also fails on invalid UTF-8.
+    ESF_JSON_ERR("json_value_init func failed. event = %d", parser->event);
+    return (parser->event == kEsfJsonPullEventString) ? kEsfJsonInvalidArgument
+                                                      : kEsfJsonOutOfMemory;
+  }
+
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  if (parser->event == kEsfJsonPullEventObjectBegin) {
+    JSON_Object* object = json_value_get_object(tmp_data);
+    while (ret == kEsfJsonSuccess) {
+      ret = EsfJsonPullAdvance(parser);
+      if (ret != kEsfJsonSuccess ||
+          parser->event == kEsfJsonPullEventObjectEnd) {
+        break;
+      }
+      // The token buffer is reused by the value, keep the name aside.
+      char* key = strdup(parser->token);
+      if (key == NULL) {
+        ESF_JSON_ERR("Failed to allocate memory for key.");
+        ret = kEsfJsonOutOfMemory;
+        break;
+      }
+      // parson rejects duplicate names while parsing, so do the same.
+      if (json_object_get_value(object, key) != NULL) {
+        ESF_JSON_ERR("Duplicate member name. key = %s", key);
+        ret = EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+      }
+      JSON_Value* member = NULL;
+      if (ret == kEsfJsonSuccess) {
+        ret = EsfJsonPullAdvance(parser);
+      }
+      if (ret == kEsfJsonSuccess) {
+        ret = EsfJsonPullBuild(parser, &member);
+      }
+      if (ret == kEsfJsonSuccess &&
+          json_object_set_value(object, key, member) != JSONSuccess) {
+        ESF_JSON_ERR("json_object_set_value func failed. key = %s", key);
+        json_value_free(member);
+        ret = kEsfJsonOutOfMemory;
+      }
+      free(key);
+    }
+  } else if (parser->event == kEsfJsonPullEventArrayBegin) {
+    JSON_Array* array = json_value_get_array(tmp_data);
+    while (ret == kEsfJsonSuccess) {
+      ret = EsfJsonPullAdvance(parser);
+      if (ret != kEsfJsonSuccess ||
+          parser->event == kEsfJsonPullEventArrayEnd) {
+        break;
+      }
+      JSON_Value* element = NULL;
+      ret = EsfJsonPullBuild(parser, &element);
+      if (ret == kEsfJsonSuccess &&
+          json_array_append_value(array, element) != JSONSuccess) {
+        ESF_JSON_ERR("json_array_append_value func failed.");
+        json_value_free(element);
+        ret = kEsfJsonOutOfMemory;
+      }
+    }
+  }
+  if (ret != kEsfJsonSuccess) {
+    json_value_free(tmp_data);
+    return ret;
+  }
+  *data = tmp_data;
+  return kEsfJsonSuccess;
+}
+
+// """Allocate a parser with no input.
+
+// Returns:
+//    The parser, or NULL on memory allocation failure.
+static EsfJsonPullParser EsfJsonPullNew(void) {
+  EsfJsonPullParser parser = (EsfJsonPullParser)calloc(1, sizeof(*parser));
+  if (parser == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for parser.");
+    return NULL;
+  }
+  parser->token_capacity = ESF_JSON_PULL_TOKEN_SIZE;
+  parser->token = (char*)malloc(parser->token_capacity);
+  if (parser->token == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for token.");
+    free(parser);
+    return NULL;
+  }
+  parser->token[0] = '\0';
+  parser->state = kEsfJsonPullStateValue;
+  parser->error = kEsfJsonSuccess;
+  return parser;
+}
+
+EsfJsonErrorCode EsfJsonPullOpen(EsfMemoryManagerHandle mem_handle,
+                                 size_t mem_size, EsfJsonPullParser* parser) {
+  ESF_JSON_TRACE("entry");
+  if (parser == NULL || mem_size > INT32_MAX) {
+    ESF_JSON_ERR("Parameter error. parser = %p, mem_size = %zu", parser,
+                 mem_size);
+    return kEsfJsonInvalidArgument;
+  }
+
+  EsfMemoryManagerMapSupport support = kEsfMemoryManagerMapIsNotSupport;
+  EsfMemoryManagerResult mem_ret =
+      EsfMemoryManagerIsMapSupport(mem_handle, &support);
+  if (mem_ret != kEsfMemoryManagerResultSuccess) {
+    ESF_JSON_ERR(
+        "EsfMemoryManagerIsMapSupport func failed. ret = %u, mem_handle = "
+        "%" PRIu32 "",
+        mem_ret, mem_handle);
+    return kEsfJsonInternalError;
+  }
+
+  EsfJsonPullParser tmp_parser = EsfJsonPullNew();
+  if (tmp_parser == NULL) {
+    return kEsfJsonOutOfMemory;
+  }
+  tmp_parser->mem_handle = mem_handle;
+
+  if (support == kEsfMemoryManagerMapIsSupport) {
+    mem_ret = EsfMemoryManagerMap(mem_handle, NULL, (int32_t)mem_size,
+                                  &tmp_parser->map_address);
+    if (mem_ret != kEsfMemoryManagerResultSuccess) {
+      ESF_JSON_ERR(
+          "EsfMemoryManagerMap func failed. ret = %u, mem_handle = "
+          "%" PRIu32 ", mem_size = %zu",
+          mem_ret, mem_handle, mem_size);
+      free(tmp_parser->token);
+      free(tmp_parser);
+      return kEsfJsonInternalError;
+    }
+    tmp_parser->data = (const char*)tmp_parser->map_address;
+    tmp_parser->data_size = mem_size;
+  } else {
+    tmp_parser->read_buf = (char*)malloc(CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE);
+    if (tmp_parser->read_buf == NULL) {
+      ESF_JSON_ERR("Failed to allocate memory for read_buf.");
+      free(tmp_parser->token);
+      free(tmp_parser);
+      return kEsfJsonOutOfMemory;
+    }
+    tmp_parser->data = tmp_parser->read_buf;
+    tmp_parser->remaining = mem_size;
+  }
+
+  *parser = tmp_parser;
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullOpenString(const char* str, size_t len,
+                                       EsfJsonPullParser* parser) {
+  ESF_JSON_TRACE("entry");
+  if (str == NULL || parser == NULL) {
+    ESF_JSON_ERR("Parameter error. str = %p, parser = %p", str, parser);
+    return kEsfJsonInvalidArgument;
+  }
+  EsfJsonPullParser tmp_parser = EsfJsonPullNew();
+  if (tmp_parser == NULL) {
+    return kEsfJsonOutOfMemory;
+  }
+  tmp_parser->data = str;
+  tmp_parser->data_size = len;
+  *parser = tmp_parser;
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullClose(EsfJsonPullParser parser) {
+  ESF_JSON_TRACE("entry");
+  if (parser == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p", parser);
+    return kEsfJsonInvalidArgument;
+  }
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  if (parser->map_address != NULL) {
+    EsfMemoryManagerResult mem_ret =
+        EsfMemoryManagerUnmap(parser->mem_handle, &parser->map_address);
+    if (mem_ret != kEsfMemoryManagerResultSuccess) {
+      ESF_JSON_ERR(
+          "EsfMemoryManagerUnmap func failed. ret = %u, mem_handle = "
+          "%" PRIu32 "",
+          mem_ret, parser->mem_handle);
+      ret = kEsfJsonInternalError;
+    }
+  }
+  free(parser->read_buf);
+  free(parser->token);
+  free(parser);
+  ESF_JSON_TRACE("exit");
+  return ret;
+}
+
+EsfJsonErrorCode EsfJsonPullNext(EsfJsonPullParser parser,
+                                 EsfJsonPullEvent* event) {
+  if (parser == NULL || event == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p, event = %p", parser, event);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+  EsfJsonErrorCode ret = EsfJsonPullAdvance(parser);
+  if (ret != kEsfJsonSuccess) {
+    return ret;
+  }
+  *event = parser->event;
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullGetString(EsfJsonPullParser parser,
+                                      const char** str, size_t* len) {
+  if (parser == NULL || str == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p, str = %p", parser, str);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+  if (parser->event != kEsfJsonPullEventKey &&
+      parser->event != kEsfJsonPullEventString) {
+    ESF_JSON_ERR("The current event is not a string. event = %d",
+                 parser->event);
+    return kEsfJsonValueTypeError;
+  }
+  *str = parser->token;
+  if (len != NULL) {
+    *len = parser->token_len;
+  }
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullGetNumber(EsfJsonPullParser parser, double* num) {
+  if (parser == NULL || num == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p, num = %p", parser, num);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+  if (parser->event != kEsfJsonPullEventNumber) {
+    ESF_JSON_ERR("The current event is not a number. event = %d",
+                 parser->event);
+    return kEsfJsonValueTypeError;
+  }
+  *num = parser->number;
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullGetBoolean(EsfJsonPullParser parser,
+                                       bool* boolean) {
+  if (parser == NULL || boolean == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p, boolean = %p", parser,
+                 boolean);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+  if (parser->event != kEsfJsonPullEventBoolean) {
+    ESF_JSON_ERR("The current event is not a boolean. event = %d",
+                 parser->event);
+    return kEsfJsonValueTypeError;
+  }
+  *boolean = parser->boolean;
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullSkip(EsfJsonPullParser parser) {
+  if (parser == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p", parser);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+  if (parser->event != kEsfJsonPullEventObjectBegin &&
+      parser->event != kEsfJsonPullEventArrayBegin) {
+    return kEsfJsonSuccess;
+  }
+
+  // Only brackets outside of strings matter, so scan the raw bytes.
+  int32_t level = 1;
+  bool in_string = false;
+  bool escaped = false;
+  while (level > 0) {
+    if (parser->pos == parser->data_size && !EsfJsonPullFill(parser)) {
+      if (parser->error != kEsfJsonSuccess) {
+        return parser->error;
+      }
+      ESF_JSON_ERR("Unterminated container.");
+      return EsfJsonPullFail(parser, kEsfJsonInvalidArgument);
+    }
+    const char* p = parser->data + parser->pos;
+    const char* end = parser->data + parser->data_size;
+    for (; p < end && level > 0; ++p) {
+      char c = *p;
+      if (c == '\0') {
+        break;
+      }
+      if (in_string) {
+        if (escaped) {
+          escaped = false;
+        } else if (c == '\\') {
+          escaped = true;
+        } else if (c == '\"') {
+          in_string = false;
+        }
+      } else if (c == '\"') {
+        in_string = true;
+      } else if (c == '{' || c == '[') {
+        ++level;
+      } else if (c == '}' || c == ']') {
+        --level;
+      }
+    }
+    parser->pos = (size_t)(p - parser->data);
+    if (level > 0 && p < end) {
+      // Reached the NULL terminator.
+      EsfJsonPullPeek(parser);
+    }
+  }
+  EsfJsonPullPop(parser);
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonPullMaterialize(EsfJsonPullParser parser,
+                                        EsfJsonHandle handle,
+                                        EsfJsonValue* value) {
+  ESF_JSON_TRACE("entry");
+  ESF_JSON_ARENA_SCOPE(handle);
+  if (handle == ESF_JSON_HANDLE_INITIALIZER) {
+    ESF_JSON_ERR("Parameter error. handle = %p", handle);
+    return kEsfJsonHandleError;
+  }
+  if (parser == NULL || value == NULL) {
+    ESF_JSON_ERR("Parameter error. parser = %p, value = %p", parser, value);
+    return kEsfJsonInvalidArgument;
+  }
+  if (parser->error != kEsfJsonSuccess) {
+    return parser->error;
+  }
+
+  JSON_Value* data = NULL;
+  EsfJsonErrorCode ret = EsfJsonPullBuild(parser, &data);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonPullBuild func failed. ret = %u", ret);
+    return ret;
+  }
+
+  EsfJsonValue value_id = ESF_JSON_VALUE_INVALID;
+  ret = EsfJsonValueAdd(handle->json_value, data, &value_id);
+  if (ret != kEsfJsonSuccess) {
+    json_value_free(data);
+    ESF_JSON_ERR(
+        "EsfJsonValueAdd func failed. ret = %u, handle->json_value = %p, data "
+        "= %p",
+        ret, handle->json_value, data);
+    return ret;
+  }
+
+  *value = value_id;
+  ESF_JSON_DEBUG("JSON Pull Materialize Info ID = %" PRId32 "", value_id);
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
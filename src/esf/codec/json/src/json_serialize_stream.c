@@ -0,0 +1,381 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_internal.h"
+#include "memory_manager.h"
+#include "parson/lib/parson.h"
+
+// Size of the buffer for a serialized number.
+#define ESF_JSON_STREAM_NUMBER_BUFFER_SIZE (64)
+
+typedef struct EsfJsonStreamWriter EsfJsonStreamWriter;
+
+// Output state of a streaming serialization.
+struct EsfJsonStreamWriter {
+  // Destination.
+  EsfMemoryManagerHandle mem_handle;
+  // Write buffer of CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE bytes. Also used
+  // to copy the contents of Memory Manager handles.
+  char* buf;
+  // Bytes of buf waiting to be written.
+  size_t used;
+  // Bytes written to mem_handle.
+  size_t written;
+};
+
+// """Write the buffered bytes to the destination.
+
+// Args:
+//    writer (EsfJsonStreamWriter*): Output state.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonStreamFlush(EsfJsonStreamWriter* writer) {
+  if (writer->used == 0) {
+    return kEsfJsonSuccess;
+  }
+  size_t wsize = 0;
+  EsfMemoryManagerResult result =
+      EsfMemoryManagerFwrite(writer->mem_handle, writer->buf, writer->used,
+                             &wsize);
+  if (result != kEsfMemoryManagerResultSuccess || wsize != writer->used) {
+    ESF_JSON_ERR(
+        "EsfMemoryManagerFwrite func failed. ret = %u, mem_handle = "
+        "%" PRIu32 ", size = %zu, wsize = %zu",
+        result, writer->mem_handle, writer->used, wsize);
+    return kEsfJsonInternalError;
+  }
+  writer->written += wsize;
+  writer->used = 0;
+  return kEsfJsonSuccess;
+}
+
+// """Append bytes to the output.
+
+// Args:
+//    writer (EsfJsonStreamWriter*): Output state.
+//    str (const char*): Bytes to append.
+//    len (size_t): Number of bytes.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonStreamWrite(EsfJsonStreamWriter* writer,
+                                           const char* str, size_t len) {
+  while (len > 0) {
+    if (writer->used == CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE) {
+      EsfJsonErrorCode ret = EsfJsonStreamFlush(writer);
+      if (ret != kEsfJsonSuccess) {
+        return ret;
+      }
+    }
+    size_t size = CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE - writer->used;
+    if (size > len) {
+      size = len;
+    }
+    memcpy(writer->buf + writer->used, str, size);
+    writer->used += size;
+    str += size;
+    len -= size;
+  }
+  return kEsfJsonSuccess;
+}
+
+// """Append a string in JSON notation, quoted and escaped like parson does.
+
+// Args:
+//    writer (EsfJsonStreamWriter*): Output state.
+//    str (const char*): String to append.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonStreamWriteString(EsfJsonStreamWriter* writer,
+                                                 const char* str) {
+  EsfJsonErrorCode ret = EsfJsonStreamWrite(writer, "\"", 1);
+  const char* p = str;
+  const char* end = str + strlen(str);
+  while (ret == kEsfJsonSuccess && p < end) {
+    // Characters that need no escape are copied in runs.
+    size_t run = EsfJsonEscapeSpan(p, (size_t)(end - p));
+    ret = EsfJsonStreamWrite(writer, p, run);
+    p += run;
+    if (ret != kEsfJsonSuccess || p == end) {
+      break;
+    }
+    char escaped[ESF_JSON_ESCAPE_MAX_SIZE];
+    const char* replacement = EsfJsonEscapeGet(*p, escaped);
+    ret = EsfJsonStreamWrite(writer, replacement, strlen(replacement));
+    ++p;
+  }
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonStreamWrite(writer, "\"", 1);
+  }
+  return ret;
+}
+
+// """Find the Memory Manager handle a string value stands in for.
+
+// Args:
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+//    str (const char*): String value.
+
+// Returns:
+//    The Memory Manager handle information, or NULL if str is not the
+//    alternative string of a registered handle.
+static const EsfJsonMemoryInfo* EsfJsonStreamFindMemInfo(
+    const EsfJsonValueContainer* json_value, const char* str) {
+  size_t prefix_len = sizeof(REPLACEMENT_STRING) - 1;
+  if (strncmp(str, REPLACEMENT_STRING, prefix_len) != 0) {
+    return NULL;
+  }
+  char* end = NULL;
+  long id = strtol(str + prefix_len, &end, 10);
+  if (end == str + prefix_len || *end != '\0') {
+    return NULL;
+  }
+  for (int i = 0; i < CONFIG_EXTERNAL_CODEC_JSON_MEM_HANDLE_MAX; ++i) {
+    if (json_value->mem_info[i].id != ESF_JSON_VALUE_INVALID &&
+        json_value->mem_info[i].id == id) {
+      return &json_value->mem_info[i];
+    }
+  }
+  return NULL;
+}
+
+// """Copy the contents of a Memory Manager handle to the output, quoted.
+
+// Args:
+//    writer (EsfJsonStreamWriter*): Output state.
+//    mem_info (const EsfJsonMemoryInfo*): Handle to copy from.
+//    mem_handle_open (bool): Open and close the handle around the copy.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonStreamWriteMemInfo(
+    EsfJsonStreamWriter* writer, const EsfJsonMemoryInfo* mem_info,
+    bool mem_handle_open) {
+  EsfJsonErrorCode ret = EsfJsonStreamWrite(writer, "\"", 1);
+  if (ret == kEsfJsonSuccess) {
+    // The write buffer is reused to read the handle.
+    ret = EsfJsonStreamFlush(writer);
+  }
+  if (ret != kEsfJsonSuccess) {
+    return ret;
+  }
+
+  EsfMemoryManagerResult result = kEsfMemoryManagerResultSuccess;
+  if (mem_handle_open) {
+    result = EsfMemoryManagerFopen(mem_info->data);
+    if (result != kEsfMemoryManagerResultSuccess) {
+      ESF_JSON_ERR("EsfMemoryManagerFopen for %" PRIu32 " failed. ret = %u",
+                   mem_info->data, result);
+      return kEsfJsonInternalError;
+    }
+  }
+
+  off_t offset = 0;
+  result = EsfMemoryManagerFseek(mem_info->data, mem_info->offset, SEEK_SET,
+                                 &offset);
+  if (result != kEsfMemoryManagerResultSuccess) {
+    ESF_JSON_ERR(
+        "EsfMemoryManagerFseek func failed. ret = %u, mem_handle = "
+        "%" PRIu32 ", offset = %jd, res_offset = %jd",
+        result, mem_info->data, (intmax_t)mem_info->offset, (intmax_t)offset);
+    ret = kEsfJsonInternalError;
+  }
+
+  size_t copied_size = 0;
+  while (ret == kEsfJsonSuccess && copied_size != mem_info->size) {
+    size_t size = mem_info->size - copied_size;
+    if (size > CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE) {
+      size = CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE;
+    }
+    size_t read_size = 0;
+    result = EsfMemoryManagerFread(mem_info->data, writer->buf, size,
+                                   &read_size);
+    if (result != kEsfMemoryManagerResultSuccess || read_size != size) {
+      ESF_JSON_ERR(
+          "EsfMemoryManagerFread func failed. ret = %u, mem_handle = "
+          "%" PRIu32 ", size = %zu, rsize = %zu",
+          result, mem_info->data, size, read_size);
+      ret = kEsfJsonInternalError;
+      break;
+    }
+    writer->used = read_size;
+    ret = EsfJsonStreamFlush(writer);
+    copied_size += read_size;
+  }
+
+  if (mem_handle_open) {
+    result = EsfMemoryManagerFclose(mem_info->data);
+    if (result != kEsfMemoryManagerResultSuccess) {
+      ESF_JSON_ERR("EsfMemoryManagerFclose for %" PRIu32 " failed. ret = %u",
+                   mem_info->data, result);
+      ret = kEsfJsonInternalError;
+    }
+  }
+
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonStreamWrite(writer, "\"", 1);
+  }
+  return ret;
+}
+
+// """Append a JSON value and its descendants to the output.
+
+// Args:
+//    writer (EsfJsonStreamWriter*): Output state.
+//    json_value (EsfJsonValueContainer*): JSON value array info.
+//    data (const JSON_Value*): JSON value to serialize.
+//    mem_handle_open (bool): Open and close Memory Manager handles.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInternalError: Internal error.
+static EsfJsonErrorCode EsfJsonStreamWriteValue(
+    EsfJsonStreamWriter* writer, const EsfJsonValueContainer* json_value,
+    const JSON_Value* data, bool mem_handle_open) {
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  switch (json_value_get_type(data)) {
+    case JSONObject: {
+      JSON_Object* object = json_value_get_object(data);
+      size_t count = json_object_get_count(object);
+      ret = EsfJsonStreamWrite(writer, "{", 1);
+      for (size_t i = 0; ret == kEsfJsonSuccess && i < count; ++i) {
+        if (i != 0) {
+          ret = EsfJsonStreamWrite(writer, ",", 1);
+        }
+        if (ret == kEsfJsonSuccess) {
+          ret = EsfJsonStreamWriteString(writer,
+                                         json_object_get_name(object, i));
+        }
+        if (ret == kEsfJsonSuccess) {
+          ret = EsfJsonStreamWrite(writer, ":", 1);
+        }
+        if (ret == kEsfJsonSuccess) {
+          ret = EsfJsonStreamWriteValue(writer, json_value,
+                                        json_object_get_value_at(object, i),
+                                        mem_handle_open);
+        }
+      }
+      if (ret == kEsfJsonSuccess) {
+        ret = EsfJsonStreamWrite(writer, "}", 1);
+      }
+      break;
+    }
+    case JSONArray: {
+      JSON_Array* array = json_value_get_array(data);
+      size_t count = json_array_get_count(array);
+      ret = EsfJsonStreamWrite(writer, "[", 1);
+      for (size_t i = 0; ret == kEsfJsonSuccess && i < count; ++i) {
+        if (i != 0) {
+          ret = EsfJsonStreamWrite(writer, ",", 1);
+        }
+        if (ret == kEsfJsonSuccess) {
+          ret = EsfJsonStreamWriteValue(writer, json_value,
+                                        json_array_get_value(array, i),
+                                        mem_handle_open);
+        }
+      }
+      if (ret == kEsfJsonSuccess) {
+        ret = EsfJsonStreamWrite(writer, "]", 1);
+      }
+      break;
+    }
+    case JSONString: {
+      const char* str = json_value_get_string(data);
+      const EsfJsonMemoryInfo* mem_info =
+          EsfJsonStreamFindMemInfo(json_value, str);
+      if (mem_info != NULL) {
+        ret = EsfJsonStreamWriteMemInfo(writer, mem_info, mem_handle_open);
+      } else {
+        ret = EsfJsonStreamWriteString(writer, str);
+      }
+      break;
+    }
+    case JSONNumber: {
+      // Numbers are left to parson so that the notation matches
+      // json_serialize_to_string.
+      char number[ESF_JSON_STREAM_NUMBER_BUFFER_SIZE];
+      if (json_serialize_to_buffer(data, number, sizeof(number)) !=
+          JSONSuccess) {
+        ESF_JSON_ERR("json_serialize_to_buffer func failed. data = %p", data);
+        ret = kEsfJsonInternalError;
+        break;
+      }
+      ret = EsfJsonStreamWrite(writer, number, strlen(number));
+      break;
+    }
+    case JSONBoolean:
+      if (json_value_get_boolean(data) != 0) {
+        ret = EsfJsonStreamWrite(writer, "true", 4);
+      } else {
+        ret = EsfJsonStreamWrite(writer, "false", 5);
+      }
+      break;
+    case JSONNull:
+      ret = EsfJsonStreamWrite(writer, "null", 4);
+      break;
+    default:
+      ESF_JSON_ERR("Unexpected JSON type. data = %p", data);
+      ret = kEsfJsonInternalError;
+      break;
+  }
+  return ret;
+}
+
+EsfJsonErrorCode EsfJsonSerializeStreamFileIO(
+    EsfJsonValueContainer* json_value, const JSON_Value* data,
+    EsfMemoryManagerHandle mem_handle, bool mem_handle_open,
+    size_t* serialized_size) {
+  ESF_JSON_TRACE("entry.");
+  if (json_value == NULL || data == NULL || serialized_size == NULL) {
+    ESF_JSON_ERR(
+        "Parameter error. json_value = %p, data = %p, serialized_size = %p",
+        json_value, data, serialized_size);
+    return kEsfJsonInvalidArgument;
+  }
+
+  EsfJsonStreamWriter writer = {
+      .mem_handle = mem_handle,
+      .buf = (char*)malloc(CONFIG_EXTERNAL_CODEC_JSON_BUFFER_SIZE),
+      .used = 0,
+      .written = 0,
+  };
+  if (writer.buf == NULL) {
+    ESF_JSON_ERR("Failed to allocate memory for buf.");
+    return kEsfJsonOutOfMemory;
+  }
+
+  EsfJsonErrorCode ret =
+      EsfJsonStreamWriteValue(&writer, json_value, data, mem_handle_open);
+  // The terminating character is written too, but not counted.
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonStreamWrite(&writer, "", 1);
+  }
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonStreamFlush(&writer);
+  }
+  free(writer.buf);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("Streaming serialization failed. ret = %u", ret);
+    return ret;
+  }
+
+  *serialized_size = writer.written - 1;
+  ESF_JSON_TRACE("exit.");
+  return kEsfJsonSuccess;
+}
@@ -0,0 +1,414 @@
+/*
+ * SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "json_struct.h"
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "json_internal.h"
+#include "json_pull.h"
+
+// Size of the buffer for a formatted number.
+#define ESF_JSON_STRUCT_NUMBER_BUFFER_SIZE (64)
+// Same notation as parson.
+#define ESF_JSON_STRUCT_REAL_FORMAT "%1.17g"
+
+typedef struct EsfJsonStructWriter EsfJsonStructWriter;
+
+// Output state of EsfJsonStructEncode.
+struct EsfJsonStructWriter {
+  // Destination. May be NULL if size is 0.
+  char* buf;
+  // Size of buf.
+  size_t size;
+  // Length of the string so far, including the part that did not fit.
+  size_t len;
+};
+
+// """Append bytes to the output. Bytes beyond the buffer are only counted.
+
+// Args:
+//    writer (EsfJsonStructWriter*): Output state.
+//    str (const char*): Bytes to append.
+//    len (size_t): Number of bytes.
+static void EsfJsonStructWrite(EsfJsonStructWriter* writer, const char* str,
+                               size_t len) {
+  // Keep room for the NULL terminator.
+  if (writer->len + 1 < writer->size) {
+    size_t room = writer->size - 1 - writer->len;
+    memcpy(writer->buf + writer->len, str, len < room ? len : room);
+  }
+  writer->len += len;
+}
+
+// """Append a string in JSON notation.
+
+// Args:
+//    writer (EsfJsonStructWriter*): Output state.
+//    str (const char*): String to append.
+//    len (size_t): Length of str.
+static void EsfJsonStructWriteString(EsfJsonStructWriter* writer,
+                                     const char* str, size_t len) {
+  EsfJsonStructWrite(writer, "\"", 1);
+  const char* p = str;
+  const char* end = str + len;
+  while (p < end) {
+    size_t run = EsfJsonEscapeSpan(p, (size_t)(end - p));
+    EsfJsonStructWrite(writer, p, run);
+    p += run;
+    if (p == end) {
+      break;
+    }
+    char escaped[ESF_JSON_ESCAPE_MAX_SIZE];
+    const char* replacement = EsfJsonEscapeGet(*p, escaped);
+    EsfJsonStructWrite(writer, replacement, strlen(replacement));
+    ++p;
+  }
+  EsfJsonStructWrite(writer, "\"", 1);
+}
+
+// """Check that the size of a member matches its type.
+
+// Args:
+//    item (const EsfJsonStructMemberInfo*): Member information.
+
+// Returns:
+//    true if the member information is usable.
+static bool EsfJsonStructMemberIsValid(const EsfJsonStructMemberInfo* item) {
+  switch (item->type) {
+    case kEsfJsonStructMemberBoolean:
+      return item->size == sizeof(bool);
+    case kEsfJsonStructMemberInt32:
+      return item->size == sizeof(int32_t);
+    case kEsfJsonStructMemberUint32:
+      return item->size == sizeof(uint32_t);
+    case kEsfJsonStructMemberReal:
+      return item->size == sizeof(double);
+    case kEsfJsonStructMemberString:
+      return item->size > 0;
+    case kEsfJsonStructMemberObject:
+      return item->object != NULL;
+    default:
+      return false;
+  }
+}
+
+// """Write a structure as a JSON object.
+
+// Args:
+//    writer (EsfJsonStructWriter*): Output state.
+//    info (const EsfJsonStructInfo*): Layout of the structure.
+//    data (const void*): Structure.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Invalid layout or value.
+static EsfJsonErrorCode EsfJsonStructEncodeObject(EsfJsonStructWriter* writer,
+                                                  const EsfJsonStructInfo* info,
+                                                  const void* data) {
+  if (info->items_num > 0 && info->items == NULL) {
+    ESF_JSON_ERR("Parameter error. items = %p", info->items);
+    return kEsfJsonInvalidArgument;
+  }
+  EsfJsonStructWrite(writer, "{", 1);
+  for (size_t i = 0; i < info->items_num; ++i) {
+    const EsfJsonStructMemberInfo* item = &info->items[i];
+    if (item->name == NULL || !EsfJsonStructMemberIsValid(item)) {
+      ESF_JSON_ERR("Invalid member information. index = %zu", i);
+      return kEsfJsonInvalidArgument;
+    }
+    if (i > 0) {
+      EsfJsonStructWrite(writer, ",", 1);
+    }
+    EsfJsonStructWriteString(writer, item->name, strlen(item->name));
+    EsfJsonStructWrite(writer, ":", 1);
+
+    const char* member = (const char*)data + item->offset;
+    char number[ESF_JSON_STRUCT_NUMBER_BUFFER_SIZE];
+    int number_len = 0;
+    switch (item->type) {
+      case kEsfJsonStructMemberBoolean:
+        if (*(const bool*)member) {
+          EsfJsonStructWrite(writer, "true", 4);
+        } else {
+          EsfJsonStructWrite(writer, "false", 5);
+        }
+        break;
+      case kEsfJsonStructMemberInt32:
+        number_len = snprintf(number, sizeof(number), "%" PRId32,
+                              *(const int32_t*)member);
+        EsfJsonStructWrite(writer, number, (size_t)number_len);
+        break;
+      case kEsfJsonStructMemberUint32:
+        number_len = snprintf(number, sizeof(number), "%" PRIu32,
+                              *(const uint32_t*)member);
+        EsfJsonStructWrite(writer, number, (size_t)number_len);
+        break;
+      case kEsfJsonStructMemberReal: {
+        double real = *(const double*)member;
+        if (!isfinite(real)) {
+          ESF_JSON_ERR("Real number is not finite. name = %s", item->name);
+          return kEsfJsonInvalidArgument;
+        }
+        number_len =
+            snprintf(number, sizeof(number), ESF_JSON_STRUCT_REAL_FORMAT, real);
+        EsfJsonStructWrite(writer, number, (size_t)number_len);
+        break;
+      }
+      case kEsfJsonStructMemberString: {
+        const char* terminator = memchr(member, '\0', item->size);
+        if (terminator == NULL) {
+          ESF_JSON_ERR("String is not NULL terminated. name = %s", item->name);
+          return kEsfJsonInvalidArgument;
+        }
+        EsfJsonStructWriteString(writer, member, (size_t)(terminator - member));
+        break;
+      }
+      case kEsfJsonStructMemberObject:
+      default: {
+        EsfJsonErrorCode ret =
+            EsfJsonStructEncodeObject(writer, item->object, member);
+        if (ret != kEsfJsonSuccess) {
+          return ret;
+        }
+        break;
+      }
+    }
+  }
+  EsfJsonStructWrite(writer, "}", 1);
+  return kEsfJsonSuccess;
+}
+
+static EsfJsonErrorCode EsfJsonStructDecodeObject(EsfJsonPullParser parser,
+                                                  const EsfJsonStructInfo* info,
+                                                  void* data);
+
+// """Store the current value of the parser into a structure member.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser positioned at the value.
+//    event (EsfJsonPullEvent): Event of the value.
+//    item (const EsfJsonStructMemberInfo*): Member information.
+//    member (char*): Address of the member.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonValueTypeError: The value does not fit the member.
+//    Other: Error of the parser.
+static EsfJsonErrorCode EsfJsonStructDecodeMember(
+    EsfJsonPullParser parser, EsfJsonPullEvent event,
+    const EsfJsonStructMemberInfo* item, char* member) {
+  EsfJsonErrorCode ret = kEsfJsonSuccess;
+  double number = 0;
+  switch (item->type) {
+    case kEsfJsonStructMemberBoolean: {
+      bool boolean = false;
+      ret = EsfJsonPullGetBoolean(parser, &boolean);
+      if (ret == kEsfJsonSuccess) {
+        *(bool*)member = boolean;
+      }
+      break;
+    }
+    case kEsfJsonStructMemberInt32:
+      ret = EsfJsonPullGetNumber(parser, &number);
+      if (ret == kEsfJsonSuccess) {
+        if (number != trunc(number) || number < INT32_MIN ||
+            number > INT32_MAX) {
+          ret = kEsfJsonValueTypeError;
+          break;
+        }
+        *(int32_t*)member = (int32_t)number;
+      }
+      break;
+    case kEsfJsonStructMemberUint32:
+      ret = EsfJsonPullGetNumber(parser, &number);
+      if (ret == kEsfJsonSuccess) {
+        if (number != trunc(number) || number < 0 || number > UINT32_MAX) {
+          ret = kEsfJsonValueTypeError;
+          break;
+        }
+        *(uint32_t*)member = (uint32_t)number;
+      }
+      break;
+    case kEsfJsonStructMemberReal:
+      ret = EsfJsonPullGetNumber(parser, &number);
+      if (ret == kEsfJsonSuccess) {
+        *(double*)member = number;
+      }
+      break;
+    case kEsfJsonStructMemberString: {
+      const char* str = NULL;
+      size_t len = 0;
+      ret = EsfJsonPullGetString(parser, &str, &len);
+      if (ret == kEsfJsonSuccess) {
+        if (len >= item->size) {
+          ret = kEsfJsonValueTypeError;
+          break;
+        }
+        memcpy(member, str, len);
+        member[len] = '\0';
+      }
+      break;
+    }
+    case kEsfJsonStructMemberObject:
+    default:
+      if (event != kEsfJsonPullEventObjectBegin) {
+        ret = kEsfJsonValueTypeError;
+        break;
+      }
+      ret = EsfJsonStructDecodeObject(parser, item->object, member);
+      break;
+  }
+  if (ret == kEsfJsonValueTypeError) {
+    ESF_JSON_ERR("JSON value does not fit the member. name = %s, event = %d",
+                 item->name, event);
+  }
+  return ret;
+}
+
+// """Read a JSON object into a structure. The object begin is consumed
+// already.
+
+// Args:
+//    parser (EsfJsonPullParser): Parser.
+//    info (const EsfJsonStructInfo*): Layout of the structure.
+//    data (void*): Structure.
+
+// Returns:
+//    kEsfJsonSuccess: Normal termination.
+//    kEsfJsonInvalidArgument: Invalid layout or malformed JSON string.
+//    kEsfJsonValueTypeError: A value does not fit its member.
+//    Other: Error of the parser.
+static EsfJsonErrorCode EsfJsonStructDecodeObject(EsfJsonPullParser parser,
+                                                  const EsfJsonStructInfo* info,
+                                                  void* data) {
+  if (info->items_num > 0 && info->items == NULL) {
+    ESF_JSON_ERR("Parameter error. items = %p", info->items);
+    return kEsfJsonInvalidArgument;
+  }
+  for (;;) {
+    EsfJsonPullEvent event = kEsfJsonPullEventEndOfDocument;
+    EsfJsonErrorCode ret = EsfJsonPullNext(parser, &event);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+    if (event == kEsfJsonPullEventObjectEnd) {
+      return kEsfJsonSuccess;
+    }
+
+    const char* key = NULL;
+    ret = EsfJsonPullGetString(parser, &key, NULL);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+    const EsfJsonStructMemberInfo* item = NULL;
+    for (size_t i = 0; i < info->items_num; ++i) {
+      if (info->items[i].name != NULL &&
+          strcmp(info->items[i].name, key) == 0) {
+        item = &info->items[i];
+        break;
+      }
+    }
+    if (item != NULL && !EsfJsonStructMemberIsValid(item)) {
+      ESF_JSON_ERR("Invalid member information. name = %s", item->name);
+      return kEsfJsonInvalidArgument;
+    }
+
+    ret = EsfJsonPullNext(parser, &event);
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+    if (item == NULL) {
+      // Not part of the structure. Does nothing for scalars.
+      ret = EsfJsonPullSkip(parser);
+    } else {
+      ret = EsfJsonStructDecodeMember(parser, event, item,
+                                      (char*)data + item->offset);
+    }
+    if (ret != kEsfJsonSuccess) {
+      return ret;
+    }
+  }
+}
+
+EsfJsonErrorCode EsfJsonStructEncode(const EsfJsonStructInfo* info,
+                                     const void* data, char* buf,
+                                     size_t buf_size, size_t* len) {
+  ESF_JSON_TRACE("entry");
+  if (info == NULL || data == NULL || (buf == NULL && buf_size != 0) ||
+      len == NULL) {
+    ESF_JSON_ERR(
+        "Parameter error. info = %p, data = %p, buf = %p, buf_size = %zu, len "
+        "= %p",
+        info, data, buf, buf_size, len);
+    return kEsfJsonInvalidArgument;
+  }
+
+  EsfJsonStructWriter writer = {
+      .buf = buf,
+      .size = buf_size,
+      .len = 0,
+  };
+  EsfJsonErrorCode ret = EsfJsonStructEncodeObject(&writer, info, data);
+  if (ret != kEsfJsonSuccess) {
+    return ret;
+  }
+  if (buf_size > 0) {
+    buf[writer.len < buf_size ? writer.len : buf_size - 1] = '\0';
+  }
+  *len = writer.len;
+  if (writer.len >= buf_size) {
+    ESF_JSON_DEBUG("Buffer too small. buf_size = %zu, len = %zu", buf_size,
+                   writer.len);
+    return kEsfJsonOutOfMemory;
+  }
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
+
+EsfJsonErrorCode EsfJsonStructDecode(const EsfJsonStructInfo* info,
+                                     const char* str, size_t len, void* data) {
+  ESF_JSON_TRACE("entry");
+  if (info == NULL || str == NULL || data == NULL) {
+    ESF_JSON_ERR("Parameter error. info = %p, str = %p, data = %p", info, str,
+                 data);
+    return kEsfJsonInvalidArgument;
+  }
+
+  EsfJsonPullParser parser = NULL;
+  EsfJsonErrorCode ret = EsfJsonPullOpenString(str, len, &parser);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("EsfJsonPullOpenString func failed. ret = %u", ret);
+    return ret;
+  }
+
+  EsfJsonPullEvent event = kEsfJsonPullEventEndOfDocument;
+  ret = EsfJsonPullNext(parser, &event);
+  if (ret == kEsfJsonSuccess && event != kEsfJsonPullEventObjectBegin) {
+    ESF_JSON_ERR("JSON string is not an object. event = %d", event);
+    ret = kEsfJsonValueTypeError;
+  }
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonStructDecodeObject(parser, info, data);
+  }
+  // Reject anything but white space after the object.
+  if (ret == kEsfJsonSuccess) {
+    ret = EsfJsonPullNext(parser, &event);
+  }
+  (void)EsfJsonPullClose(parser);
+  if (ret != kEsfJsonSuccess) {
+    ESF_JSON_ERR("Failed to decode the JSON string. ret = %u", ret);
+    return ret;
+  }
+  ESF_JSON_TRACE("exit");
+  return kEsfJsonSuccess;
+}
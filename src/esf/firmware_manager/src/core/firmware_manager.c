@@ -24,6 +24,7 @@
 #include "memory_manager.h"
 #include "processor/firmware_manager_processor.h"
 #include "sensor/firmware_manager_sensor.h"
+#include "utility_counter.h"
 
 #ifndef CONFIG_EXTERNAL_FIRMWARE_MANAGER_USE_SENSOR_FW_UPDATE_LIB
 #include "sensor_ai_lib/sensor_ai_lib_fwupdate.h"
@@ -111,6 +112,11 @@ static EsfFwMgrSubmoduleOps* s_submodule_ops_list = NULL;
 
 static EsfFwMgrContext* s_active_context = NULL;
 
+// Number of EsfFwMgrWrite calls that succeeded and the bytes they wrote.
+static UTILITY_COUNTER_DEFINE(s_write_counter, "firmware_manager.write");
+static UTILITY_COUNTER_DEFINE(s_write_bytes_counter,
+                              "firmware_manager.write_bytes");
+
 // Internal functions ##########################################################
 
 #ifndef CONFIG_EXTERNAL_FIRMWARE_MANAGER_USE_SENSOR_FW_UPDATE_LIB
@@ -1340,6 +1346,8 @@ EsfFwMgrResult EsfFwMgrWrite(EsfFwMgrHandle handle,
     goto unlock_mutex_then_exit;
   }
 
+  UTILITY_COUNTER_INC(s_write_counter);
+  UTILITY_COUNTER_ADD(s_write_bytes_counter, (uint64_t)request->size);
   ret = kEsfFwMgrResultOk;
 
 unlock_mutex_then_exit:
@@ -27,6 +27,7 @@
 #include "pl.h"
 #include "pl_dmamem.h"
 #include "pl_lheap.h"
+#include "utility_counter.h"
 #include "utility_msg.h"
 #include "wasm_export.h"
 
@@ -44,6 +45,12 @@
 
 #define LOG_MANAGER_METRICS_STACK_SIZE (20)
 
+#define LOG_MANAGER_METRICS_COUNTER_KEY "Counter"
+#define LOG_MANAGER_METRICS_COUNTER_KEY_COUNT "count"
+#define LOG_MANAGER_METRICS_COUNTER_KEY_SUM "sum"
+#define LOG_MANAGER_METRICS_COUNTER_KEY_BUCKETS "buckets"
+#define LOG_MANAGER_METRICS_COUNTER_KEY_BUCKET_INF "+Inf"
+
 struct meminfo {
   int32_t total;
   int32_t total_used;
@@ -58,6 +65,12 @@ typedef struct {
   int32_t stack_used;
 } EsfLogManagerStackInfo;
 
+typedef struct {
+  EsfJsonHandle json_handle;
+  EsfJsonValue counter_obj;
+  EsfLogManagerStatus status;
+} EsfLogManagerCounterContext;
+
 static EsfLogManagerStatus EsfLogManagerCreateMetricsGenerationThread(void);
 static EsfLogManagerStatus EsfLogManagerCreateMetricsSendingThread(void);
 static void *EsfLogManagerMetricsGenerationThread(void *p);
@@ -73,6 +86,13 @@ static EsfLogManagerStatus EsfLogManagerGenerateMemInfo(
     EsfJsonHandle json_handle, EsfJsonValue *metrics_object_id);
 static EsfLogManagerStatus EsfLogManagerGenerateStackInfo(
     EsfJsonHandle json_handle, EsfJsonValue *metrics_object_id);
+static EsfLogManagerStatus EsfLogManagerGenerateCounterInfo(
+    EsfJsonHandle json_handle, EsfJsonValue *metrics_object_id);
+static void EsfLogManagerMetricsSetCounterJsonObject(
+    const UtilityCounterSnapshot *snapshot, void *user_data);
+static EsfJsonErrorCode EsfLogManagerMetricsSetBucketJsonObject(
+    EsfJsonHandle json_handle, EsfJsonValue parent,
+    const UtilityCounterSnapshot *snapshot);
 static EsfLogManagerStatus EsfLogManagerOpenProc(char *buf, char *filepath);
 static EsfLogManagerStatus EsfLogManagerReadStackInfo(
     const char *filepath, EsfLogManagerStackInfo *stack_info);
@@ -373,27 +393,32 @@ static void *EsfLogManagerMetricsGenerationThread(void *p) {
   const char *serialized_string;
   int32_t send_size;
 
+  // One handle serves every cycle. Resetting it keeps its memory, so the
+  // thread stops allocating once the metrics reach their usual size.
+  json_result = EsfJsonOpenArena(&json_handle);
+  if (json_result != kEsfJsonSuccess) {
+    ESF_LOG_MANAGER_ERROR("%d\n", json_result);
+    (void)pthread_exit((void *)NULL);
+    return NULL;
+  }
+
   while (s_metrics_loop_generate) {
     clock_gettime(CLOCK_REALTIME, &ts);
     ts.tv_sec += CONFIG_EXTERNAL_LOG_MANAGER_METRICS_GENERATE_INTERVAL;
 
-    json_result = EsfJsonOpen(&json_handle);
-    if (json_result != kEsfJsonSuccess) {
-      ESF_LOG_MANAGER_ERROR("%d\n", json_result);
-      break;
-    }
-
     ret = EsfLogManagerGenerateMsg(json_handle, &serialized_string);
     if (ret != kEsfLogManagerStatusOk) {
       ESF_LOG_MANAGER_ERROR("%d\n", ret);
-      (void)EsfJsonClose(json_handle);
       break;
     }
 
     msg_ret = UtilityMsgSend(s_queue_handle, serialized_string,
                              strlen(serialized_string) + 1, 0, &send_size);
-    (void)EsfJsonSerializeFree(json_handle);
-    (void)EsfJsonClose(json_handle);
+    json_result = EsfJsonReset(json_handle);
+    if (json_result != kEsfJsonSuccess) {
+      ESF_LOG_MANAGER_ERROR("%d\n", json_result);
+      break;
+    }
     if (msg_ret != kUtilityMsgOk) {
       ESF_LOG_MANAGER_ERROR("%d\n", msg_ret);
       break;
@@ -405,6 +430,7 @@ static void *EsfLogManagerMetricsGenerationThread(void *p) {
     (void)pthread_mutex_unlock(&s_metrics_generate_mutex);
   }
 
+  (void)EsfJsonClose(json_handle);
   (void)pthread_exit((void *)NULL);
   return NULL;
 }
@@ -523,6 +549,12 @@ static EsfLogManagerStatus EsfLogManagerGenerateMsg(
     return kEsfLogManagerStatusFailed;
   }
 
+  ret = EsfLogManagerGenerateCounterInfo(json_handle, &metrics_object_id);
+  if (ret != kEsfLogManagerStatusOk) {
+    ESF_LOG_MANAGER_ERROR("%d\n", ret);
+    return kEsfLogManagerStatusFailed;
+  }
+
   json_result = EsfJsonSerialize(json_handle, metrics_object_id,
                                  serialized_string);
   if (json_result != kEsfJsonSuccess) {
@@ -922,6 +954,185 @@ cleanup:
   return ret;
 }
 
+// """ Generate Counter info
+// Args:
+//    EsfJsonHandle json_handle: JSON json_handle
+//    EsfJsonValue *metrics_object_id: pointer to store metrics object ID
+// Returns:
+//    kEsfLogManagerStatusOk: success
+//    kEsfLogManagerStatusFailed: abnormal termination
+static EsfLogManagerStatus EsfLogManagerGenerateCounterInfo(
+    EsfJsonHandle json_handle, EsfJsonValue *metrics_object_id) {
+  if (metrics_object_id == NULL) {
+    ESF_LOG_MANAGER_ERROR("Invalid argument.\n");
+    return kEsfLogManagerStatusFailed;
+  }
+
+  EsfLogManagerCounterContext context = {
+      .json_handle = json_handle,
+      .counter_obj = ESF_JSON_VALUE_INVALID,
+      .status = kEsfLogManagerStatusOk,
+  };
+
+  EsfJsonErrorCode json_result =
+      EsfJsonObjectInit(json_handle, &context.counter_obj);
+  if (json_result != kEsfJsonSuccess) {
+    ESF_LOG_MANAGER_ERROR("Failed to init json object. json_result=%d\n",
+                          json_result);
+    return kEsfLogManagerStatusFailed;
+  }
+
+  UtilityCounterErrCode counter_ret = UtilityCounterForEachSnapshot(
+      EsfLogManagerMetricsSetCounterJsonObject, &context);
+  if (counter_ret != kUtilityCounterOk) {
+    ESF_LOG_MANAGER_ERROR("Failed to take counter snapshot. ret=%d\n",
+                          counter_ret);
+    return kEsfLogManagerStatusFailed;
+  }
+  if (context.status != kEsfLogManagerStatusOk) {
+    return context.status;
+  }
+
+  json_result = EsfJsonObjectSet(json_handle, *metrics_object_id,
+                                 LOG_MANAGER_METRICS_COUNTER_KEY,
+                                 context.counter_obj);
+  if (json_result != kEsfJsonSuccess) {
+    ESF_LOG_MANAGER_ERROR("Failed to set json object. json_result=%d\n",
+                          json_result);
+    return kEsfLogManagerStatusFailed;
+  }
+
+  return kEsfLogManagerStatusOk;
+}
+
+// """ Set Counter Json Object
+// Called for each registered counter. Counters and gauges are stored as a
+// number, histograms as an object holding the sample count, sum and buckets.
+// Args:
+//    const UtilityCounterSnapshot *snapshot: counter snapshot
+//    void *user_data: EsfLogManagerCounterContext
+// Returns:
+//    none
+static void EsfLogManagerMetricsSetCounterJsonObject(
+    const UtilityCounterSnapshot *snapshot, void *user_data) {
+  EsfLogManagerCounterContext *context =
+      (EsfLogManagerCounterContext *)user_data;
+  if (context->status != kEsfLogManagerStatusOk) {
+    return;
+  }
+
+  EsfJsonErrorCode json_result = kEsfJsonSuccess;
+  EsfJsonValue counter_value = ESF_JSON_VALUE_INVALID;
+
+  switch (snapshot->type) {
+    case kUtilityCounterTypeCounter:
+      json_result = EsfJsonRealInit(context->json_handle,
+                                    (double)snapshot->value, &counter_value);
+      break;
+    case kUtilityCounterTypeGauge:
+      json_result = EsfJsonRealInit(context->json_handle,
+                                    (double)snapshot->gauge, &counter_value);
+      break;
+    case kUtilityCounterTypeHistogram: {
+      EsfJsonValue count_value, sum_value;
+      json_result = EsfJsonObjectInit(context->json_handle, &counter_value);
+      if (json_result != kEsfJsonSuccess) {
+        break;
+      }
+      json_result = EsfJsonRealInit(context->json_handle,
+                                    (double)snapshot->value, &count_value);
+      if (json_result != kEsfJsonSuccess) {
+        break;
+      }
+      json_result = EsfJsonObjectSet(context->json_handle, counter_value,
+                                     LOG_MANAGER_METRICS_COUNTER_KEY_COUNT,
+                                     count_value);
+      if (json_result != kEsfJsonSuccess) {
+        break;
+      }
+      json_result = EsfJsonRealInit(context->json_handle,
+                                    (double)snapshot->sum, &sum_value);
+      if (json_result != kEsfJsonSuccess) {
+        break;
+      }
+      json_result = EsfJsonObjectSet(context->json_handle, counter_value,
+                                     LOG_MANAGER_METRICS_COUNTER_KEY_SUM,
+                                     sum_value);
+      if (json_result != kEsfJsonSuccess) {
+        break;
+      }
+      json_result = EsfLogManagerMetricsSetBucketJsonObject(
+          context->json_handle, counter_value, snapshot);
+      break;
+    }
+    default:
+      return;
+  }
+  if (json_result != kEsfJsonSuccess) {
+    ESF_LOG_MANAGER_ERROR("Failed to init counter value. json_result=%d\n",
+                          json_result);
+    context->status = kEsfLogManagerStatusFailed;
+    return;
+  }
+
+  json_result = EsfJsonObjectSet(context->json_handle, context->counter_obj,
+                                 snapshot->name, counter_value);
+  if (json_result != kEsfJsonSuccess) {
+    ESF_LOG_MANAGER_ERROR("Failed to set counter value. json_result=%d\n",
+                          json_result);
+    context->status = kEsfLogManagerStatusFailed;
+  }
+}
+
+// """ Set Histogram Bucket Json Object
+// Stores the non-empty buckets of a histogram as an object that maps the
+// inclusive upper bound of each bucket to its number of samples, e.g.
+// {"0": 2, "7": 10, "+Inf": 1}.
+// Args:
+//    EsfJsonHandle json_handle: json handle
+//    EsfJsonValue parent: histogram object
+//    const UtilityCounterSnapshot *snapshot: histogram snapshot
+// Returns:
+//    kEsfJsonSuccess: success
+//    others: error code of the json codec
+static EsfJsonErrorCode EsfLogManagerMetricsSetBucketJsonObject(
+    EsfJsonHandle json_handle, EsfJsonValue parent,
+    const UtilityCounterSnapshot *snapshot) {
+  EsfJsonValue bucket_obj = ESF_JSON_VALUE_INVALID;
+  EsfJsonErrorCode json_result = EsfJsonObjectInit(json_handle, &bucket_obj);
+  if (json_result != kEsfJsonSuccess) {
+    return json_result;
+  }
+
+  for (uint32_t i = 0; i < UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM; i++) {
+    if (snapshot->bucket[i] == 0) {
+      continue;
+    }
+    // Bucket i holds the samples below 2^i, the last one every larger sample.
+    char key[24];
+    if (i == UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM - 1) {
+      snprintf(key, sizeof(key), "%s",
+               LOG_MANAGER_METRICS_COUNTER_KEY_BUCKET_INF);
+    } else {
+      snprintf(key, sizeof(key), "%llu",
+               (unsigned long long)((UINT64_C(1) << i) - 1));
+    }
+    EsfJsonValue count_value = ESF_JSON_VALUE_INVALID;
+    json_result = EsfJsonRealInit(json_handle, (double)snapshot->bucket[i],
+                                  &count_value);
+    if (json_result != kEsfJsonSuccess) {
+      return json_result;
+    }
+    json_result = EsfJsonObjectSet(json_handle, bucket_obj, key, count_value);
+    if (json_result != kEsfJsonSuccess) {
+      return json_result;
+    }
+  }
+
+  return EsfJsonObjectSet(json_handle, parent,
+                          LOG_MANAGER_METRICS_COUNTER_KEY_BUCKETS, bucket_obj);
+}
+
 // """ Open Proc file and read content
 // Args:
 //    char *buf: buffer to store content
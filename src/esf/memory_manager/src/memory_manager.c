@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <stdlib.h>       // for free
 #include <string.h>       // for memcpy
+#include <strings.h>      // for ffs
 #include <wasm_export.h>  // for wasm_exec_env_t, wasm_runtim...
 #ifndef __NuttX__
 #include <bsd/sys/queue.h>
@@ -23,12 +24,16 @@
 #endif  // __NuttX__
 
 #include "memory_manager_internal.h"
+#include "utility_counter.h"
 
 // Global Variables ------------------------------------------------------------
 
-// This variable is used by MemoryManager as a list management variable for
-// memory information allocated from the LargeHeap area and DMA area.
-STATIC struct EsfMemoryManagerHandleInfoList s_handle_info_list;
+// This variable is used by MemoryManager to manage the memory information
+// allocated from the LargeHeap area and DMA area. It is indexed by handle ID,
+// so the information of a handle is found without a search. The entries of
+// unused handle IDs and of ID 0 (WasmHeap) are NULL.
+STATIC struct EsfMemoryManagerHandleInternal
+    *s_handle_info_table[MEMORY_MANAGER_MAX_MAPS + 1];
 
 // This variable is used as a flag variable to indicate completion of
 // initialization of MemoryManager.
@@ -46,6 +51,15 @@ STATIC pthread_mutex_t s_memory_manager_mutex = PTHREAD_MUTEX_INITIALIZER;
 //  ("bit 0" is unused: handle ID=0 is reserved for WasmHeap)
 STATIC uint32_t s_handle_id_map[4] = {0, 0, 0, 0};
 
+// Performance counters reported through the metrics of LogManager.
+static UTILITY_HISTOGRAM_DEFINE(s_allocate_size_counter,
+                                "memory_manager.allocate_size");
+static UTILITY_GAUGE_DEFINE(s_handle_num_counter, "memory_manager.handles");
+static UTILITY_COUNTER_DEFINE(s_fwrite_bytes_counter,
+                              "memory_manager.fwrite_bytes");
+static UTILITY_COUNTER_DEFINE(s_fread_bytes_counter,
+                              "memory_manager.fread_bytes");
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -150,15 +164,12 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFreeWasm(
 
 // """ EsfMemoryManagerDiscardMemoryInfo
 // This function discards memory information from the memory management system.
-// It takes a handle as an argument and checks if it exists in the memory
-// manager's list of handles. If not, it returns a parameter error result. Then,
-// it iterates through the linked list of memory management information to find
-// the matching entry based on the given handle ID. Once found, it verifies that
-// the memory is unmapped and has no map count. It then frees the allocated
-// memory depending on the target area (large heap or DMA). After freeing the
-// memory, it cleans up the map management information list by removing all
-// entries and deallocating their memory. Finally, it removes the found entry
-// from the linked list of memory manager's handles and frees its memory before
+// It takes a handle as an argument and looks up its entry in the memory
+// manager's table of handles by handle ID. If there is none, it returns a
+// parameter error result. Then, it verifies that the memory is unmapped and
+// has no map count. It then frees the allocated memory depending on the target
+// area (large heap or DMA). Finally, it removes the entry from the table of
+// memory manager's handles, frees its memory and returns the handle ID before
 // returning a success result. If any error occurs during this process, an
 // appropriate error result is returned instead.
 
@@ -334,8 +345,9 @@ STATIC void EsfMemoryManagerClearHandleId(void);
 //  Description: Get a free handle ID from the memory manager.
 //  This function searches for an available handle ID within the range of 1 to
 //  MEMORY_MANAGER_MAX_MAPS. It uses a bit map (s_handle_id_map) to track which
-//  IDs are in use or not. The first available ID is returned, and -1 is
-//  returned if no free ID is found.
+//  IDs are in use or not, and finds the lowest clear bit of each 32-bit word
+//  with ffs(). The first available ID is returned, and -1 is returned if no
+//  free ID is found.
 
 // Args: None
 
@@ -363,7 +375,8 @@ STATIC void EsfMemoryManagerReturnUsedHandleId(int8_t used_id);
 
 // """ EsfMemoryManagerHandleExists
 //  Description: This function checks if a given handle exists in the memory
-//  management information list.
+//  management information table. The entry is indexed by the handle ID, so
+//  the check takes constant time.
 
 // Args:
 //    handle (EsfMemoryManagerHandle): The handle to be checked for its
@@ -372,13 +385,13 @@ STATIC void EsfMemoryManagerReturnUsedHandleId(int8_t used_id);
 // Returns:
 //   - bool: Returns true if the handle is found, otherwise returns false
 //   indicating that the handle does not exist in the memory management
-//   information list.
+//   information table.
 // """
 STATIC bool EsfMemoryManagerHandleExists(EsfMemoryManagerHandle handle);
 
 // """ EsfMemoryManagerIsHandleExist
 //  Description: This function checks if a given handle exists in the memory
-//  management information list. And if it exists, it returns the entry.
+//  management information table. And if it exists, it returns the entry.
 
 // Args:
 //    handle (EsfMemoryManagerHandle): The handle to be checked for its
@@ -389,7 +402,7 @@ STATIC bool EsfMemoryManagerHandleExists(EsfMemoryManagerHandle handle);
 // Returns:
 //   - bool: Returns true if the handle is found, otherwise returns false
 //   indicating that the handle does not exist in the memory management
-//   information list.
+//   information table.
 // """
 STATIC bool EsfMemoryManagerIsHandleExist(
     EsfMemoryManagerHandle handle,
@@ -501,7 +514,7 @@ STATIC void EsfMemoryManagerCleanUpMemoryInfo(
 
 // """ EsfMemoryManagerCleanUpAllMemoryInfo
 //  Description: This function is responsible for cleaning up all memory
-//  management information. It iterates through the linked list of memory
+//  management information. It iterates through the table of memory
 //  management handles and cleans up any remaining map entries, unmap memory if
 //  necessary, frees allocated memory, and finally discards the memory
 //  management information.
@@ -1048,8 +1061,8 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerGenerateMemoryInfo(
   // linking memory operation handles to memory management information
   memory_handle->link_info = *user_handle;
   // register memory management information in the memory information
-  // management list
-  SLIST_INSERT_HEAD(&s_handle_info_list, memory_handle, next);
+  // management table
+  s_handle_info_table[handle_id] = memory_handle;
   return ret;
 
 error_exit:
@@ -1091,7 +1104,9 @@ STATIC EsfMemoryManagerResult
 EsfMemoryManagerDiscardMemoryInfo(EsfMemoryManagerHandle handle) {
   EsfMemoryManagerResult ret = kEsfMemoryManagerResultSuccess;
   // memory information existence check
-  if (!EsfMemoryManagerHandleExists(handle)) {
+  struct EsfMemoryManagerHandleInternal *entry =
+      (struct EsfMemoryManagerHandleInternal *)NULL;
+  if (!EsfMemoryManagerIsHandleExist(handle, &entry)) {
     WRITE_DLOG_ERROR(
         MODULE_ID_SYSTEM,
         "%s-%d:[%s] parameter error - handle does not exist, handle=0x%08x",
@@ -1099,73 +1114,59 @@ EsfMemoryManagerDiscardMemoryInfo(EsfMemoryManagerHandle handle) {
     ret = kEsfMemoryManagerResultParamError;
     goto error_exit;
   }
-  // selecting memory information from the memory management information list
-  struct EsfMemoryManagerHandleInternal *entry =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  ret = kEsfMemoryManagerResultParamError;
-  SLIST_FOREACH_SAFE(entry, &s_handle_info_list, next, temp) {
-    if ((entry != (struct EsfMemoryManagerHandleInternal *)NULL) &&
-        (MEMORY_MANAGER_HANDLE_ID(entry->link_info) ==
-         MEMORY_MANAGER_HANDLE_ID(handle))) {
-      // unmap error,close error
-      if ((entry->map_address != MEMORY_MANAGER_UNMAP) ||
-          (entry->file_descriptor >= 0)) {
-        WRITE_DLOG_ERROR(
-            MODULE_ID_SYSTEM,
-            "%s-%d:[%s] operation error - memory still mapped or file open, "
-            "handle=0x%08x, map_address=0x%016" PRIx64 ", fd=%d",
-            __FILE__, __LINE__, __func__, handle, entry->map_address,
-            entry->file_descriptor);
-        ret = kEsfMemoryManagerResultOperationError;
+  // unmap error,close error
+  if ((entry->map_address != MEMORY_MANAGER_UNMAP) ||
+      (entry->file_descriptor >= 0)) {
+    WRITE_DLOG_ERROR(
+        MODULE_ID_SYSTEM,
+        "%s-%d:[%s] operation error - memory still mapped or file open, "
+        "handle=0x%08x, map_address=0x%016" PRIx64 ", fd=%d",
+        __FILE__, __LINE__, __func__, handle, entry->map_address,
+        entry->file_descriptor);
+    ret = kEsfMemoryManagerResultOperationError;
+    goto error_exit;
+  }
+  // memory free
+  switch (entry->target_area) {
+    case kEsfMemoryManagerTargetLargeHeap:
+      if (PlLheapFree((PlLheapHandle)(uintptr_t)entry->allocate_address)) {
+        WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                         "%s-%d:[%s] other error - large heap free failed, "
+                         "handle=0x%08x, address=0x%lx",
+                         __FILE__, __LINE__, __func__, handle,
+                         (unsigned long)entry->allocate_address);
+        ret = kEsfMemoryManagerResultOtherError;
         goto error_exit;
       }
-      // memory free
-      switch (entry->target_area) {
-        case kEsfMemoryManagerTargetLargeHeap:
-          if (PlLheapFree((PlLheapHandle)(uintptr_t)entry->allocate_address)) {
-            WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                             "%s-%d:[%s] other error - large heap free failed, "
-                             "handle=0x%08x, address=0x%lx",
-                             __FILE__, __LINE__, __func__, handle,
-                             (unsigned long)entry->allocate_address);
-            ret = kEsfMemoryManagerResultOtherError;
-            goto error_exit;
-          }
-          break;
-        case kEsfMemoryManagerTargetDma:
-          if (PlDmaMemFree(
-                  (PlDmaMemHandle)(uintptr_t)entry->allocate_address)) {
-            WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                             "%s-%d:[%s] other error - DMA memory free failed, "
-                             "handle=0x%08x, address=0x%lx",
-                             __FILE__, __LINE__, __func__, handle,
-                             (unsigned long)entry->allocate_address);
-            ret = kEsfMemoryManagerResultOtherError;
-            goto error_exit;
-          }
-          break;
-        case kEsfMemoryManagerTargetWasmHeap:
-        default:
-          WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                           "%s-%d:[%s] parameter error - unsupported target "
-                           "area, target_area=%d",
-                           __FILE__, __LINE__, __func__, entry->target_area);
-          ret = kEsfMemoryManagerResultParamError;
-          goto error_exit;
+      break;
+    case kEsfMemoryManagerTargetDma:
+      if (PlDmaMemFree((PlDmaMemHandle)(uintptr_t)entry->allocate_address)) {
+        WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                         "%s-%d:[%s] other error - DMA memory free failed, "
+                         "handle=0x%08x, address=0x%lx",
+                         __FILE__, __LINE__, __func__, handle,
+                         (unsigned long)entry->allocate_address);
+        ret = kEsfMemoryManagerResultOtherError;
+        goto error_exit;
       }
-      // discarding memory management information
-      SLIST_REMOVE(&s_handle_info_list, entry, EsfMemoryManagerHandleInternal,
-                   next);
-      free(entry);
-      entry = (struct EsfMemoryManagerHandleInternal *)NULL;
-      // delete the memory operation handle ID.
-      EsfMemoryManagerReturnUsedHandleId(MEMORY_MANAGER_HANDLE_ID(handle));
-      ret = kEsfMemoryManagerResultSuccess;
       break;
-    }
+    case kEsfMemoryManagerTargetWasmHeap:
+    default:
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                       "%s-%d:[%s] parameter error - unsupported target "
+                       "area, target_area=%d",
+                       __FILE__, __LINE__, __func__, entry->target_area);
+      ret = kEsfMemoryManagerResultParamError;
+      goto error_exit;
   }
+  // discarding memory management information
+  s_handle_info_table[MEMORY_MANAGER_HANDLE_ID(handle)] =
+      (struct EsfMemoryManagerHandleInternal *)NULL;
+  free(entry);
+  entry = (struct EsfMemoryManagerHandleInternal *)NULL;
+  // delete the memory operation handle ID.
+  EsfMemoryManagerReturnUsedHandleId(MEMORY_MANAGER_HANDLE_ID(handle));
+  ret = kEsfMemoryManagerResultSuccess;
 
 error_exit:
   return ret;
@@ -1248,95 +1249,79 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerMapMemoryInfo(
   *address = (void *)NULL;
 
   // memory operation handle (handle_id = 1-127)
-  if (!EsfMemoryManagerHandleExists(handle)) {
+  struct EsfMemoryManagerHandleInternal *entry =
+      (struct EsfMemoryManagerHandleInternal *)NULL;
+  if (!EsfMemoryManagerIsHandleExist(handle, &entry)) {
     WRITE_DLOG_ERROR(
         MODULE_ID_SYSTEM,
         "%s-%d:[%s] parameter error - handle does not exist, handle=0x%08x",
         __FILE__, __LINE__, __func__, handle);
     return kEsfMemoryManagerResultParamError;
   }
-  // selecting memory information from the memory management information list
-  struct EsfMemoryManagerHandleInternal *entry =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  SLIST_FOREACH_SAFE(entry, &s_handle_info_list, next, temp) {
-    if ((entry != (struct EsfMemoryManagerHandleInternal *)NULL) &&
-        (MEMORY_MANAGER_HANDLE_ID(entry->link_info) ==
-         MEMORY_MANAGER_HANDLE_ID(handle))) {
-      // map area check
-      uint32_t area_size = 0;
-      if (entry->target_area == kEsfMemoryManagerTargetWasmHeap) {
-        WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                         "%s-%d:[%s] parameter error - wasm heap not supported "
-                         "for mapping, handle=0x%08x",
-                         __FILE__, __LINE__, __func__, handle);
-        return kEsfMemoryManagerResultParamError;
-      }
-      if ((uint32_t)entry->allocate_size <
-          MEMORY_MANAGER_HANDLE_OFFSET(handle)) {
-        WRITE_DLOG_ERROR(
-            MODULE_ID_SYSTEM,
-            "%s-%d:[%s] parameter error - offset exceeds allocated size, "
-            "handle=0x%08x, allocate_size=%d, offset=0x%08x",
-            __FILE__, __LINE__, __func__, handle, entry->allocate_size,
-            MEMORY_MANAGER_HANDLE_OFFSET(handle));
-        return kEsfMemoryManagerResultParamError;
-      }
-      area_size = (uint32_t)entry->allocate_size -
-                  MEMORY_MANAGER_HANDLE_OFFSET(handle);
-      if (area_size < (uint32_t)size) {
-        WRITE_DLOG_ERROR(
-            MODULE_ID_SYSTEM,
-            "%s-%d:[%s] parameter error - requested size exceeds available "
-            "area, handle=0x%08x, area_size=%u, requested_size=%d",
-            __FILE__, __LINE__, __func__, handle, area_size, size);
-        return kEsfMemoryManagerResultParamError;
-      }
-      // virtual Address Map processing
-      //  when mapping for the first time, execute Osal's MapAPI. *Updates
-      //  the map address for the entire area (virtual address of the
-      //  beginning of the area).
-      ret = EsfMemoryManagerMapMemory(entry);
-      if (ret != kEsfMemoryManagerResultSuccess) {
-        WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                         "%s-%d:[%s] map memory failed, handle=0x%08x, ret=%d",
-                         __FILE__, __LINE__, __func__, handle, ret);
-        return ret;
-      }
-      // map management information list unregistered check
-      if (!EsfMemoryManagerMapInfoExists(handle, entry)) {
-        // allocate map management information for new registrations
-        struct EsfMemoryManagerHandleAddressOffset *new_list = NULL;
-        new_list = malloc(sizeof(struct EsfMemoryManagerHandleAddressOffset));
-        if (new_list == NULL) {
-          // Elog (telemetry) output
-          ESF_MEMORY_MANAGER_ELOG_ERROR(ESF_ERROR_MEMORY_MAP);
-          WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:[%s] failed(%d)", __FILE__,
-                           __LINE__, __func__, kEsfMemoryManagerResultMapError);
-          return kEsfMemoryManagerResultMapError;
-        }
-        new_list->address_offset = MEMORY_MANAGER_HANDLE_OFFSET(handle);
-        new_list->file_descriptor = -1;
-        // register map management information in the map management
-        // information list
-        SLIST_INSERT_HEAD(&(entry->map_info_list), new_list, next);
-        // map registration count up
-        entry->map_count++;
-      }
-      // map address: thew offset value specified by the memory operation
-      // handle + virtual address
-      *address = (void *)(uintptr_t)(entry->map_address +
-                                     MEMORY_MANAGER_HANDLE_OFFSET(handle));
-      // break;
-      return kEsfMemoryManagerResultSuccess;
-    }
+  // map area check
+  if (entry->target_area == kEsfMemoryManagerTargetWasmHeap) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:[%s] parameter error - wasm heap not supported "
+                     "for mapping, handle=0x%08x",
+                     __FILE__, __LINE__, __func__, handle);
+    return kEsfMemoryManagerResultParamError;
+  }
+  if ((uint32_t)entry->allocate_size <
+      MEMORY_MANAGER_HANDLE_OFFSET(handle)) {
+    WRITE_DLOG_ERROR(
+        MODULE_ID_SYSTEM,
+        "%s-%d:[%s] parameter error - offset exceeds allocated size, "
+        "handle=0x%08x, allocate_size=%d, offset=0x%08x",
+        __FILE__, __LINE__, __func__, handle, entry->allocate_size,
+        MEMORY_MANAGER_HANDLE_OFFSET(handle));
+    return kEsfMemoryManagerResultParamError;
+  }
+  uint32_t area_size = (uint32_t)entry->allocate_size -
+                       MEMORY_MANAGER_HANDLE_OFFSET(handle);
+  if (area_size < (uint32_t)size) {
+    WRITE_DLOG_ERROR(
+        MODULE_ID_SYSTEM,
+        "%s-%d:[%s] parameter error - requested size exceeds available "
+        "area, handle=0x%08x, area_size=%u, requested_size=%d",
+        __FILE__, __LINE__, __func__, handle, area_size, size);
+    return kEsfMemoryManagerResultParamError;
+  }
+  // virtual Address Map processing
+  //  when mapping for the first time, execute Osal's MapAPI. *Updates
+  //  the map address for the entire area (virtual address of the
+  //  beginning of the area).
+  ret = EsfMemoryManagerMapMemory(entry);
+  if (ret != kEsfMemoryManagerResultSuccess) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:[%s] map memory failed, handle=0x%08x, ret=%d",
+                     __FILE__, __LINE__, __func__, handle, ret);
+    return ret;
   }
-  WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                   "%s-%d:[%s] parameter error - handle not found in memory "
-                   "info list, handle=0x%08x",
-                   __FILE__, __LINE__, __func__, handle);
-  return kEsfMemoryManagerResultParamError;
+  // map management information list unregistered check
+  if (!EsfMemoryManagerMapInfoExists(handle, entry)) {
+    // allocate map management information for new registrations
+    struct EsfMemoryManagerHandleAddressOffset *new_list = NULL;
+    new_list = malloc(sizeof(struct EsfMemoryManagerHandleAddressOffset));
+    if (new_list == NULL) {
+      // Elog (telemetry) output
+      ESF_MEMORY_MANAGER_ELOG_ERROR(ESF_ERROR_MEMORY_MAP);
+      WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:[%s] failed(%d)", __FILE__,
+                       __LINE__, __func__, kEsfMemoryManagerResultMapError);
+      return kEsfMemoryManagerResultMapError;
+    }
+    new_list->address_offset = MEMORY_MANAGER_HANDLE_OFFSET(handle);
+    new_list->file_descriptor = -1;
+    // register map management information in the map management
+    // information list
+    SLIST_INSERT_HEAD(&(entry->map_info_list), new_list, next);
+    // map registration count up
+    entry->map_count++;
+  }
+  // map address: thew offset value specified by the memory operation
+  // handle + virtual address
+  *address = (void *)(uintptr_t)(entry->map_address +
+                                 MEMORY_MANAGER_HANDLE_OFFSET(handle));
+  return kEsfMemoryManagerResultSuccess;
 }
 /* ------------------------------------------------------------------------ */
 STATIC EsfMemoryManagerResult
@@ -1438,70 +1423,56 @@ STATIC EsfMemoryManagerResult
 EsfMemoryManagerUnmapMemoryInfo(EsfMemoryManagerHandle handle) {
   EsfMemoryManagerResult ret = kEsfMemoryManagerResultSuccess;
   // memory operation handle (handle_id = 1-127)
-  if (!EsfMemoryManagerHandleExists(handle)) {
+  struct EsfMemoryManagerHandleInternal *entry =
+      (struct EsfMemoryManagerHandleInternal *)NULL;
+  if (!EsfMemoryManagerIsHandleExist(handle, &entry)) {
     WRITE_DLOG_ERROR(
         MODULE_ID_SYSTEM,
         "%s-%d:[%s] parameter error - handle does not exist, handle=0x%08x",
         __FILE__, __LINE__, __func__, handle);
     return kEsfMemoryManagerResultParamError;
   }
-  // selecting memory information from the memory management information list
-  struct EsfMemoryManagerHandleInternal *entry =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  SLIST_FOREACH_SAFE(entry, &s_handle_info_list, next, temp) {
-    if ((entry != (struct EsfMemoryManagerHandleInternal *)NULL) &&
-        (MEMORY_MANAGER_HANDLE_ID(entry->link_info) ==
-         MEMORY_MANAGER_HANDLE_ID(handle))) {
-      if (entry->map_address == MEMORY_MANAGER_UNMAP) {
-        WRITE_DLOG_ERROR(
-            MODULE_ID_SYSTEM,
-            "%s-%d:[%s] operation error - memory not mapped, handle=0x%08x",
-            __FILE__, __LINE__, __func__, handle);
-        return kEsfMemoryManagerResultOperationError;
-      }
-      if (!EsfMemoryManagerMapInfoExists(handle, entry)) {
-        WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                         "%s-%d:[%s] parameter error - map info does not "
-                         "exist, handle=0x%08x",
-                         __FILE__, __LINE__, __func__, handle);
-        return kEsfMemoryManagerResultParamError;
-      }
-      // virtual Address Unmap processing
-      //  delete the corresponding map management information from the map
-      //  management information list in the memory management information
-      struct EsfMemoryManagerHandleAddressOffset *map_entry =
-          (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-      struct EsfMemoryManagerHandleAddressOffset *map_temp =
-          (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-      SLIST_FOREACH_SAFE(map_entry, &(entry->map_info_list), next, map_temp) {
-        if (map_entry->address_offset == MEMORY_MANAGER_HANDLE_OFFSET(handle)) {
-          SLIST_REMOVE(&(entry->map_info_list), map_entry,
-                       EsfMemoryManagerHandleAddressOffset, next);
-          free(map_entry);
-          break;
-        }
-      }
-      // map registration count down
-      if (entry->map_count > 0) {
-        entry->map_count--;
-      }
-      // virtual Address unmap processing
-      //  when map registration count is 0, execute Osal's UnAPI. *Clear the
-      //  map addresses of the entire area (All "ff")
-      ret = EsfMemoryManagerUnmapMemory(entry);
-      if (ret != kEsfMemoryManagerResultSuccess) {
-        // No error is returned to the higher level
-      }
-      return kEsfMemoryManagerResultSuccess;
+  if (entry->map_address == MEMORY_MANAGER_UNMAP) {
+    WRITE_DLOG_ERROR(
+        MODULE_ID_SYSTEM,
+        "%s-%d:[%s] operation error - memory not mapped, handle=0x%08x",
+        __FILE__, __LINE__, __func__, handle);
+    return kEsfMemoryManagerResultOperationError;
+  }
+  if (!EsfMemoryManagerMapInfoExists(handle, entry)) {
+    WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
+                     "%s-%d:[%s] parameter error - map info does not "
+                     "exist, handle=0x%08x",
+                     __FILE__, __LINE__, __func__, handle);
+    return kEsfMemoryManagerResultParamError;
+  }
+  // virtual Address Unmap processing
+  //  delete the corresponding map management information from the map
+  //  management information list in the memory management information
+  struct EsfMemoryManagerHandleAddressOffset *map_entry =
+      (struct EsfMemoryManagerHandleAddressOffset *)NULL;
+  struct EsfMemoryManagerHandleAddressOffset *map_temp =
+      (struct EsfMemoryManagerHandleAddressOffset *)NULL;
+  SLIST_FOREACH_SAFE(map_entry, &(entry->map_info_list), next, map_temp) {
+    if (map_entry->address_offset == MEMORY_MANAGER_HANDLE_OFFSET(handle)) {
+      SLIST_REMOVE(&(entry->map_info_list), map_entry,
+                   EsfMemoryManagerHandleAddressOffset, next);
+      free(map_entry);
+      break;
     }
   }
-  WRITE_DLOG_ERROR(MODULE_ID_SYSTEM,
-                   "%s-%d:[%s] parameter error - handle not found in memory "
-                   "info list, handle=0x%08x",
-                   __FILE__, __LINE__, __func__, handle);
-  return kEsfMemoryManagerResultParamError;
+  // map registration count down
+  if (entry->map_count > 0) {
+    entry->map_count--;
+  }
+  // virtual Address unmap processing
+  //  when map registration count is 0, execute Osal's UnAPI. *Clear the
+  //  map addresses of the entire area (All "ff")
+  ret = EsfMemoryManagerUnmapMemory(entry);
+  if (ret != kEsfMemoryManagerResultSuccess) {
+    // No error is returned to the higher level
+  }
+  return kEsfMemoryManagerResultSuccess;
 }
 /* ------------------------------------------------------------------------ */
 STATIC EsfMemoryManagerResult
@@ -1552,18 +1523,20 @@ STATIC void EsfMemoryManagerClearHandleId(void) {
 }
 /* ------------------------------------------------------------------------ */
 STATIC int8_t EsfMemoryManagerGetFreeHandleId(void) {
-  uint32_t i = 0;
   uint32_t index = 0;
-  uint32_t bit_pos = 0;
   int8_t free_id = -1;  // id initialize(No free ID)
 
-  // search for available IDs
-  for (i = 1; i <= MEMORY_MANAGER_MAX_MAPS; i++) {
-    index = i / 32;    // s_handle_id_map index calculation
-    bit_pos = i % 32;  // s_handle_id_map bit position set
-    if ((s_handle_id_map[index] & ((uint32_t)(1 << bit_pos))) == 0) {
+  // search for available IDs, a word of s_handle_id_map at a time
+  for (index = 0; index < (sizeof(s_handle_id_map) / sizeof(uint32_t));
+       index++) {
+    // "bit 0" is unused: handle ID=0 is reserved for WasmHeap
+    uint32_t used_map = s_handle_id_map[index] | ((index == 0) ? 1U : 0U);
+    // position of the lowest clear bit + 1 (0: no clear bit)
+    int bit = ffs((int)~used_map);
+    if (bit != 0) {
+      uint32_t bit_pos = (uint32_t)(bit - 1);
       // calculate ID from s_handle_id_map bit position
-      s_handle_id_map[index] |= ((uint32_t)(1 << bit_pos));
+      s_handle_id_map[index] |= ((uint32_t)1 << bit_pos);
       free_id = (int8_t)(32 * index + bit_pos);
       break;
     }
@@ -1583,44 +1556,18 @@ STATIC void EsfMemoryManagerReturnUsedHandleId(int8_t used_id) {
 }
 /* ------------------------------------------------------------------------ */
 STATIC bool EsfMemoryManagerHandleExists(EsfMemoryManagerHandle handle) {
-  // Search for the corresponding handle ID from the memory management
-  // information list
-  struct EsfMemoryManagerHandleInternal *entry =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  SLIST_FOREACH_SAFE(entry, &s_handle_info_list, next, temp) {
-    if (MEMORY_MANAGER_HANDLE_ID(entry->link_info) ==
-        MEMORY_MANAGER_HANDLE_ID(handle)) {
-      // Handle ID detection
-      return true;
-    }
-  }
-  // Handle ID not found
-  return false;
+  // The entry of the handle ID in the memory management information table
+  return (s_handle_info_table[MEMORY_MANAGER_HANDLE_ID(handle)] !=
+          (struct EsfMemoryManagerHandleInternal *)NULL);
 }
 /* ------------------------------------------------------------------------ */
 STATIC bool EsfMemoryManagerIsHandleExist(
     EsfMemoryManagerHandle handle,
     struct EsfMemoryManagerHandleInternal **entry) {
   if (entry == (struct EsfMemoryManagerHandleInternal **)NULL) return false;
-  // Search for the corresponding handle ID from the memory management
-  // information list
-  struct EsfMemoryManagerHandleInternal *entry_temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  SLIST_FOREACH_SAFE(entry_temp, &s_handle_info_list, next, temp) {
-    if (MEMORY_MANAGER_HANDLE_ID(entry_temp->link_info) ==
-        MEMORY_MANAGER_HANDLE_ID(handle)) {
-      // Handle ID detection
-      *entry = entry_temp;
-      return true;
-    }
-  }
-  // Handle ID not found
-  *entry = entry_temp;
-  return false;
+  // The entry of the handle ID in the memory management information table
+  *entry = s_handle_info_table[MEMORY_MANAGER_HANDLE_ID(handle)];
+  return (*entry != (struct EsfMemoryManagerHandleInternal *)NULL);
 }
 /* ------------------------------------------------------------------------ */
 STATIC bool EsfMemoryManagerMapInfoExists(
@@ -1731,17 +1678,16 @@ STATIC void EsfMemoryManagerCleanUpRemainResource(
 }
 /* ------------------------------------------------------------------------ */
 STATIC EsfMemoryManagerResult EsfMemoryManagerCleanUpAllMemoryInfo(void) {
-  // finalizing the linked list of memory management information.
-  struct EsfMemoryManagerHandleInternal *entry =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  struct EsfMemoryManagerHandleInternal *temp =
-      (struct EsfMemoryManagerHandleInternal *)NULL;
-  SLIST_FOREACH_SAFE(entry, &s_handle_info_list, next, temp) {
+  // finalizing the table of memory management information.
+  uint32_t handle_id = 0;
+  for (handle_id = 1; handle_id <= MEMORY_MANAGER_MAX_MAPS; handle_id++) {
+    struct EsfMemoryManagerHandleInternal *entry =
+        s_handle_info_table[handle_id];
     if (entry != (struct EsfMemoryManagerHandleInternal *)NULL) {
       // Cleaning up remaining resources (memory map & file descriptors )
       EsfMemoryManagerCleanUpRemainResource(entry);
       // cleaning up the map management information list
-      //  Check the handle link list and clean up if there are any remaining
+      //  Check the handle table and clean up if there are any remaining
       //  handles Does not unmap or free remaining memory
       struct EsfMemoryManagerHandleAddressOffset *map_entry =
           (struct EsfMemoryManagerHandleAddressOffset *)NULL;
@@ -1756,8 +1702,8 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerCleanUpAllMemoryInfo(void) {
                      EsfMemoryManagerHandleAddressOffset, next);
         free(map_entry);
       }
-      SLIST_REMOVE(&s_handle_info_list, entry, EsfMemoryManagerHandleInternal,
-                   next);
+      s_handle_info_table[handle_id] =
+          (struct EsfMemoryManagerHandleInternal *)NULL;
       // memory free
       EsfMemoryManagerCleanUpMemoryInfo(entry);
     }
@@ -1819,7 +1765,7 @@ EsfMemoryManagerFileIoFopen(EsfMemoryManagerHandle handle, int32_t size) {
   PlErrCode err_code = kPlErrCodeOk;
   int file_descriptor = -1;
 
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   struct EsfMemoryManagerHandleInternal *entry =
       (struct EsfMemoryManagerHandleInternal *)NULL;
   bool handle_exist = EsfMemoryManagerIsHandleExist(handle, &entry);
@@ -1990,7 +1936,7 @@ EsfMemoryManagerFileIoFclose(EsfMemoryManagerHandle handle) {
       (struct EsfMemoryManagerHandleInternal *)NULL;
   struct EsfMemoryManagerHandleAddressOffset *map_info_entry =
       (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   // Search for the corresponding map(open) information from the map(open)
   // management information list.
   ret = EsfMemoryManagerFileIoGetHandleEntry(handle, &entry, &map_info_entry);
@@ -2050,7 +1996,7 @@ EsfMemoryManagerFileIoFclose(EsfMemoryManagerHandle handle) {
     }
     // FileIO access end (mutex unlock)
     pthread_mutex_unlock(handle_mutex);
-    // selecting memory information from the memory management information list
+    // selecting memory information from the memory management information table
     // Search for the corresponding map(open) information from the map(open)
     // management information list.
     ret = EsfMemoryManagerFileIoGetHandleEntry(handle, &entry, &map_info_entry);
@@ -2232,7 +2178,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoFseek(
       (struct EsfMemoryManagerHandleInternal *)NULL;
   struct EsfMemoryManagerHandleAddressOffset *map_info_entry =
       (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   // Search for the corresponding map(open) information from the map(open)
   // management information list.
   ret = EsfMemoryManagerFileIoGetHandleEntry(handle, &entry, &map_info_entry);
@@ -2285,7 +2231,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoFseek(
                        __FILE__, __LINE__, __func__);
       return kEsfMemoryManagerResultOtherError;
     }
-    // selecting memory information from the memory management information list
+    // selecting memory information from the memory management information table
     // Search for the corresponding map(open) information from the map(open)
     // management information list.
     EsfMemoryManagerResult ret2 =
@@ -2462,7 +2408,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoFwriteFread(
       (struct EsfMemoryManagerHandleInternal *)NULL;
   struct EsfMemoryManagerHandleAddressOffset *map_info_entry =
       (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   // Search for the corresponding map(open) information from the map(open)
   // management information list.
   ret = EsfMemoryManagerFileIoGetHandleEntry(handle, &entry, &map_info_entry);
@@ -2506,6 +2452,11 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoFwriteFread(
         allocate_address, file_descriptor, operation, param, &seek_position);
     // FileIO access end (mutex unlock)
     pthread_mutex_unlock(handle_mutex);
+    if (operation == kEsfMemoryManagerFileIoFwrite) {
+      UTILITY_COUNTER_ADD(s_fwrite_bytes_counter, *param->rsize);
+    } else {
+      UTILITY_COUNTER_ADD(s_fread_bytes_counter, *param->rsize);
+    }
     err = pthread_mutex_lock(&s_memory_manager_mutex);
     if (err != 0) {
       // Elog (telemetry) output
@@ -2513,7 +2464,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoFwriteFread(
                        __FILE__, __LINE__, __func__);
       return kEsfMemoryManagerResultOtherError;
     }
-    // selecting memory information from the memory management information list
+    // selecting memory information from the memory management information table
     // Search for the corresponding map(open) information from the map(open)
     // management information list.
     EsfMemoryManagerResult ret2 =
@@ -2554,7 +2505,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoPwritePread(
       (struct EsfMemoryManagerHandleInternal *)NULL;
   struct EsfMemoryManagerHandleAddressOffset *map_info_entry =
       (struct EsfMemoryManagerHandleAddressOffset *)NULL;
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   // Search for the corresponding map(open) information from the map(open)
   // management information list.
   ret = EsfMemoryManagerFileIoGetHandleEntry(handle, &entry, &map_info_entry);
@@ -2626,6 +2577,11 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoPwritePread(
                                                 access_param, &seek_position);
     // FileIO access end (mutex unlock)
     pthread_mutex_unlock(handle_mutex);
+    if (operation == kEsfMemoryManagerFileIoFwrite) {
+      UTILITY_COUNTER_ADD(s_fwrite_bytes_counter, *access_param->rsize);
+    } else {
+      UTILITY_COUNTER_ADD(s_fread_bytes_counter, *access_param->rsize);
+    }
     err = pthread_mutex_lock(&s_memory_manager_mutex);
     if (err != 0) {
       // Elog (telemetry) output
@@ -2633,7 +2589,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoPwritePread(
                        __FILE__, __LINE__, __func__);
       return kEsfMemoryManagerResultOtherError;
     }
-    // selecting memory information from the memory management information list
+    // selecting memory information from the memory management information table
     // Search for the corresponding map(open) information from the map(open)
     // management information list.
     EsfMemoryManagerResult ret2 =
@@ -2657,7 +2613,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerFileIoIsMapSupport(
     // Map function support (FileIO function not supported)
     return kEsfMemoryManagerResultParamError;
   }
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   struct EsfMemoryManagerHandleInternal *entry =
       (struct EsfMemoryManagerHandleInternal *)NULL;
   bool handle_exist = EsfMemoryManagerIsHandleExist(handle, &entry);
@@ -2700,7 +2656,7 @@ STATIC EsfMemoryManagerResult EsfMemoryManagerSetHandleInfo(
   }
   info->target_area = kEsfMemoryManagerTargetOtherHeap;
   info->allocate_size = 0;
-  // selecting memory information from the memory management information list
+  // selecting memory information from the memory management information table
   struct EsfMemoryManagerHandleInternal *entry =
       (struct EsfMemoryManagerHandleInternal *)NULL;
   bool handle_exist = EsfMemoryManagerIsHandleExist(handle, &entry);
@@ -2822,7 +2778,7 @@ EsfMemoryManagerResult EsfMemoryManagerInitialize(int32_t app_mem_div_num) {
     return kEsfMemoryManagerResultOtherError;
   }
   // Linked list initialize for memory management information.
-  SLIST_INIT(&s_handle_info_list);
+  memset(s_handle_info_table, 0, sizeof(s_handle_info_table));
 
   // s_handle_id_map initialize(clear)
   EsfMemoryManagerClearHandleId();
@@ -2926,6 +2882,9 @@ EsfMemoryManagerResult EsfMemoryManagerAllocate(
     // TODO: Error log.
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:[%s] failed(%d)", __FILE__,
                      __LINE__, __func__, ret);
+  } else {
+    UTILITY_HISTOGRAM_OBSERVE(s_allocate_size_counter, (uint64_t)size);
+    UTILITY_GAUGE_ADD(s_handle_num_counter, 1);
   }
   // set the memory operation handle for the new allocate memory
   *handle = user_handle;
@@ -2964,6 +2923,8 @@ EsfMemoryManagerResult EsfMemoryManagerFree(EsfMemoryManagerHandle handle,
     // TODO: Error log.
     WRITE_DLOG_ERROR(MODULE_ID_SYSTEM, "%s-%d:[%s] failed(%d)", __FILE__,
                      __LINE__, __func__, ret);
+  } else {
+    UTILITY_GAUGE_ADD(s_handle_num_counter, -1);
   }
 
   pthread_mutex_unlock(&s_memory_manager_mutex);
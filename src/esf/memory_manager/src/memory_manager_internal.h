@@ -118,7 +118,7 @@ struct EsfMemoryManagerHandleAddressOffset {
 SLIST_HEAD(EsfMemoryManagerMapInfoList, EsfMemoryManagerHandleAddressOffset);
 
 // Definition of memory information for LargeHeap/DMA/WasmHeap area.
-// Linked list definition of memory management information.
+// Entry of the memory management information table, indexed by handle ID.
 struct EsfMemoryManagerHandleInternal {
   uint32_t link_info;  // Link information with the handle (handle ID)
   EsfMemoryManagerTargetArea target_area;  // target memory area
@@ -128,9 +128,7 @@ struct EsfMemoryManagerHandleInternal {
   int32_t map_count;                       // mapped count
   int file_descriptor;                     // File Descriptors (for FileIO)
   struct EsfMemoryManagerMapInfoList map_info_list;
-  SLIST_ENTRY(EsfMemoryManagerHandleInternal) next;
 };
-SLIST_HEAD(EsfMemoryManagerHandleInfoList, EsfMemoryManagerHandleInternal);
 
 #ifdef __cplusplus
 }
@@ -13,6 +13,7 @@
 #include "parameter_storage_manager/src/parameter_storage_manager_storage_adapter_item_type.h"
 #include "parameter_storage_manager/src/parameter_storage_manager_storage_adapter_settings.h"
 #include "parameter_storage_manager/src/parameter_storage_manager_utility.h"
+#include "utility_counter.h"
 
 #include ESF_PARAMETER_STORAGE_MANAGER_POWER_MANAGER_FILE
 
@@ -33,6 +34,13 @@ typedef struct EsfParameterStorageManagerUpdateBeginContext {
   EsfParameterStorageManagerUpdateType type;
 } EsfParameterStorageManagerUpdateBeginContext;
 
+// Performance counters reported through the metrics of LogManager.
+static UTILITY_COUNTER_DEFINE(s_save_counter, "psm.save");
+static UTILITY_COUNTER_DEFINE(s_save_failed_counter, "psm.save_failed");
+static UTILITY_HISTOGRAM_DEFINE(s_save_time_counter, "psm.save_time_us");
+static UTILITY_COUNTER_DEFINE(s_load_counter, "psm.load");
+static UTILITY_COUNTER_DEFINE(s_load_failed_counter, "psm.load_failed");
+
 // """Initializes the internal resource and the storage area.
 
 // Initializes the internal resource and the storage area.
@@ -1211,6 +1219,8 @@ EsfParameterStorageManagerStatus EsfParameterStorageManagerSave(
   ESF_PARAMETER_STORAGE_MANAGER_TRACE("entry");
   EsfParameterStorageManagerWorkContext* work = NULL;
   EsfParameterStorageManagerStatus ret = kEsfParameterStorageManagerStatusOk;
+  struct timespec begin_ts, end_ts;
+  clock_gettime(CLOCK_MONOTONIC, &begin_ts);
 
   do {
     if (handle == ESF_PARAMETER_STORAGE_MANAGER_INVALID_HANDLE ||
@@ -1278,6 +1288,18 @@ EsfParameterStorageManagerStatus EsfParameterStorageManagerSave(
     ESF_PARAMETER_STORAGE_MANAGER_DEBUG("Work memory freed");
   }
 
+  if (ret == kEsfParameterStorageManagerStatusOk) {
+    clock_gettime(CLOCK_MONOTONIC, &end_ts);
+    int64_t elapsed_us =
+        (int64_t)(end_ts.tv_sec - begin_ts.tv_sec) * 1000000 +
+        (end_ts.tv_nsec - begin_ts.tv_nsec) / 1000;
+    UTILITY_COUNTER_INC(s_save_counter);
+    UTILITY_HISTOGRAM_OBSERVE(s_save_time_counter,
+                              (uint64_t)(elapsed_us > 0 ? elapsed_us : 0));
+  } else {
+    UTILITY_COUNTER_INC(s_save_failed_counter);
+  }
+
   ESF_PARAMETER_STORAGE_MANAGER_TRACE("exit %u(%s)", ret,
                                       EsfParameterStorageManagerStrError(ret));
   return ret;
@@ -1357,6 +1379,12 @@ EsfParameterStorageManagerStatus EsfParameterStorageManagerLoad(
     ESF_PARAMETER_STORAGE_MANAGER_DEBUG("Work memory freed");
   }
 
+  if (ret == kEsfParameterStorageManagerStatusOk) {
+    UTILITY_COUNTER_INC(s_load_counter);
+  } else {
+    UTILITY_COUNTER_INC(s_load_failed_counter);
+  }
+
   ESF_PARAMETER_STORAGE_MANAGER_TRACE("exit %u(%s)", ret,
                                       EsfParameterStorageManagerStrError(ret));
   return ret;
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <pthread.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 
 #include "pl.h"
@@ -28,9 +30,132 @@
                    format, __FILE__, __LINE__, ##__VA_ARGS__); \
   WRITE_ELOG_ERROR(MODULE_ID_SYSTEM, (EVENT_ID | (EVENT_ID_START + event_id)))
 
+// Size of the memory preallocated at initialization for size-class blocks.
+// 0 disables the arena.
+#ifdef CONFIG_PL_LHEAP_ARENA_SIZE
+#define PL_LHEAP_ARENA_SIZE (CONFIG_PL_LHEAP_ARENA_SIZE)
+#else
+#define PL_LHEAP_ARENA_SIZE (0)
+#endif
+
+// Largest size class is 1 << PL_LHEAP_MAX_CLASS_SHIFT bytes. Larger
+// allocations are passed to malloc().
+#ifdef CONFIG_PL_LHEAP_MAX_CLASS_SHIFT
+#define PL_LHEAP_MAX_CLASS_SHIFT (CONFIG_PL_LHEAP_MAX_CLASS_SHIFT)
+#else
+#define PL_LHEAP_MAX_CLASS_SHIFT (25)
+#endif
+
+// Free blocks kept per size class by each thread, up to
+// PL_LHEAP_THREAD_CACHE_BYTES in all classes. 0 disables thread caches.
+// A thread hands blocks beyond a batch to the shared free lists while they
+// have room, but the blocks left in its cache are only given back when the
+// thread exits or on its first call after a finalization.
+#ifdef CONFIG_PL_LHEAP_THREAD_CACHE_NUM
+#define PL_LHEAP_THREAD_CACHE_NUM (CONFIG_PL_LHEAP_THREAD_CACHE_NUM)
+#else
+#define PL_LHEAP_THREAD_CACHE_NUM (4)
+#endif
+#ifdef CONFIG_PL_LHEAP_THREAD_CACHE_BYTES
+#define PL_LHEAP_THREAD_CACHE_BYTES (CONFIG_PL_LHEAP_THREAD_CACHE_BYTES)
+#else
+#define PL_LHEAP_THREAD_CACHE_BYTES (256 * 1024)
+#endif
+
+// Bytes of heap blocks kept in the shared free lists of all size classes.
+// Other freed heap blocks go back to free(). Arena blocks are always kept.
+#ifdef CONFIG_PL_LHEAP_FREE_BYTES
+#define PL_LHEAP_FREE_BYTES (CONFIG_PL_LHEAP_FREE_BYTES)
+#else
+#define PL_LHEAP_FREE_BYTES (2 * 1024 * 1024)
+#endif
+
+// Allocations up to this size are passed to malloc().
+#define PL_LHEAP_SMALL_MAX_SHIFT (11)
+#define PL_LHEAP_SMALL_MAX (1U << PL_LHEAP_SMALL_MAX_SHIFT)
+
+// Four size classes per power of two, so a block is less than 25% larger
+// than the request.
+#define PL_LHEAP_CLASS_PER_SHIFT (4)
+#define PL_LHEAP_CLASS_NUM                                \
+  ((PL_LHEAP_MAX_CLASS_SHIFT - PL_LHEAP_SMALL_MAX_SHIFT) * \
+   PL_LHEAP_CLASS_PER_SHIFT)
+#define PL_LHEAP_CLASS_DIRECT (UINT32_MAX)
+
+// Blocks moved at once between a thread cache and the shared free list.
+#define PL_LHEAP_BATCH_NUM ((PL_LHEAP_THREAD_CACHE_NUM + 1) / 2)
+
+// The header keeps the payload on a cache line boundary.
+#define PL_LHEAP_ALIGN (64)
+#define PL_LHEAP_HEADER_SIZE (PL_LHEAP_ALIGN)
+
+#define PL_LHEAP_MAGIC_USED (0x4C484150U)
+#define PL_LHEAP_MAGIC_FREE (0x4C484646U)
+
+// Typedefs --------------------------------------------------------------------
+typedef struct LheapBlock {
+  uint32_t magic;
+  uint32_t class_idx;
+  struct LheapBlock *next;
+} LheapBlock;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  LheapBlock *head;
+  // Bytes of the heap blocks in the list, counted in s_free_bytes.
+  size_t heap_bytes;
+} LheapClassList;
+
+typedef struct LheapThreadCache {
+  LheapBlock *head[PL_LHEAP_CLASS_NUM];
+  uint32_t count[PL_LHEAP_CLASS_NUM];
+  size_t bytes;
+  // Value of s_generation when the cache was last used.
+  uint32_t generation;
+} LheapThreadCache;
+
+_Static_assert(sizeof(LheapBlock) <= PL_LHEAP_HEADER_SIZE,
+               "LheapBlock exceeds PL_LHEAP_HEADER_SIZE");
+
+// Local functions -------------------------------------------------------------
+static void LheapOnce(void);
+static uint32_t LheapClassIndex(uint32_t size);
+static size_t LheapClassSize(uint32_t class_idx);
+static size_t LheapClassBytes(uint32_t class_idx);
+static bool LheapFreeBytesReserve(size_t size);
+static bool LheapIsArenaBlock(const LheapBlock *block);
+static LheapBlock *LheapBlockNew(uint32_t class_idx, size_t size);
+static void LheapClassPush(uint32_t class_idx, LheapBlock *head,
+                           bool keep_heap);
+static LheapThreadCache *LheapThreadCacheGet(void);
+static void LheapThreadCacheDrain(LheapThreadCache *cache, bool keep_heap);
+static void LheapThreadCacheDestroy(void *arg);
+static LheapBlock *LheapCachePop(uint32_t class_idx);
+static void LheapCachePush(LheapBlock *block);
+
 // Global Variables ------------------------------------------------------------
+// s_mutex serializes initialization and finalization. Allocation and free do
+// not take it.
 static pthread_mutex_t s_mutex = PTHREAD_MUTEX_INITIALIZER;
-static bool s_is_initialized = false;
+static atomic_bool s_is_initialized = false;
+// Incremented by every finalization. A thread cache is only touched by its
+// own thread, which drains it when it sees a new generation.
+static atomic_uint s_generation = 0;
+
+static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+static pthread_key_t s_cache_key;
+static bool s_cache_key_valid = false;
+static LheapClassList s_class_list[PL_LHEAP_CLASS_NUM];
+// Bytes of heap blocks in the shared free lists, up to PL_LHEAP_FREE_BYTES.
+static atomic_size_t s_free_bytes = 0;
+static _Thread_local LheapThreadCache *s_thread_cache = NULL;
+
+// The arena is mapped once by the first initialization and kept for the life
+// of the process, so blocks carved from it stay valid across finalization.
+static pthread_mutex_t s_arena_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint8_t *s_arena = NULL;
+static size_t s_arena_size = 0;
+static size_t s_arena_used = 0;
 
 // External functions ----------------------------------------------------------
 PlErrCode PlLheapInitializeOsImpl(void) {
@@ -43,13 +168,15 @@ PlErrCode PlLheapInitializeOsImpl(void) {
     goto err_mutex;
   }
 
-  if (s_is_initialized) {
+  if (atomic_load(&s_is_initialized)) {
     pl_ercd = kPlErrInvalidState;
     LOG_E(0x01, "Already initialized.");
     goto err_end;
   }
 
-  s_is_initialized = true;
+  pthread_once(&s_once, LheapOnce);
+
+  atomic_store(&s_is_initialized, true);
 
 err_end:
   ret = pthread_mutex_unlock(&s_mutex);
@@ -72,13 +199,28 @@ PlErrCode PlLheapFinalizeOsImpl(void) {
     goto err_mutex;
   }
 
-  if (!s_is_initialized) {
+  if (!atomic_load(&s_is_initialized)) {
     pl_ercd = kPlErrInvalidState;
     LOG_E(0x05, "Not initialized.");
     goto err_end;
   }
 
-  s_is_initialized = false;
+  atomic_store(&s_is_initialized, false);
+  atomic_fetch_add(&s_generation, 1);
+
+  // Give the heap blocks of the shared free lists back to the OS. Arena
+  // blocks stay there for the next initialization. Thread caches are drained
+  // by their own threads on their next call or at thread exit.
+  for (uint32_t i = 0; i < PL_LHEAP_CLASS_NUM; i++) {
+    LheapClassList *list = &s_class_list[i];
+    pthread_mutex_lock(&list->mutex);
+    LheapBlock *head = list->head;
+    list->head = NULL;
+    atomic_fetch_sub(&s_free_bytes, list->heap_bytes);
+    list->heap_bytes = 0;
+    pthread_mutex_unlock(&list->mutex);
+    LheapClassPush(i, head, false);
+  }
 
 err_end:
   ret = pthread_mutex_unlock(&s_mutex);
@@ -92,146 +234,99 @@ err_mutex:
 
 // -----------------------------------------------------------------------------
 PlLheapHandle PlLheapAllocOsImpl(uint32_t size) {
-  int32_t ret = pthread_mutex_lock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x07, "pthread_mutex_lock() error(ret:%d errno:%d)", ret, errno);
-    return NULL;
-  }
-
-  void* handle = NULL;
-  if (!s_is_initialized) {
+  if (!atomic_load_explicit(&s_is_initialized, memory_order_acquire)) {
     LOG_E(0x08, "Not initialized.");
-    goto err_end;
+    return NULL;
   }
 
   if (size == 0) {
     LOG_E(0x09, "argument(size) error.");
-    goto err_end;
+    return NULL;
   }
 
-  handle = (void *)malloc(size);
-  if (handle == NULL) {
-    LOG_E(0x0A, "malloc() failed. size=%d", size);
-    goto err_end;
+  uint32_t class_idx = LheapClassIndex(size);
+  LheapBlock *block = NULL;
+  if (class_idx == PL_LHEAP_CLASS_DIRECT) {
+    block = LheapBlockNew(class_idx, size);
+  } else {
+    block = LheapCachePop(class_idx);
+    if (block == NULL) {
+      block = LheapBlockNew(class_idx, LheapClassSize(class_idx));
+    }
   }
-
-err_end:
-  ret = pthread_mutex_unlock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x0C, "pthread_mutex_unlock() error(ret:%d errno:%d)", ret, errno);
+  if (block == NULL) {
+    LOG_E(0x0A, "malloc() failed. size=%u", size);
+    return NULL;
   }
-  return handle;
+
+  block->magic = PL_LHEAP_MAGIC_USED;
+  return (PlLheapHandle)((uint8_t *)block + PL_LHEAP_HEADER_SIZE);
 }
 
 // -----------------------------------------------------------------------------
 PlErrCode PlLheapFreeOsImpl(PlLheapHandle handle) {
-  PlErrCode pl_ercd = kPlErrCodeOk;
-
-  int32_t ret = pthread_mutex_lock(&s_mutex);
-  if (ret != 0) {
-    pl_ercd = kPlErrLock;
-    LOG_E(0x0D, "pthread_mutex_lock() error(ret:%d errno:%d)", ret, errno);
-    goto err_mutex;
-  }
-
-  if (!s_is_initialized) {
-    pl_ercd = kPlErrInvalidState;
+  if (!atomic_load_explicit(&s_is_initialized, memory_order_acquire)) {
     LOG_E(0x0E, "Not initialized.");
-    goto err_end;
+    return kPlErrInvalidState;
   }
 
   if (handle == NULL) {
-    pl_ercd = kPlErrInvalidParam;
     LOG_E(0x0F, "argument(handle) NULL.");
-    goto err_end;
+    return kPlErrInvalidParam;
   }
 
-  free(handle);
+  LheapBlock *block = (LheapBlock *)((uint8_t *)handle - PL_LHEAP_HEADER_SIZE);
+  if (block->magic != PL_LHEAP_MAGIC_USED) {
+    LOG_E(0x10, "argument(handle) is not an allocated block.");
+    return kPlErrInvalidParam;
+  }
+  block->magic = PL_LHEAP_MAGIC_FREE;
 
-err_end:
-  ret = pthread_mutex_unlock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x13, "pthread_mutex_unlock() error(ret:%d errno:%d)", ret, errno);
+  if (block->class_idx == PL_LHEAP_CLASS_DIRECT) {
+    free(block);
+  } else {
+    LheapCachePush(block);
   }
 
-err_mutex:
-  return pl_ercd;
+  return kPlErrCodeOk;
 }
 
 // -----------------------------------------------------------------------------
 PlErrCode PlLheapMapOsImpl(const PlLheapHandle handle, void **vaddr) {
-  PlErrCode pl_ercd = kPlErrCodeOk;
-
-  int32_t ret = pthread_mutex_lock(&s_mutex);
-  if (ret != 0) {
-    pl_ercd = kPlErrLock;
-    LOG_E(0x14, "pthread_mutex_lock() error(ret:%d errno:%d)", ret, errno);
-    goto err_mutex;
-  }
-
-  if (!s_is_initialized) {
-    pl_ercd = kPlErrInvalidState;
+  if (!atomic_load_explicit(&s_is_initialized, memory_order_acquire)) {
     LOG_E(0x15, "Not initialized.");
-    goto err_end;
+    return kPlErrInvalidState;
   }
 
   if (handle == NULL) {
-    pl_ercd = kPlErrInvalidParam;
     LOG_E(0x16, "argument(handle) error.");
-    goto err_end;
+    return kPlErrInvalidParam;
   }
   if (vaddr == NULL) {
-    pl_ercd = kPlErrInvalidParam;
     LOG_E(0x17, "argument(vaddr) error.");
-    goto err_end;
+    return kPlErrInvalidParam;
   }
 
   *vaddr = (void *)handle;  // Do nothing
 
-err_end:
-  ret = pthread_mutex_unlock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x1A, "pthread_mutex_unlock() error(ret:%d errno:%d)", ret, errno);
-  }
-
-err_mutex:
-  return pl_ercd;
+  return kPlErrCodeOk;
 }
 
 // -----------------------------------------------------------------------------
 PlErrCode PlLheapUnmapOsImpl(void *vaddr) {
-  PlErrCode pl_ercd = kPlErrCodeOk;
-
-  int32_t ret = pthread_mutex_lock(&s_mutex);
-  if (ret != 0) {
-    pl_ercd = kPlErrLock;
-    LOG_E(0x1B, "pthread_mutex_lock() error(ret:%d errno:%d)", ret, errno);
-    goto err_mutex;
-  }
-
-  if (!s_is_initialized) {
-    pl_ercd = kPlErrInvalidState;
+  if (!atomic_load_explicit(&s_is_initialized, memory_order_acquire)) {
     LOG_E(0x1C, "Not initialized.");
-    goto err_end;
+    return kPlErrInvalidState;
   }
 
   if (vaddr == NULL) {
-    pl_ercd = kPlErrInvalidParam;
     LOG_E(0x1D, "argument(vaddr) error.");
-    goto err_end;
+    return kPlErrInvalidParam;
   }
 
-  (void)vaddr;  // Avoid compiler warning
   // Do nothing
 
-err_end:
-  ret = pthread_mutex_unlock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x21, "pthread_mutex_unlock() error(ret:%d errno:%d)", ret, errno);
-  }
-
-err_mutex:
-  return pl_ercd;
+  return kPlErrCodeOk;
 }
 
 // -----------------------------------------------------------------------------
@@ -241,34 +336,19 @@ PlErrCode PlLheapGetMeminfoOsImpl(PlLheapMeminfo *info) {
 }
 // -----------------------------------------------------------------------------
 bool PlLheapIsValidOsImpl(const PlLheapHandle handle) {
-  bool valid = false;
-
-  int32_t ret = pthread_mutex_lock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x26, "pthread_mutex_lock() error(ret:%d errno:%d)", ret, errno);
-    goto err_mutex;
-  }
-
-  if (!s_is_initialized) {
+  if (!atomic_load_explicit(&s_is_initialized, memory_order_acquire)) {
     LOG_E(0x27, "Not initialized.");
-    goto err_end;
+    return false;
   }
   // argument check
   if (handle == NULL) {
     LOG_E(0x28, "argument(handle) error.");
-    goto err_end;
+    return false;
   }
 
-  valid = true;
-
-err_end:
-  ret = pthread_mutex_unlock(&s_mutex);
-  if (ret != 0) {
-    LOG_E(0x29, "pthread_mutex_unlock() error(ret:%d errno:%d)", ret, errno);
-  }
-
-err_mutex:
-  return valid;
+  const LheapBlock *block =
+      (const LheapBlock *)((const uint8_t *)handle - PL_LHEAP_HEADER_SIZE);
+  return block->magic == PL_LHEAP_MAGIC_USED;
 }
 
 // -----------------------------------------------------------------------------
@@ -319,3 +399,281 @@ bool PlLheapIsMapSupportOsImpl(const PlLheapHandle handle) {
   return true;
 }
 // -----------------------------------------------------------------------------
+
+// Local functions -------------------------------------------------------------
+static void LheapOnce(void) {
+  if (PL_LHEAP_ARENA_SIZE > 0) {
+    void *arena = mmap(NULL, PL_LHEAP_ARENA_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (arena == MAP_FAILED) {
+      // Not fatal, blocks are taken from malloc() instead.
+      LOG_E(0x3E, "mmap() failed. size=%zu errno=%d",
+            (size_t)PL_LHEAP_ARENA_SIZE, errno);
+    } else {
+      s_arena = (uint8_t *)arena;
+      s_arena_size = PL_LHEAP_ARENA_SIZE;
+    }
+  }
+  for (uint32_t i = 0; i < PL_LHEAP_CLASS_NUM; i++) {
+    pthread_mutex_init(&s_class_list[i].mutex, NULL);
+  }
+  int ret = pthread_key_create(&s_cache_key, LheapThreadCacheDestroy);
+  if (ret != 0) {
+    // Not fatal, every allocation goes to the shared free lists instead.
+    LOG_E(0x3F, "pthread_key_create() error(ret:%d)", ret);
+    return;
+  }
+  s_cache_key_valid = true;
+}
+
+// -----------------------------------------------------------------------------
+static uint32_t LheapClassIndex(uint32_t size) {
+  if (size <= PL_LHEAP_SMALL_MAX ||
+      size > (1U << PL_LHEAP_MAX_CLASS_SHIFT)) {
+    return PL_LHEAP_CLASS_DIRECT;
+  }
+  // The top three bits of size - 1 select the class: the leading one gives
+  // the power of two and the next two the quarter step within it.
+  uint32_t value = size - 1;
+  uint32_t shift = 31 - (uint32_t)__builtin_clz(value);
+  uint32_t step = (value >> (shift - 2)) - PL_LHEAP_CLASS_PER_SHIFT;
+  return (shift - PL_LHEAP_SMALL_MAX_SHIFT) * PL_LHEAP_CLASS_PER_SHIFT + step;
+}
+
+// -----------------------------------------------------------------------------
+static size_t LheapClassSize(uint32_t class_idx) {
+  uint32_t shift =
+      class_idx / PL_LHEAP_CLASS_PER_SHIFT + PL_LHEAP_SMALL_MAX_SHIFT;
+  size_t step = class_idx % PL_LHEAP_CLASS_PER_SHIFT;
+  return (PL_LHEAP_CLASS_PER_SHIFT + step + 1) << (shift - 2);
+}
+
+// -----------------------------------------------------------------------------
+static size_t LheapClassBytes(uint32_t class_idx) {
+  return PL_LHEAP_HEADER_SIZE + LheapClassSize(class_idx);
+}
+
+// -----------------------------------------------------------------------------
+static bool LheapFreeBytesReserve(size_t size) {
+  size_t used = atomic_load_explicit(&s_free_bytes, memory_order_relaxed);
+  do {
+    if (size > PL_LHEAP_FREE_BYTES || used > PL_LHEAP_FREE_BYTES - size) {
+      return false;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(
+      &s_free_bytes, &used, used + size, memory_order_relaxed,
+      memory_order_relaxed));
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+static bool LheapIsArenaBlock(const LheapBlock *block) {
+  const uint8_t *addr = (const uint8_t *)block;
+  return s_arena != NULL && addr >= s_arena && addr < s_arena + s_arena_size;
+}
+
+// -----------------------------------------------------------------------------
+static LheapBlock *LheapBlockNew(uint32_t class_idx, size_t size) {
+  if (size > SIZE_MAX - PL_LHEAP_HEADER_SIZE) {
+    return NULL;
+  }
+  size_t total = PL_LHEAP_HEADER_SIZE + size;
+  LheapBlock *block = NULL;
+
+  if (class_idx != PL_LHEAP_CLASS_DIRECT) {
+    // Class sizes are multiples of PL_LHEAP_ALIGN, so carved blocks keep the
+    // arena alignment.
+    pthread_mutex_lock(&s_arena_mutex);
+    if (s_arena != NULL && s_arena_size - s_arena_used >= total) {
+      block = (LheapBlock *)(s_arena + s_arena_used);
+      s_arena_used += total;
+    }
+    pthread_mutex_unlock(&s_arena_mutex);
+    if (block == NULL) {
+      block = (LheapBlock *)aligned_alloc(PL_LHEAP_ALIGN, total);
+    }
+  } else {
+    block = (LheapBlock *)malloc(total);
+  }
+  if (block == NULL) {
+    return NULL;
+  }
+
+  block->class_idx = class_idx;
+  block->next = NULL;
+  return block;
+}
+
+// -----------------------------------------------------------------------------
+static void LheapClassPush(uint32_t class_idx, LheapBlock *head,
+                           bool keep_heap) {
+  LheapClassList *list = &s_class_list[class_idx];
+  size_t bytes = LheapClassBytes(class_idx);
+  LheapBlock *release = NULL;
+
+  pthread_mutex_lock(&list->mutex);
+  while (head != NULL) {
+    LheapBlock *block = head;
+    head = block->next;
+    bool is_arena = LheapIsArenaBlock(block);
+    if (is_arena || (keep_heap && LheapFreeBytesReserve(bytes))) {
+      block->next = list->head;
+      list->head = block;
+      if (!is_arena) {
+        list->heap_bytes += bytes;
+      }
+    } else {
+      block->next = release;
+      release = block;
+    }
+  }
+  pthread_mutex_unlock(&list->mutex);
+
+  while (release != NULL) {
+    LheapBlock *block = release;
+    release = block->next;
+    free(block);
+  }
+}
+
+// -----------------------------------------------------------------------------
+static LheapThreadCache *LheapThreadCacheGet(void) {
+  uint32_t generation = atomic_load_explicit(&s_generation,
+                                             memory_order_relaxed);
+  LheapThreadCache *cache = s_thread_cache;
+  if (cache != NULL) {
+    if (cache->generation != generation) {
+      // Blocks cached before a finalization go back like those of the
+      // shared free lists did.
+      LheapThreadCacheDrain(cache, false);
+      cache->generation = generation;
+    }
+    return cache;
+  }
+  if (PL_LHEAP_THREAD_CACHE_NUM == 0 || !s_cache_key_valid) {
+    return NULL;
+  }
+
+  cache = (LheapThreadCache *)calloc(1, sizeof(LheapThreadCache));
+  if (cache == NULL) {
+    return NULL;
+  }
+  if (pthread_setspecific(s_cache_key, cache) != 0) {
+    free(cache);
+    return NULL;
+  }
+  cache->generation = generation;
+
+  s_thread_cache = cache;
+  return cache;
+}
+
+// -----------------------------------------------------------------------------
+static void LheapThreadCacheDrain(LheapThreadCache *cache, bool keep_heap) {
+  for (uint32_t i = 0; i < PL_LHEAP_CLASS_NUM; i++) {
+    if (cache->head[i] != NULL) {
+      LheapClassPush(i, cache->head[i], keep_heap);
+      cache->head[i] = NULL;
+      cache->count[i] = 0;
+    }
+  }
+  cache->bytes = 0;
+}
+
+// -----------------------------------------------------------------------------
+static void LheapThreadCacheDestroy(void *arg) {
+  LheapThreadCache *cache = (LheapThreadCache *)arg;
+
+  bool keep_heap = atomic_load(&s_is_initialized) &&
+                   cache->generation == atomic_load(&s_generation);
+  LheapThreadCacheDrain(cache, keep_heap);
+
+  s_thread_cache = NULL;
+  free(cache);
+}
+
+// -----------------------------------------------------------------------------
+static LheapBlock *LheapCachePop(uint32_t class_idx) {
+  size_t bytes = LheapClassBytes(class_idx);
+  LheapThreadCache *cache = LheapThreadCacheGet();
+  if (cache != NULL && cache->head[class_idx] != NULL) {
+    LheapBlock *block = cache->head[class_idx];
+    cache->head[class_idx] = block->next;
+    cache->count[class_idx]--;
+    cache->bytes -= bytes;
+    return block;
+  }
+
+  // Take one block for the caller and refill the thread cache in the same
+  // locked section.
+  LheapClassList *list = &s_class_list[class_idx];
+  size_t heap_bytes = 0;
+  pthread_mutex_lock(&list->mutex);
+  LheapBlock *block = list->head;
+  if (block != NULL) {
+    list->head = block->next;
+    if (!LheapIsArenaBlock(block)) {
+      heap_bytes += bytes;
+    }
+    for (uint32_t i = 1; cache != NULL && i < PL_LHEAP_BATCH_NUM &&
+                         list->head != NULL &&
+                         cache->bytes + bytes <= PL_LHEAP_THREAD_CACHE_BYTES;
+         i++) {
+      LheapBlock *refill = list->head;
+      list->head = refill->next;
+      if (!LheapIsArenaBlock(refill)) {
+        heap_bytes += bytes;
+      }
+      refill->next = cache->head[class_idx];
+      cache->head[class_idx] = refill;
+      cache->count[class_idx]++;
+      cache->bytes += bytes;
+    }
+    list->heap_bytes -= heap_bytes;
+  }
+  pthread_mutex_unlock(&list->mutex);
+  if (heap_bytes > 0) {
+    atomic_fetch_sub_explicit(&s_free_bytes, heap_bytes,
+                              memory_order_relaxed);
+  }
+  return block;
+}
+
+// -----------------------------------------------------------------------------
+static void LheapCachePush(LheapBlock *block) {
+  uint32_t class_idx = block->class_idx;
+  size_t bytes = LheapClassBytes(class_idx);
+  LheapThreadCache *cache = LheapThreadCacheGet();
+  if (cache == NULL || cache->bytes + bytes > PL_LHEAP_THREAD_CACHE_BYTES) {
+    block->next = NULL;
+    LheapClassPush(class_idx, block, true);
+    return;
+  }
+
+  // Hand a batch to the shared free list so that blocks freed by one thread
+  // can be reused by another: always when the cache of the class is full,
+  // and from a batch on while the shared free lists have room, so that a
+  // thread that stops allocating does not hold more than it needs.
+  uint32_t count = cache->count[class_idx];
+  size_t batch_bytes = bytes * PL_LHEAP_BATCH_NUM;
+  if (count >= PL_LHEAP_THREAD_CACHE_NUM ||
+      (count >= PL_LHEAP_BATCH_NUM &&
+       atomic_load_explicit(&s_free_bytes, memory_order_relaxed) +
+               batch_bytes <= PL_LHEAP_FREE_BYTES)) {
+    LheapBlock *head = cache->head[class_idx];
+    LheapBlock *tail = head;
+    for (uint32_t i = 1; i < PL_LHEAP_BATCH_NUM; i++) {
+      tail = tail->next;
+    }
+    cache->head[class_idx] = tail->next;
+    cache->count[class_idx] -= PL_LHEAP_BATCH_NUM;
+    cache->bytes -= batch_bytes;
+    tail->next = NULL;
+    LheapClassPush(class_idx, head, true);
+  }
+
+  block->next = cache->head[class_idx];
+  cache->head[class_idx] = block;
+  cache->count[class_idx]++;
+  cache->bytes += bytes;
+}
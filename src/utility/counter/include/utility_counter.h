@@ -0,0 +1,153 @@
+/*
+* SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+// Define the external API for Utility counter code.
+//
+// Counters are statically defined by the module that owns them and register
+// themselves into a process wide registry the first time they are updated (or
+// when UtilityCounterRegister is called explicitly). Updates are lock free and
+// spread over per-thread shards so that hot paths on different cores do not
+// contend on the same cache line. The registry can be walked at any time to
+// take a snapshot of every registered counter.
+
+#ifndef __UTILITY_COUNTER_H
+#define __UTILITY_COUNTER_H
+
+/*******************************************************************************
+ * Included Files
+ ******************************************************************************/
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*******************************************************************************
+ * Pre-preprocessor Definitions
+ ******************************************************************************/
+// Number of shards per counter. Threads are spread over the shards, so this
+// should be close to the number of cores.
+#ifdef CONFIG_UTILITY_COUNTER_SHARD_NUM
+#define UTILITY_COUNTER_SHARD_NUM (CONFIG_UTILITY_COUNTER_SHARD_NUM)
+#else
+#define UTILITY_COUNTER_SHARD_NUM (4)
+#endif
+
+// Shards are padded to this size to avoid false sharing.
+#define UTILITY_COUNTER_CACHE_LINE_SIZE (64)
+
+// Histogram bucket i counts the samples v with 2^(i-1) <= v < 2^i. Bucket 0
+// counts the samples equal to 0 and the last bucket also counts every larger
+// sample.
+#define UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM (32)
+
+// Static initializer of a UtilityCounter.
+#define UTILITY_COUNTER_INITIALIZER(counter_name, counter_type) \
+  {                                                             \
+    .name = (counter_name), .type = (counter_type),             \
+    .registered = 0, .next = NULL,                              \
+  }
+
+// Defines a monotonic counter. Use as
+//   UTILITY_COUNTER_DEFINE(s_psm_save_count, "psm.save");
+// at file scope, optionally prefixed with static.
+#define UTILITY_COUNTER_DEFINE(var, counter_name) \
+  UtilityCounter var =                            \
+      UTILITY_COUNTER_INITIALIZER(counter_name, kUtilityCounterTypeCounter)
+
+// Defines a gauge, i.e. a value that can go up and down.
+#define UTILITY_GAUGE_DEFINE(var, counter_name) \
+  UtilityCounter var =                          \
+      UTILITY_COUNTER_INITIALIZER(counter_name, kUtilityCounterTypeGauge)
+
+// Defines a histogram with power-of-two buckets.
+#define UTILITY_HISTOGRAM_DEFINE(var, counter_name) \
+  UtilityCounter var =                              \
+      UTILITY_COUNTER_INITIALIZER(counter_name, kUtilityCounterTypeHistogram)
+
+// Update helpers for the call sites.
+#define UTILITY_COUNTER_INC(var) UtilityCounterAdd(&(var), 1)
+#define UTILITY_COUNTER_ADD(var, delta) UtilityCounterAdd(&(var), (delta))
+#define UTILITY_GAUGE_SET(var, value) UtilityGaugeSet(&(var), (value))
+#define UTILITY_GAUGE_ADD(var, delta) UtilityGaugeAdd(&(var), (delta))
+#define UTILITY_HISTOGRAM_OBSERVE(var, sample) \
+  UtilityHistogramObserve(&(var), (sample))
+
+/*******************************************************************************
+ * Public Types
+ ******************************************************************************/
+typedef enum {
+  kUtilityCounterOk = 0,
+  kUtilityCounterErrParam,
+  kUtilityCounterErrType,
+} UtilityCounterErrCode;
+
+typedef enum {
+  kUtilityCounterTypeCounter = 0,  // Monotonic counter.
+  kUtilityCounterTypeGauge,        // Value that can go up and down.
+  kUtilityCounterTypeHistogram,    // Distribution of samples.
+} UtilityCounterType;
+
+// One shard of a counter. For a counter "value" is the partial total, for a
+// histogram it is the partial number of samples, "sum" their partial sum and
+// "bucket" their partial distribution.
+typedef struct {
+  _Alignas(UTILITY_COUNTER_CACHE_LINE_SIZE) atomic_uint_fast64_t value;
+  atomic_uint_fast64_t sum;
+  atomic_uint_fast64_t bucket[UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM];
+} UtilityCounterShard;
+
+// Counter object. Define it with the UTILITY_*_DEFINE macros and do not touch
+// the members directly.
+typedef struct UtilityCounter {
+  const char *name;
+  UtilityCounterType type;
+  atomic_int registered;
+  struct UtilityCounter *next;
+  UtilityCounterShard shard[UTILITY_COUNTER_SHARD_NUM];
+  atomic_int_fast64_t gauge;
+} UtilityCounter;
+
+// Point in time copy of a counter.
+typedef struct {
+  const char *name;
+  UtilityCounterType type;
+  // Counter: total. Histogram: number of samples.
+  uint64_t value;
+  // Gauge: current value.
+  int64_t gauge;
+  // Histogram: sum of the samples.
+  uint64_t sum;
+  // Histogram: number of samples per bucket.
+  uint64_t bucket[UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM];
+} UtilityCounterSnapshot;
+
+// Called once per registered counter by UtilityCounterForEachSnapshot.
+typedef void (*UtilityCounterSnapshotCallback)(
+    const UtilityCounterSnapshot *snapshot, void *user_data);
+
+/*******************************************************************************
+ * Public Data
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Inline Functions
+ ******************************************************************************/
+
+/*******************************************************************************
+ * Public Function Prototypes
+ ******************************************************************************/
+UtilityCounterErrCode UtilityCounterRegister(UtilityCounter *counter);
+UtilityCounterErrCode UtilityCounterAdd(UtilityCounter *counter,
+                                        uint64_t delta);
+UtilityCounterErrCode UtilityGaugeSet(UtilityCounter *counter, int64_t value);
+UtilityCounterErrCode UtilityGaugeAdd(UtilityCounter *counter, int64_t delta);
+UtilityCounterErrCode UtilityHistogramObserve(UtilityCounter *counter,
+                                              uint64_t sample);
+UtilityCounterErrCode UtilityCounterGetSnapshot(
+    const UtilityCounter *counter, UtilityCounterSnapshot *snapshot);
+UtilityCounterErrCode UtilityCounterForEachSnapshot(
+    UtilityCounterSnapshotCallback callback, void *user_data);
+
+#endif  // __UTILITY_COUNTER_H
@@ -0,0 +1,187 @@
+/*
+* SPDX-FileCopyrightText: 2024-2025 Sony Semiconductor Solutions Corporation
+*
+* SPDX-License-Identifier: Apache-2.0
+*/
+
+// Includes --------------------------------------------------------------------
+#include "utility_counter.h"
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Macros ----------------------------------------------------------------------
+// Values of UtilityCounter.registered.
+#define COUNTER_UNREGISTERED (0)
+#define COUNTER_REGISTERING (1)
+#define COUNTER_REGISTERED (2)
+
+// Typedefs --------------------------------------------------------------------
+
+// External functions ----------------------------------------------------------
+
+// Local functions -------------------------------------------------------------
+static void CounterEnsureRegistered(UtilityCounter *counter);
+static uint32_t CounterShardIndex(void);
+static uint32_t CounterBucketIndex(uint64_t sample);
+
+// Global Variables ------------------------------------------------------------
+// Head of the registry. Counters have static storage duration and are never
+// unlinked, so readers can walk the list without a lock.
+static _Atomic(UtilityCounter *) s_counter_list = NULL;
+
+// Functions -------------------------------------------------------------------
+UtilityCounterErrCode UtilityCounterRegister(UtilityCounter *counter) {
+  if (counter == NULL || counter->name == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  CounterEnsureRegistered(counter);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityCounterAdd(UtilityCounter *counter,
+                                        uint64_t delta) {
+  if (counter == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  if (counter->type != kUtilityCounterTypeCounter) {
+    return kUtilityCounterErrType;
+  }
+  CounterEnsureRegistered(counter);
+  atomic_fetch_add_explicit(&counter->shard[CounterShardIndex()].value, delta,
+                            memory_order_relaxed);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityGaugeSet(UtilityCounter *counter, int64_t value) {
+  if (counter == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  if (counter->type != kUtilityCounterTypeGauge) {
+    return kUtilityCounterErrType;
+  }
+  CounterEnsureRegistered(counter);
+  atomic_store_explicit(&counter->gauge, value, memory_order_relaxed);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityGaugeAdd(UtilityCounter *counter, int64_t delta) {
+  if (counter == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  if (counter->type != kUtilityCounterTypeGauge) {
+    return kUtilityCounterErrType;
+  }
+  CounterEnsureRegistered(counter);
+  atomic_fetch_add_explicit(&counter->gauge, delta, memory_order_relaxed);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityHistogramObserve(UtilityCounter *counter,
+                                              uint64_t sample) {
+  if (counter == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  if (counter->type != kUtilityCounterTypeHistogram) {
+    return kUtilityCounterErrType;
+  }
+  CounterEnsureRegistered(counter);
+  UtilityCounterShard *shard = &counter->shard[CounterShardIndex()];
+  atomic_fetch_add_explicit(&shard->value, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->sum, sample, memory_order_relaxed);
+  atomic_fetch_add_explicit(&shard->bucket[CounterBucketIndex(sample)], 1,
+                            memory_order_relaxed);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityCounterGetSnapshot(
+    const UtilityCounter *counter, UtilityCounterSnapshot *snapshot) {
+  if (counter == NULL || snapshot == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  memset(snapshot, 0, sizeof(*snapshot));
+  snapshot->name = counter->name;
+  snapshot->type = counter->type;
+
+  // The shards are read one by one, so a snapshot taken while other threads
+  // update the counter is consistent per shard but not across shards.
+  for (uint32_t i = 0; i < UTILITY_COUNTER_SHARD_NUM; i++) {
+    snapshot->value +=
+        atomic_load_explicit(&counter->shard[i].value, memory_order_relaxed);
+    snapshot->sum +=
+        atomic_load_explicit(&counter->shard[i].sum, memory_order_relaxed);
+    if (counter->type != kUtilityCounterTypeHistogram) {
+      continue;
+    }
+    for (uint32_t j = 0; j < UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM; j++) {
+      snapshot->bucket[j] += atomic_load_explicit(&counter->shard[i].bucket[j],
+                                                  memory_order_relaxed);
+    }
+  }
+  snapshot->gauge = atomic_load_explicit(&counter->gauge, memory_order_relaxed);
+  return kUtilityCounterOk;
+}
+
+UtilityCounterErrCode UtilityCounterForEachSnapshot(
+    UtilityCounterSnapshotCallback callback, void *user_data) {
+  if (callback == NULL) {
+    return kUtilityCounterErrParam;
+  }
+  UtilityCounterSnapshot snapshot;
+  UtilityCounter *counter =
+      atomic_load_explicit(&s_counter_list, memory_order_acquire);
+  while (counter != NULL) {
+    (void)UtilityCounterGetSnapshot(counter, &snapshot);
+    callback(&snapshot, user_data);
+    counter = counter->next;
+  }
+  return kUtilityCounterOk;
+}
+
+// Local functions -------------------------------------------------------------
+static void CounterEnsureRegistered(UtilityCounter *counter) {
+  if (atomic_load_explicit(&counter->registered, memory_order_acquire) ==
+      COUNTER_REGISTERED) {
+    return;
+  }
+  int expected = COUNTER_UNREGISTERED;
+  if (!atomic_compare_exchange_strong(&counter->registered, &expected,
+                                      COUNTER_REGISTERING)) {
+    // Another thread is linking the counter. The update itself does not need
+    // the link, so there is nothing to wait for.
+    return;
+  }
+  UtilityCounter *head =
+      atomic_load_explicit(&s_counter_list, memory_order_relaxed);
+  do {
+    counter->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(
+      &s_counter_list, &head, counter, memory_order_release,
+      memory_order_relaxed));
+  atomic_store_explicit(&counter->registered, COUNTER_REGISTERED,
+                        memory_order_release);
+}
+
+static uint32_t CounterShardIndex(void) {
+  // pthread_t is an opaque value that is unique per live thread. Mix its bits
+  // so that neighbouring thread descriptors land on different shards.
+  uint64_t key = 0;
+  pthread_t self = pthread_self();
+  memcpy(&key, &self,
+         sizeof(self) < sizeof(key) ? sizeof(self) : sizeof(key));
+  key ^= key >> 33;
+  key *= UINT64_C(0xff51afd7ed558ccd);
+  key ^= key >> 33;
+  return (uint32_t)(key % UTILITY_COUNTER_SHARD_NUM);
+}
+
+static uint32_t CounterBucketIndex(uint64_t sample) {
+  uint32_t index = 0;
+  while (sample != 0 && index < UTILITY_COUNTER_HISTOGRAM_BUCKET_NUM - 1) {
+    sample >>= 1;
+    index++;
+  }
+  return index;
+}
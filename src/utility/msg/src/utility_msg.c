@@ -16,6 +16,7 @@
 #include <sys/queue.h>
 
 #include "utility_msg.h"
+#include "utility_counter.h"
 #include "utility_log.h"
 #include "utility_log_module_id.h"
 
@@ -101,6 +102,8 @@ static pthread_mutex_t s_list_mutex;
 
 static struct MqInfoList s_mq_info_list = {0};
 static bool s_is_initialized = false;
+// Number of messages queued by UtilityMsgSend.
+static UTILITY_COUNTER_DEFINE(s_msg_sent_counter, "utility_msg.sent");
 static int32_t s_handle_cnt = 0;
 
 // Functions -------------------------------------------------------------------
@@ -220,6 +223,7 @@ UtilityMsgErrCode UtilityMsgSend(int32_t handle, const void *msg,
   }
 
   *sent_size = msg_size;
+  UTILITY_COUNTER_INC(s_msg_sent_counter);
 
   return kUtilityMsgOk;
 }
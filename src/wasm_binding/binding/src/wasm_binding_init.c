@@ -47,6 +47,7 @@ static NativeSymbol native_symbols[] = {
 #endif  // CONFIG_EXTERNAL_CODEC_JPEG_WASM
 #ifdef CONFIG_EXTERNAL_CODEC_JPEG_HANDLE_WASM
     REG_NATIVE_FUNC_FILEIO(EsfCodecJpegEncodeHandle, "(iiii)i"),
+    REG_NATIVE_FUNCx(EsfCodecJpegEncodeHandleToBuffer, "(iiiii)i"),
     REG_NATIVE_FUNCx(EsfCodecJpegEncodeRelease, "(i)i"),
 #endif  // CONFIG_EXTERNAL_CODEC_JPEG_HANDLE_WASM
 #ifdef CONFIG_EXTERNAL_DEVICE_ID_WASM
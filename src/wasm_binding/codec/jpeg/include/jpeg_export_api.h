@@ -19,6 +19,10 @@ EsfCodecJpegError EsfCodecJpegEncodeHandle_wasm(
     wasm_exec_env_t exec_env, EsfMemoryManagerHandle input_file_handle,
     uint32_t output_file_handle_offset, uint32_t info_offset,
     uint32_t jpeg_size_offset);
+EsfCodecJpegError EsfCodecJpegEncodeHandleToBuffer_wasm(
+    wasm_exec_env_t exec_env, EsfMemoryManagerHandle input_file_handle,
+    uint32_t info_offset, uint32_t output_offset, uint32_t output_size,
+    uint32_t jpeg_size_offset);
 EsfCodecJpegError EsfCodecJpegEncodeRelease_wasm(
     wasm_exec_env_t exec_env, EsfMemoryManagerHandle release_file_handle);
 
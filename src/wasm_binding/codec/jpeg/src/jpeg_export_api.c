@@ -11,9 +11,11 @@
 #include "jpeg_export_api.h"
 
 #include <inttypes.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "jpeg_export_internal.h"
 #include "jpeg_fileio_internal.h"
@@ -256,6 +258,80 @@ EsfCodecJpegError EsfCodecJpegEncodeHandle_wasm(
   return jpeg_error_ret;
 }
 
+EsfCodecJpegError EsfCodecJpegEncodeHandleToBuffer_wasm(
+    wasm_exec_env_t exec_env, EsfMemoryManagerHandle input_file_handle,
+    uint32_t info_offset, uint32_t output_offset, uint32_t output_size,
+    uint32_t jpeg_size_offset) {
+  if (info_offset == 0 || output_offset == 0 || output_size == 0 ||
+      output_size > (uint32_t)INT32_MAX || jpeg_size_offset == 0) {
+    WASM_BINDING_ERR("Param error! info_offset is %" PRIu32
+                     " output_offset is %" PRIu32 " output_size is %" PRIu32
+                     " jpeg_size_offset is %" PRIu32,
+                     info_offset, output_offset, output_size,
+                     jpeg_size_offset);
+    return kJpegParamError;
+  }
+  wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+
+  // 1. info_offset
+  if (!wasm_runtime_validate_app_addr(module_inst, info_offset,
+                                      sizeof(EsfCodecJpegInfo))) {
+    WASM_BINDING_ERR("bounds check error! info_offset=%" PRIu32, info_offset);
+    return kJpegParamError;
+  }
+  const EsfCodecJpegInfo *info =
+      (const EsfCodecJpegInfo *)wasm_runtime_addr_app_to_native(module_inst,
+                                                                info_offset);
+  if (info == NULL) {
+    WASM_BINDING_ERR("address conversion error! info is NULL");
+    return kJpegParamError;
+  }
+
+  // 2. jpeg_size_offset
+  if (!wasm_runtime_validate_app_addr(module_inst, jpeg_size_offset,
+                                      sizeof(int32_t))) {
+    WASM_BINDING_ERR("bounds check error! jpeg_size_offset=%" PRIu32,
+                     jpeg_size_offset);
+    return kJpegParamError;
+  }
+  int32_t *jpeg_size = (int32_t *)wasm_runtime_addr_app_to_native(
+      module_inst, jpeg_size_offset);
+  if (jpeg_size == NULL) {
+    WASM_BINDING_ERR("address conversion error! jpeg_size is NULL");
+    return kJpegParamError;
+  }
+
+  // 3. The whole output range must be in the linear memory, since the JPEG
+  // data is written there by the encoder without a copy.
+  if (!wasm_runtime_validate_app_addr(module_inst, output_offset,
+                                      output_size)) {
+    WASM_BINDING_ERR("bounds check error! output_offset=%" PRIu32
+                     " output_size=%" PRIu32,
+                     output_offset, output_size);
+    return kJpegParamError;
+  }
+  void *output = wasm_runtime_addr_app_to_native(module_inst, output_offset);
+  if (output == NULL) {
+    WASM_BINDING_ERR("address conversion error! output is NULL");
+    return kJpegParamError;
+  }
+  WASM_BINDING_TRC("input_file_handle: %" PRIu32, input_file_handle);
+
+  // API Call.
+  EsfCodecJpegOutputBuf out_buf = {
+      .output_adr_handle = (uint64_t)(uintptr_t)output,
+      .output_buf_size = (int32_t)output_size};
+  EsfCodecJpegError jpeg_error_ret = EsfCodecJpegEncodeHandleToMemory(
+      input_file_handle, info, &out_buf, jpeg_size);
+  if (jpeg_error_ret != kJpegSuccess) {
+    WASM_BINDING_ERR("EsfCodecJpegEncodeHandleToMemory failed. ret = %d",
+                     jpeg_error_ret);
+  } else {
+    WASM_BINDING_TRC("jpeg_size=%d", *jpeg_size);
+  }
+  return jpeg_error_ret;
+}
+
 EsfCodecJpegError EsfCodecJpegEncode_wasm(wasm_exec_env_t exec_env,
                                           uint32_t enc_param_offset,
                                           uint32_t jpeg_size_offset) {
@@ -266,19 +342,20 @@ EsfCodecJpegError EsfCodecJpegEncode_wasm(wasm_exec_env_t exec_env,
     return kJpegParamError;
   }
 
-  EsfCodecJpegError jpeg_error_ret = kJpegSuccess;
-  uint64_t input_buff_addr = 0;
-  uint64_t output_buff_addr = 0;
   int32_t input_buff_size = 0;
   int32_t output_buff_size = 0;
 
   wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
-  EsfCodecJpegEncParam *enc_param = NULL;
+  const EsfCodecJpegEncParam *app_enc_param = NULL;
   int32_t *jpeg_size = NULL;
 
+  // The parameters of applications end before the region and the scale, so
+  // only that part is read and the rest keeps encoding the whole image.
+  size_t app_enc_param_size = offsetof(EsfCodecJpegEncParam, roi);
+
   // encode parameter & jpeg size check
   if (!wasm_runtime_validate_app_addr(module_inst, enc_param_offset,
-                                      sizeof(EsfCodecJpegEncParam))) {
+                                      app_enc_param_size)) {
     WASM_BINDING_ERR("bounds check error! enc_param_offset=%d",
                      enc_param_offset);
     return kJpegParamError;
@@ -291,13 +368,19 @@ EsfCodecJpegError EsfCodecJpegEncode_wasm(wasm_exec_env_t exec_env,
   }
 
   // do address conversion
-  enc_param = (EsfCodecJpegEncParam *)wasm_runtime_addr_app_to_native(
+  app_enc_param = (const EsfCodecJpegEncParam *)wasm_runtime_addr_app_to_native(
       module_inst, enc_param_offset);
-  if (enc_param == NULL) {
+  if (app_enc_param == NULL) {
     WASM_BINDING_ERR("address conversion error! enc_param is NULL");
     return kJpegParamError;
   }
 
+  // The addresses are converted in a copy, so the parameters of the
+  // application are left as they are.
+  EsfCodecJpegEncParam local_enc_param = {0};
+  EsfCodecJpegEncParam *enc_param = &local_enc_param;
+  memcpy(enc_param, app_enc_param, app_enc_param_size);
+
   if (enc_param->input_adr_handle == 0 ||
       enc_param->out_buf.output_adr_handle == 0) {
     WASM_BINDING_ERR(
@@ -314,10 +397,6 @@ EsfCodecJpegError EsfCodecJpegEncode_wasm(wasm_exec_env_t exec_env,
     return kJpegParamError;
   }
 
-  // back up the addresses of the input and output buffers.
-  input_buff_addr = enc_param->input_adr_handle;
-  output_buff_addr = enc_param->out_buf.output_adr_handle;
-
   // get the input buffer size using the new helper function
   input_buff_size = CalculateInputBufferSize(
       enc_param->stride, enc_param->height, enc_param->input_fmt);
@@ -351,17 +430,9 @@ EsfCodecJpegError EsfCodecJpegEncode_wasm(wasm_exec_env_t exec_env,
     WASM_BINDING_ERR(
         "address validation error! output buffer address is invalid or out of "
         "bounds");
-    // reset the input buffer addresses to their original values.
-    enc_param->input_adr_handle = input_buff_addr;
     return kJpegParamError;
   }
 
   // API Call.
-  jpeg_error_ret = EsfCodecJpegEncode(enc_param, jpeg_size);
-
-  // reset the input and output buffer addresses to their original values.
-  enc_param->input_adr_handle = input_buff_addr;
-  enc_param->out_buf.output_adr_handle = output_buff_addr;
-
-  return jpeg_error_ret;
+  return EsfCodecJpegEncode(enc_param, jpeg_size);
 }
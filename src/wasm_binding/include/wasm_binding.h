@@ -98,6 +98,10 @@ EsfCodecJpegError EsfCodecJpegEncodeHandle(
     EsfMemoryManagerHandle *output_file_handle, const EsfCodecJpegInfo *info,
     int32_t *jpeg_size);
 
+EsfCodecJpegError EsfCodecJpegEncodeHandleToBuffer(
+    EsfMemoryManagerHandle input_file_handle, const EsfCodecJpegInfo *info,
+    uint8_t *output, uint32_t output_size, int32_t *jpeg_size);
+
 EsfCodecJpegError EsfCodecJpegEncodeRelease(
     EsfMemoryManagerHandle release_file_handle);
 